@@ -30,6 +30,242 @@
 #ifndef POLYFIT_H
 #define POLYFIT_H
 
+#include <stdbool.h>    // bool
+#include <stddef.h>     // size_t
+
+
+//------------------------------------------------
+// Types
+//------------------------------------------------
+
+// Streaming accumulator of the sums that make up the
+// normal equations of a least squares polynomial fit.
+typedef struct polyfit_accum_s
+{
+    int         coefficientCount;   // Number of coefficients to be fitted.
+    long long   pointCount;         // Number of points added so far.
+    double *    pPowerSums;         // (2 * coefficientCount - 1) sums of x^j, ascending j.
+    double *    pRhsSums;           // coefficientCount sums of (x^j * y), ascending j.
+    double      ySquareSum;         // Sum of y^2, for the goodness of fit.
+} polyfit_accum_t;
+
+
+// Linear solvers for the least squares equations.
+typedef enum polyfit_solver_e
+{
+    POLYFIT_SOLVER_DEFAULT = 0,     // Cholesky, or QR if Cholesky refuses a pivot.
+    POLYFIT_SOLVER_CHOLESKY,        // Packed Cholesky on (AT)A; about k^3/6 flops.
+    POLYFIT_SOLVER_QR,              // Householder QR on A; for ill-conditioned inputs.
+    POLYFIT_SOLVER_GAUSS_JORDAN     // The original unpivoted Gauss-Jordan; about k^3 flops.
+} polyfit_solver_t;
+
+// Caller-owned working storage for polyfit_ws(). Set up
+// by polyfit_workspace_init() in memory sized by
+// polyfit_workspace_size().
+typedef struct polyfit_workspace_s
+{
+    int         maxPoints;          // Most points a fit may use.
+    int         maxCoefficients;    // Most coefficients a fit may use.
+    size_t      size;               // Bytes at pMemory.
+    double *    pMemory;
+    polyfit_solver_t solver;        // Solver to use; set to DEFAULT by polyfit_workspace_init().
+    polyfit_solver_t solverUsed;    // Solver the last polyfit_ws() call ran.
+} polyfit_workspace_t;
+
+// Savitzky-Golay filter: convolution weights for every
+// position in a window, precomputed by polyfit_savgol_init().
+typedef struct polyfit_savgol_s
+{
+    int         windowLength;       // Samples per window; odd.
+    int         coefficientCount;   // Coefficients of the polynomial fitted to each window.
+    int         derivativeOrder;    // 0 to smooth, 1 for the first derivative, and so on.
+    double *    pWeights;           // windowLength rows of windowLength weights.
+} polyfit_savgol_t;
+
+// Fit plan for a fixed set of x positions: the projection
+// from y values to coefficients, made by polyfit_plan_init().
+typedef struct polyfit_plan_s
+{
+    int         pointCount;
+    int         coefficientCount;
+    double *    pProjection;        // coefficientCount rows of pointCount weights.
+} polyfit_plan_t;
+
+// Power sum kernels, from slowest to fastest. Each vector
+// kernel needs the instruction set it is named after.
+typedef enum polyfit_kernel_e
+{
+    POLYFIT_KERNEL_AUTO = 0,    // The fastest kernel the CPU supports.
+    POLYFIT_KERNEL_SCALAR,      // Portable C.
+    POLYFIT_KERNEL_SSE2,        // 2 doubles per vector.
+    POLYFIT_KERNEL_AVX2,        // 4 doubles per vector.
+    POLYFIT_KERNEL_AVX512       // 8 doubles per vector.
+} polyfit_kernel_t;
+
+// The measurements of one fit, passed to a stats hook.
+typedef struct polyfit_call_stats_s
+{
+    int         status;             // What the fit returned.
+    int         pointCount;
+    int         coefficientCount;
+    polyfit_solver_t solver;        // The solver that ran; DEFAULT if none did.
+    double      buildNs;            // Argument checks, allocation and setup.
+    double      accumulateNs;       // Summing the normal equations.
+    double      solveNs;            // Solving them; all of the work for QR.
+    double      conditionEstimate;  // Of (AT)A; 0 if not estimated, infinite if singular.
+} polyfit_call_stats_t;
+
+// Running totals kept while stats are enabled.
+typedef struct polyfit_stats_s
+{
+    unsigned long long  calls;                  // Fits measured.
+    unsigned long long  failures[ 6 ];          // failures[e] counts fits that returned -e.
+    unsigned long long  allocations;            // Library heap allocations.
+    unsigned long long  bytesAllocated;
+    unsigned long long  buildNs;                // Phase times summed over all fits.
+    unsigned long long  accumulateNs;
+    unsigned long long  solveNs;
+    double              worstConditionEstimate;
+} polyfit_stats_t;
+
+// Called after each measured fit, on the fitting thread.
+typedef void (*polyfit_stats_hook_t)( const polyfit_call_stats_t *pCall, void *pUserData );
+
+// How well a fit matches its points, from polyfit_goodness().
+typedef struct polyfit_goodness_s
+{
+    long long   pointCount;
+    long long   degreesOfFreedom;   // pointCount - coefficientCount.
+    double      sse;                // Sum of squared residuals.
+    double      sst;                // Sum of squares of y about its mean.
+    double      rSquared;           // 1 - sse / sst; NaN if y is constant.
+    double      adjustedRSquared;   // NaN if y is constant or there are no degrees of freedom.
+    double      residualVariance;   // sse / degreesOfFreedom; NaN if there are none.
+} polyfit_goodness_t;
+
+// How polyfit_auto() scores each candidate degree. The
+// lowest score wins.
+typedef enum polyfit_criterion_e
+{
+    POLYFIT_CRITERION_AIC = 0,      // Akaike: n ln(sse / n) + 2k.
+    POLYFIT_CRITERION_BIC,          // Bayesian: n ln(sse / n) + k ln(n); favours fewer coefficients.
+    POLYFIT_CRITERION_GCV           // Generalized cross-validation: n sse / (n - k)^2.
+} polyfit_criterion_t;
+
+// Piecewise polynomial made by polyfit_piecewise_fit(). Segment s
+// covers knots s to s + 1, and its polynomial is in (x - pKnots[s]).
+typedef struct polyfit_piecewise_s
+{
+    int         segmentCount;
+    int         coefficientCount;   // Per segment.
+    double *    pKnots;             // segmentCount + 1 ascending x values.
+    double *    pCoefficients;      // segmentCount rows of coefficientCount, highest power first.
+} polyfit_piecewise_t;
+
+// Called on a service worker thread when a job's fit is done,
+// before the job is marked done.
+struct polyfit_job_s;
+typedef void (*polyfit_job_callback_t)( struct polyfit_job_s *pJob, void *pUserData );
+
+// A fit for polyfit_service_submit(). The caller owns the job and
+// its arrays, and must leave them alone until the job is done.
+typedef struct polyfit_job_s
+{
+    int                     pointCount;
+    double *                xValues;
+    double *                yValues;
+    int                     coefficientCount;
+    double *                coefficientResults;
+    polyfit_job_callback_t  callback;           // NULL to poll or wait instead.
+    void *                  pUserData;          // Passed to the callback.
+    int                     status;             // What polyfit() would return, once done.
+    int                     done;               // Set by the service; see polyfit_job_done().
+    double                  submitNs;           // Set by the service.
+} polyfit_job_t;
+
+// A pool of fitting threads fed by a job queue, made by
+// polyfit_service_create(). Its contents are private.
+typedef struct polyfit_service_s polyfit_service_t;
+
+// The counts and latencies of a service since it was created,
+// from polyfit_service_metrics().
+typedef struct polyfit_service_metrics_s
+{
+    long long   submitted;
+    long long   completed;
+    long long   rejected;           // Submissions turned away because the queue was full.
+    int         queueDepth;         // Jobs waiting for a thread now.
+    int         maxQueueDepth;
+    double      meanLatencyNs;      // From submission until done.
+    double      p50LatencyNs;       // Percentiles within about 5%.
+    double      p99LatencyNs;
+    double      maxLatencyNs;
+} polyfit_service_metrics_t;
+
+// Online fit of the latest points of a stream, made by
+// polyfit_online_init(). The sums and state are kept in
+// x - origin, to stay well conditioned as x grows.
+typedef struct polyfit_online_s
+{
+    int         coefficientCount;
+    int         windowLength;       // Most points kept.
+    double      forgetting;         // 1 for a sliding window; below 1 for recursive least squares.
+    int         rebuildInterval;    // Points added between re-accumulations from the kept points.
+    int         pointCount;         // Points kept now.
+    int         oldest;             // Index of the oldest kept point.
+    int         sinceRebuild;
+    bool        primed;             // Recursive least squares: the state is set up.
+    double      origin;
+    double *    pXValues;           // windowLength kept points, oldest at index oldest.
+    double *    pYValues;
+    double *    pSums;              // (2 * coefficientCount - 1) power sums, then coefficientCount rhs sums.
+    double *    pState;             // Coefficients in x - origin, then their coefficientCount^2 P matrix.
+    double *    pScratch;
+} polyfit_online_t;
+
+// Element types an input view can read.
+typedef enum polyfit_type_e
+{
+    POLYFIT_TYPE_DOUBLE = 0,
+    POLYFIT_TYPE_FLOAT,
+    POLYFIT_TYPE_INT32,
+    POLYFIT_TYPE_INT64,
+    POLYFIT_TYPE_TIME_NS        // int64 nanoseconds, read as seconds since origin.
+} polyfit_type_t;
+
+// A column of values in the caller's memory: the i'th is
+// the element of type at pBase + i * stride bytes, so
+// fields of an array of structs can be read in place.
+typedef struct polyfit_view_s
+{
+    const void *    pBase;
+    size_t          stride;         // Bytes from one value to the next.
+    polyfit_type_t  type;
+    long long       origin;         // Integer and timestamp types: subtracted exactly before converting.
+} polyfit_view_t;
+
+// Most inputs of a surface fit.
+#define POLYFIT_SURFACE_MAX_DIMENSIONS  (4)
+
+// A polynomial in several variables, fitted by
+// polyfit_surface_fit(): the sum over its terms of
+// coefficient * x0^e0 * x1^e1 * ..., one term for each
+// row of exponents. It is evaluated in the variables
+// u = (x - offset) * scale, with the same terms, from
+// pCentred, which loses less to cancellation far from
+// the origin.
+typedef struct polyfit_surface_s
+{
+    int         dimensionCount;
+    int         termCount;
+    int *       pExponents;         // termCount rows of dimensionCount exponents.
+    double *    pCoefficients;      // One per term, in the same order.
+    int *       pSteps;             // How each term is built from an earlier one, for evaluation.
+    double *    pCentred;           // The coefficients in the u variables, in the same order.
+    double      offsets[ POLYFIT_SURFACE_MAX_DIMENSIONS ];  // Each variable's mid-range, or 0.
+    double      scales[ POLYFIT_SURFACE_MAX_DIMENSIONS ];   // Powers of 2 bringing each within -1 .. 1.
+} polyfit_surface_t;
+
 
 //------------------------------------------------
 // Function Prototypes
@@ -44,6 +280,638 @@
 //--------------------------------------------------------
 int polyfit( int pointCount, double *xValues, double *yValues, int coefficientCount, double *coefficientResults );
 
+//--------------------------------------------------------
+// polyfit_workspace_size()
+// Returns the bytes of working storage polyfit_ws() needs
+// for fits of up to maxPoints points and maxCoefficients
+// coefficients, or 0 if a count is out of range.
+//--------------------------------------------------------
+size_t polyfit_workspace_size( int maxPoints, int maxCoefficients );
+
+//--------------------------------------------------------
+// polyfit_workspace_size_for_solver()
+// Same as polyfit_workspace_size(), for a given solver.
+// The QR solver needs room for the whole of A.
+//--------------------------------------------------------
+size_t polyfit_workspace_size_for_solver( polyfit_solver_t solver, int maxPoints, int maxCoefficients );
+
+//--------------------------------------------------------
+// polyfit_workspace_init()
+// Prepares a workspace in caller-owned memory.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_workspace_init( polyfit_workspace_t *pWorkspace, void *pMemory, size_t memorySize,
+                            int maxPoints, int maxCoefficients );
+
+//--------------------------------------------------------
+// polyfit_ws()
+// Same as polyfit(), but uses only the workspace's memory
+// and never touches the heap.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_ws( polyfit_workspace_t *pWorkspace, int pointCount, double *xValues, double *yValues,
+                int coefficientCount, double *coefficientResults );
+
+//--------------------------------------------------------
+// polyfit_with_solver()
+// Same as polyfit(), but with a chosen solver. The solver
+// that ran is stored in *pSolverUsed, unless it's NULL.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_with_solver( int pointCount, double *xValues, double *yValues, int coefficientCount,
+                         double *coefficientResults, polyfit_solver_t solver, polyfit_solver_t *pSolverUsed );
+
+//--------------------------------------------------------
+// polyfit_solver_name()
+// Returns a printable name for a solver.
+//--------------------------------------------------------
+const char *polyfit_solver_name( polyfit_solver_t solver );
+
+//--------------------------------------------------------
+// polyfit_set_allocator()
+// Replaces the calloc() and free() used for all of the
+// library's heap memory. NULL restores the defaults.
+//--------------------------------------------------------
+void polyfit_set_allocator( void *(*pCalloc)( size_t count, size_t size ), void (*pFree)( void *pMemory ) );
+
+//--------------------------------------------------------
+// polyfit_accum_init()
+// Prepares an accumulator for a fit with coefficientCount
+// coefficients. Its memory use does not grow with the
+// number of points added.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_accum_init( polyfit_accum_t *pAccum, int coefficientCount );
+
+//--------------------------------------------------------
+// polyfit_accum_add()
+// Adds one point to an accumulator.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_accum_add( polyfit_accum_t *pAccum, double x, double y );
+
+//--------------------------------------------------------
+// polyfit_accum_add_many()
+// Adds an array of points to an accumulator.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_accum_add_many( polyfit_accum_t *pAccum, int pointCount, double *xValues, double *yValues );
+
+//--------------------------------------------------------
+// polyfit_accum_solve()
+// Computes the coefficients that best fit the points
+// added to an accumulator so far.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_accum_solve( polyfit_accum_t *pAccum, double *coefficientResults );
+
+//--------------------------------------------------------
+// polyfit_accum_solve_with()
+// Same as polyfit_accum_solve(), with a chosen solver
+// other than QR.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_accum_solve_with( polyfit_accum_t *pAccum, polyfit_solver_t solver, double *coefficientResults );
+
+//--------------------------------------------------------
+// polyfit_accum_free()
+// Releases the memory held by an accumulator.
+//--------------------------------------------------------
+void polyfit_accum_free( polyfit_accum_t *pAccum );
+
+//--------------------------------------------------------
+// polyfit_accum_merge()
+// Adds the points of one accumulator to another, so that
+// shards of a fit can be accumulated apart and combined.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_accum_merge( polyfit_accum_t *pInto, polyfit_accum_t *pFrom );
+
+//--------------------------------------------------------
+// polyfit_parallel()
+// Same as polyfit(), but accumulates the power sums on
+// threadCount threads (0 means one per online CPU). The
+// result does not depend on the thread count.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_parallel( int pointCount, double *xValues, double *yValues, int coefficientCount,
+                      double *coefficientResults, int threadCount );
+
+//--------------------------------------------------------
+// polyfit_accum_add_many_parallel()
+// Adds an array of points to an accumulator, using up to
+// threadCount threads (0 means one per online CPU).
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_accum_add_many_parallel( polyfit_accum_t *pAccum, int pointCount, double *xValues, double *yValues,
+                                     int threadCount );
+
+//--------------------------------------------------------
+// polyfit_batch()
+// Fits every one of seriesCount independent series, packed
+// end to end in xValues and yValues. Series s occupies
+// elements seriesOffsets[s] to (seriesOffsets[s + 1] - 1).
+// Per-series polyfit() return values go to seriesStatus.
+// For 2 to 4 coefficients, short series are fitted four
+// at a time in AVX2 lanes where the CPU has it, giving
+// polyfit()'s coefficients bit for bit, 1.4 to 2.5 times
+// as fast as a polyfit() call per series.
+// Returns 0 if every series was fitted.
+//--------------------------------------------------------
+int polyfit_batch( int seriesCount, int *seriesOffsets, double *xValues, double *yValues,
+                   int coefficientCount, double *coefficientResults, int *seriesStatus );
+
+//--------------------------------------------------------
+// polyfit_kernel_detect()
+// Returns the fastest power sum kernel the CPU supports,
+// as found from its CPUID feature bits.
+//--------------------------------------------------------
+polyfit_kernel_t polyfit_kernel_detect( void );
+
+//--------------------------------------------------------
+// polyfit_kernel_supported()
+// Returns true if a kernel can run on this CPU.
+//--------------------------------------------------------
+bool polyfit_kernel_supported( polyfit_kernel_t kernel );
+
+//--------------------------------------------------------
+// polyfit_kernel_name()
+// Returns a printable name for a kernel.
+//--------------------------------------------------------
+const char *polyfit_kernel_name( polyfit_kernel_t kernel );
+
+//--------------------------------------------------------
+// polyfit_power_sums()
+// Adds the power sums of an array of points, using the
+// given kernel, into pPowerSums (2 * coefficientCount - 1
+// sums of x^j) and pRhsSums (coefficientCount sums of
+// x^j * y), both in ascending order of j.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_power_sums( polyfit_kernel_t kernel, int pointCount, double *xValues, double *yValues,
+                        int coefficientCount, double *pPowerSums, double *pRhsSums );
+
+//--------------------------------------------------------
+// polyfit_savgol_init()
+// Precomputes a Savitzky-Golay filter that fits a
+// polynomial to each window of windowLength evenly spaced
+// samples and takes its derivativeOrder'th derivative.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_savgol_init( polyfit_savgol_t *pFilter, int windowLength, int coefficientCount, int derivativeOrder,
+                         double sampleSpacing );
+
+//--------------------------------------------------------
+// polyfit_savgol_apply()
+// Smooths or differentiates a whole signal, including its
+// ends. inValues and outValues must not overlap.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_savgol_apply( polyfit_savgol_t *pFilter, int sampleCount, double *inValues, double *outValues );
+
+//--------------------------------------------------------
+// polyfit_savgol_free()
+// Releases the memory held by a filter.
+//--------------------------------------------------------
+void polyfit_savgol_free( polyfit_savgol_t *pFilter );
+
+//--------------------------------------------------------
+// polyfit_linear()
+// Same as polyfit() with 2 coefficients, specialized for
+// speed; polyfit() calls it itself.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_linear( int pointCount, double *xValues, double *yValues, double *coefficientResults );
+
+//--------------------------------------------------------
+// polyfit_quadratic()
+// Same as polyfit() with 3 coefficients, specialized for
+// speed; polyfit() calls it itself.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_quadratic( int pointCount, double *xValues, double *yValues, double *coefficientResults );
+
+//--------------------------------------------------------
+// polyfit_cubic()
+// Same as polyfit() with 4 coefficients, specialized for
+// speed; polyfit() calls it itself.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_cubic( int pointCount, double *xValues, double *yValues, double *coefficientResults );
+
+//--------------------------------------------------------
+// polyval()
+// Evaluates a polynomial, coefficients highest power
+// first as polyfit() gives them, at an array of x values.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyval( int coefficientCount, double *coefficients, int pointCount, double *xValues, double *yValues );
+
+//--------------------------------------------------------
+// polyval_batch()
+// Same as polyval(), also giving the first and second
+// derivatives unless their arrays are NULL.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyval_batch( int coefficientCount, double *coefficients, int pointCount, double *xValues, double *yValues,
+                   double *firstDerivatives, double *secondDerivatives );
+
+//--------------------------------------------------------
+// polyfit_uniform()
+// Same as polyfit(), for evenly spaced x values x0, x0 +
+// dx, x0 + 2 * dx, ..., so no x array is needed.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_uniform( int pointCount, double x0, double dx, double *yValues, int coefficientCount,
+                     double *coefficientResults );
+
+//--------------------------------------------------------
+// polyfit_plan_init()
+// Precomputes the fit of any y values at these x values.
+// Release the plan with polyfit_plan_free().
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_plan_init( polyfit_plan_t *pPlan, int pointCount, double *xValues, int coefficientCount );
+
+//--------------------------------------------------------
+// polyfit_plan_execute()
+// Fits one series of y values with a plan.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_plan_execute( polyfit_plan_t *pPlan, double *yValues, double *coefficientResults );
+
+//--------------------------------------------------------
+// polyfit_plan_execute_many()
+// Fits seriesCount packed series of y values with a plan.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_plan_execute_many( polyfit_plan_t *pPlan, int seriesCount, double *yValues, double *coefficientResults );
+
+//--------------------------------------------------------
+// polyfit_plan_free()
+// Releases the memory held by a plan.
+//--------------------------------------------------------
+void polyfit_plan_free( polyfit_plan_t *pPlan );
+
+//--------------------------------------------------------
+// polyfitf()
+// Same as polyfit(), for float data, accumulated in float
+// vector lanes for speed. See README.md for its accuracy.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfitf( int pointCount, float *xValues, float *yValues, int coefficientCount, float *coefficientResults );
+
+//--------------------------------------------------------
+// polyfitf_mixed()
+// Fits float data with float accumulation, then refines
+// the coefficients in double to near double accuracy,
+// starting again from double sums when the float ones
+// are too coarse to refine. Returns 0 if success.
+//--------------------------------------------------------
+int polyfitf_mixed( int pointCount, float *xValues, float *yValues, int coefficientCount,
+                    double *coefficientResults );
+
+//--------------------------------------------------------
+// polyfit_stats_enable()
+// Turns the measurement of fits on or off. It starts off,
+// when it costs a single flag test per fit.
+//--------------------------------------------------------
+void polyfit_stats_enable( bool enable );
+
+//--------------------------------------------------------
+// polyfit_stats_get()
+// Copies the running totals into *pStats.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_stats_get( polyfit_stats_t *pStats );
+
+//--------------------------------------------------------
+// polyfit_stats_reset()
+// Clears the running totals.
+//--------------------------------------------------------
+void polyfit_stats_reset( void );
+
+//--------------------------------------------------------
+// polyfit_stats_set_hook()
+// Sets a function to receive the measurements of each
+// fit, or removes it if hook is NULL.
+//--------------------------------------------------------
+void polyfit_stats_set_hook( polyfit_stats_hook_t hook, void *pUserData );
+
+//--------------------------------------------------------
+// polyfit_format_double()
+// Writes the shortest decimal text that reads back as
+// exactly value. *pLength receives its length.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_format_double( char *buffer, size_t bufferSize, double value, size_t *pLength );
+
+//--------------------------------------------------------
+// polyfit_encode_json()
+// Writes coefficients as a JSON array of shortest round
+// trip numbers. *pLength receives the length needed.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_encode_json( char *buffer, size_t bufferSize, int coefficientCount, double *coefficients,
+                         size_t *pLength );
+
+//--------------------------------------------------------
+// polyfit_decode_json()
+// Reads coefficients written by polyfit_encode_json().
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_decode_json( const char *text, size_t textLength, int maxCoefficients, double *coefficients,
+                         int *pCoefficientCount, size_t *pLength );
+
+//--------------------------------------------------------
+// polyfit_encode_binary()
+// Writes coefficients as a little endian count and
+// doubles. *pLength receives the length needed.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_encode_binary( void *buffer, size_t bufferSize, int coefficientCount, double *coefficients,
+                           size_t *pLength );
+
+//--------------------------------------------------------
+// polyfit_decode_binary()
+// Reads coefficients written by polyfit_encode_binary().
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_decode_binary( const void *buffer, size_t bufferSize, int maxCoefficients, double *coefficients,
+                           int *pCoefficientCount, size_t *pLength );
+
+//--------------------------------------------------------
+// polyfit_accum_encode()
+// Writes the state of an accumulator in a versioned,
+// little endian binary form. *pLength receives the length
+// needed.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_accum_encode( void *buffer, size_t bufferSize, polyfit_accum_t *pAccum, size_t *pLength );
+
+//--------------------------------------------------------
+// polyfit_accum_decode()
+// Reads accumulator state written by
+// polyfit_accum_encode() into a new accumulator.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_accum_decode( const void *buffer, size_t bufferSize, polyfit_accum_t *pAccum, size_t *pLength );
+
+//--------------------------------------------------------
+// polyfit_goodness()
+// Same as polyfit(), and also reports the goodness of fit
+// and, unless standardErrors is NULL, the standard error
+// of each coefficient, all from the one pass over the
+// points.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_goodness( int pointCount, double *xValues, double *yValues, int coefficientCount,
+                      double *coefficientResults, double *standardErrors, polyfit_goodness_t *pGoodness );
+
+//--------------------------------------------------------
+// polyfit_accum_goodness()
+// Same as polyfit_accum_solve(), and also reports the
+// goodness of fit and, unless standardErrors is NULL, the
+// standard error of each coefficient.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_accum_goodness( polyfit_accum_t *pAccum, double *coefficientResults, double *standardErrors,
+                            polyfit_goodness_t *pGoodness );
+
+//--------------------------------------------------------
+// polyfit_auto()
+// Fits every coefficient count from 1 to maxCoefficients
+// from one pass over the points, and keeps the one with
+// the lowest score by the given criterion. The count goes
+// to *pCoefficientCount, and each count's score to
+// scores[count - 1] unless scores is NULL.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_auto( int pointCount, double *xValues, double *yValues, int maxCoefficients,
+                  polyfit_criterion_t criterion, double *coefficientResults, int *pCoefficientCount,
+                  double *scores );
+
+//--------------------------------------------------------
+// polyfit_accum_auto()
+// Same as polyfit_auto(), for the points added to an
+// accumulator, whose coefficientCount is the most tried.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_accum_auto( polyfit_accum_t *pAccum, polyfit_criterion_t criterion, double *coefficientResults,
+                        int *pCoefficientCount, double *scores );
+
+//--------------------------------------------------------
+// polyfit_piecewise_fit()
+// Fits a polynomial to each segment of points sorted by
+// x, between the given knots, or between segmentCount + 1
+// knots chosen from the points if knots is NULL. The
+// segments are fitted on threadCount threads, 0 for one
+// per CPU. A continuityOrder of 0 or more joins adjacent
+// segments with matching value and derivatives up to that
+// order; -1 leaves them independent.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_piecewise_fit( polyfit_piecewise_t *pPiecewise, int pointCount, double *xValues, double *yValues,
+                           int coefficientCount, int segmentCount, double *knots, int continuityOrder,
+                           int threadCount );
+
+//--------------------------------------------------------
+// polyfit_piecewise_eval()
+// Evaluates a piecewise polynomial at each of pointCount
+// x values into yValues.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_piecewise_eval( polyfit_piecewise_t *pPiecewise, int pointCount, double *xValues, double *yValues );
+
+//--------------------------------------------------------
+// polyfit_piecewise_free()
+// Releases the knots and coefficients of a piecewise
+// polynomial.
+//--------------------------------------------------------
+void polyfit_piecewise_free( polyfit_piecewise_t *pPiecewise );
+
+//--------------------------------------------------------
+// polyfit_service_create()
+// Starts threadCount fitting threads, 0 for one per CPU,
+// fed by a queue of queueCapacity jobs, each thread with
+// its own workspace for up to maxCoefficients.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_service_create( polyfit_service_t **ppService, int threadCount, int queueCapacity, int maxCoefficients );
+
+//--------------------------------------------------------
+// polyfit_service_submit()
+// Queues a job. If the queue is full, waits for room if
+// wait is true, or returns -6 if not.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_service_submit( polyfit_service_t *pService, polyfit_job_t *pJob, bool wait );
+
+//--------------------------------------------------------
+// polyfit_job_done()
+// Returns true once a submitted job is done.
+//--------------------------------------------------------
+bool polyfit_job_done( polyfit_job_t *pJob );
+
+//--------------------------------------------------------
+// polyfit_service_wait()
+// Waits until a submitted job is done.
+// Returns the job's status.
+//--------------------------------------------------------
+int polyfit_service_wait( polyfit_service_t *pService, polyfit_job_t *pJob );
+
+//--------------------------------------------------------
+// polyfit_service_metrics()
+// Reports a service's counts and latencies.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_service_metrics( polyfit_service_t *pService, polyfit_service_metrics_t *pMetrics );
+
+//--------------------------------------------------------
+// polyfit_service_destroy()
+// Finishes the queued jobs, stops the threads and
+// releases the service.
+//--------------------------------------------------------
+void polyfit_service_destroy( polyfit_service_t *pService );
+
+//--------------------------------------------------------
+// polyfit_online_init()
+// Prepares an online fit of the last windowLength points
+// of a stream, or, with forgetting below 1, of all points
+// weighted by forgetting to the power of their age.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_online_init( polyfit_online_t *pOnline, int coefficientCount, int windowLength, double forgetting );
+
+//--------------------------------------------------------
+// polyfit_online_add()
+// Adds the newest point, dropping the oldest from a full
+// window.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_online_add( polyfit_online_t *pOnline, double x, double y );
+
+//--------------------------------------------------------
+// polyfit_online_remove()
+// Drops the oldest point from a sliding window.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_online_remove( polyfit_online_t *pOnline );
+
+//--------------------------------------------------------
+// polyfit_online_solve()
+// Gets the coefficients of the current fit, highest power
+// first, as polyfit() gives them.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_online_solve( polyfit_online_t *pOnline, double *coefficientResults );
+
+//--------------------------------------------------------
+// polyfit_online_free()
+// Releases the memory held by an online fit.
+//--------------------------------------------------------
+void polyfit_online_free( polyfit_online_t *pOnline );
+
+//--------------------------------------------------------
+// polyfit_view_fit()
+// Same as polyfit(), reading x and y through views of the
+// caller's memory instead of double arrays.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_view_fit( int pointCount, polyfit_view_t *pXView, polyfit_view_t *pYView, int coefficientCount,
+                      double *coefficientResults );
+
+//--------------------------------------------------------
+// polyfit_accum_add_view()
+// Adds points read through views of the caller's memory
+// to an accumulator.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_accum_add_view( polyfit_accum_t *pAccum, int pointCount, polyfit_view_t *pXView,
+                            polyfit_view_t *pYView );
+
+//--------------------------------------------------------
+// polyfit_orthogonal()
+// Same as polyfit(), but fits by orthogonal polynomials
+// without forming the normal equations, in
+// O(pointCount * coefficientCount) time.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_orthogonal( int pointCount, double *xValues, double *yValues, int coefficientCount,
+                        double *coefficientResults );
+
+//--------------------------------------------------------
+// polyfit_chebyshev()
+// Fits as polyfit_orthogonal() does, giving the fit as a
+// Chebyshev series over the range of x, lowest term
+// first, and that range.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_chebyshev( int pointCount, double *xValues, double *yValues, int coefficientCount,
+                       double *pLow, double *pHigh, double *chebyshevResults );
+
+//--------------------------------------------------------
+// polyval_chebyshev()
+// Evaluates a Chebyshev series from polyfit_chebyshev()
+// at each of pointCount x values, by Clenshaw's
+// recurrence.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyval_chebyshev( int coefficientCount, double *chebyshevCoefficients, double low, double high,
+                       int pointCount, double *xValues, double *yValues );
+
+//--------------------------------------------------------
+// polyfit_surface_terms()
+// Writes the exponents of every term of total degree up
+// to totalDegree in dimensionCount variables, for
+// polyfit_surface_fit(). *pTermCount receives their
+// number.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_surface_terms( int dimensionCount, int totalDegree, int maxTerms, int *pExponents, int *pTermCount );
+
+//--------------------------------------------------------
+// polyfit_surface_workspace_size()
+// Returns the bytes of working storage
+// polyfit_surface_fit_ws() needs for fits of up to
+// maxTerms terms, or 0 if maxTerms < 1.
+//--------------------------------------------------------
+size_t polyfit_surface_workspace_size( int maxTerms );
+
+//--------------------------------------------------------
+// polyfit_surface_fit()
+// Fits a polynomial in 1 to 4 variables, with the terms
+// whose exponents are given, to a set of points.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_surface_fit( polyfit_surface_t *pSurface, int pointCount, int dimensionCount, double *inputValues,
+                         double *zValues, int termCount, int *pExponents );
+
+//--------------------------------------------------------
+// polyfit_surface_fit_ws()
+// Same as polyfit_surface_fit(), but uses only the
+// workspace's memory, never touches the heap, and stores
+// just the coefficients, in the order of the terms.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_surface_fit_ws( polyfit_workspace_t *pWorkspace, int pointCount, int dimensionCount,
+                            double *inputValues, double *zValues, int termCount, int *pExponents,
+                            double *coefficientResults );
+
+//--------------------------------------------------------
+// polyfit_surface_eval()
+// Evaluates a fitted surface at each of pointCount
+// points.
+// Returns 0 if success.
+//--------------------------------------------------------
+int polyfit_surface_eval( polyfit_surface_t *pSurface, int pointCount, double *inputValues, double *zValues );
+
+//--------------------------------------------------------
+// polyfit_surface_free()
+// Releases the memory held by a fitted surface.
+//--------------------------------------------------------
+void polyfit_surface_free( polyfit_surface_t *pSurface );
+
 //--------------------------------------------------------
 // polyToString()
 // Produces a string representation of a polynomial from
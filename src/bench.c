@@ -0,0 +1,1913 @@
+// Name: bench.c
+// Description: Benchmarks for the MLS polynomial fitting library.
+// Author: Henry Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+//
+// Synopsis:
+//      polybench [--csv | --json] [--suite name] ... [--max-points n] [--min-time ms]
+//
+// Each measurement is written as one row of CSV (the default), or as one
+// JSON object per line with --json. Every row has the same fields, so
+// runs of different suites, builds and hosts can be compared directly:
+//
+//      suite, method, distribution, coefficients, points,
+//      ns_per_fit, ns_per_point, fits_per_sec,
+//      allocations_per_fit, peak_rss_kib, flops_per_fit, status
+//
+// A "fit" is one call of the method being timed: one series fitted, or
+// one array evaluated. peak_rss_kib is the peak resident memory of the
+// whole process so far. flops_per_fit is 0 where it isn't counted, and
+// status is the method's last return value.
+//
+// The suites are:
+//      sweep   -- polyfit() and each supported power sum kernel, for
+//                 10 to max-points points, 2 to 20 coefficients and
+//                 several x distributions.
+//      solvers -- each solver for degrees 10 to 20.
+//      plans   -- many series on one x grid, with and without a plan.
+//      uniform -- evenly spaced points, with and without x values.
+//      fixed   -- short series, with the fixed degree fits and without.
+//      eval    -- polyval() against a plain Horner loop.
+//      stats   -- polyfit() with stats disabled and enabled.
+//      serial  -- polyToString() against the JSON and binary
+//                 encoders, for 4 to 32 coefficients.
+//      goodness -- polyfit() and a second pass for R^2, against
+//                 polyfit_goodness().
+//      auto    -- a fit per candidate degree, against
+//                 polyfit_auto().
+//      piecewise -- polyfit() on each segment of a long series,
+//                 against polyfit_piecewise_fit() on one thread
+//                 and on all, and with knots it chooses.
+//      service -- many short fits with polyfit() on one thread,
+//                 against a fit service fed by one and by four
+//                 submitting threads.
+//      online  -- polyfit() on the latest window of a stream after
+//                 each new sample, against polyfit_online_add() and
+//                 polyfit_online_solve() in window and forgetting
+//                 modes.
+//      views   -- copying fields of records into arrays for
+//                 polyfit(), against polyfit_view_fit() reading
+//                 them in place, as floats and as timestamps.
+//      orthogonal -- polyfit() against polyfit_orthogonal() and
+//                 polyfit_chebyshev(), for 4 to 16 coefficients.
+//      surface -- normal sums of a surface in two variables with
+//                 pow() a point at a time, against
+//                 polyfit_surface_fit() and polyfit_surface_fit_ws(),
+//                 for total degrees 1 to 4.
+//      batch   -- polyfit() on each of many short series, against
+//                 polyfit_batch() on all of them, for 2 to 4
+//                 coefficients; a fit here is one series.
+// With no --suite option all of them run.
+
+#define _POSIX_C_SOURCE 200809L     // clock_gettime()
+
+#include  <limits.h>                // INT_MAX
+#include  <math.h>                  // log(), HUGE_VAL
+#include  <pthread.h>               // pthread_create()
+#include  <stdbool.h>
+#include  <stdio.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include  <sys/resource.h>          // getrusage()
+#include  <time.h>
+
+#include  "polyfit.h"
+
+// Points fitted by the solver benchmark. Kept small, so the solve, not
+// the accumulation, is what's measured.
+#define SOLVER_POINTS       (64)
+
+// Points and series fitted by the plan benchmark.
+#define PLAN_POINTS         (1000)
+#define PLAN_SERIES         (64)
+
+// Points fitted by the uniform spacing benchmark.
+#define UNIFORM_POINTS      (1000000)
+
+// Largest series fitted by the fixed degree benchmark.
+#define FIXED_MAX_POINTS    (1024)
+
+// Points evaluated by the polyval benchmark.
+#define EVAL_POINTS         (1000000)
+
+// Largest series fitted by the stats benchmark.
+#define STATS_MAX_POINTS    (1000)
+
+// Largest coefficient vector written by the serialization benchmark, and
+// room for any text of it.
+#define SERIAL_MAX_COEFFICIENTS (32)
+#define SERIAL_TEXT_SIZE        (4096)
+
+// Points fitted by the goodness of fit benchmark.
+#define GOODNESS_POINTS     (1000000)
+
+// Points fitted by the degree selection benchmark.
+#define AUTO_POINTS         (1000000)
+
+// Points and segments fitted by the piecewise benchmark.
+#define PIECEWISE_POINTS    (1000000)
+#define PIECEWISE_SEGMENTS  (1000)
+
+// Jobs per run, points per job and submitting threads of the service
+// benchmark.
+#define SERVICE_JOBS        (1000)
+#define SERVICE_POINTS      (100)
+#define SERVICE_SUBMITTERS  (4)
+
+// Samples streamed, and the window refitted, by the online benchmark.
+#define ONLINE_SAMPLES      (10000)
+#define ONLINE_WINDOW       (256)
+
+// Records fitted by the input view benchmark.
+#define VIEW_POINTS         (1000000)
+
+// Points fitted by the orthogonal polynomial benchmark.
+#define ORTHOGONAL_POINTS   (100000)
+
+// Points fitted by the surface benchmark, and its highest total degree.
+#define SURFACE_POINTS      (100000)
+#define SURFACE_MAX_DEGREE  (4)
+
+// Series fitted by the batch benchmark, and the most points in one.
+#define BATCH_SERIES        (1024)
+#define BATCH_MAX_POINTS    (64)
+
+// Default largest point count of the sweep.
+#define SWEEP_MAX_POINTS    (100000000)
+
+// By default each measurement repeats until it has run for at least this long.
+#define DEFAULT_MIN_RUN_MS  (50)
+
+// Output formats.
+typedef enum benchFormat_e
+{
+    BENCH_FORMAT_CSV = 0,
+    BENCH_FORMAT_JSON
+} benchFormat_t;
+
+// One measurement, as reported.
+typedef struct benchRow_s
+{
+    const char *    pSuite;
+    const char *    pMethod;
+    const char *    pDistribution;      // How the x values are spread.
+    int             coefficientCount;
+    int             pointCount;         // Points per fit.
+    double          flopsPerFit;        // 0 if not counted.
+    long long       fits;
+    double          elapsedNs;
+    long long       allocations;        // Library heap allocations over all the fits.
+    int             status;
+} benchRow_t;
+
+// A record of the input view benchmark, as a caller might hold its data.
+typedef struct benchRecord_s
+{
+    long long   timeNs;
+    float       level;
+    int         count;
+    double      value;
+} benchRecord_t;
+
+// What a timed run works on. Each suite uses the fields it needs.
+typedef struct benchContext_s
+{
+    int                     method;             // Index into the suite's methods.
+    int                     pointCount;
+    int                     coefficientCount;
+    double *                xValues;
+    double *                yValues;
+    double *                results;
+    double *                pSums;              // Power sums, then right hand side sums.
+    polyfit_kernel_t        kernel;
+    polyfit_workspace_t *   pWorkspace;
+    polyfit_plan_t *        pPlan;
+    polyfit_service_t *     pService;
+    polyfit_job_t *         pJobs;
+    benchRecord_t *         pRecords;
+    int *                   pExponents;         // Surface terms, two to a row.
+    int *                   pSeriesOffsets;     // Batch series, packed end to end.
+    int *                   pSeriesStatus;
+} benchContext_t;
+
+typedef int (*benchRunFn_t)( benchContext_t *pContext );
+
+// A share of the service benchmark's jobs, for one submitting thread.
+typedef struct benchSubmitter_s
+{
+    polyfit_service_t *     pService;
+    polyfit_job_t *         pJobs;
+    int                     jobCount;
+} benchSubmitter_t;
+
+
+//------------------------------------------------
+// Private Function Prototypes
+//------------------------------------------------
+
+static double   nowNs( void );
+static void *   countingCalloc( size_t count, size_t size );
+static void     countingFree( void *pMemory );
+static void     measure( benchRow_t *pRow, benchRunFn_t pRun, benchContext_t *pContext, int fitsPerRun );
+static void     report( benchRow_t *pRow );
+static double   solverFlops( polyfit_solver_t solver, int pointCount, int coefficientCount );
+static void     makePoints( const char *pDistribution, int pointCount, double *xValues, double *yValues );
+static int      runSweep( benchContext_t *pContext );
+static int      runSolver( benchContext_t *pContext );
+static int      runPlan( benchContext_t *pContext );
+static int      runUniform( benchContext_t *pContext );
+static int      runFixed( benchContext_t *pContext );
+static int      runEval( benchContext_t *pContext );
+static int      runStats( benchContext_t *pContext );
+static int      runSerial( benchContext_t *pContext );
+static int      runGoodness( benchContext_t *pContext );
+static int      runAuto( benchContext_t *pContext );
+static int      runPiecewise( benchContext_t *pContext );
+static int      runService( benchContext_t *pContext );
+static int      runOnline( benchContext_t *pContext );
+static int      runView( benchContext_t *pContext );
+static int      runOrthogonal( benchContext_t *pContext );
+static int      runSurface( benchContext_t *pContext );
+static int      runBatch( benchContext_t *pContext );
+static void *   submitJobs( void *pArg );
+static void     benchSweep( int maxPoints );
+static void     benchSolvers( void );
+static void     benchPlans( void );
+static void     benchUniform( void );
+static void     benchFixed( void );
+static void     benchEval( void );
+static void     benchStats( void );
+static void     benchSerial( void );
+static void     benchGoodness( void );
+static void     benchAuto( void );
+static void     benchPiecewise( void );
+static void     benchService( void );
+static void     benchOnline( void );
+static void     benchView( void );
+static void     benchOrthogonal( void );
+static void     benchSurface( void );
+static void     benchBatch( void );
+
+
+//------------------------------------------------
+// Private Variables
+//------------------------------------------------
+
+static benchFormat_t    outputFormat = BENCH_FORMAT_CSV;
+static double           minRunNs = DEFAULT_MIN_RUN_MS * 1e6;
+static long long        allocationCount = 0;
+
+
+//--------------------------------------------------------
+// main()
+// Parses the options and runs the chosen suites.
+// Returns 0 if success, or after --help; 1 if an option
+// is not understood.
+//--------------------------------------------------------
+int main( int argc, char *argv[] )
+{
+    const char *suiteNames[] = { "sweep", "solvers", "plans", "uniform", "fixed", "eval", "stats", "serial", "goodness",
+                                 "auto", "piecewise", "service", "online", "views",
+                                 "orthogonal", "surface", "batch" };
+    int suiteCount = (int) (sizeof( suiteNames ) / sizeof( suiteNames[0] ));
+    bool chosen[ sizeof( suiteNames ) / sizeof( suiteNames[0] ) ] = { false };
+    bool anyChosen = false;
+    int maxPoints = SWEEP_MAX_POINTS;
+
+    for( int a = 1; a < argc; a++ )
+    {
+        bool understood = true;
+
+        if( 0 == strcmp( argv[a], "--csv" ) )
+        {
+            outputFormat = BENCH_FORMAT_CSV;
+        }
+        else if( 0 == strcmp( argv[a], "--json" ) )
+        {
+            outputFormat = BENCH_FORMAT_JSON;
+        }
+        else if( (0 == strcmp( argv[a], "--max-points" )) && (a + 1 < argc) )
+        {
+            maxPoints = atoi( argv[++a] );
+            understood = (maxPoints >= 10);
+        }
+        else if( (0 == strcmp( argv[a], "--min-time" )) && (a + 1 < argc) )
+        {
+            minRunNs = atof( argv[++a] ) * 1e6;
+            understood = (minRunNs >= 0.0);
+        }
+        else if( (0 == strcmp( argv[a], "--suite" )) && (a + 1 < argc) )
+        {
+            understood = false;
+            a += 1;
+            for( int s = 0; s < suiteCount; s++ )
+            {
+                if( 0 == strcmp( argv[a], suiteNames[s] ) )
+                {
+                    chosen[s] = true;
+                    anyChosen = true;
+                    understood = true;
+                }
+            }
+        }
+        else
+        {
+            understood = (0 == strcmp( argv[a], "--help" ));
+        }
+
+        if( !understood || (0 == strcmp( argv[a], "--help" )) )
+        {
+            fprintf( understood ? stdout : stderr, "usage: %s [--csv | --json] "
+                     "[--suite sweep|solvers|plans|uniform|fixed|eval|stats|serial|goodness|auto|piecewise|service|"
+                     "online|views|orthogonal|surface|batch] "
+                     "... [--max-points n] [--min-time ms]\n",
+                     argv[0] );
+            return understood ? 0 : 1;
+        }
+    }
+
+    // Count every allocation the library makes.
+    polyfit_set_allocator( countingCalloc, countingFree );
+
+    if( BENCH_FORMAT_CSV == outputFormat )
+    {
+        printf( "suite,method,distribution,coefficients,points,ns_per_fit,ns_per_point,fits_per_sec,"
+                "allocations_per_fit,peak_rss_kib,flops_per_fit,status\n" );
+    }
+    if( !anyChosen || chosen[0] )
+    {
+        benchSweep( maxPoints );
+    }
+    if( !anyChosen || chosen[1] )
+    {
+        benchSolvers();
+    }
+    if( !anyChosen || chosen[2] )
+    {
+        benchPlans();
+    }
+    if( !anyChosen || chosen[3] )
+    {
+        benchUniform();
+    }
+    if( !anyChosen || chosen[4] )
+    {
+        benchFixed();
+    }
+    if( !anyChosen || chosen[5] )
+    {
+        benchEval();
+    }
+    if( !anyChosen || chosen[6] )
+    {
+        benchStats();
+    }
+    if( !anyChosen || chosen[7] )
+    {
+        benchSerial();
+    }
+    if( !anyChosen || chosen[8] )
+    {
+        benchGoodness();
+    }
+    if( !anyChosen || chosen[9] )
+    {
+        benchAuto();
+    }
+    if( !anyChosen || chosen[10] )
+    {
+        benchPiecewise();
+    }
+    if( !anyChosen || chosen[11] )
+    {
+        benchService();
+    }
+    if( !anyChosen || chosen[12] )
+    {
+        benchOnline();
+    }
+    if( !anyChosen || chosen[13] )
+    {
+        benchView();
+    }
+    if( !anyChosen || chosen[14] )
+    {
+        benchOrthogonal();
+    }
+    if( !anyChosen || chosen[15] )
+    {
+        benchSurface();
+    }
+    if( !anyChosen || chosen[16] )
+    {
+        benchBatch();
+    }
+
+    polyfit_set_allocator( NULL, NULL );
+    return 0;
+}
+
+
+//=========================================================
+//      Private function definitions
+//=========================================================
+
+//--------------------------------------------------------
+// nowNs()
+// Returns a monotonic time in nanoseconds.
+//--------------------------------------------------------
+static double nowNs( void )
+{
+    struct timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ((double) now.tv_sec * 1e9) + (double) now.tv_nsec;
+}
+
+//--------------------------------------------------------
+// countingCalloc(), countingFree()
+// The library's allocator while benchmarking: calloc() and
+// free(), counting the allocations.
+//--------------------------------------------------------
+static void *countingCalloc( size_t count, size_t size )
+{
+    allocationCount += 1;
+    return calloc( count, size );
+}
+
+static void countingFree( void *pMemory )
+{
+    free( pMemory );
+}
+
+//--------------------------------------------------------
+// measure()
+// Calls pRun until it has run for at least minRunNs, and
+// at least once, after one warm up call, then reports the
+// row. Each call counts
+// as fitsPerRun fits. Calls are timed in groups that grow
+// while the elapsed time is small, so reading the clock
+// doesn't swamp very short runs.
+//--------------------------------------------------------
+static void measure( benchRow_t *pRow, benchRunFn_t pRun, benchContext_t *pContext, int fitsPerRun )
+{
+    long long runs = 0;
+    long long groupSize = 1;
+    double elapsed = 0.0;
+
+    // One untimed call first, so page faults on first touching the
+    // arrays and cold caches aren't counted.
+    pRun( pContext );
+
+    allocationCount = 0;
+    double start = nowNs();
+    while( (0 == runs) || (elapsed < minRunNs) )
+    {
+        for( long long r = 0; r < groupSize; r++ )
+        {
+            pRow->status = pRun( pContext );
+        }
+        runs += groupSize;
+        elapsed = nowNs() - start;
+        if( elapsed < minRunNs / 100.0 )
+        {
+            groupSize *= 2;
+        }
+    }
+
+    pRow->fits = runs * fitsPerRun;
+    pRow->elapsedNs = elapsed;
+    pRow->allocations = allocationCount;
+    report( pRow );
+}
+
+//--------------------------------------------------------
+// report()
+// Writes one row in the chosen format.
+//--------------------------------------------------------
+static void report( benchRow_t *pRow )
+{
+    struct rusage usage;
+    long peakKib = (0 == getrusage( RUSAGE_SELF, &usage )) ? usage.ru_maxrss : 0;     // KiB on Linux.
+    double nsPerFit = pRow->elapsedNs / (double) pRow->fits;
+    double nsPerPoint = nsPerFit / (double) pRow->pointCount;
+    double fitsPerSec = (nsPerFit > 0.0) ? 1e9 / nsPerFit : 0.0;
+    double allocationsPerFit = (double) pRow->allocations / (double) pRow->fits;
+
+    if( BENCH_FORMAT_JSON == outputFormat )
+    {
+        printf( "{\"suite\":\"%s\",\"method\":\"%s\",\"distribution\":\"%s\",\"coefficients\":%d,\"points\":%d,"
+                "\"ns_per_fit\":%.1f,\"ns_per_point\":%.4f,\"fits_per_sec\":%.1f,\"allocations_per_fit\":%.3f,"
+                "\"peak_rss_kib\":%ld,\"flops_per_fit\":%.0f,\"status\":%d}\n",
+                pRow->pSuite, pRow->pMethod, pRow->pDistribution, pRow->coefficientCount, pRow->pointCount,
+                nsPerFit, nsPerPoint, fitsPerSec, allocationsPerFit, peakKib, pRow->flopsPerFit, pRow->status );
+    }
+    else
+    {
+        printf( "%s,%s,%s,%d,%d,%.1f,%.4f,%.1f,%.3f,%ld,%.0f,%d\n",
+                pRow->pSuite, pRow->pMethod, pRow->pDistribution, pRow->coefficientCount, pRow->pointCount,
+                nsPerFit, nsPerPoint, fitsPerSec, allocationsPerFit, peakKib, pRow->flopsPerFit, pRow->status );
+    }
+    fflush( stdout );
+}
+
+//--------------------------------------------------------
+// solverFlops()
+// Returns the leading term of a solver's multiply-add
+// count, not counting the accumulation of the sums.
+//--------------------------------------------------------
+static double solverFlops( polyfit_solver_t solver, int pointCount, int coefficientCount )
+{
+    double k = coefficientCount;
+    double n = pointCount;
+
+    switch( solver )
+    {
+        case POLYFIT_SOLVER_GAUSS_JORDAN:   return k * k * (k + 1.0);
+        case POLYFIT_SOLVER_QR:             return (2.0 * n * k * k) - ((2.0 * k * k * k) / 3.0);
+        default:                            return ((k * k * k) / 6.0) + (k * k);
+    }
+}
+
+//--------------------------------------------------------
+// makePoints()
+// Fills pointCount points of a noisy parabola, with x
+// spread according to pDistribution:
+//      "even"      -- evenly spaced from -1 to 1.
+//      "random"    -- uniformly random from -1 to 1.
+//      "clustered" -- the mean of four uniform values, so
+//                     bunched near 0.
+//      "offset"    -- uniformly random from 1000 to 1002,
+//                     far from the origin, which strains
+//                     the conditioning of high degrees.
+//--------------------------------------------------------
+static void makePoints( const char *pDistribution, int pointCount, double *xValues, double *yValues )
+{
+    unsigned int seed = 2020u;
+
+    for( int i = 0; i < pointCount; i++ )
+    {
+        double uniform[4];
+        for( int u = 0; u < 4; u++ )
+        {
+            seed = (seed * 1103515245u) + 12345u;
+            uniform[u] = (2.0 * (double) (seed >> 8) / 16777216.0) - 1.0;
+        }
+
+        double x = uniform[0];
+        if( 0 == strcmp( pDistribution, "even" ) )
+        {
+            x = (pointCount > 1) ? -1.0 + ((2.0 * i) / (pointCount - 1)) : 0.0;
+        }
+        else if( 0 == strcmp( pDistribution, "clustered" ) )
+        {
+            x = 0.25 * (uniform[0] + uniform[1] + uniform[2] + uniform[3]);
+        }
+        else if( 0 == strcmp( pDistribution, "offset" ) )
+        {
+            x = 1001.0 + uniform[0];
+        }
+        xValues[i] = x;
+        yValues[i] = (((0.5 * x) - 1.0) * x) + 0.25 + (0.01 * uniform[1]);
+    }
+}
+
+//--------------------------------------------------------
+// runSweep()
+// Method 0 fits with polyfit(); method 1 computes only the
+// power sums, with the context's kernel.
+//--------------------------------------------------------
+static int runSweep( benchContext_t *pContext )
+{
+    int coefficientCount = pContext->coefficientCount;
+
+    if( 0 == pContext->method )
+    {
+        return polyfit( pContext->pointCount, pContext->xValues, pContext->yValues, coefficientCount,
+                        pContext->results );
+    }
+    memset( pContext->pSums, 0, ((3 * coefficientCount) - 1) * sizeof( double ));
+    return polyfit_power_sums( pContext->kernel, pContext->pointCount, pContext->xValues, pContext->yValues,
+                               coefficientCount, pContext->pSums, &(pContext->pSums[ (2 * coefficientCount) - 1 ]) );
+}
+
+//--------------------------------------------------------
+// runSolver()
+// Fits through the context's workspace.
+//--------------------------------------------------------
+static int runSolver( benchContext_t *pContext )
+{
+    return polyfit_ws( pContext->pWorkspace, pContext->pointCount, pContext->xValues, pContext->yValues,
+                       pContext->coefficientCount, pContext->results );
+}
+
+//--------------------------------------------------------
+// runPlan()
+// Fits PLAN_SERIES series: method 0 with polyfit(),
+// method 1 with a plan one series at a time, method 2
+// with a plan all at once.
+//--------------------------------------------------------
+static int runPlan( benchContext_t *pContext )
+{
+    int rVal = 0;
+
+    if( 2 == pContext->method )
+    {
+        return polyfit_plan_execute_many( pContext->pPlan, PLAN_SERIES, pContext->yValues, pContext->results );
+    }
+    for( int s = 0; s < PLAN_SERIES; s++ )
+    {
+        double *pY = &(pContext->yValues[ s * PLAN_POINTS ]);
+        double *pResults = &(pContext->results[ s * pContext->coefficientCount ]);
+        rVal = (0 == pContext->method) ? polyfit( PLAN_POINTS, pContext->xValues, pY, pContext->coefficientCount,
+                                                  pResults )
+                                       : polyfit_plan_execute( pContext->pPlan, pY, pResults );
+    }
+    return rVal;
+}
+
+//--------------------------------------------------------
+// runUniform()
+// Method 0 fits with polyfit(), method 1 with
+// polyfit_uniform() and no x values.
+//--------------------------------------------------------
+static int runUniform( benchContext_t *pContext )
+{
+    if( 0 == pContext->method )
+    {
+        return polyfit( pContext->pointCount, pContext->xValues, pContext->yValues, pContext->coefficientCount,
+                        pContext->results );
+    }
+    return polyfit_uniform( pContext->pointCount, pContext->xValues[0], pContext->xValues[1] - pContext->xValues[0],
+                            pContext->yValues, pContext->coefficientCount, pContext->results );
+}
+
+//--------------------------------------------------------
+// runFixed()
+// Method 0 fits with the general Cholesky path, method 1
+// with polyfit(), which takes the fixed degree fits.
+//--------------------------------------------------------
+static int runFixed( benchContext_t *pContext )
+{
+    if( 0 == pContext->method )
+    {
+        return polyfit_with_solver( pContext->pointCount, pContext->xValues, pContext->yValues,
+                                    pContext->coefficientCount, pContext->results, POLYFIT_SOLVER_CHOLESKY, NULL );
+    }
+    return polyfit( pContext->pointCount, pContext->xValues, pContext->yValues, pContext->coefficientCount,
+                    pContext->results );
+}
+
+//--------------------------------------------------------
+// runEval()
+// Evaluates the context's coefficients at its points:
+// method 0 with a plain scalar Horner loop, method 1 with
+// polyval(), method 2 with polyval_batch() and both
+// derivatives, which go after the values in yValues.
+//--------------------------------------------------------
+static int runEval( benchContext_t *pContext )
+{
+    int pointCount = pContext->pointCount;
+    double *coefficients = pContext->results;
+
+    if( 0 == pContext->method )
+    {
+        for( int i = 0; i < pointCount; i++ )
+        {
+            double value = coefficients[0];
+            for( int c = 1; c < pContext->coefficientCount; c++ )
+            {
+                value = (value * pContext->xValues[i]) + coefficients[c];
+            }
+            pContext->yValues[i] = value;
+        }
+        return 0;
+    }
+    if( 1 == pContext->method )
+    {
+        return polyval( pContext->coefficientCount, coefficients, pointCount, pContext->xValues, pContext->yValues );
+    }
+    return polyval_batch( pContext->coefficientCount, coefficients, pointCount, pContext->xValues, pContext->yValues,
+                          &(pContext->yValues[ pointCount ]), &(pContext->yValues[ 2 * pointCount ]) );
+}
+
+//--------------------------------------------------------
+// runStats()
+// Fits with polyfit(); the caller turns stats on or off.
+//--------------------------------------------------------
+static int runStats( benchContext_t *pContext )
+{
+    return polyfit( pContext->pointCount, pContext->xValues, pContext->yValues, pContext->coefficientCount,
+                    pContext->results );
+}
+
+//--------------------------------------------------------
+// runSerial()
+// Writes the context's coefficients: method 0 with
+// polyToString(), method 1 as JSON, method 2 as binary.
+//--------------------------------------------------------
+static int runSerial( benchContext_t *pContext )
+{
+    static char text[ SERIAL_TEXT_SIZE ];
+    size_t length = 0;
+
+    if( 0 == pContext->method )
+    {
+        return polyToString( text, sizeof( text ), pContext->coefficientCount, pContext->results );
+    }
+    if( 1 == pContext->method )
+    {
+        return polyfit_encode_json( text, sizeof( text ), pContext->coefficientCount, pContext->results, &length );
+    }
+    return polyfit_encode_binary( text, sizeof( text ), pContext->coefficientCount, pContext->results, &length );
+}
+
+//--------------------------------------------------------
+// runGoodness()
+// Method 0 fits with polyfit() and then finds the SSE and
+// R^2 with a second pass over the points, as a caller
+// would without the library's help; method 1 fits with
+// polyfit_goodness(), which needs no second pass.
+//--------------------------------------------------------
+static int runGoodness( benchContext_t *pContext )
+{
+    int coefficientCount = pContext->coefficientCount;
+    double *coefficients = pContext->results;
+    polyfit_goodness_t goodness;
+
+    if( 1 == pContext->method )
+    {
+        return polyfit_goodness( pContext->pointCount, pContext->xValues, pContext->yValues, coefficientCount,
+                                 coefficients, NULL, &goodness );
+    }
+
+    int rVal = polyfit( pContext->pointCount, pContext->xValues, pContext->yValues, coefficientCount, coefficients );
+    double ySum = 0.0;
+    double ySquareSum = 0.0;
+    double sse = 0.0;
+    for( int i = 0; i < pContext->pointCount; i++ )
+    {
+        double fitted = coefficients[0];
+        for( int c = 1; c < coefficientCount; c++ )
+        {
+            fitted = (fitted * pContext->xValues[i]) + coefficients[c];
+        }
+        double y = pContext->yValues[i];
+        ySum += y;
+        ySquareSum += y * y;
+        sse += (y - fitted) * (y - fitted);
+    }
+    pContext->pSums[0] = 1.0 - (sse / (ySquareSum - ((ySum * ySum) / pContext->pointCount)));
+    return rVal;
+}
+
+//--------------------------------------------------------
+// runAuto()
+// Chooses among 1 to coefficientCount coefficients by
+// BIC: method 0 with polyfit_goodness() for each count in
+// turn, method 1 with polyfit_auto().
+//--------------------------------------------------------
+static int runAuto( benchContext_t *pContext )
+{
+    int rVal = 0;
+    int chosenCount = 0;
+
+    if( 1 == pContext->method )
+    {
+        return polyfit_auto( pContext->pointCount, pContext->xValues, pContext->yValues, pContext->coefficientCount,
+                             POLYFIT_CRITERION_BIC, pContext->results, &chosenCount, NULL );
+    }
+
+    double bestScore = HUGE_VAL;
+    for( int k = 1; (0 == rVal) && (k <= pContext->coefficientCount); k++ )
+    {
+        polyfit_goodness_t goodness;
+        rVal = polyfit_goodness( pContext->pointCount, pContext->xValues, pContext->yValues, k, pContext->results,
+                                 NULL, &goodness );
+        double score = (pContext->pointCount * log( goodness.sse / pContext->pointCount )) +
+                       (k * log( (double) pContext->pointCount ));
+        if( score < bestScore )
+        {
+            bestScore = score;
+            chosenCount = k;
+        }
+    }
+    pContext->pSums[0] = chosenCount;
+    return rVal;
+}
+
+//--------------------------------------------------------
+// runPiecewise()
+// Fits PIECEWISE_SEGMENTS segments between the knots in
+// pSums: method 0 with polyfit() on each, method 1 with
+// polyfit_piecewise_fit() on one thread, method 2 on one
+// per CPU, and method 3 with knots it chooses.
+//--------------------------------------------------------
+static int runPiecewise( benchContext_t *pContext )
+{
+    int rVal = 0;
+    int coefficientCount = pContext->coefficientCount;
+    polyfit_piecewise_t piecewise;
+
+    if( 0 == pContext->method )
+    {
+        int first = 0;
+        for( int s = 0; (0 == rVal) && (s < PIECEWISE_SEGMENTS); s++ )
+        {
+            int end = first;
+            while( (end < pContext->pointCount) &&
+                   ((pContext->xValues[ end ] < pContext->pSums[ s + 1 ]) || (PIECEWISE_SEGMENTS - 1 == s)) )
+            {
+                end++;
+            }
+            rVal = polyfit( end - first, &(pContext->xValues[ first ]), &(pContext->yValues[ first ]),
+                            coefficientCount, &(pContext->results[ s * coefficientCount ]) );
+            first = end;
+        }
+        return rVal;
+    }
+
+    double *knots = (3 == pContext->method) ? NULL : pContext->pSums;
+    rVal = polyfit_piecewise_fit( &piecewise, pContext->pointCount, pContext->xValues, pContext->yValues,
+                                  coefficientCount, PIECEWISE_SEGMENTS, knots, -1, (1 == pContext->method) ? 1 : 0 );
+    polyfit_piecewise_free( &piecewise );
+    return rVal;
+}
+
+//--------------------------------------------------------
+// runOnline()
+// Streams pointCount samples and fits the latest
+// ONLINE_WINDOW of them after each one, once there are
+// that many: method 0 with polyfit() from scratch, method
+// 1 with a sliding window online fitter, and method 2
+// with one that forgets at the same time scale instead.
+//--------------------------------------------------------
+static int runOnline( benchContext_t *pContext )
+{
+    int rVal = 0;
+
+    if( 0 == pContext->method )
+    {
+        for( int i = ONLINE_WINDOW; (0 == rVal) && (i <= pContext->pointCount); i++ )
+        {
+            rVal = polyfit( ONLINE_WINDOW, &(pContext->xValues[ i - ONLINE_WINDOW ]),
+                            &(pContext->yValues[ i - ONLINE_WINDOW ]), pContext->coefficientCount, pContext->results );
+        }
+        return rVal;
+    }
+
+    polyfit_online_t online;
+    double forgetting = (1 == pContext->method) ? 1.0 : 1.0 - (1.0 / ONLINE_WINDOW);
+    rVal = polyfit_online_init( &online, pContext->coefficientCount, ONLINE_WINDOW, forgetting );
+    for( int i = 0; (0 == rVal) && (i < pContext->pointCount); i++ )
+    {
+        rVal = polyfit_online_add( &online, pContext->xValues[i], pContext->yValues[i] );
+        if( (0 == rVal) && (i >= ONLINE_WINDOW - 1) )
+        {
+            rVal = polyfit_online_solve( &online, pContext->results );
+        }
+    }
+    polyfit_online_free( &online );
+    return rVal;
+}
+
+//--------------------------------------------------------
+// runView()
+// Fits the value field of the context's records: method 0
+// against the level field, copied with it into xValues and
+// yValues for polyfit(), method 1 against the level field
+// read in place, and method 2 against the timestamps read
+// in place.
+//--------------------------------------------------------
+static int runView( benchContext_t *pContext )
+{
+    benchRecord_t *pRecords = pContext->pRecords;
+    polyfit_view_t valueView = { &(pRecords[0].value), sizeof( benchRecord_t ), POLYFIT_TYPE_DOUBLE, 0 };
+    polyfit_view_t levelView = { &(pRecords[0].level), sizeof( benchRecord_t ), POLYFIT_TYPE_FLOAT, 0 };
+    polyfit_view_t timeView = { &(pRecords[0].timeNs), sizeof( benchRecord_t ), POLYFIT_TYPE_TIME_NS,
+                                pRecords[0].timeNs };
+
+    if( 0 == pContext->method )
+    {
+        for( int i = 0; i < pContext->pointCount; i++ )
+        {
+            pContext->xValues[i] = pRecords[i].level;
+            pContext->yValues[i] = pRecords[i].value;
+        }
+        return polyfit( pContext->pointCount, pContext->xValues, pContext->yValues, pContext->coefficientCount,
+                        pContext->results );
+    }
+    return polyfit_view_fit( pContext->pointCount, (1 == pContext->method) ? &levelView : &timeView, &valueView,
+                             pContext->coefficientCount, pContext->results );
+}
+
+//--------------------------------------------------------
+// runOrthogonal()
+// Fits the context's points: method 0 with polyfit(),
+// method 1 with polyfit_orthogonal(), and method 2 with
+// polyfit_chebyshev(), its range going to pSums.
+//--------------------------------------------------------
+static int runOrthogonal( benchContext_t *pContext )
+{
+    switch( pContext->method )
+    {
+        case 0:     return polyfit( pContext->pointCount, pContext->xValues, pContext->yValues,
+                                    pContext->coefficientCount, pContext->results );
+        case 1:     return polyfit_orthogonal( pContext->pointCount, pContext->xValues, pContext->yValues,
+                                               pContext->coefficientCount, pContext->results );
+        default:    return polyfit_chebyshev( pContext->pointCount, pContext->xValues, pContext->yValues,
+                                              pContext->coefficientCount, &(pContext->pSums[0]),
+                                              &(pContext->pSums[1]), pContext->results );
+    }
+}
+
+//--------------------------------------------------------
+// runSurface()
+// Method 0 adds every point's terms, made with pow(), into
+// the full normal matrix and right hand side in pSums, as
+// a direct implementation would before solving. Method 1
+// fits the surface with polyfit_surface_fit(), and method
+// 2 with polyfit_surface_fit_ws() in the context's
+// workspace.
+//--------------------------------------------------------
+static int runSurface( benchContext_t *pContext )
+{
+    int termCount = pContext->coefficientCount;
+
+    if( 2 == pContext->method )
+    {
+        return polyfit_surface_fit_ws( pContext->pWorkspace, pContext->pointCount, 2, pContext->xValues,
+                                       pContext->yValues, termCount, pContext->pExponents, pContext->results );
+    }
+    if( 1 == pContext->method )
+    {
+        polyfit_surface_t surface;
+        int rVal = polyfit_surface_fit( &surface, pContext->pointCount, 2, pContext->xValues, pContext->yValues,
+                                        termCount, pContext->pExponents );
+        polyfit_surface_free( &surface );
+        return rVal;
+    }
+
+    double *pMatrix = pContext->pSums;
+    double *pRhs = &(pContext->pSums[ termCount * termCount ]);
+    double *pTerms = pContext->results;
+    memset( pContext->pSums, 0, (size_t) termCount * (termCount + 1) * sizeof( double ));
+    for( int i = 0; i < pContext->pointCount; i++ )
+    {
+        double x = pContext->xValues[ 2 * i ];
+        double y = pContext->xValues[ (2 * i) + 1 ];
+        for( int t = 0; t < termCount; t++ )
+        {
+            pTerms[t] = pow( x, pContext->pExponents[ 2 * t ] ) * pow( y, pContext->pExponents[ (2 * t) + 1 ] );
+        }
+        for( int r = 0; r < termCount; r++ )
+        {
+            for( int c = 0; c < termCount; c++ )
+            {
+                pMatrix[ (r * termCount) + c ] += pTerms[r] * pTerms[c];
+            }
+            pRhs[r] += pTerms[r] * pContext->yValues[i];
+        }
+    }
+    return 0;
+}
+
+//--------------------------------------------------------
+// runBatch()
+// Fits every one of BATCH_SERIES series: method 0 with
+// polyfit() on each, method 1 with one polyfit_batch().
+//--------------------------------------------------------
+static int runBatch( benchContext_t *pContext )
+{
+    int coefficientCount = pContext->coefficientCount;
+    int *pOffsets = pContext->pSeriesOffsets;
+    int rVal = 0;
+
+    if( 1 == pContext->method )
+    {
+        return polyfit_batch( BATCH_SERIES, pOffsets, pContext->xValues, pContext->yValues, coefficientCount,
+                              pContext->results, pContext->pSeriesStatus );
+    }
+    for( int s = 0; s < BATCH_SERIES; s++ )
+    {
+        int status = polyfit( pOffsets[s + 1] - pOffsets[s], &(pContext->xValues[ pOffsets[s] ]),
+                              &(pContext->yValues[ pOffsets[s] ]), coefficientCount,
+                              &(pContext->results[ s * coefficientCount ]) );
+        rVal = (0 != status) ? status : rVal;
+    }
+    return rVal;
+}
+
+//--------------------------------------------------------
+// benchSweep()
+// Times polyfit(), and the power sums alone with each
+// kernel the CPU supports, for every distribution, for
+// 10, 100, ... up to maxPoints points, and for 2 to 20
+// coefficients.
+//--------------------------------------------------------
+static void benchSweep( int maxPoints )
+{
+    const char *distributions[] = { "even", "random", "clustered", "offset" };
+    int coefficientCounts[] = { 2, 3, 4, 6, 8, 12, 16, 20 };
+    polyfit_kernel_t kernels[] = { POLYFIT_KERNEL_SCALAR, POLYFIT_KERNEL_SSE2, POLYFIT_KERNEL_AVX2,
+                                   POLYFIT_KERNEL_AVX512 };
+    char methodNames[ sizeof( kernels ) / sizeof( kernels[0] ) ][32];
+    double results[20];
+    double sums[(3 * 20) - 1];
+
+    double *xValues = (double *) malloc( (size_t) maxPoints * sizeof( double ));
+    double *yValues = (double *) malloc( (size_t) maxPoints * sizeof( double ));
+    if( (NULL == xValues) || (NULL == yValues) )
+    {
+        fprintf( stderr, "sweep: unable to allocate %d points\n", maxPoints );
+        free( xValues );
+        free( yValues );
+        return;
+    }
+    for( int m = 0; m < (int) (sizeof( kernels ) / sizeof( kernels[0] )); m++ )
+    {
+        snprintf( methodNames[m], sizeof( methodNames[m] ), "power_sums_%s", polyfit_kernel_name( kernels[m] ));
+    }
+
+    for( int d = 0; d < (int) (sizeof( distributions ) / sizeof( distributions[0] )); d++ )
+    {
+        for( long long pointCount = 10; pointCount <= maxPoints; pointCount *= 10 )
+        {
+            benchContext_t context = { 0 };
+            context.pointCount = (int) pointCount;
+            context.xValues = xValues;
+            context.yValues = yValues;
+            context.results = results;
+            context.pSums = sums;
+            makePoints( distributions[d], context.pointCount, xValues, yValues );
+
+            for( int c = 0; c < (int) (sizeof( coefficientCounts ) / sizeof( coefficientCounts[0] )); c++ )
+            {
+                benchRow_t row = { "sweep", "polyfit", distributions[d], coefficientCounts[c], (int) pointCount,
+                                   0.0, 0, 0.0, 0, 0 };
+                context.coefficientCount = coefficientCounts[c];
+                context.method = 0;
+                measure( &row, runSweep, &context, 1 );
+
+                context.method = 1;
+                for( int m = 0; m < (int) (sizeof( kernels ) / sizeof( kernels[0] )); m++ )
+                {
+                    if( polyfit_kernel_supported( kernels[m] ))
+                    {
+                        context.kernel = kernels[m];
+                        row.pMethod = methodNames[m];
+                        measure( &row, runSweep, &context, 1 );
+                    }
+                }
+            }
+        }
+    }
+    free( xValues );
+    free( yValues );
+}
+
+//--------------------------------------------------------
+// benchSolvers()
+// Times each solver on a fit of SOLVER_POINTS points for
+// degrees 10 to 20, through a workspace so nothing but
+// the fit itself is measured.
+//--------------------------------------------------------
+static void benchSolvers( void )
+{
+    polyfit_solver_t solvers[] = { POLYFIT_SOLVER_CHOLESKY, POLYFIT_SOLVER_QR, POLYFIT_SOLVER_GAUSS_JORDAN };
+    double xValues[ SOLVER_POINTS ];
+    double yValues[ SOLVER_POINTS ];
+    double results[ 21 ];
+
+    for( int i = 0; i < SOLVER_POINTS; i++ )
+    {
+        xValues[i] = -1.0 + ((2.0 * i) / (SOLVER_POINTS - 1));
+        yValues[i] = 1.0 / (1.0 + (25.0 * xValues[i] * xValues[i]));
+    }
+
+    for( int degree = 10; degree <= 20; degree++ )
+    {
+        int coefficientCount = degree + 1;
+        for( int s = 0; s < (int) (sizeof( solvers ) / sizeof( solvers[0] )); s++ )
+        {
+            polyfit_workspace_t workspace;
+            size_t workspaceSize = polyfit_workspace_size_for_solver( solvers[s], SOLVER_POINTS, coefficientCount );
+            void *pMemory = malloc( workspaceSize );
+            benchRow_t row = { "solvers", polyfit_solver_name( solvers[s] ), "even", coefficientCount,
+                               SOLVER_POINTS, solverFlops( solvers[s], SOLVER_POINTS, coefficientCount ),
+                               0, 0.0, 0, 0 };
+            benchContext_t context = { 0 };
+
+            row.status = polyfit_workspace_init( &workspace, pMemory, workspaceSize, SOLVER_POINTS,
+                                                 coefficientCount );
+            workspace.solver = solvers[s];
+            context.pointCount = SOLVER_POINTS;
+            context.coefficientCount = coefficientCount;
+            context.xValues = xValues;
+            context.yValues = yValues;
+            context.results = results;
+            context.pWorkspace = &workspace;
+            if( 0 == row.status )
+            {
+                measure( &row, runSolver, &context, 1 );
+            }
+            free( pMemory );
+        }
+    }
+}
+
+//--------------------------------------------------------
+// benchPlans()
+// Times fits of PLAN_SERIES series on one x grid: with
+// polyfit(), with a plan one series at a time, and with a
+// plan all at once.
+//--------------------------------------------------------
+static void benchPlans( void )
+{
+    static double xValues[ PLAN_POINTS ];
+    static double yValues[ PLAN_SERIES * PLAN_POINTS ];
+    static double results[ PLAN_SERIES * 21 ];
+    const char *methods[] = { "polyfit", "plan_execute", "plan_execute_many" };
+
+    for( int i = 0; i < PLAN_POINTS; i++ )
+    {
+        xValues[i] = (double) i / PLAN_POINTS;
+    }
+    for( int i = 0; i < PLAN_SERIES * PLAN_POINTS; i++ )
+    {
+        yValues[i] = xValues[ i % PLAN_POINTS ] * (1 + (i / PLAN_POINTS));
+    }
+
+    for( int coefficientCount = 2; coefficientCount <= 8; coefficientCount *= 2 )
+    {
+        polyfit_plan_t plan;
+        benchContext_t context = { 0 };
+        int rVal = polyfit_plan_init( &plan, PLAN_POINTS, xValues, coefficientCount );
+
+        context.coefficientCount = coefficientCount;
+        context.xValues = xValues;
+        context.yValues = yValues;
+        context.results = results;
+        context.pPlan = &plan;
+        for( int m = 0; (0 == rVal) && (m < 3); m++ )
+        {
+            benchRow_t row = { "plans", methods[m], "even", coefficientCount, PLAN_POINTS, 0.0, 0, 0.0, 0, 0 };
+            context.method = m;
+            measure( &row, runPlan, &context, PLAN_SERIES );
+        }
+        polyfit_plan_free( &plan );
+    }
+}
+
+//--------------------------------------------------------
+// benchUniform()
+// Times fits of UNIFORM_POINTS evenly spaced points with
+// polyfit() and with polyfit_uniform().
+//--------------------------------------------------------
+static void benchUniform( void )
+{
+    double *xValues = (double *) malloc( UNIFORM_POINTS * sizeof( double ));
+    double *yValues = (double *) malloc( UNIFORM_POINTS * sizeof( double ));
+    const char *methods[] = { "polyfit", "polyfit_uniform" };
+    double results[ 8 ];
+
+    if( (NULL == xValues) || (NULL == yValues) )
+    {
+        free( xValues );
+        free( yValues );
+        return;
+    }
+    for( int i = 0; i < UNIFORM_POINTS; i++ )
+    {
+        xValues[i] = 10.0 + (0.001 * i);
+        yValues[i] = (xValues[i] * xValues[i]) - xValues[i];
+    }
+
+    for( int coefficientCount = 2; coefficientCount <= 8; coefficientCount *= 2 )
+    {
+        for( int m = 0; m < 2; m++ )
+        {
+            benchRow_t row = { "uniform", methods[m], "even", coefficientCount, UNIFORM_POINTS, 0.0, 0, 0.0, 0, 0 };
+            benchContext_t context = { 0 };
+            context.method = m;
+            context.pointCount = UNIFORM_POINTS;
+            context.coefficientCount = coefficientCount;
+            context.xValues = xValues;
+            context.yValues = yValues;
+            context.results = results;
+            measure( &row, runUniform, &context, 1 );
+        }
+    }
+    free( xValues );
+    free( yValues );
+}
+
+//--------------------------------------------------------
+// benchFixed()
+// Times fits of 2 to 4 coefficients to short and long
+// series with polyfit(), which takes the fixed degree
+// path, and with the general Cholesky path it replaces.
+//--------------------------------------------------------
+static void benchFixed( void )
+{
+    static double xValues[ FIXED_MAX_POINTS ];
+    static double yValues[ FIXED_MAX_POINTS ];
+    int pointCounts[] = { 8, 16, 32, 64, 128, FIXED_MAX_POINTS };
+    const char *methods[] = { "general", "fixed" };
+    double results[ 4 ];
+
+    for( int i = 0; i < FIXED_MAX_POINTS; i++ )
+    {
+        xValues[i] = (double) i / FIXED_MAX_POINTS;
+        yValues[i] = (xValues[i] * xValues[i]) - xValues[i];
+    }
+
+    for( int coefficientCount = 2; coefficientCount <= 4; coefficientCount++ )
+    {
+        for( int p = 0; p < (int) (sizeof( pointCounts ) / sizeof( pointCounts[0] )); p++ )
+        {
+            for( int m = 0; m < 2; m++ )
+            {
+                benchRow_t row = { "fixed", methods[m], "even", coefficientCount, pointCounts[p], 0.0, 0, 0.0, 0, 0 };
+                benchContext_t context = { 0 };
+                context.method = m;
+                context.pointCount = pointCounts[p];
+                context.coefficientCount = coefficientCount;
+                context.xValues = xValues;
+                context.yValues = yValues;
+                context.results = results;
+                measure( &row, runFixed, &context, 1 );
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------
+// benchEval()
+// Times the evaluation of polynomials of 4 to 16
+// coefficients at EVAL_POINTS points: with a plain scalar
+// Horner loop, with polyval(), and with polyval_batch()
+// giving both derivatives as well.
+//--------------------------------------------------------
+static void benchEval( void )
+{
+    double *xValues = (double *) malloc( EVAL_POINTS * sizeof( double ));
+    double *yValues = (double *) malloc( 3 * EVAL_POINTS * sizeof( double ));
+    const char *methods[] = { "horner", "polyval", "polyval_batch" };
+    double coefficients[ 16 ];
+
+    if( (NULL == xValues) || (NULL == yValues) )
+    {
+        free( xValues );
+        free( yValues );
+        return;
+    }
+    for( int i = 0; i < EVAL_POINTS; i++ )
+    {
+        xValues[i] = -1.0 + ((2.0 * i) / EVAL_POINTS);
+    }
+    for( int c = 0; c < 16; c++ )
+    {
+        coefficients[c] = 1.0 / (c + 1);
+    }
+
+    for( int coefficientCount = 4; coefficientCount <= 16; coefficientCount *= 2 )
+    {
+        for( int m = 0; m < 3; m++ )
+        {
+            benchRow_t row = { "eval", methods[m], "even", coefficientCount, EVAL_POINTS, 0.0, 0, 0.0, 0, 0 };
+            benchContext_t context = { 0 };
+            context.method = m;
+            context.pointCount = EVAL_POINTS;
+            context.coefficientCount = coefficientCount;
+            context.xValues = xValues;
+            context.yValues = yValues;
+            context.results = coefficients;
+            measure( &row, runEval, &context, 1 );
+        }
+    }
+    free( xValues );
+    free( yValues );
+}
+
+//--------------------------------------------------------
+// benchStats()
+// Times polyfit() with stats disabled, which should cost
+// next to nothing, and enabled, for a fixed degree and a
+// general fit of short and longer series.
+//--------------------------------------------------------
+static void benchStats( void )
+{
+    static double xValues[ STATS_MAX_POINTS ];
+    static double yValues[ STATS_MAX_POINTS ];
+    int coefficientCounts[] = { 3, 8 };
+    int pointCounts[] = { 16, STATS_MAX_POINTS };
+    const char *methods[] = { "stats_off", "stats_on" };
+    double results[ 8 ];
+
+    for( int i = 0; i < STATS_MAX_POINTS; i++ )
+    {
+        xValues[i] = (double) i / STATS_MAX_POINTS;
+        yValues[i] = (xValues[i] * xValues[i]) - xValues[i];
+    }
+
+    for( int c = 0; c < 2; c++ )
+    {
+        for( int p = 0; p < 2; p++ )
+        {
+            for( int m = 0; m < 2; m++ )
+            {
+                benchRow_t row = { "stats", methods[m], "even", coefficientCounts[c], pointCounts[p], 0.0, 0, 0.0,
+                                   0, 0 };
+                benchContext_t context = { 0 };
+                context.method = m;
+                context.pointCount = pointCounts[p];
+                context.coefficientCount = coefficientCounts[c];
+                context.xValues = xValues;
+                context.yValues = yValues;
+                context.results = results;
+                polyfit_stats_enable( 1 == m );
+                measure( &row, runStats, &context, 1 );
+                polyfit_stats_enable( false );
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------
+// benchSerial()
+// Times writing fitted coefficients as text with
+// polyToString(), as shortest round trip JSON, and as
+// binary. A "fit" is one vector written, and "points" is
+// its coefficient count.
+//--------------------------------------------------------
+static void benchSerial( void )
+{
+    const char *methods[] = { "polyToString", "json", "binary" };
+    double coefficients[ SERIAL_MAX_COEFFICIENTS ];
+    unsigned int seed = 2020u;
+
+    // Full precision values of mixed sign and magnitude, like real fits.
+    for( int c = 0; c < SERIAL_MAX_COEFFICIENTS; c++ )
+    {
+        seed = (seed * 1103515245u) + 12345u;
+        coefficients[c] = (((double) (seed >> 8) / 8388608.0) - 1.0) * (double) (1 << (c % 16)) / 3.0;
+    }
+
+    for( int coefficientCount = 4; coefficientCount <= SERIAL_MAX_COEFFICIENTS; coefficientCount *= 2 )
+    {
+        for( int m = 0; m < 3; m++ )
+        {
+            benchRow_t row = { "serial", methods[m], "random", coefficientCount, coefficientCount, 0.0, 0, 0.0, 0,
+                               0 };
+            benchContext_t context = { 0 };
+            context.method = m;
+            context.coefficientCount = coefficientCount;
+            context.results = coefficients;
+            measure( &row, runSerial, &context, 1 );
+        }
+    }
+}
+
+//--------------------------------------------------------
+// benchGoodness()
+// Times a fit with its R^2 found by a second pass over
+// the points, against polyfit_goodness(), for random
+// points and 4 and 8 coefficients.
+//--------------------------------------------------------
+static void benchGoodness( void )
+{
+    double *xValues = (double *) malloc( GOODNESS_POINTS * sizeof( double ));
+    double *yValues = (double *) malloc( GOODNESS_POINTS * sizeof( double ));
+    const char *methods[] = { "polyfit_second_pass", "polyfit_goodness" };
+    double results[ 8 ];
+    double rSquared = 0.0;
+
+    if( (NULL == xValues) || (NULL == yValues) )
+    {
+        free( xValues );
+        free( yValues );
+        return;
+    }
+    makePoints( "random", GOODNESS_POINTS, xValues, yValues );
+
+    for( int coefficientCount = 4; coefficientCount <= 8; coefficientCount *= 2 )
+    {
+        for( int m = 0; m < 2; m++ )
+        {
+            benchRow_t row = { "goodness", methods[m], "random", coefficientCount, GOODNESS_POINTS, 0.0, 0, 0.0, 0,
+                               0 };
+            benchContext_t context = { 0 };
+            context.method = m;
+            context.pointCount = GOODNESS_POINTS;
+            context.coefficientCount = coefficientCount;
+            context.xValues = xValues;
+            context.yValues = yValues;
+            context.results = results;
+            context.pSums = &rSquared;
+            measure( &row, runGoodness, &context, 1 );
+        }
+    }
+    free( xValues );
+    free( yValues );
+}
+
+//--------------------------------------------------------
+// benchAuto()
+// Times choosing the degree of a fit to random points
+// from up to 4 and up to 12 coefficients, fitting each
+// candidate in turn and with polyfit_auto().
+//--------------------------------------------------------
+static void benchAuto( void )
+{
+    double *xValues = (double *) malloc( AUTO_POINTS * sizeof( double ));
+    double *yValues = (double *) malloc( AUTO_POINTS * sizeof( double ));
+    const char *methods[] = { "fit_each_degree", "polyfit_auto" };
+    double results[ 12 ];
+    double chosenCount = 0.0;
+
+    if( (NULL == xValues) || (NULL == yValues) )
+    {
+        free( xValues );
+        free( yValues );
+        return;
+    }
+    makePoints( "random", AUTO_POINTS, xValues, yValues );
+
+    for( int maxCoefficients = 4; maxCoefficients <= 12; maxCoefficients += 8 )
+    {
+        for( int m = 0; m < 2; m++ )
+        {
+            benchRow_t row = { "auto", methods[m], "random", maxCoefficients, AUTO_POINTS, 0.0, 0, 0.0, 0, 0 };
+            benchContext_t context = { 0 };
+            context.method = m;
+            context.pointCount = AUTO_POINTS;
+            context.coefficientCount = maxCoefficients;
+            context.xValues = xValues;
+            context.yValues = yValues;
+            context.results = results;
+            context.pSums = &chosenCount;
+            measure( &row, runAuto, &context, 1 );
+        }
+    }
+    free( xValues );
+    free( yValues );
+}
+
+//--------------------------------------------------------
+// runService()
+// Fits SERVICE_JOBS series of pointCount points, each
+// with its own y values: method 0 with polyfit() in turn,
+// method 1 submitted to the context's service by this
+// thread, and method 2 by SERVICE_SUBMITTERS threads.
+//--------------------------------------------------------
+static int runService( benchContext_t *pContext )
+{
+    int rVal = 0;
+
+    if( 0 == pContext->method )
+    {
+        for( int j = 0; (0 == rVal) && (j < SERVICE_JOBS); j++ )
+        {
+            rVal = polyfit( pContext->pointCount, pContext->xValues, &(pContext->yValues[ j * pContext->pointCount ]),
+                            pContext->coefficientCount, &(pContext->results[ j * pContext->coefficientCount ]) );
+        }
+        return rVal;
+    }
+
+    int submitterCount = (1 == pContext->method) ? 1 : SERVICE_SUBMITTERS;
+    benchSubmitter_t submitters[ SERVICE_SUBMITTERS ];
+    pthread_t threads[ SERVICE_SUBMITTERS ];
+    bool started[ SERVICE_SUBMITTERS ] = { false };
+
+    for( int t = 0; t < submitterCount; t++ )
+    {
+        int first = (SERVICE_JOBS * t) / submitterCount;
+        submitters[t].pService = pContext->pService;
+        submitters[t].pJobs = &(pContext->pJobs[ first ]);
+        submitters[t].jobCount = ((SERVICE_JOBS * (t + 1)) / submitterCount) - first;
+    }
+    for( int t = 1; t < submitterCount; t++ )
+    {
+        started[t] = (0 == pthread_create( &threads[t], NULL, submitJobs, &submitters[t] ));
+    }
+    submitJobs( &submitters[0] );
+    for( int t = 1; t < submitterCount; t++ )
+    {
+        if( started[t] )
+        {
+            pthread_join( threads[t], NULL );
+        }
+        else
+        {
+            submitJobs( &submitters[t] );
+        }
+    }
+    for( int j = 0; (0 == rVal) && (j < SERVICE_JOBS); j++ )
+    {
+        rVal = pContext->pJobs[j].status;
+    }
+    return rVal;
+}
+
+//--------------------------------------------------------
+// submitJobs()
+// Submitting thread body for runService(): submits a
+// share of the jobs, then waits for them all.
+//--------------------------------------------------------
+static void *submitJobs( void *pArg )
+{
+    benchSubmitter_t *pSubmitter = (benchSubmitter_t *) pArg;
+
+    for( int j = 0; j < pSubmitter->jobCount; j++ )
+    {
+        polyfit_service_submit( pSubmitter->pService, &(pSubmitter->pJobs[j]), true );
+    }
+    for( int j = 0; j < pSubmitter->jobCount; j++ )
+    {
+        polyfit_service_wait( pSubmitter->pService, &(pSubmitter->pJobs[j]) );
+    }
+    return NULL;
+}
+
+//--------------------------------------------------------
+// benchPiecewise()
+// Times fitting 1000 evenly spaced segments of a long
+// series of evenly spaced points, for 2 and 4
+// coefficients.
+//--------------------------------------------------------
+static void benchPiecewise( void )
+{
+    double *xValues = (double *) malloc( PIECEWISE_POINTS * sizeof( double ));
+    double *yValues = (double *) malloc( PIECEWISE_POINTS * sizeof( double ));
+    double *results = (double *) malloc( PIECEWISE_SEGMENTS * 4 * sizeof( double ));
+    const char *methods[] = { "polyfit_each_segment", "piecewise_1_thread", "piecewise_all_threads",
+                              "piecewise_chosen_knots" };
+    double knots[ PIECEWISE_SEGMENTS + 1 ];
+
+    if( (NULL == xValues) || (NULL == yValues) || (NULL == results) )
+    {
+        free( xValues );
+        free( yValues );
+        free( results );
+        return;
+    }
+    makePoints( "even", PIECEWISE_POINTS, xValues, yValues );
+    for( int s = 0; s <= PIECEWISE_SEGMENTS; s++ )
+    {
+        knots[s] = -1.0 + ((2.0 * s) / PIECEWISE_SEGMENTS);
+    }
+
+    for( int coefficientCount = 2; coefficientCount <= 4; coefficientCount += 2 )
+    {
+        for( int m = 0; m < 4; m++ )
+        {
+            benchRow_t row = { "piecewise", methods[m], "even", coefficientCount, PIECEWISE_POINTS, 0.0, 0, 0.0, 0, 0 };
+            benchContext_t context = { 0 };
+            context.method = m;
+            context.pointCount = PIECEWISE_POINTS;
+            context.coefficientCount = coefficientCount;
+            context.xValues = xValues;
+            context.yValues = yValues;
+            context.results = results;
+            context.pSums = knots;
+            measure( &row, runPiecewise, &context, 1 );
+        }
+    }
+    free( xValues );
+    free( yValues );
+    free( results );
+}
+
+//--------------------------------------------------------
+// benchService()
+// Times SERVICE_JOBS quadratic fits of SERVICE_POINTS
+// random points each, fitted in turn and through a
+// service with one thread per CPU, and reports the
+// service's latencies on stderr.
+//--------------------------------------------------------
+static void benchService( void )
+{
+    const int coefficientCount = 3;
+    double *xValues = (double *) malloc( SERVICE_POINTS * sizeof( double ));
+    double *yValues = (double *) malloc( (size_t) SERVICE_JOBS * SERVICE_POINTS * sizeof( double ));
+    double *results = (double *) malloc( (size_t) SERVICE_JOBS * coefficientCount * sizeof( double ));
+    polyfit_job_t *pJobs = (polyfit_job_t *) calloc( SERVICE_JOBS, sizeof( polyfit_job_t ));
+    const char *methods[] = { "polyfit_in_turn", "service_1_submitter", "service_4_submitters" };
+    polyfit_service_t *pService = NULL;
+
+    if( (NULL == xValues) || (NULL == yValues) || (NULL == results) || (NULL == pJobs) ||
+        (0 != polyfit_service_create( &pService, 0, 256, coefficientCount )) )
+    {
+        free( xValues );
+        free( yValues );
+        free( results );
+        free( pJobs );
+        return;
+    }
+    for( int j = 0; j < SERVICE_JOBS; j++ )
+    {
+        makePoints( "random", SERVICE_POINTS, xValues, &(yValues[ j * SERVICE_POINTS ]) );
+        polyfit_job_t job = { SERVICE_POINTS, xValues, &(yValues[ j * SERVICE_POINTS ]), coefficientCount,
+                              &(results[ j * coefficientCount ]), NULL, NULL, 0, 0, 0.0 };
+        pJobs[j] = job;
+    }
+
+    for( int m = 0; m < 3; m++ )
+    {
+        benchRow_t row = { "service", methods[m], "random", coefficientCount, SERVICE_POINTS, 0.0, 0, 0.0, 0, 0 };
+        benchContext_t context = { 0 };
+        context.method = m;
+        context.pointCount = SERVICE_POINTS;
+        context.coefficientCount = coefficientCount;
+        context.xValues = xValues;
+        context.yValues = yValues;
+        context.results = results;
+        context.pService = pService;
+        context.pJobs = pJobs;
+        measure( &row, runService, &context, SERVICE_JOBS );
+    }
+
+    polyfit_service_metrics_t metrics;
+    polyfit_service_metrics( pService, &metrics );
+    fprintf( stderr, "service: %lld jobs, latency mean %.0f ns, p50 %.0f ns, p99 %.0f ns, max %.0f ns, "
+             "deepest queue %d\n", metrics.completed, metrics.meanLatencyNs, metrics.p50LatencyNs,
+             metrics.p99LatencyNs, metrics.maxLatencyNs, metrics.maxQueueDepth );
+    polyfit_service_destroy( pService );
+
+    free( xValues );
+    free( yValues );
+    free( results );
+    free( pJobs );
+}
+
+//--------------------------------------------------------
+// benchOnline()
+// Times refitting a window of ONLINE_WINDOW points as each
+// of ONLINE_SAMPLES samples of a long stream arrives, for
+// 2, 3 and 4 coefficients. A "fit" is one sample added
+// and the fit brought up to date.
+//--------------------------------------------------------
+static void benchOnline( void )
+{
+    static double xValues[ ONLINE_SAMPLES ];
+    static double yValues[ ONLINE_SAMPLES ];
+    const char *methods[] = { "polyfit_each_sample", "online_window", "online_forgetting" };
+    double results[ 4 ];
+
+    makePoints( "even", ONLINE_SAMPLES, xValues, yValues );
+
+    for( int coefficientCount = 2; coefficientCount <= 4; coefficientCount++ )
+    {
+        for( int m = 0; m < 3; m++ )
+        {
+            benchRow_t row = { "online", methods[m], "even", coefficientCount, ONLINE_WINDOW, 0.0, 0, 0.0, 0, 0 };
+            benchContext_t context = { 0 };
+            context.method = m;
+            context.pointCount = ONLINE_SAMPLES;
+            context.coefficientCount = coefficientCount;
+            context.xValues = xValues;
+            context.yValues = yValues;
+            context.results = results;
+            measure( &row, runOnline, &context, ONLINE_SAMPLES - ONLINE_WINDOW + 1 );
+        }
+    }
+}
+
+//--------------------------------------------------------
+// benchView()
+// Times fitting VIEW_POINTS records with 3 and 6
+// coefficients, copying their fields into arrays first
+// and reading them in place through views.
+//--------------------------------------------------------
+static void benchView( void )
+{
+    double *xValues = (double *) malloc( VIEW_POINTS * sizeof( double ));
+    double *yValues = (double *) malloc( VIEW_POINTS * sizeof( double ));
+    benchRecord_t *pRecords = (benchRecord_t *) malloc( VIEW_POINTS * sizeof( benchRecord_t ));
+    const char *methods[] = { "copy_then_polyfit", "view_float", "view_timestamps" };
+    double results[ 6 ];
+
+    if( (NULL == xValues) || (NULL == yValues) || (NULL == pRecords) )
+    {
+        free( xValues );
+        free( yValues );
+        free( pRecords );
+        return;
+    }
+    makePoints( "even", VIEW_POINTS, xValues, yValues );
+    for( int i = 0; i < VIEW_POINTS; i++ )
+    {
+        pRecords[i].timeNs = 1700000000000000000LL + (1000LL * i);
+        pRecords[i].level = (float) xValues[i];
+        pRecords[i].count = i;
+        pRecords[i].value = yValues[i];
+    }
+
+    for( int coefficientCount = 3; coefficientCount <= 6; coefficientCount += 3 )
+    {
+        for( int m = 0; m < 3; m++ )
+        {
+            benchRow_t row = { "views", methods[m], "even", coefficientCount, VIEW_POINTS, 0.0, 0, 0.0, 0, 0 };
+            benchContext_t context = { 0 };
+            context.method = m;
+            context.pointCount = VIEW_POINTS;
+            context.coefficientCount = coefficientCount;
+            context.xValues = xValues;
+            context.yValues = yValues;
+            context.results = results;
+            context.pRecords = pRecords;
+            measure( &row, runView, &context, 1 );
+        }
+    }
+    free( xValues );
+    free( yValues );
+    free( pRecords );
+}
+
+//--------------------------------------------------------
+// benchOrthogonal()
+// Times fitting ORTHOGONAL_POINTS random points with 4, 8
+// and 16 coefficients through the normal equations and by
+// orthogonal polynomials. The status column shows where
+// the normal equations can no longer be solved.
+//--------------------------------------------------------
+static void benchOrthogonal( void )
+{
+    double *xValues = (double *) malloc( ORTHOGONAL_POINTS * sizeof( double ));
+    double *yValues = (double *) malloc( ORTHOGONAL_POINTS * sizeof( double ));
+    const char *methods[] = { "polyfit", "polyfit_orthogonal", "polyfit_chebyshev" };
+    double results[ 16 ];
+    double range[ 2 ];
+
+    if( (NULL == xValues) || (NULL == yValues) )
+    {
+        free( xValues );
+        free( yValues );
+        return;
+    }
+    makePoints( "random", ORTHOGONAL_POINTS, xValues, yValues );
+
+    for( int coefficientCount = 4; coefficientCount <= 16; coefficientCount *= 2 )
+    {
+        for( int m = 0; m < 3; m++ )
+        {
+            benchRow_t row = { "orthogonal", methods[m], "random", coefficientCount, ORTHOGONAL_POINTS, 0.0, 0,
+                               0.0, 0, 0 };
+            benchContext_t context = { 0 };
+            context.method = m;
+            context.pointCount = ORTHOGONAL_POINTS;
+            context.coefficientCount = coefficientCount;
+            context.xValues = xValues;
+            context.yValues = yValues;
+            context.results = results;
+            context.pSums = range;
+            measure( &row, runOrthogonal, &context, 1 );
+        }
+    }
+    free( xValues );
+    free( yValues );
+}
+
+//--------------------------------------------------------
+// benchSurface()
+// Times the normal sums of SURFACE_POINTS random points
+// on a surface in two variables, of total degree 1 to
+// SURFACE_MAX_DEGREE, made directly with pow(), against
+// the whole of polyfit_surface_fit(), and of
+// polyfit_surface_fit_ws() in a workspace made once.
+//--------------------------------------------------------
+static void benchSurface( void )
+{
+    double *pInputs = (double *) malloc( 2 * SURFACE_POINTS * sizeof( double ));
+    double *zValues = (double *) malloc( 2 * SURFACE_POINTS * sizeof( double ));
+    const char *methods[] = { "pow_normal_sums", "polyfit_surface_fit", "polyfit_surface_fit_ws" };
+    int exponents[ 2 * 15 ];
+    double terms[ 15 ];
+    double sums[ 15 * 16 ];
+    size_t workspaceSize = polyfit_surface_workspace_size( 15 );
+    void *pMemory = malloc( workspaceSize );
+    polyfit_workspace_t workspace;
+
+    if( (NULL == pInputs) || (NULL == zValues) || (NULL == pMemory) ||
+        (0 != polyfit_workspace_init( &workspace, pMemory, workspaceSize, INT_MAX, 15 )) )
+    {
+        free( pInputs );
+        free( zValues );
+        free( pMemory );
+        return;
+    }
+    // Random x from -1 to 1 and y from -10 to 10, paired, with z made from them.
+    makePoints( "random", 2 * SURFACE_POINTS, pInputs, zValues );
+    for( int i = 0; i < SURFACE_POINTS; i++ )
+    {
+        double x = pInputs[ 2 * i ];
+        double y = 10.0 * pInputs[ (2 * i) + 1 ];
+        pInputs[ (2 * i) + 1 ] = y;
+        zValues[i] = 1.0 + x - (0.5 * x * y) + (0.01 * y * y) + (1e-3 * zValues[ (2 * i) + 1 ]);
+    }
+
+    for( int degree = 1; degree <= SURFACE_MAX_DEGREE; degree++ )
+    {
+        int termCount = 0;
+        if( 0 != polyfit_surface_terms( 2, degree, 15, exponents, &termCount ))
+        {
+            break;
+        }
+        for( int m = 0; m < 3; m++ )
+        {
+            benchRow_t row = { "surface", methods[m], "random", termCount, SURFACE_POINTS, 0.0, 0, 0.0, 0, 0 };
+            benchContext_t context = { 0 };
+            context.method = m;
+            context.pointCount = SURFACE_POINTS;
+            context.coefficientCount = termCount;
+            context.xValues = pInputs;
+            context.yValues = zValues;
+            context.results = terms;
+            context.pSums = sums;
+            context.pExponents = exponents;
+            context.pWorkspace = &workspace;
+            measure( &row, runSurface, &context, 1 );
+        }
+    }
+    free( pInputs );
+    free( zValues );
+    free( pMemory );
+}
+
+//--------------------------------------------------------
+// benchBatch()
+// Times BATCH_SERIES series of 4 to BATCH_MAX_POINTS
+// points each, fitted with polyfit() one at a time and
+// with polyfit_batch() all at once, for 2 to 4
+// coefficients. Each series has its own x values.
+//--------------------------------------------------------
+static void benchBatch( void )
+{
+    double *xValues = (double *) malloc( BATCH_SERIES * BATCH_MAX_POINTS * sizeof( double ));
+    double *yValues = (double *) malloc( BATCH_SERIES * BATCH_MAX_POINTS * sizeof( double ));
+    const char *methods[] = { "polyfit", "polyfit_batch" };
+    int pointCounts[] = { 4, 8, 16, BATCH_MAX_POINTS };
+    static int seriesOffsets[ BATCH_SERIES + 1 ];
+    static int seriesStatus[ BATCH_SERIES ];
+    static double results[ BATCH_SERIES * 4 ];
+
+    if( (NULL == xValues) || (NULL == yValues) )
+    {
+        free( xValues );
+        free( yValues );
+        return;
+    }
+    makePoints( "random", BATCH_SERIES * BATCH_MAX_POINTS, xValues, yValues );
+
+    for( int coefficientCount = 2; coefficientCount <= 4; coefficientCount++ )
+    {
+        for( int p = 0; p < (int) (sizeof( pointCounts ) / sizeof( pointCounts[0] )); p++ )
+        {
+            for( int s = 0; s <= BATCH_SERIES; s++ )
+            {
+                seriesOffsets[s] = s * pointCounts[p];
+            }
+            for( int m = 0; m < 2; m++ )
+            {
+                benchRow_t row = { "batch", methods[m], "random", coefficientCount, pointCounts[p], 0.0, 0, 0.0, 0,
+                                   0 };
+                benchContext_t context = { 0 };
+                context.method = m;
+                context.pointCount = pointCounts[p];
+                context.coefficientCount = coefficientCount;
+                context.xValues = xValues;
+                context.yValues = yValues;
+                context.results = results;
+                context.pSeriesOffsets = seriesOffsets;
+                context.pSeriesStatus = seriesStatus;
+                measure( &row, runBatch, &context, BATCH_SERIES );
+            }
+        }
+    }
+    free( xValues );
+    free( yValues );
+}
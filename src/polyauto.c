@@ -0,0 +1,283 @@
+// Name: polyauto.c
+// Description: Automatic choice of the polynomial degree from one set of power sums.
+// Author: Henry M. Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+#include <float.h>      // DBL_EPSILON
+#include <math.h>       // log(), HUGE_VAL
+
+#include "polyfit_internal.h"
+
+
+//------------------------------------------------
+// Private Function Prototypes
+//------------------------------------------------
+
+static int      factorAscending( int coefficientCount, double *pPowerSums, double *pFactor );
+static double   scoreFit( polyfit_criterion_t criterion, double pointCount, int coefficientCount, double sse );
+
+
+//=========================================================
+//      Global function definitions
+//=========================================================
+
+
+//--------------------------------------------------------
+// polyfit_auto()
+// Chooses how many coefficients to fit, from 1 up to
+// maxCoefficients, by the given criterion, and stores
+// that many coefficients, highest power first, in
+// coefficientResults, which must have room for
+// maxCoefficients. The count goes to *pCoefficientCount.
+// Unless scores is NULL, scores[k - 1] receives the score
+// of the fit with k coefficients; lower is better, and
+// infinity marks a count whose equations can't be solved.
+//
+// The points are read once, into an accumulator for
+// maxCoefficients; see polyfit_accum_auto().
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < maxCoefficients),
+//          -3 if unable to allocate memory,
+//          -4 if unable to solve even for 1 coefficient,
+//          -5 if maxCoefficients < 1 or the criterion is
+//             out of range.
+//--------------------------------------------------------
+int polyfit_auto( int pointCount, double *xValues, double *yValues, int maxCoefficients,
+                  polyfit_criterion_t criterion, double *coefficientResults, int *pCoefficientCount,
+                  double *scores )
+{
+    int rVal = 0;
+    polyfit_accum_t accum;
+
+    if( (NULL == xValues) || (NULL == yValues) || (NULL == coefficientResults) || (NULL == pCoefficientCount) )
+    {
+        return -1;
+    }
+    if( pointCount < maxCoefficients )
+    {
+        return -2;
+    }
+
+    rVal = polyfit_accum_init( &accum, maxCoefficients );
+    if( 0 == rVal )
+    {
+        rVal = polyfit_accum_add_many( &accum, pointCount, xValues, yValues );
+    }
+    if( 0 == rVal )
+    {
+        rVal = polyfit_accum_auto( &accum, criterion, coefficientResults, pCoefficientCount, scores );
+    }
+    polyfit_accum_free( &accum );
+
+    return rVal;
+}
+
+//--------------------------------------------------------
+// polyfit_accum_auto()
+// Same as polyfit_auto(), choosing among 1 up to the
+// accumulator's coefficientCount coefficients.
+//
+// With the powers in ascending order, (AT)A for k
+// coefficients is the leading k by k block of (AT)A for
+// more, so the leading block of one Cholesky factor L is
+// the factor for every smaller k. The forward solve
+// L z = (AT)b likewise gives every k's z as a prefix of
+// one vector, and the sum of squared residuals of the k
+// coefficient fit is
+//      sum of y^2 - (z[0]^2 + ... + z[k - 1]^2).
+// So one k^3/6 factorization and one k^2/2 forward solve
+// score every candidate, and only the winner needs a back
+// substitution. If a pivot fails, the counts from there
+// up can't be solved and score infinity.
+//
+// The scores use n points and SSE as follows:
+//      AIC     n ln(SSE / n) + 2k
+//      BIC     n ln(SSE / n) + k ln(n)
+//      GCV     n SSE / (n - k)^2
+// GCV is the leave-one-out cross-validation error with
+// each point's leverage replaced by the average, k / n,
+// which, unlike true cross-validation, needs no second
+// pass. An SSE within rounding of 0 is raised to
+// DBL_EPSILON times the sum of y^2, so exact data picks
+// the fewest coefficients that fit it.
+//
+// The accumulator is left unchanged.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if fewer points than coefficientCount have
+//             been added,
+//          -3 if unable to allocate memory,
+//          -4 if unable to solve even for 1 coefficient,
+//          -5 if the criterion is out of range.
+//--------------------------------------------------------
+int polyfit_accum_auto( polyfit_accum_t *pAccum, polyfit_criterion_t criterion, double *coefficientResults,
+                        int *pCoefficientCount, double *scores )
+{
+    if( (NULL == pAccum) || (NULL == pAccum->pPowerSums) || (NULL == coefficientResults) ||
+        (NULL == pCoefficientCount) )
+    {
+        return -1;
+    }
+    if( (criterion < POLYFIT_CRITERION_AIC) || (criterion > POLYFIT_CRITERION_GCV) )
+    {
+        return -5;
+    }
+    if( pAccum->pointCount < pAccum->coefficientCount )
+    {
+        return -2;
+    }
+
+    int maxCoefficients = pAccum->coefficientCount;
+    int factorCount = (maxCoefficients * (maxCoefficients + 1)) / 2;
+    double *pTemp = (double *) polyfitCalloc( factorCount + maxCoefficients, sizeof( double ));
+    if( NULL == pTemp )
+    {
+        return -3;
+    }
+
+    double *pFactor = pTemp;
+    double *pZ = &(pFactor[ factorCount ]);         // Forward solution, ascending powers.
+    double pointCount = (double) pAccum->pointCount;
+    double sseFloor = fmax( DBL_EPSILON * pAccum->ySquareSum, DBL_MIN );
+
+    int solvableCount = factorAscending( maxCoefficients, pAccum->pPowerSums, pFactor );
+
+    // Forward solve, scoring each prefix as it is completed.
+    int bestCount = 0;
+    double bestScore = HUGE_VAL;
+    double explained = 0.0;
+    for( int k = 1; k <= maxCoefficients; k++ )
+    {
+        double score = HUGE_VAL;
+        if( k <= solvableCount )
+        {
+            int r = k - 1;
+            double *pRowR = &(pFactor[ (r * (r + 1)) / 2 ]);
+            double sum = pAccum->pRhsSums[r];
+            for( int m = 0; m < r; m++ )
+            {
+                sum -= pRowR[m] * pZ[m];
+            }
+            pZ[r] = sum / pRowR[r];
+            explained += pZ[r] * pZ[r];
+            score = scoreFit( criterion, pointCount, k, fmax( pAccum->ySquareSum - explained, sseFloor ));
+        }
+        if( NULL != scores )
+        {
+            scores[ k - 1 ] = score;
+        }
+        if( score < bestScore )
+        {
+            bestScore = score;
+            bestCount = k;
+        }
+    }
+
+    // Back substitution for the winner only, storing the highest power first.
+    for( int r = bestCount - 1; r >= 0; r-- )
+    {
+        double sum = pZ[r];
+        for( int m = r + 1; m < bestCount; m++ )
+        {
+            sum -= pFactor[ ((m * (m + 1)) / 2) + r ] * coefficientResults[ bestCount - 1 - m ];
+        }
+        coefficientResults[ bestCount - 1 - r ] = sum / pFactor[ ((r * (r + 1)) / 2) + r ];
+    }
+
+    polyfitFree( pTemp );
+    *pCoefficientCount = bestCount;
+    return (bestCount > 0) ? 0 : -4;
+}
+
+
+//=========================================================
+//      Private function definitions
+//=========================================================
+
+//--------------------------------------------------------
+// factorAscending()
+// Computes the packed Cholesky factor of (AT)A, as
+// polyfitCholeskyFactor() does, but with the powers in
+// ascending order, so that each leading block is the
+// factor for fewer coefficients. Stops at the first pivot
+// that is no more than rounding noise on its diagonal.
+// Returns the number of rows factored.
+//--------------------------------------------------------
+static int factorAscending( int coefficientCount, double *pPowerSums, double *pFactor )
+{
+    for( int r = 0; r < coefficientCount; r++ )
+    {
+        double *pRowR = &(pFactor[ (r * (r + 1)) / 2 ]);
+        for( int c = 0; c <= r; c++ )
+        {
+            double *pRowC = &(pFactor[ (c * (c + 1)) / 2 ]);
+            double diagonal = pPowerSums[ r + c ];
+            double sum = diagonal;
+            for( int m = 0; m < c; m++ )
+            {
+                sum -= pRowR[m] * pRowC[m];
+            }
+            if( r == c )
+            {
+                if( !(sum > (r + 1) * DBL_EPSILON * diagonal) )
+                {
+                    return r;
+                }
+                pRowR[c] = sqrt( sum );
+            }
+            else
+            {
+                pRowR[c] = sum / pRowC[c];
+            }
+        }
+    }
+    return coefficientCount;
+}
+
+//--------------------------------------------------------
+// scoreFit()
+// Returns the criterion's score of a fit of
+// coefficientCount coefficients to pointCount points with
+// a sum of squared residuals of sse, or infinity if GCV
+// has no degrees of freedom left.
+//--------------------------------------------------------
+static double scoreFit( polyfit_criterion_t criterion, double pointCount, int coefficientCount, double sse )
+{
+    double misfit = pointCount * log( sse / pointCount );     // -2 ln(likelihood), less a constant.
+    double freePoints = pointCount - coefficientCount;
+
+    switch( criterion )
+    {
+        case POLYFIT_CRITERION_AIC: return misfit + (2.0 * coefficientCount);
+        case POLYFIT_CRITERION_BIC: return misfit + (coefficientCount * log( pointCount ));
+        case POLYFIT_CRITERION_GCV: return (freePoints > 0.0) ? (pointCount * sse) / (freePoints * freePoints)
+                                                              : HUGE_VAL;
+    }
+    return HUGE_VAL;
+}
@@ -0,0 +1,1062 @@
+// Name: polycli.c
+// Description: Command line tool that fits polynomials to large files of points.
+// Author: Henry M. Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+//
+// Synopsis:
+//      polyfit [-k n] [--csv [file]] [--delimiter c] [--header]
+//              [--x-column i] [--y-column i] [--group-column i]
+//      polyfit [-k n] --f64 | --f32 -x file -y file [-g file] [--threads n]
+//      ... [--chunk-points n] [--json-output | --binary-output]
+//
+// Fits a polynomial of n coefficients (2 by default, a line) to every
+// point of its input, or one per group of points with the same key.
+//
+// CSV comes from a file, or from stdin if none is named. It is read in a
+// fixed buffer and parsed in place, so nothing is allocated per line;
+// lines whose x or y field isn't a number are skipped and counted.
+//
+// Binary input is flat columns of float64 (--f64) or float32 (--f32)
+// values, one file each for x, y and the optional group keys. Each file
+// is memory mapped one chunk at a time, so float64 points are fitted
+// straight from the page cache with no copy, and memory use stays the
+// same whatever the file size.
+//
+// Groups are keyed by the text of a CSV field, or by the value in the
+// group file. Each consecutive run of points with the same key is added
+// to its group's accumulator at once, so input sorted or clustered by
+// key costs little more than ungrouped input.
+//
+// The coefficients of each fit are written, in the order its group first
+// appeared, as one line of text formatted by polyToString(), preceded
+// by the key and a tab if there are groups. --json-output writes the
+// coefficients instead as a JSON array of shortest round trip numbers,
+// which read back exactly. --binary-output writes them as n float64
+// values per fit, highest power first, with NaN for a fit that failed.
+//
+// Exits with 0 if every fit succeeded, 1 if the options or input can't
+// be used, and 2 if any fit failed.
+
+#define _POSIX_C_SOURCE 200809L     // posix_madvise(), sysconf()
+
+#include  <errno.h>
+#include  <fcntl.h>                 // open()
+#include  <math.h>
+#include  <stdbool.h>
+#include  <stdint.h>
+#include  <stdio.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include  <sys/mman.h>              // mmap()
+#include  <sys/stat.h>              // fstat()
+#include  <unistd.h>                // close(), sysconf()
+
+#include  "polyfit.h"
+
+// Default points fitted per chunk: 8 MiB of float64 x values.
+#define DEFAULT_CHUNK_POINTS    (1 << 20)
+
+// Bytes of CSV read at a time. No line may be longer.
+#define CSV_BUFFER_SIZE         (1 << 20)
+
+// Longest field handed to strtod() when the fast number parser can't
+// give an exact result.
+#define NUMBER_MAX_LENGTH       (64)
+
+// Initial sizes of the group table, which doubles as it fills.
+#define GROUP_INITIAL_CAPACITY  (64)
+#define KEY_INITIAL_SIZE        (4096)
+
+// Input formats.
+typedef enum cliInput_e
+{
+    CLI_INPUT_CSV = 0,
+    CLI_INPUT_F64,
+    CLI_INPUT_F32
+} cliInput_t;
+
+// The parsed command line.
+typedef struct cliOptions_s
+{
+    int             coefficientCount;
+    cliInput_t      input;
+    const char *    pCsvPath;           // NULL for stdin.
+    char            delimiter;
+    bool            header;             // Skip the first CSV line.
+    int             xColumn;
+    int             yColumn;
+    int             groupColumn;        // -1 for no groups.
+    const char *    pXPath;
+    const char *    pYPath;
+    const char *    pGroupPath;         // NULL for no groups.
+    int             threadCount;
+    int             chunkPoints;
+    bool            jsonOutput;
+    bool            binaryOutput;
+} cliOptions_t;
+
+// One group: its key, and the accumulator of its points.
+typedef struct cliGroup_s
+{
+    size_t          keyOffset;          // Into the key store.
+    int             keyLength;
+    polyfit_accum_t accum;
+} cliGroup_t;
+
+// Groups in order of first appearance, found by an open addressing hash
+// table of indexes into pGroups.
+typedef struct cliGroups_s
+{
+    int             coefficientCount;
+    bool            numericKeys;        // Keys are float64 or float32 values, not text.
+    cliGroup_t *    pGroups;
+    int             groupCount;
+    int             groupCapacity;
+    int *           pSlots;             // -1 for empty; slotCount is twice groupCapacity.
+    int             slotCount;
+    char *          pKeys;
+    size_t          keysUsed;
+    size_t          keysSize;
+} cliGroups_t;
+
+// A chunk of a binary column file, mapped into memory.
+typedef struct cliWindow_s
+{
+    void *          pMap;
+    size_t          mapLength;
+    const char *    pData;              // The chunk's first value.
+} cliWindow_t;
+
+
+//------------------------------------------------
+// Private Function Prototypes
+//------------------------------------------------
+
+static int          parseOptions( int argc, char *argv[], cliOptions_t *pOptions );
+static void         printUsage( FILE *pFile, const char *pProgram );
+static int          groupsInit( cliGroups_t *pGroups, int coefficientCount, bool numericKeys );
+static void         groupsFree( cliGroups_t *pGroups );
+static cliGroup_t * groupsFind( cliGroups_t *pGroups, const char *pKey, int keyLength );
+static int          groupsGrow( cliGroups_t *pGroups );
+static uint64_t     hashKey( const char *pKey, int keyLength );
+static int          fitBinary( cliOptions_t *pOptions, cliGroups_t *pGroups );
+static int          openColumn( const char *pPath, size_t valueSize, long long *pValueCount );
+static int          mapWindow( int fd, size_t valueSize, long long first, int count, cliWindow_t *pWindow );
+static void         unmapWindow( cliWindow_t *pWindow );
+static int          fitCsv( cliOptions_t *pOptions, cliGroups_t *pGroups );
+static int          addRun( cliGroup_t *pGroup, int pointCount, double *xValues, double *yValues, int threadCount );
+static bool         parseNumber( const char *pField, const char *pEnd, double *pValue );
+static int          writeFits( cliOptions_t *pOptions, cliGroups_t *pGroups );
+
+
+//--------------------------------------------------------
+// main()
+// Parses the options, adds every point to its group's
+// accumulator, then solves and writes each fit.
+// Returns 0 if every fit succeeded, 1 if the options or
+// input can't be used, 2 if any fit failed.
+//--------------------------------------------------------
+int main( int argc, char *argv[] )
+{
+    cliOptions_t options;
+    cliGroups_t groups;
+
+    int rVal = parseOptions( argc, argv, &options );
+    if( rVal <= 0 )
+    {
+        return -rVal;
+    }
+
+    bool grouped = (CLI_INPUT_CSV == options.input) ? (options.groupColumn >= 0) : (NULL != options.pGroupPath);
+    if( 0 != groupsInit( &groups, options.coefficientCount, CLI_INPUT_CSV != options.input ) )
+    {
+        fprintf( stderr, "%s: out of memory\n", argv[0] );
+        return 1;
+    }
+    if( !grouped && (NULL == groupsFind( &groups, "", 0 )) )
+    {
+        fprintf( stderr, "%s: out of memory\n", argv[0] );
+        groupsFree( &groups );
+        return 1;
+    }
+
+    rVal = (CLI_INPUT_CSV == options.input) ? fitCsv( &options, &groups ) : fitBinary( &options, &groups );
+    if( 0 == rVal )
+    {
+        rVal = writeFits( &options, &groups );
+    }
+    groupsFree( &groups );
+    return rVal;
+}
+
+
+//=========================================================
+//      Private function definitions
+//=========================================================
+
+//--------------------------------------------------------
+// parseOptions()
+// Fills in *pOptions from the command line.
+// Returns 1 to go on, 0 after --help, or -1 if the options
+// can't be used.
+//--------------------------------------------------------
+static int parseOptions( int argc, char *argv[], cliOptions_t *pOptions )
+{
+    pOptions->coefficientCount = 2;
+    pOptions->input = CLI_INPUT_CSV;
+    pOptions->pCsvPath = NULL;
+    pOptions->delimiter = ',';
+    pOptions->header = false;
+    pOptions->xColumn = 0;
+    pOptions->yColumn = 1;
+    pOptions->groupColumn = -1;
+    pOptions->pXPath = NULL;
+    pOptions->pYPath = NULL;
+    pOptions->pGroupPath = NULL;
+    pOptions->threadCount = 1;
+    pOptions->chunkPoints = DEFAULT_CHUNK_POINTS;
+    pOptions->jsonOutput = false;
+    pOptions->binaryOutput = false;
+
+    for( int a = 1; a < argc; a++ )
+    {
+        bool understood = true;
+        bool hasValue = (a + 1 < argc);
+
+        if( 0 == strcmp( argv[a], "--help" ) )
+        {
+            printUsage( stdout, argv[0] );
+            return 0;
+        }
+        else if( 0 == strcmp( argv[a], "--csv" ) )
+        {
+            pOptions->input = CLI_INPUT_CSV;
+            if( hasValue && ('-' != argv[a + 1][0]) )
+            {
+                pOptions->pCsvPath = argv[++a];
+            }
+        }
+        else if( 0 == strcmp( argv[a], "--f64" ) )
+        {
+            pOptions->input = CLI_INPUT_F64;
+        }
+        else if( 0 == strcmp( argv[a], "--f32" ) )
+        {
+            pOptions->input = CLI_INPUT_F32;
+        }
+        else if( 0 == strcmp( argv[a], "--header" ) )
+        {
+            pOptions->header = true;
+        }
+        else if( 0 == strcmp( argv[a], "--json-output" ) )
+        {
+            pOptions->jsonOutput = true;
+        }
+        else if( 0 == strcmp( argv[a], "--binary-output" ) )
+        {
+            pOptions->binaryOutput = true;
+        }
+        else if( !hasValue )
+        {
+            understood = false;
+        }
+        else if( 0 == strcmp( argv[a], "-k" ) )
+        {
+            pOptions->coefficientCount = atoi( argv[++a] );
+            understood = (pOptions->coefficientCount >= 1);
+        }
+        else if( 0 == strcmp( argv[a], "--delimiter" ) )
+        {
+            pOptions->delimiter = argv[++a][0];
+            understood = ('\0' != pOptions->delimiter) && ('\n' != pOptions->delimiter);
+        }
+        else if( 0 == strcmp( argv[a], "--x-column" ) )
+        {
+            pOptions->xColumn = atoi( argv[++a] );
+            understood = (pOptions->xColumn >= 0);
+        }
+        else if( 0 == strcmp( argv[a], "--y-column" ) )
+        {
+            pOptions->yColumn = atoi( argv[++a] );
+            understood = (pOptions->yColumn >= 0);
+        }
+        else if( 0 == strcmp( argv[a], "--group-column" ) )
+        {
+            pOptions->groupColumn = atoi( argv[++a] );
+            understood = (pOptions->groupColumn >= 0);
+        }
+        else if( 0 == strcmp( argv[a], "-x" ) )
+        {
+            pOptions->pXPath = argv[++a];
+        }
+        else if( 0 == strcmp( argv[a], "-y" ) )
+        {
+            pOptions->pYPath = argv[++a];
+        }
+        else if( 0 == strcmp( argv[a], "-g" ) )
+        {
+            pOptions->pGroupPath = argv[++a];
+        }
+        else if( 0 == strcmp( argv[a], "--threads" ) )
+        {
+            pOptions->threadCount = atoi( argv[++a] );
+            understood = (pOptions->threadCount >= 0);
+        }
+        else if( 0 == strcmp( argv[a], "--chunk-points" ) )
+        {
+            pOptions->chunkPoints = atoi( argv[++a] );
+            understood = (pOptions->chunkPoints >= 1);
+        }
+        else
+        {
+            understood = false;
+        }
+
+        if( !understood )
+        {
+            fprintf( stderr, "%s: can't use option %s\n", argv[0], argv[a] );
+            printUsage( stderr, argv[0] );
+            return -1;
+        }
+    }
+
+    if( (CLI_INPUT_CSV != pOptions->input) && ((NULL == pOptions->pXPath) || (NULL == pOptions->pYPath)) )
+    {
+        fprintf( stderr, "%s: binary input needs -x and -y files\n", argv[0] );
+        return -1;
+    }
+    return 1;
+}
+
+//--------------------------------------------------------
+// printUsage()
+// Writes the synopsis to pFile.
+//--------------------------------------------------------
+static void printUsage( FILE *pFile, const char *pProgram )
+{
+    fprintf( pFile, "usage: %s [-k n] [--csv [file]] [--delimiter c] [--header]\n"
+                    "           [--x-column i] [--y-column i] [--group-column i]\n"
+                    "       %s [-k n] --f64 | --f32 -x file -y file [-g file] [--threads n]\n"
+                    "       ... [--chunk-points n] [--json-output | --binary-output]\n", pProgram, pProgram );
+}
+
+//--------------------------------------------------------
+// groupsInit()
+// Prepares an empty group table.
+// Returns 0 if success, -3 if unable to allocate memory.
+//--------------------------------------------------------
+static int groupsInit( cliGroups_t *pGroups, int coefficientCount, bool numericKeys )
+{
+    pGroups->coefficientCount = coefficientCount;
+    pGroups->numericKeys = numericKeys;
+    pGroups->groupCount = 0;
+    pGroups->groupCapacity = GROUP_INITIAL_CAPACITY;
+    pGroups->slotCount = 2 * GROUP_INITIAL_CAPACITY;
+    pGroups->keysUsed = 0;
+    pGroups->keysSize = KEY_INITIAL_SIZE;
+    pGroups->pGroups = (cliGroup_t *) calloc( pGroups->groupCapacity, sizeof( cliGroup_t ));
+    pGroups->pSlots = (int *) malloc( pGroups->slotCount * sizeof( int ));
+    pGroups->pKeys = (char *) malloc( pGroups->keysSize );
+    if( (NULL == pGroups->pGroups) || (NULL == pGroups->pSlots) || (NULL == pGroups->pKeys) )
+    {
+        groupsFree( pGroups );
+        return -3;
+    }
+    for( int s = 0; s < pGroups->slotCount; s++ )
+    {
+        pGroups->pSlots[s] = -1;
+    }
+    return 0;
+}
+
+//--------------------------------------------------------
+// groupsFree()
+// Releases a group table and its accumulators.
+//--------------------------------------------------------
+static void groupsFree( cliGroups_t *pGroups )
+{
+    for( int g = 0; (NULL != pGroups->pGroups) && (g < pGroups->groupCount); g++ )
+    {
+        polyfit_accum_free( &(pGroups->pGroups[g].accum) );
+    }
+    free( pGroups->pGroups );
+    free( pGroups->pSlots );
+    free( pGroups->pKeys );
+    pGroups->pGroups = NULL;
+    pGroups->pSlots = NULL;
+    pGroups->pKeys = NULL;
+    pGroups->groupCount = 0;
+}
+
+//--------------------------------------------------------
+// groupsFind()
+// Returns the group with a key, adding it if it's new, or
+// NULL if unable to allocate memory.
+//--------------------------------------------------------
+static cliGroup_t *groupsFind( cliGroups_t *pGroups, const char *pKey, int keyLength )
+{
+    int mask = pGroups->slotCount - 1;
+    int slot = (int) (hashKey( pKey, keyLength ) & (uint64_t) mask);
+
+    while( pGroups->pSlots[ slot ] >= 0 )
+    {
+        cliGroup_t *pGroup = &(pGroups->pGroups[ pGroups->pSlots[ slot ] ]);
+        if( (pGroup->keyLength == keyLength) &&
+            (0 == memcmp( &(pGroups->pKeys[ pGroup->keyOffset ]), pKey, keyLength )) )
+        {
+            return pGroup;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    if( pGroups->groupCount == pGroups->groupCapacity )
+    {
+        if( 0 != groupsGrow( pGroups ) )
+        {
+            return NULL;
+        }
+        return groupsFind( pGroups, pKey, keyLength );
+    }
+    while( pGroups->keysUsed + keyLength > pGroups->keysSize )
+    {
+        char *pKeys = (char *) realloc( pGroups->pKeys, 2 * pGroups->keysSize );
+        if( NULL == pKeys )
+        {
+            return NULL;
+        }
+        pGroups->pKeys = pKeys;
+        pGroups->keysSize *= 2;
+    }
+
+    cliGroup_t *pGroup = &(pGroups->pGroups[ pGroups->groupCount ]);
+    if( 0 != polyfit_accum_init( &(pGroup->accum), pGroups->coefficientCount ) )
+    {
+        return NULL;
+    }
+    memcpy( &(pGroups->pKeys[ pGroups->keysUsed ]), pKey, keyLength );
+    pGroup->keyOffset = pGroups->keysUsed;
+    pGroup->keyLength = keyLength;
+    pGroups->keysUsed += keyLength;
+    pGroups->pSlots[ slot ] = pGroups->groupCount;
+    pGroups->groupCount += 1;
+    return pGroup;
+}
+
+//--------------------------------------------------------
+// groupsGrow()
+// Doubles the capacity of a group table, and rebuilds its
+// hash slots.
+// Returns 0 if success, -3 if unable to allocate memory.
+//--------------------------------------------------------
+static int groupsGrow( cliGroups_t *pGroups )
+{
+    int capacity = 2 * pGroups->groupCapacity;
+    int slotCount = 2 * capacity;
+    cliGroup_t *pGrown = (cliGroup_t *) realloc( pGroups->pGroups, capacity * sizeof( cliGroup_t ));
+    if( NULL == pGrown )
+    {
+        return -3;
+    }
+    pGroups->pGroups = pGrown;
+    int *pSlots = (int *) malloc( slotCount * sizeof( int ));
+    if( NULL == pSlots )
+    {
+        return -3;
+    }
+
+    for( int s = 0; s < slotCount; s++ )
+    {
+        pSlots[s] = -1;
+    }
+    for( int g = 0; g < pGroups->groupCount; g++ )
+    {
+        cliGroup_t *pGroup = &(pGroups->pGroups[g]);
+        int slot = (int) (hashKey( &(pGroups->pKeys[ pGroup->keyOffset ]), pGroup->keyLength ) &
+                          (uint64_t) (slotCount - 1));
+        while( pSlots[ slot ] >= 0 )
+        {
+            slot = (slot + 1) & (slotCount - 1);
+        }
+        pSlots[ slot ] = g;
+    }
+
+    free( pGroups->pSlots );
+    pGroups->pSlots = pSlots;
+    pGroups->slotCount = slotCount;
+    pGroups->groupCapacity = capacity;
+    return 0;
+}
+
+//--------------------------------------------------------
+// hashKey()
+// Returns the 64 bit FNV-1a hash of a key's bytes.
+//--------------------------------------------------------
+static uint64_t hashKey( const char *pKey, int keyLength )
+{
+    uint64_t hash = 14695981039346656037ull;
+
+    for( int i = 0; i < keyLength; i++ )
+    {
+        hash = (hash ^ (unsigned char) pKey[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+//--------------------------------------------------------
+// fitBinary()
+// Adds the points of binary column files to the groups,
+// one mapped chunk at a time. float64 chunks are fitted
+// in place; float32 chunks are widened into a buffer.
+// Returns 0 if success, 1 if the input can't be used.
+//--------------------------------------------------------
+static int fitBinary( cliOptions_t *pOptions, cliGroups_t *pGroups )
+{
+    int rVal = 0;
+    bool isFloat = (CLI_INPUT_F32 == pOptions->input);
+    size_t valueSize = isFloat ? sizeof( float ) : sizeof( double );
+    long long pointCount = 0;
+    long long yCount = 0;
+    long long groupCount = 0;
+    int xFd = openColumn( pOptions->pXPath, valueSize, &pointCount );
+    int yFd = openColumn( pOptions->pYPath, valueSize, &yCount );
+    int groupFd = (NULL == pOptions->pGroupPath) ? -1 : openColumn( pOptions->pGroupPath, valueSize, &groupCount );
+    int chunkPoints = pOptions->chunkPoints;
+    double *pBuffer = isFloat ? (double *) malloc( 2 * (size_t) chunkPoints * sizeof( double )) : NULL;
+
+    if( (xFd < 0) || (yFd < 0) || ((NULL != pOptions->pGroupPath) && (groupFd < 0)) || (isFloat && (NULL == pBuffer)) )
+    {
+        rVal = 1;
+    }
+    else if( (yCount != pointCount) || ((groupFd >= 0) && (groupCount != pointCount)) )
+    {
+        fprintf( stderr, "polyfit: the column files hold different numbers of values\n" );
+        rVal = 1;
+    }
+
+    for( long long first = 0; (0 == rVal) && (first < pointCount); first += chunkPoints )
+    {
+        int count = (pointCount - first < chunkPoints) ? (int) (pointCount - first) : chunkPoints;
+        cliWindow_t xWindow = { NULL, 0, NULL };
+        cliWindow_t yWindow = { NULL, 0, NULL };
+        cliWindow_t groupWindow = { NULL, 0, NULL };
+
+        if( (0 != mapWindow( xFd, valueSize, first, count, &xWindow )) ||
+            (0 != mapWindow( yFd, valueSize, first, count, &yWindow )) ||
+            ((groupFd >= 0) && (0 != mapWindow( groupFd, valueSize, first, count, &groupWindow ))) )
+        {
+            fprintf( stderr, "polyfit: unable to map the column files: %s\n", strerror( errno ));
+            rVal = 1;
+        }
+        else
+        {
+            double *xValues = (double *) xWindow.pData;
+            double *yValues = (double *) yWindow.pData;
+            if( isFloat )
+            {
+                const float *xFloats = (const float *) xWindow.pData;
+                const float *yFloats = (const float *) yWindow.pData;
+                xValues = pBuffer;
+                yValues = &(pBuffer[ chunkPoints ]);
+                for( int i = 0; i < count; i++ )
+                {
+                    xValues[i] = xFloats[i];
+                    yValues[i] = yFloats[i];
+                }
+            }
+
+            if( groupFd < 0 )
+            {
+                rVal = addRun( &(pGroups->pGroups[0]), count, xValues, yValues, pOptions->threadCount );
+            }
+
+            // Add each run of equal keys to its group in one call.
+            for( int runStart = 0; (groupFd >= 0) && (0 == rVal) && (runStart < count); )
+            {
+                const char *pKey = &(groupWindow.pData[ runStart * valueSize ]);
+                int runEnd = runStart + 1;
+                while( (runEnd < count) && (0 == memcmp( &(groupWindow.pData[ runEnd * valueSize ]), pKey, valueSize )) )
+                {
+                    runEnd += 1;
+                }
+                cliGroup_t *pGroup = groupsFind( pGroups, pKey, (int) valueSize );
+                rVal = (NULL == pGroup) ? 1 : addRun( pGroup, runEnd - runStart, &(xValues[ runStart ]),
+                                                      &(yValues[ runStart ]), 1 );
+                runStart = runEnd;
+            }
+        }
+        unmapWindow( &xWindow );
+        unmapWindow( &yWindow );
+        unmapWindow( &groupWindow );
+    }
+
+    free( pBuffer );
+    if( xFd >= 0 )
+    {
+        close( xFd );
+    }
+    if( yFd >= 0 )
+    {
+        close( yFd );
+    }
+    if( groupFd >= 0 )
+    {
+        close( groupFd );
+    }
+    return rVal;
+}
+
+//--------------------------------------------------------
+// openColumn()
+// Opens a binary column file, and counts its values.
+// Returns the file descriptor, or -1 if it can't be used.
+//--------------------------------------------------------
+static int openColumn( const char *pPath, size_t valueSize, long long *pValueCount )
+{
+    struct stat status;
+
+    int fd = open( pPath, O_RDONLY );
+    if( fd < 0 )
+    {
+        fprintf( stderr, "polyfit: can't open %s: %s\n", pPath, strerror( errno ));
+        return -1;
+    }
+    if( (0 != fstat( fd, &status )) || (0 != (status.st_size % valueSize)) )
+    {
+        fprintf( stderr, "polyfit: %s is not a whole number of %zu byte values\n", pPath, valueSize );
+        close( fd );
+        return -1;
+    }
+    *pValueCount = (long long) (status.st_size / valueSize);
+    return fd;
+}
+
+//--------------------------------------------------------
+// mapWindow()
+// Maps count values of a column file, from value first,
+// read only. The mapping starts on a page boundary, and
+// the kernel is told it will be read in order.
+// Returns 0 if success, -1 if the mapping failed.
+//--------------------------------------------------------
+static int mapWindow( int fd, size_t valueSize, long long first, int count, cliWindow_t *pWindow )
+{
+    long pageSize = sysconf( _SC_PAGESIZE );
+    off_t offset = (off_t) (first * (long long) valueSize);
+    size_t lead = (size_t) (offset % pageSize);
+
+    pWindow->mapLength = lead + ((size_t) count * valueSize);
+    pWindow->pMap = mmap( NULL, pWindow->mapLength, PROT_READ, MAP_PRIVATE, fd, offset - (off_t) lead );
+    if( MAP_FAILED == pWindow->pMap )
+    {
+        pWindow->pMap = NULL;
+        return -1;
+    }
+    posix_madvise( pWindow->pMap, pWindow->mapLength, POSIX_MADV_SEQUENTIAL );
+    pWindow->pData = (const char *) pWindow->pMap + lead;
+    return 0;
+}
+
+//--------------------------------------------------------
+// unmapWindow()
+// Unmaps a window, if it was mapped.
+//--------------------------------------------------------
+static void unmapWindow( cliWindow_t *pWindow )
+{
+    if( NULL != pWindow->pMap )
+    {
+        munmap( pWindow->pMap, pWindow->mapLength );
+        pWindow->pMap = NULL;
+    }
+}
+
+//--------------------------------------------------------
+// fitCsv()
+// Adds the points of CSV input to the groups. The input
+// is read into a fixed buffer, and each complete line is
+// parsed where it lies. Points are gathered into chunks,
+// and each chunk, or run of points with one key, is added
+// to its group's accumulator in one call.
+// Returns 0 if success, 1 if the input can't be used.
+//--------------------------------------------------------
+static int fitCsv( cliOptions_t *pOptions, cliGroups_t *pGroups )
+{
+    int rVal = 0;
+    FILE *pFile = (NULL == pOptions->pCsvPath) ? stdin : fopen( pOptions->pCsvPath, "rb" );
+    char *pBuffer = (char *) malloc( CSV_BUFFER_SIZE );
+    double *xValues = (double *) malloc( 2 * (size_t) pOptions->chunkPoints * sizeof( double ));
+    double *yValues = &(xValues[ pOptions->chunkPoints ]);
+    int lastColumn = (pOptions->xColumn > pOptions->yColumn) ? pOptions->xColumn : pOptions->yColumn;
+    bool grouped = (pOptions->groupColumn >= 0);
+    cliGroup_t *pRunGroup = grouped ? NULL : &(pGroups->pGroups[0]);
+    int runLength = 0;
+    long long lineNumber = 0;
+    long long skippedLines = 0;
+    size_t held = 0;                // Bytes of the buffer not yet parsed.
+    bool atEnd = false;
+
+    lastColumn = (pOptions->groupColumn > lastColumn) ? pOptions->groupColumn : lastColumn;
+    if( NULL == pFile )
+    {
+        fprintf( stderr, "polyfit: can't open %s: %s\n", pOptions->pCsvPath, strerror( errno ));
+        rVal = 1;
+    }
+    else if( (NULL == pBuffer) || (NULL == xValues) )
+    {
+        fprintf( stderr, "polyfit: out of memory\n" );
+        rVal = 1;
+    }
+
+    while( (0 == rVal) && !atEnd )
+    {
+        size_t got = fread( &(pBuffer[ held ]), 1, CSV_BUFFER_SIZE - held, pFile );
+        atEnd = (0 == got);
+        held += got;
+        if( atEnd && (held > 0) && (held < CSV_BUFFER_SIZE) && ('\n' != pBuffer[ held - 1 ]) )
+        {
+            pBuffer[ held++ ] = '\n';   // Finish a last line with no newline.
+        }
+
+        char *pLine = pBuffer;
+        char *pHeldEnd = &(pBuffer[ held ]);
+        char *pLineEnd = NULL;
+        while( (0 == rVal) && (NULL != (pLineEnd = memchr( pLine, '\n', pHeldEnd - pLine ))) )
+        {
+            const char *pFields[3] = { NULL, NULL, NULL };  // x, y and key.
+            const char *pFieldEnds[3] = { NULL, NULL, NULL };
+            const char *pField = pLine;
+            lineNumber += 1;
+
+            for( int column = 0; column <= lastColumn; column++ )
+            {
+                const char *pFieldEnd = memchr( pField, pOptions->delimiter, pLineEnd - pField );
+                bool isLast = (NULL == pFieldEnd);
+                pFieldEnd = isLast ? pLineEnd : pFieldEnd;
+                for( int f = 0; f < 3; f++ )
+                {
+                    int wanted = (0 == f) ? pOptions->xColumn : ((1 == f) ? pOptions->yColumn : pOptions->groupColumn);
+                    if( column == wanted )
+                    {
+                        pFields[f] = pField;
+                        pFieldEnds[f] = pFieldEnd;
+                    }
+                }
+                if( isLast )
+                {
+                    break;
+                }
+                pField = pFieldEnd + 1;
+            }
+            if( (NULL != pFieldEnds[2]) && (pFieldEnds[2] > pFields[2]) && ('\r' == pFieldEnds[2][-1]) )
+            {
+                pFieldEnds[2] -= 1;
+            }
+
+            double x = 0.0;
+            double y = 0.0;
+            if( (1 == lineNumber) && pOptions->header )
+            {
+                // Column names.
+            }
+            else if( (NULL == pFields[0]) || (NULL == pFields[1]) || (grouped && (NULL == pFields[2])) ||
+                     !parseNumber( pFields[0], pFieldEnds[0], &x ) || !parseNumber( pFields[1], pFieldEnds[1], &y ) )
+            {
+                skippedLines += 1;
+            }
+            else
+            {
+                cliGroup_t *pGroup = pRunGroup;
+                if( grouped )
+                {
+                    pGroup = groupsFind( pGroups, pFields[2], (int) (pFieldEnds[2] - pFields[2]) );
+                    rVal = (NULL == pGroup) ? 1 : 0;
+                }
+                if( (0 == rVal) && ((pGroup != pRunGroup) || (runLength == pOptions->chunkPoints)) )
+                {
+                    if( runLength > 0 )
+                    {
+                        rVal = addRun( pRunGroup, runLength, xValues, yValues, 1 );
+                    }
+                    pRunGroup = pGroup;
+                    runLength = 0;
+                }
+                xValues[ runLength ] = x;
+                yValues[ runLength ] = y;
+                runLength += 1;
+            }
+            pLine = pLineEnd + 1;
+        }
+
+        // Keep the unfinished last line for the next read.
+        held = pHeldEnd - pLine;
+        memmove( pBuffer, pLine, held );
+        if( (0 == rVal) && (CSV_BUFFER_SIZE == held) )
+        {
+            fprintf( stderr, "polyfit: line %lld is longer than %d bytes\n", lineNumber + 1, CSV_BUFFER_SIZE );
+            rVal = 1;
+        }
+    }
+    if( (0 == rVal) && (runLength > 0) )
+    {
+        rVal = addRun( pRunGroup, runLength, xValues, yValues, 1 );
+    }
+    if( (0 == rVal) && (NULL != pFile) && ferror( pFile ) )
+    {
+        fprintf( stderr, "polyfit: error reading the input\n" );
+        rVal = 1;
+    }
+    if( skippedLines > 0 )
+    {
+        fprintf( stderr, "polyfit: skipped %lld lines without numbers in the x and y columns\n", skippedLines );
+    }
+
+    if( (NULL != pFile) && (stdin != pFile) )
+    {
+        fclose( pFile );
+    }
+    free( pBuffer );
+    free( xValues );
+    return rVal;
+}
+
+//--------------------------------------------------------
+// addRun()
+// Adds points to a group's accumulator, across
+// threadCount threads if that's more than 1.
+// Returns 0 if success, 1 if the accumulator failed.
+//--------------------------------------------------------
+static int addRun( cliGroup_t *pGroup, int pointCount, double *xValues, double *yValues, int threadCount )
+{
+    int rVal = (1 == threadCount) ? polyfit_accum_add_many( &(pGroup->accum), pointCount, xValues, yValues )
+                                  : polyfit_accum_add_many_parallel( &(pGroup->accum), pointCount, xValues, yValues,
+                                                                     threadCount );
+    if( 0 != rVal )
+    {
+        fprintf( stderr, "polyfit: unable to add points, error = %d\n", rVal );
+        return 1;
+    }
+    return 0;
+}
+
+//--------------------------------------------------------
+// parseNumber()
+// Parses the decimal number between pField and pEnd,
+// allowing spaces around it. Most numbers, of up to 19
+// significant digits with a power of ten up to 22, are
+// converted exactly by one multiplication or division of
+// two exactly held doubles, as in Clinger's fast path.
+// The rest, and forms such as inf and hex, go to strtod().
+// Returns true if the whole field is one number.
+//--------------------------------------------------------
+static bool parseNumber( const char *pField, const char *pEnd, double *pValue )
+{
+    static const double powersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                          1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    char text[ NUMBER_MAX_LENGTH ];
+
+    while( (pField < pEnd) && ((' ' == *pField) || ('\t' == *pField)) )
+    {
+        pField++;
+    }
+    while( (pEnd > pField) && ((' ' == pEnd[-1]) || ('\t' == pEnd[-1]) || ('\r' == pEnd[-1])) )
+    {
+        pEnd--;
+    }
+
+    const char *p = pField;
+    bool negative = (p < pEnd) && ('-' == *p);
+    p += ((p < pEnd) && (('-' == *p) || ('+' == *p))) ? 1 : 0;
+
+    uint64_t mantissa = 0;
+    int digitCount = 0;             // Significant digits in mantissa.
+    int exponent = 0;
+    bool anyDigits = false;
+    for( ; (p < pEnd) && (*p >= '0') && (*p <= '9'); p++ )
+    {
+        anyDigits = true;
+        if( (0 == mantissa) && ('0' == *p) )
+        {
+            continue;
+        }
+        if( digitCount < 19 )
+        {
+            mantissa = (mantissa * 10) + (uint64_t) (*p - '0');
+            digitCount += 1;
+        }
+        else
+        {
+            exponent += 1;
+            digitCount = 20;        // Too long for the fast path.
+        }
+    }
+    if( (p < pEnd) && ('.' == *p) )
+    {
+        for( p++; (p < pEnd) && (*p >= '0') && (*p <= '9'); p++ )
+        {
+            anyDigits = true;
+            if( (0 == mantissa) && ('0' == *p) )
+            {
+                exponent -= 1;
+                continue;
+            }
+            if( digitCount < 19 )
+            {
+                mantissa = (mantissa * 10) + (uint64_t) (*p - '0');
+                digitCount += 1;
+                exponent -= 1;
+            }
+            else
+            {
+                digitCount = 20;
+            }
+        }
+    }
+    if( anyDigits && (p < pEnd) && (('e' == *p) || ('E' == *p)) )
+    {
+        const char *pExponent = p + 1;
+        bool negativeExponent = (pExponent < pEnd) && ('-' == *pExponent);
+        pExponent += ((pExponent < pEnd) && (('-' == *pExponent) || ('+' == *pExponent))) ? 1 : 0;
+        int value = 0;
+        bool anyExponentDigits = false;
+        for( ; (pExponent < pEnd) && (*pExponent >= '0') && (*pExponent <= '9'); pExponent++ )
+        {
+            anyExponentDigits = true;
+            value = (value < 10000) ? ((value * 10) + (*pExponent - '0')) : value;
+        }
+        if( anyExponentDigits )
+        {
+            exponent += negativeExponent ? -value : value;
+            p = pExponent;
+        }
+    }
+
+    if( anyDigits && (p == pEnd) && (digitCount <= 19) && (mantissa < (1ull << 53)) &&
+        (exponent >= -22) && (exponent <= 22) )
+    {
+        double value = (double) mantissa;
+        value = (exponent < 0) ? (value / powersOfTen[ -exponent ]) : (value * powersOfTen[ exponent ]);
+        *pValue = negative ? -value : value;
+        return true;
+    }
+
+    // Everything else, including a field that isn't a number, is left to strtod().
+    size_t length = (size_t) (pEnd - pField);
+    if( (0 == length) || (length >= NUMBER_MAX_LENGTH) )
+    {
+        return false;
+    }
+    memcpy( text, pField, length );
+    text[ length ] = '\0';
+    char *pParsedEnd = NULL;
+    *pValue = strtod( text, &pParsedEnd );
+    return (&(text[ length ]) == pParsedEnd);
+}
+
+//--------------------------------------------------------
+// writeFits()
+// Solves each group's fit and writes its coefficients to
+// stdout, as text, JSON or binary.
+// Returns 0 if every fit succeeded, 1 if the output
+// failed, 2 if any fit failed.
+//--------------------------------------------------------
+static int writeFits( cliOptions_t *pOptions, cliGroups_t *pGroups )
+{
+    int rVal = 0;
+    int coefficientCount = pOptions->coefficientCount;
+    size_t textSize = (64 * (size_t) coefficientCount) + 64;
+    double *results = (double *) malloc( coefficientCount * sizeof( double ));
+    char *pText = (char *) malloc( textSize );
+
+    if( (NULL == results) || (NULL == pText) )
+    {
+        fprintf( stderr, "polyfit: out of memory\n" );
+        free( results );
+        free( pText );
+        return 1;
+    }
+
+    for( int g = 0; g < pGroups->groupCount; g++ )
+    {
+        cliGroup_t *pGroup = &(pGroups->pGroups[g]);
+        int status = polyfit_accum_solve( &(pGroup->accum), results );
+        if( 0 != status )
+        {
+            rVal = 2;
+        }
+
+        if( pOptions->binaryOutput )
+        {
+            for( int c = 0; (0 != status) && (c < coefficientCount); c++ )
+            {
+                results[c] = NAN;
+            }
+            fwrite( results, sizeof( double ), coefficientCount, stdout );
+            continue;
+        }
+
+        const char *pKey = &(pGroups->pKeys[ pGroup->keyOffset ]);
+        if( pGroups->numericKeys && (sizeof( double ) == pGroup->keyLength) )
+        {
+            double key;
+            memcpy( &key, pKey, sizeof( key ));
+            printf( "%.17g\t", key );
+        }
+        else if( pGroups->numericKeys && (sizeof( float ) == pGroup->keyLength) )
+        {
+            float key;
+            memcpy( &key, pKey, sizeof( key ));
+            printf( "%.9g\t", key );
+        }
+        else if( pGroup->keyLength > 0 )
+        {
+            printf( "%.*s\t", pGroup->keyLength, pKey );
+        }
+
+        if( (0 == status) && pOptions->jsonOutput )
+        {
+            size_t length = 0;
+            polyfit_encode_json( pText, textSize, coefficientCount, results, &length );
+            printf( "%s\n", pText );
+        }
+        else if( 0 == status )
+        {
+            polyToString( pText, textSize, coefficientCount, results );
+            printf( "%s\n", pText );
+        }
+        else
+        {
+            printf( "error = %d\n", status );
+        }
+    }
+
+    if( 0 != fflush( stdout ) )
+    {
+        fprintf( stderr, "polyfit: error writing the output\n" );
+        rVal = 1;
+    }
+    free( results );
+    free( pText );
+    return rVal;
+}
@@ -26,13 +26,14 @@
 // SOFTWARE.
 //------------------------------------------------------------------------------------
 
-#include <math.h>       // pow()
+#include <float.h>      // DBL_EPSILON
+#include <math.h>       // sqrt()
 #include <stdbool.h>    // bool
 #include <stdio.h>      // printf()
 #include <stdlib.h>     // calloc()
-#include <string.h>     // strlen()
+#include <string.h>     // memset()
 
-#include "polyfit.h"
+#include "polyfit_internal.h"
 
 // Define SHOW_MATRIX to display intermediate matrix values:
 // #define SHOW_MATRIX 1
@@ -46,7 +47,7 @@ typedef struct matrix_s
 } matrix_t;
 
 // MACRO to access a value with a matrix.
-#define MATRIX_VALUE_PTR( pA, row, col )  (&(((pA)->pContents)[ (row * (pA)->cols) + col]))
+#define MATRIX_VALUE_PTR( pA, row, col )  (&(((pA)->pContents)[ ((row) * (pA)->cols) + (col)]))
 
 #ifdef SHOW_MATRIX
 #define showMatrix( x ) do {\
@@ -58,18 +59,37 @@ typedef struct matrix_s
 #define showMatrix( x )
 #endif   // SHOW_MATRIX
 
+// The heap functions used for all of the library's memory; see polyfit_set_allocator().
+static void *(*pAllocatorCalloc)( size_t count, size_t size ) = calloc;
+static void (*pAllocatorFree)( void *pMemory ) = free;
+
 
 //------------------------------------------------
 // Private Function Prototypes
 //------------------------------------------------
 
-static matrix_t *   createMatrix( int rows, int cols );
-static void         destroyMatrix( matrix_t *pMat );
+static void         attachAccumulator( polyfit_accum_t *pAccum, int coefficientCount, double *pSums );
+static int          fitInAllocation( int pointCount, double *xValues, double *yValues, int coefficientCount,
+                                     double *coefficientResults, polyfit_solver_t solver,
+                                     polyfit_solver_t *pSolverUsed, polyfitCall_t *pCall );
+static int          fitAllocated( int pointCount, double *xValues, double *yValues, int coefficientCount,
+                                  double *coefficientResults, polyfit_solver_t solver,
+                                  polyfit_solver_t *pSolverUsed, polyfitCall_t *pCall );
+static int          fitWorkspace( polyfit_workspace_t *pWorkspace, int pointCount, double *xValues,
+                                  double *yValues, int coefficientCount, double *coefficientResults,
+                                  polyfitCall_t *pCall );
 #ifdef SHOW_MATRIX
 static void         reallyShowMatrix( matrix_t *pMat );
 #endif  // SHOW_MATRIX
-static matrix_t *   createTranspose( matrix_t *pMat );
-static matrix_t *   createProduct( matrix_t *pLeft, matrix_t *pRight );
+static void         loadNormalEquations( int coefficientCount, double *pPowerSums, double *pRhsSums,
+                                         matrix_t *pMatATA, matrix_t *pMatATB );
+static int          solveFromSums( int coefficientCount, double *pPowerSums, double *pRhsSums,
+                                   matrix_t *pMatATA, matrix_t *pMatATB, double *coefficientResults );
+static int          solveGaussJordan( matrix_t *pMatATA, matrix_t *pMatATB );
+static int          solveCholesky( int coefficientCount, double *pPowerSums, double *pRhsSums, double *pScratch,
+                                   double *coefficientResults );
+static int          solveQR( int pointCount, double *xValues, double *yValues, int coefficientCount,
+                             double *pScratch, double *coefficientResults );
 
 
 //=========================================================
@@ -95,163 +115,540 @@ static matrix_t *   createProduct( matrix_t *pLeft, matrix_t *pRight );
 // then the i'th row of A is: {(xi)^0, (xi)^1, ... (xn)^n},
 // and the i'th row of b is: {yi}.
 //
-// Returns   0 if success, 
+// A itself is never built: the points are streamed
+// through a polyfit_accum_t, which keeps only the power
+// sums that make up (AT)A and (AT)b. The accumulator and
+// the solver's matrices share a single allocation; see
+// polyfit_ws() for a version that makes none. Lines,
+// quadratics and cubics go to the fixed degree fits in
+// polyfixed.c instead, which need no allocation.
+//
+// The normal equations square the condition number of A,
+// so for points far from the origin against their spread
+// the Cholesky factorization can refuse a pivot. The fit
+// is then made again by QR, which factors A itself, in an
+// allocation sized for it.
+//
+// Returns   0 if success,
 //          -1 if passed a NULL pointer,
 //          -2 if (pointCount < coefficientCount),
 //          -3 if unable to allocate memory,
-//          -4 if unable to solve equations.
+//          -4 if unable to solve equations,
+//          -5 if coefficientCount < 1.
 //--------------------------------------------------------
 //int polyfit( int pointCount, point_t pointArray[],  int coeffCount, double coeffArray[] )
 int polyfit( int pointCount, double *xValues, double *yValues, int coefficientCount, double *coefficientResults )
 {
-    int rVal = 0;
-    int degree = coefficientCount - 1;
+    return polyfit_with_solver( pointCount, xValues, yValues, coefficientCount, coefficientResults,
+                                POLYFIT_SOLVER_DEFAULT, NULL );
+}
 
-    // Check that the input pointers aren't null.
-    if( (NULL == xValues) || (NULL == yValues) || (NULL == coefficientResults) )
+//--------------------------------------------------------
+// polyfit_workspace_size()
+// Returns the number of bytes of working storage that
+// polyfit_ws() needs for fits of up to maxPoints points
+// and maxCoefficients coefficients with the default
+// solver, or 0 if either count is out of range.
+//--------------------------------------------------------
+size_t polyfit_workspace_size( int maxPoints, int maxCoefficients )
+{
+    return polyfit_workspace_size_for_solver( POLYFIT_SOLVER_DEFAULT, maxPoints, maxCoefficients );
+}
+
+//--------------------------------------------------------
+// polyfit_workspace_size_for_solver()
+// Returns the number of bytes of working storage that
+// polyfit_ws() needs for fits with the given solver, or
+// 0 if a count or the solver is out of range.
+//
+// The solvers that work on the normal equations need
+// nothing per point. The QR solver factors A itself, so
+// it also needs room for A and a copy of b.
+//--------------------------------------------------------
+size_t polyfit_workspace_size_for_solver( polyfit_solver_t solver, int maxPoints, int maxCoefficients )
+{
+    if( (maxPoints < 0) || (maxCoefficients < 1) ||
+        (solver < POLYFIT_SOLVER_DEFAULT) || (solver > POLYFIT_SOLVER_GAUSS_JORDAN) )
+    {
+        return 0;
+    }
+
+    // The accumulator's sums, followed by (AT)A and (AT)b.
+    size_t doubleCount = (size_t) ((3 * maxCoefficients) - 1) +
+                         ((size_t) maxCoefficients * (maxCoefficients + 1));
+    if( POLYFIT_SOLVER_QR == solver )
+    {
+        doubleCount += (size_t) maxPoints * (maxCoefficients + 1);
+    }
+    return doubleCount * sizeof( double );
+}
+
+//--------------------------------------------------------
+// polyfit_workspace_init()
+// Prepares a workspace in caller-owned memory of
+// memorySize bytes, which must be aligned for doubles and
+// at least polyfit_workspace_size( maxPoints,
+// maxCoefficients ) bytes long. The workspace keeps no
+// other resources, so it needs no cleanup beyond whatever
+// the caller does with the memory.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -5 if a count is out of range, or the memory
+//             is too small or misaligned.
+//--------------------------------------------------------
+int polyfit_workspace_init( polyfit_workspace_t *pWorkspace, void *pMemory, size_t memorySize,
+                            int maxPoints, int maxCoefficients )
+{
+    if( (NULL == pWorkspace) || (NULL == pMemory) )
     {
         return -1;
     }
-    // Check that pointCount >= coefficientCount.
-    if(pointCount < coefficientCount)
+
+    size_t neededSize = polyfit_workspace_size( maxPoints, maxCoefficients );
+    if( (0 == neededSize) || (memorySize < neededSize) || (0 != ((size_t) pMemory % sizeof( double ))) )
     {
-        return -2;
+        return -5;
     }
 
-    // printf( "pointCount = %d:", pointCount );
+    pWorkspace->maxPoints = maxPoints;
+    pWorkspace->maxCoefficients = maxCoefficients;
+    pWorkspace->size = memorySize;
+    pWorkspace->pMemory = (double *) pMemory;
+    pWorkspace->solver = POLYFIT_SOLVER_DEFAULT;
+    pWorkspace->solverUsed = POLYFIT_SOLVER_DEFAULT;
+    return 0;
+}
 
-    // for( i = 0; i < pointCount; i++ )
-    // {
-    //     printf( " ( %f, %f )", xValues[i], yValues[i] );
-    // }
-    // printf( "\n");
+//--------------------------------------------------------
+// polyfit_ws()
+// Same as polyfit(), but keeps all of its working storage
+// in a workspace, so it makes no heap calls at all.
+// Suitable for real-time loops: size the workspace once,
+// then fit any number of times.
+//
+// The workspace's solver field chooses the solver, and
+// its solverUsed field reports the one that ran. With the
+// default solver, 2 to 4 coefficients are fitted by the
+// fixed degree Cholesky fits, and the workspace is unused.
+// If the default's Cholesky factorization refuses a
+// pivot, and the workspace is as large as
+// polyfit_workspace_size_for_solver() gives for QR, the
+// fit is made again by QR.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < coefficientCount),
+//          -4 if unable to solve equations,
+//          -5 if coefficientCount < 1, or the workspace is
+//             too small for the counts and solver.
+//--------------------------------------------------------
+int polyfit_ws( polyfit_workspace_t *pWorkspace, int pointCount, double *xValues, double *yValues,
+                int coefficientCount, double *coefficientResults )
+{
+    if( !POLYFIT_STATS_ON() )
+    {
+        return fitWorkspace( pWorkspace, pointCount, xValues, yValues, coefficientCount, coefficientResults, NULL );
+    }
 
-    // printf( "coefficientCount = %d\n", coefficientCount );
+    polyfitCall_t call;
+    polyfitStatsBegin( &call, pointCount, coefficientCount );
+    int rVal = fitWorkspace( pWorkspace, pointCount, xValues, yValues, coefficientCount, coefficientResults, &call );
+    polyfitStatsEnd( &call, rVal );
+    return rVal;
+}
 
-    // Make the A matrix:
-    matrix_t *pMatA = createMatrix( pointCount, coefficientCount );
-    if( NULL == pMatA)
+//--------------------------------------------------------
+// polyfit_with_solver()
+// Same as polyfit(), but with a chosen solver. If
+// pSolverUsed isn't NULL, it receives the solver that
+// ran, which tells what POLYFIT_SOLVER_DEFAULT stands for:
+// Cholesky, or QR if Cholesky refused a pivot.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < coefficientCount),
+//          -3 if unable to allocate memory,
+//          -4 if unable to solve equations,
+//          -5 if coefficientCount < 1 or the solver is
+//             out of range.
+//--------------------------------------------------------
+int polyfit_with_solver( int pointCount, double *xValues, double *yValues, int coefficientCount,
+                         double *coefficientResults, polyfit_solver_t solver, polyfit_solver_t *pSolverUsed )
+{
+    if( !POLYFIT_STATS_ON() )
     {
-        return -3;
+        return fitAllocated( pointCount, xValues, yValues, coefficientCount, coefficientResults, solver,
+                             pSolverUsed, NULL );
     }
 
-    for( int r = 0; r < pointCount; r++)
+    polyfitCall_t call;
+    polyfitStatsBegin( &call, pointCount, coefficientCount );
+    int rVal = fitAllocated( pointCount, xValues, yValues, coefficientCount, coefficientResults, solver,
+                             pSolverUsed, &call );
+    polyfitStatsEnd( &call, rVal );
+    return rVal;
+}
+
+//--------------------------------------------------------
+// polyfit_solver_name()
+// Returns a printable name for a solver.
+//--------------------------------------------------------
+const char *polyfit_solver_name( polyfit_solver_t solver )
+{
+    switch( solver )
     {
-        for( int c = 0; c < coefficientCount; c++)
-        {
-            *(MATRIX_VALUE_PTR(pMatA, r, c)) = pow((xValues[r]), (double) (degree -c));
-        }
+        case POLYFIT_SOLVER_DEFAULT:        return "default";
+        case POLYFIT_SOLVER_CHOLESKY:       return "cholesky";
+        case POLYFIT_SOLVER_QR:             return "qr";
+        case POLYFIT_SOLVER_GAUSS_JORDAN:   return "gauss-jordan";
     }
+    return "unknown";
+}
 
-    showMatrix( pMatA );
+//--------------------------------------------------------
+// polyfit_set_allocator()
+// Replaces the calloc() and free() functions that the
+// library uses for all of its heap memory. Passing NULL
+// for either restores the standard library's pair. Call
+// it before any fitting starts, not while fits are
+// running on other threads.
+//--------------------------------------------------------
+void polyfit_set_allocator( void *(*pCalloc)( size_t count, size_t size ), void (*pFree)( void *pMemory ) )
+{
+    if( (NULL == pCalloc) || (NULL == pFree) )
+    {
+        pCalloc = calloc;
+        pFree = free;
+    }
+    pAllocatorCalloc = pCalloc;
+    pAllocatorFree = pFree;
+}
 
-    // Make the b matrix
-    matrix_t *pMatB = createMatrix( pointCount, 1);
-    if( NULL == pMatB )
+//--------------------------------------------------------
+// polyfit_accum_init()
+// Prepares an accumulator of the power sums needed to fit
+// a polynomial with coefficientCount coefficients.
+//
+// The accumulator holds (2 * coefficientCount - 1) sums
+// of x^j and coefficientCount sums of (x^j * y), so its
+// size does not depend on how many points are added.
+// Release it with polyfit_accum_free().
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -3 if unable to allocate memory,
+//          -5 if coefficientCount < 1.
+//--------------------------------------------------------
+int polyfit_accum_init( polyfit_accum_t *pAccum, int coefficientCount )
+{
+    if( NULL == pAccum )
     {
-        return -3;
+        return -1;
     }
 
-    for( int r = 0; r < pointCount; r++)
+    pAccum->coefficientCount = 0;
+    pAccum->pointCount = 0;
+    pAccum->pPowerSums = NULL;
+    pAccum->pRhsSums = NULL;
+    pAccum->ySquareSum = 0.0;
+
+    if( coefficientCount < 1 )
     {
-        *(MATRIX_VALUE_PTR(pMatB, r, 0)) = yValues[r];
+        return -5;
     }
 
-    // Make the transpose of matrix A
-    matrix_t * pMatAT = createTranspose( pMatA );
-    if( NULL == pMatAT )
+    // One block holds both the power sums and the right hand side sums.
+    double *pSums = (double *) polyfitCalloc( (3 * coefficientCount) - 1, sizeof( double ));
+    if( NULL == pSums )
     {
         return -3;
     }
 
-    showMatrix( pMatAT );
+    attachAccumulator( pAccum, coefficientCount, pSums );
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_accum_add()
+// Adds a single point to an accumulator.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer.
+//--------------------------------------------------------
+int polyfit_accum_add( polyfit_accum_t *pAccum, double x, double y )
+{
+    return polyfit_accum_add_many( pAccum, 1, &x, &y );
+}
 
-    // Make the product of matrices AT and A:
-    matrix_t *pMatATA = createProduct( pMatAT, pMatA );
-    if( NULL == pMatATA )
+//--------------------------------------------------------
+// polyfit_accum_add_many()
+// Adds an array of points to an accumulator. It may be
+// called any number of times, so data can be fed in
+// chunks as it arrives.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -5 if pointCount < 0.
+//--------------------------------------------------------
+int polyfit_accum_add_many( polyfit_accum_t *pAccum, int pointCount, double *xValues, double *yValues )
+{
+    if( (NULL == pAccum) || (NULL == pAccum->pPowerSums) || (NULL == xValues) || (NULL == yValues) )
     {
-        return -3;
+        return -1;
     }
+    if( pointCount < 0 )
+    {
+        return -5;
+    }
+
+    polyfitKernelPowerSums( pAccum->coefficientCount, pointCount, xValues, yValues,
+                            pAccum->pPowerSums, pAccum->pRhsSums, &(pAccum->ySquareSum) );
+    pAccum->pointCount += pointCount;
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_accum_solve()
+// Computes the polynomial coefficients that best fit all
+// of the points added to an accumulator so far.
+//
+// The accumulator is left unchanged, so more points may
+// be added and the fit solved again.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < coefficientCount),
+//          -3 if unable to allocate memory,
+//          -4 if unable to solve equations.
+//--------------------------------------------------------
+int polyfit_accum_solve( polyfit_accum_t *pAccum, double *coefficientResults )
+{
+    return polyfit_accum_solve_with( pAccum, POLYFIT_SOLVER_DEFAULT, coefficientResults );
+}
+
+//--------------------------------------------------------
+// polyfit_accum_solve_with()
+// Same as polyfit_accum_solve(), but with a chosen solver.
+// An accumulator keeps only the normal equations, so the
+// QR solver, which needs A itself, can't be used.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < coefficientCount),
+//          -3 if unable to allocate memory,
+//          -4 if unable to solve equations,
+//          -5 if the solver is out of range or is QR.
+//--------------------------------------------------------
+int polyfit_accum_solve_with( polyfit_accum_t *pAccum, polyfit_solver_t solver, double *coefficientResults )
+{
+    int rVal = 0;
 
-     showMatrix( pMatATA );
+    if( (NULL == pAccum) || (NULL == pAccum->pPowerSums) || (NULL == coefficientResults) )
+    {
+        return -1;
+    }
+    if( (solver < POLYFIT_SOLVER_DEFAULT) || (solver > POLYFIT_SOLVER_GAUSS_JORDAN) ||
+        (POLYFIT_SOLVER_QR == solver) )
+    {
+        return -5;
+    }
+    if( pAccum->pointCount < pAccum->coefficientCount )
+    {
+        return -2;
+    }
 
-    // Make the product of matrices AT and b:
-    matrix_t *pMatATB = createProduct( pMatAT, pMatB );
-    if( NULL == pMatATB )
+    int coefficientCount = pAccum->coefficientCount;
+    double *pScratch = (double *) polyfitCalloc( coefficientCount * (coefficientCount + 1), sizeof( double ));
+    if( NULL == pScratch )
     {
         return -3;
     }
 
-    showMatrix( pMatATB );
+    rVal = polyfitSolveSums( solver, coefficientCount, pAccum->pPowerSums, pAccum->pRhsSums, pScratch,
+                             coefficientResults );
 
-    // Now we need to solve the system of linear equations,
-    // (AT)Ax = (AT)b for "x", the coefficients of the polynomial.
+    polyfitFree( pScratch );
+    return rVal;
+}
 
-    for( int c = 0; c < pMatATA->cols; c++ )
+//--------------------------------------------------------
+// polyfit_accum_merge()
+// Adds the points of one accumulator to another, as if
+// they had been added to it directly, by adding up their
+// sums. pFrom is left unchanged.
+//
+// So a large fit can be sharded: each shard accumulates
+// its own points, perhaps in another process, sending its
+// state with polyfit_accum_encode(), and the states are
+// merged in any order, or as a tree, before solving.
+// Addition makes the result the same whatever the order,
+// up to rounding of the sums.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -5 if the coefficient counts differ.
+//--------------------------------------------------------
+int polyfit_accum_merge( polyfit_accum_t *pInto, polyfit_accum_t *pFrom )
+{
+    if( (NULL == pInto) || (NULL == pInto->pPowerSums) || (NULL == pFrom) || (NULL == pFrom->pPowerSums) )
     {
-        int pr = c;     // pr is the pivot row.
-        double prVal = *MATRIX_VALUE_PTR(pMatATA, pr, c);
-        // If it's zero, we can't solve the equations.
-        if( 0.0 == prVal )
+        return -1;
+    }
+    if( pInto->coefficientCount != pFrom->coefficientCount )
+    {
+        return -5;
+    }
+
+    int powerSumCount = (2 * pInto->coefficientCount) - 1;
+    for( int j = 0; j < powerSumCount; j++ )
+    {
+        pInto->pPowerSums[j] += pFrom->pPowerSums[j];
+    }
+    for( int j = 0; j < pInto->coefficientCount; j++ )
+    {
+        pInto->pRhsSums[j] += pFrom->pRhsSums[j];
+    }
+    pInto->ySquareSum += pFrom->ySquareSum;
+    pInto->pointCount += pFrom->pointCount;
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_accum_free()
+// Releases the sums held by an accumulator.
+//--------------------------------------------------------
+void polyfit_accum_free( polyfit_accum_t *pAccum )
+{
+    if( NULL != pAccum )
+    {
+        polyfitFree( pAccum->pPowerSums );
+        pAccum->pPowerSums = NULL;
+        pAccum->pRhsSums = NULL;
+        pAccum->coefficientCount = 0;
+        pAccum->pointCount = 0;
+        pAccum->ySquareSum = 0.0;
+    }
+}
+
+//--------------------------------------------------------
+// polyfit_batch()
+// Fits a polynomial with coefficientCount coefficients to
+// each of seriesCount independent series of points.
+//
+// The series are packed end to end in xValues and yValues.
+// Series s occupies elements seriesOffsets[s] up to, but
+// not including, seriesOffsets[s + 1], so seriesOffsets
+// holds (seriesCount + 1) entries. The coefficients of
+// series s are stored at coefficientResults[s * coefficientCount],
+// and seriesStatus[s] receives the value polyfit() would
+// have returned for it.
+//
+// Fits of 2 to 4 coefficients take the fixed degree
+// fits, with no working storage. Where the CPU has AVX2,
+// series of fewer than 128 points are fitted four at a
+// time, one to each lane, through both the sums and the
+// solve, with the same arithmetic as polyfit() gives each.
+// Other fits allocate a single block of working storage
+// and reuse it for every series. A series that Cholesky
+// refuses is refitted by QR, as polyfit() would.
+//
+// Returns   0 if every series was fitted,
+//          -1 if passed a NULL pointer,
+//          -3 if unable to allocate memory,
+//          -4 if any series could not be fitted (see seriesStatus),
+//          -5 if a count or offset is out of range.
+//--------------------------------------------------------
+int polyfit_batch( int seriesCount, int *seriesOffsets, double *xValues, double *yValues,
+                   int coefficientCount, double *coefficientResults, int *seriesStatus )
+{
+    int rVal = 0;
+
+    if( (NULL == seriesOffsets) || (NULL == xValues) || (NULL == yValues) ||
+        (NULL == coefficientResults) || (NULL == seriesStatus) )
+    {
+        return -1;
+    }
+    if( (seriesCount < 0) || (coefficientCount < 1) || (seriesOffsets[0] < 0) )
+    {
+        return -5;
+    }
+    for( int s = 0; s < seriesCount; s++ )
+    {
+        if( seriesOffsets[s + 1] < seriesOffsets[s] )
         {
-            // printf( "Unable to solve equations, pr = %d, c = %d.\n", pr, c );
-            showMatrix( pMatATA );
-            rVal = -4;
-            break;
+            return -5;
         }
-        for( int r = 0; r < pMatATA->rows; r++)
+    }
+
+    // Fits of 2 to 4 coefficients need no working storage.
+    if( 0 != polyfitFixedBatch( coefficientCount, seriesCount, seriesOffsets, xValues, yValues, coefficientResults,
+                                seriesStatus ))
+    {
+        // Working storage: the sums, followed by (AT)A and (AT)b.
+        int sumCount = (3 * coefficientCount) - 1;
+        int matrixCount = coefficientCount * (coefficientCount + 1);
+        double *pScratch = (double *) polyfitCalloc( sumCount + matrixCount, sizeof( double ));
+        if( NULL == pScratch )
         {
-            if( r != pr )
-            {
-                double targetRowVal = *MATRIX_VALUE_PTR(pMatATA, r, c);
-                double factor = targetRowVal / prVal;
-                for( int c2 = 0; c2 < pMatATA->cols; c2++ )
-                {
-                    *MATRIX_VALUE_PTR(pMatATA, r, c2) -=  *MATRIX_VALUE_PTR(pMatATA, pr, c2) * factor; 
-                    // printf( "c = %d, pr = %d, r = %d, c2=%d, targetRowVal = %f, prVal = %f, factor = %f.\n",
-                    //         c, pr, r, c2, targetRowVal, prVal, factor );
+            return -3;
+        }
 
-                    // showMatrix( pMatATA );
-                   
-                }
-                *MATRIX_VALUE_PTR(pMatATB, r, 0) -=  *MATRIX_VALUE_PTR(pMatATB, pr, 0) * factor;
+        double *pPowerSums = pScratch;
+        double *pRhsSums = &(pScratch[ (2 * coefficientCount) - 1 ]);
 
-                showMatrix( pMatATB );
+        for( int s = 0; s < seriesCount; s++ )
+        {
+            int first = seriesOffsets[s];
+            int pointCount = seriesOffsets[s + 1] - first;
+
+            if( pointCount < coefficientCount )
+            {
+                seriesStatus[s] = -2;
+                continue;
             }
+            memset( pScratch, 0, sumCount * sizeof( double ));
+            polyfitKernelPowerSums( coefficientCount, pointCount, &(xValues[ first ]), &(yValues[ first ]),
+                                    pPowerSums, pRhsSums, NULL );
+            seriesStatus[s] = polyfitSolveSums( POLYFIT_SOLVER_DEFAULT, coefficientCount, pPowerSums, pRhsSums,
+                                                &(pScratch[ sumCount ]),
+                                                &(coefficientResults[ s * coefficientCount ]) );
         }
+        polyfitFree( pScratch );
     }
-    for( int c = 0; c < pMatATA->cols; c++ )
-    {
-        int pr = c;
-        // now, pr is the pivot row.
-        double prVal = *MATRIX_VALUE_PTR(pMatATA, pr, c);
-        *MATRIX_VALUE_PTR(pMatATA, pr, c) /= prVal;
-        *MATRIX_VALUE_PTR(pMatATB, pr, 0) /= prVal;
-    }
-
-    showMatrix( pMatATA );
 
-    showMatrix( pMatATB );
-
-    for( int i = 0; i < coefficientCount; i++)
+    for( int s = 0; s < seriesCount; s++ )
     {
-        coefficientResults[i] = *MATRIX_VALUE_PTR(pMatATB, i, 0);
+        // As polyfit() does, fall back on QR where Cholesky refused a pivot.
+        if( -4 == seriesStatus[s] )
+        {
+            int first = seriesOffsets[s];
+            seriesStatus[s] = polyfit_with_solver( seriesOffsets[s + 1] - first, &(xValues[ first ]),
+                                                   &(yValues[ first ]), coefficientCount,
+                                                   &(coefficientResults[ s * coefficientCount ]),
+                                                   POLYFIT_SOLVER_QR, NULL );
+        }
+        if( 0 != seriesStatus[s] )
+        {
+            rVal = -4;
+        }
     }
 
-    
-    destroyMatrix( pMatATB );
-    destroyMatrix( pMatATA );
-    destroyMatrix( pMatAT );
-
-    destroyMatrix( pMatA );
-    destroyMatrix( pMatB );
     return rVal;
 }
 
 //--------------------------------------------------------
 // polyToString()
 // Produces a string representation of a polynomial from
-// its coefficients.
+// its coefficients. Terms with a zero coefficient are
+// left out. If the buffer is too small, the string is cut
+// short, as snprintf() would cut it.
+//
+// The write position is carried from term to term, so
+// the cost grows linearly with the number of terms. For
+// exact or compact output, see polyfit_encode_json() and
+// polyfit_encode_binary().
+//
 // Returns 0 on success.
 //--------------------------------------------------------
 int polyToString( char *stringBuffer, size_t stringBufferSz, int coeffCount, double *coefficients )
@@ -267,6 +664,7 @@ int polyToString( char *stringBuffer, size_t stringBufferSz, int coeffCount, dou
     }
 
     stringBuffer[0] = 0;
+    size_t stringIndex = 0;                 // Index of where to write the next term.
 
     for( int i = 0; i < coeffCount; i++)
     {
@@ -274,28 +672,199 @@ int polyToString( char *stringBuffer, size_t stringBufferSz, int coeffCount, dou
         bool isTermPrintable = (coefficients[i] != 0.0);
         if( isTermPrintable )
         {
-            int stringIndex = strlen( stringBuffer );           // Index of where to write the next term.
-            char *pNext = &(stringBuffer[ stringIndex ]);       // Pointer to where to write the next term.
-            int remainingSize = stringBufferSz - stringIndex;   // Space left in buffer.
- 
+            char *pNext = &(stringBuffer[ stringIndex ]);           // Pointer to where to write the next term.
+            size_t remainingSize = stringBufferSz - stringIndex;    // Space left in buffer.
+            int termLength = 0;
+
             if( 0 == exponent )
             {
-                snprintf( pNext, remainingSize, "%s%f", isThisTheFirstTermShown ? "" : " + ", coefficients[ i ] );
+                termLength = snprintf( pNext, remainingSize, "%s%f", isThisTheFirstTermShown ? "" : " + ", coefficients[ i ] );
             }
             else if( 1 == exponent)
             {
-                snprintf( pNext, remainingSize, "%s(%f * x)", isThisTheFirstTermShown ? "" : " + ", coefficients[ i ] );
+                termLength = snprintf( pNext, remainingSize, "%s(%f * x)", isThisTheFirstTermShown ? "" : " + ", coefficients[ i ] );
             }
             else
             {
-                snprintf( pNext, remainingSize, "%s(%f * x^%d)", isThisTheFirstTermShown ? "" : " + ", coefficients[i], exponent );
+                termLength = snprintf( pNext, remainingSize, "%s(%f * x^%d)", isThisTheFirstTermShown ? "" : " + ", coefficients[i], exponent );
             }
             isThisTheFirstTermShown = false;
+
+            // A term that didn't fit fills the buffer, so nothing more can follow it.
+            stringIndex += ((termLength > 0) && ((size_t) termLength < remainingSize)) ? (size_t) termLength
+                                                                                         : remainingSize - 1;
+        }
+    }
+    return 0;
+}
+
+//=========================================================
+//      Internal function definitions
+//=========================================================
+
+//--------------------------------------------------------
+// polyfitCalloc()
+// Allocates cleared memory through the library's
+// allocator.
+//--------------------------------------------------------
+void *polyfitCalloc( size_t count, size_t size )
+{
+    void *pMemory = pAllocatorCalloc( count, size );
+    if( (NULL != pMemory) && POLYFIT_STATS_ON() )
+    {
+        polyfitStatsAllocation( count * size );
+    }
+    return pMemory;
+}
+
+//--------------------------------------------------------
+// polyfitFree()
+// Frees memory from polyfitCalloc(). NULL is ignored.
+//--------------------------------------------------------
+void polyfitFree( void *pMemory )
+{
+    if( NULL != pMemory )
+    {
+        pAllocatorFree( pMemory );
+    }
+}
+
+//--------------------------------------------------------
+// polyfitSolveSums()
+// Solves the normal equations held in power sums and
+// right hand side sums with the given solver, using
+// pScratch, which must hold
+// (coefficientCount * (coefficientCount + 1)) doubles,
+// for the matrices.
+//
+// Returns   0 if success,
+//          -4 if unable to solve equations,
+//          -5 if the solver needs A, i.e. is QR.
+//--------------------------------------------------------
+int polyfitSolveSums( polyfit_solver_t solver, int coefficientCount, double *pPowerSums, double *pRhsSums,
+                      double *pScratch, double *coefficientResults )
+{
+    if( POLYFIT_SOLVER_GAUSS_JORDAN == solver )
+    {
+        matrix_t matATA = { coefficientCount, coefficientCount, pScratch };
+        matrix_t matATB = { coefficientCount, 1, &(pScratch[ coefficientCount * coefficientCount ]) };
+
+        return solveFromSums( coefficientCount, pPowerSums, pRhsSums, &matATA, &matATB, coefficientResults );
+    }
+    if( POLYFIT_SOLVER_QR == solver )
+    {
+        return -5;
+    }
+    return solveCholesky( coefficientCount, pPowerSums, pRhsSums, pScratch, coefficientResults );
+}
+
+//--------------------------------------------------------
+// polyfitCholeskyFactor()
+// Computes the Cholesky factor L of the normal matrix
+// (AT)A held in power sums, so that (AT)A = L * (L)T.
+//
+// Only the lower triangle of the symmetric (AT)A is ever
+// needed, so L is packed row by row into pFactor, which
+// must hold coefficientCount * (coefficientCount + 1) / 2
+// doubles; element [r, c] (c <= r) sits at
+// r * (r + 1) / 2 + c. The rows are in the same highest
+// power first order as solveGaussJordan() uses.
+//
+// Returns   0 if success,
+//          -4 if (AT)A is not numerically positive
+//             definite, so the equations can't be solved.
+//--------------------------------------------------------
+int polyfitCholeskyFactor( int coefficientCount, double *pPowerSums, double *pFactor )
+{
+    int degree = coefficientCount - 1;
+
+    for( int r = 0; r < coefficientCount; r++ )
+    {
+        for( int c = 0; c <= r; c++ )
+        {
+            pFactor[ ((r * (r + 1)) / 2) + c ] = pPowerSums[ (2 * degree) - r - c ];
+        }
+    }
+    return polyfitCholeskyFactorPacked( coefficientCount, pFactor );
+}
+
+//--------------------------------------------------------
+// polyfitCholeskyFactorPacked()
+// Same as polyfitCholeskyFactor(), for any symmetric
+// matrix whose lower triangle is packed row by row in
+// pMatrix, as the factor is. The factor replaces it; each
+// element is read before it is overwritten.
+//
+// Returns   0 if success,
+//          -4 if the matrix is not numerically positive
+//             definite, so the equations can't be solved.
+//--------------------------------------------------------
+int polyfitCholeskyFactorPacked( int size, double *pMatrix )
+{
+    for( int r = 0; r < size; r++ )
+    {
+        double *pRowR = &(pMatrix[ (r * (r + 1)) / 2 ]);
+        for( int c = 0; c <= r; c++ )
+        {
+            double *pRowC = &(pMatrix[ (c * (c + 1)) / 2 ]);
+            double diagonal = pRowR[c];
+            double sum = diagonal;
+            for( int m = 0; m < c; m++ )
+            {
+                sum -= pRowR[m] * pRowC[m];
+            }
+            if( r == c )
+            {
+                // A pivot that is no more than rounding noise on its diagonal
+                // element means (AT)A is singular, or too ill-conditioned to solve.
+                if( !(sum > size * DBL_EPSILON * diagonal) )
+                {
+                    return -4;
+                }
+                pRowR[c] = sqrt( sum );
+            }
+            else
+            {
+                pRowR[c] = sum / pRowC[c];
+            }
         }
     }
+
     return 0;
 }
 
+//--------------------------------------------------------
+// polyfitCholeskySolve()
+// Solves L * (L)T * x = b, given the packed factor from
+// polyfitCholeskyFactor(). b is in pRhs, highest power
+// first, and is overwritten.
+//--------------------------------------------------------
+void polyfitCholeskySolve( int coefficientCount, double *pFactor, double *pRhs, double *coefficientResults )
+{
+    // Forward substitution: L * z = b, with z replacing b.
+    for( int r = 0; r < coefficientCount; r++ )
+    {
+        double *pRowR = &(pFactor[ (r * (r + 1)) / 2 ]);
+        double sum = pRhs[r];
+        for( int m = 0; m < r; m++ )
+        {
+            sum -= pRowR[m] * pRhs[m];
+        }
+        pRhs[r] = sum / pRowR[r];
+    }
+
+    // Back substitution: (L)T * x = z.
+    for( int r = coefficientCount - 1; r >= 0; r-- )
+    {
+        double sum = pRhs[r];
+        for( int m = r + 1; m < coefficientCount; m++ )
+        {
+            sum -= pFactor[ ((m * (m + 1)) / 2) + r ] * coefficientResults[m];
+        }
+        coefficientResults[r] = sum / pFactor[ ((r * (r + 1)) / 2) + r ];
+    }
+}
+
 //=========================================================
 //      Private function definitions
 //=========================================================
@@ -319,104 +888,435 @@ static void reallyShowMatrix( matrix_t *pMat )
 #endif  // SHOW_MATRIX
 
 //--------------------------------------------------------
-// createTranspose()
-// Returns the transpose of a matrix, or NULL.
+// attachAccumulator()
+// Points an accumulator at a block of (3 * coefficientCount - 1)
+// doubles, and clears them. The power sums come first,
+// then the right hand side sums.
+//--------------------------------------------------------
+static void attachAccumulator( polyfit_accum_t *pAccum, int coefficientCount, double *pSums )
+{
+    int powerSumCount = (2 * coefficientCount) - 1;
+
+    memset( pSums, 0, (powerSumCount + coefficientCount) * sizeof( double ));
+    pAccum->coefficientCount = coefficientCount;
+    pAccum->pointCount = 0;
+    pAccum->pPowerSums = pSums;
+    pAccum->pRhsSums = &(pSums[ powerSumCount ]);
+    pAccum->ySquareSum = 0.0;
+}
+
+//--------------------------------------------------------
+// fitAllocated()
+// The body of polyfit_with_solver(): fits in a workspace
+// of one heap allocation, measuring into pCall unless it
+// is NULL. The fixed degree fits need no workspace, so
+// they are run before allocating. If the default solver
+// can't solve the normal equations, the fit is made again
+// by QR, in an allocation large enough for it.
+//--------------------------------------------------------
+static int fitAllocated( int pointCount, double *xValues, double *yValues, int coefficientCount,
+                         double *coefficientResults, polyfit_solver_t solver,
+                         polyfit_solver_t *pSolverUsed, polyfitCall_t *pCall )
+{
+    int rVal = 0;
+    polyfit_solver_t solverUsed = solver;
+
+    // Check that the input pointers aren't null.
+    if( (NULL == xValues) || (NULL == yValues) || (NULL == coefficientResults) )
+    {
+        return -1;
+    }
+    // Check that pointCount >= coefficientCount.
+    if(pointCount < coefficientCount)
+    {
+        return -2;
+    }
+    if( 0 == polyfit_workspace_size_for_solver( solver, pointCount, coefficientCount ) )
+    {
+        return -5;
+    }
+
+    if( (POLYFIT_SOLVER_DEFAULT == solver) && (coefficientCount >= 2) && (coefficientCount <= 4) )
+    {
+        solverUsed = POLYFIT_SOLVER_CHOLESKY;
+        rVal = polyfitFixed( coefficientCount, pointCount, xValues, yValues, coefficientResults, pCall );
+    }
+    else
+    {
+        rVal = fitInAllocation( pointCount, xValues, yValues, coefficientCount, coefficientResults, solver,
+                                &solverUsed, pCall );
+    }
+    if( (-4 == rVal) && (POLYFIT_SOLVER_DEFAULT == solver) && (POLYFIT_SOLVER_QR != solverUsed) )
+    {
+        rVal = fitInAllocation( pointCount, xValues, yValues, coefficientCount, coefficientResults,
+                                POLYFIT_SOLVER_QR, &solverUsed, pCall );
+    }
+
+    if( NULL != pSolverUsed )
+    {
+        *pSolverUsed = solverUsed;
+    }
+    return rVal;
+}
+
+//--------------------------------------------------------
+// fitInAllocation()
+// Fits with the given solver in a workspace of one heap
+// allocation, sized for it, and stores the solver that
+// ran in *pSolverUsed.
 //
-// The caller must free both the allocated matrix
-// and its contents array.
+// Returns   0 if success, or the codes of fitWorkspace(),
+//          -3 if unable to allocate memory.
 //--------------------------------------------------------
-static matrix_t * createTranspose( matrix_t *pMat )
+static int fitInAllocation( int pointCount, double *xValues, double *yValues, int coefficientCount,
+                            double *coefficientResults, polyfit_solver_t solver,
+                            polyfit_solver_t *pSolverUsed, polyfitCall_t *pCall )
 {
-    matrix_t *rVal = (matrix_t *) calloc(1, sizeof(matrix_t));
-    rVal->pContents = (double *) calloc( pMat->rows * pMat->cols, sizeof( double ));
-    rVal->cols = pMat->rows;
-    rVal->rows = pMat->cols;
-    for( int r = 0; r < rVal->rows; r++ )
+    int rVal = 0;
+    polyfit_workspace_t workspace;
+
+    size_t workspaceSize = polyfit_workspace_size_for_solver( solver, pointCount, coefficientCount );
+    void *pMemory = polyfitCalloc( 1, workspaceSize );
+    if( NULL == pMemory )
+    {
+        return -3;
+    }
+
+    rVal = polyfit_workspace_init( &workspace, pMemory, workspaceSize, pointCount, coefficientCount );
+    if( 0 == rVal )
+    {
+        workspace.solver = solver;
+        rVal = fitWorkspace( &workspace, pointCount, xValues, yValues, coefficientCount, coefficientResults, pCall );
+        *pSolverUsed = workspace.solverUsed;
+    }
+    polyfitFree( pMemory );
+
+    return rVal;
+}
+
+//--------------------------------------------------------
+// fitWorkspace()
+// The body of polyfit_ws(), measuring each phase into
+// pCall unless it is NULL.
+//--------------------------------------------------------
+static int fitWorkspace( polyfit_workspace_t *pWorkspace, int pointCount, double *xValues, double *yValues,
+                         int coefficientCount, double *coefficientResults, polyfitCall_t *pCall )
+{
+    int rVal = 0;
+    polyfit_accum_t accum;
+
+    if( (NULL == pWorkspace) || (NULL == pWorkspace->pMemory) ||
+        (NULL == xValues) || (NULL == yValues) || (NULL == coefficientResults) )
+    {
+        return -1;
+    }
+    if(pointCount < coefficientCount)
+    {
+        return -2;
+    }
+    if( (coefficientCount < 1) || (coefficientCount > pWorkspace->maxCoefficients) ||
+        (pointCount > pWorkspace->maxPoints) )
+    {
+        return -5;
+    }
+
+    polyfit_solver_t solver = (POLYFIT_SOLVER_DEFAULT == pWorkspace->solver) ? POLYFIT_SOLVER_CHOLESKY
+                                                                              : pWorkspace->solver;
+    if( pWorkspace->size < polyfit_workspace_size_for_solver( solver, pointCount, coefficientCount ) )
+    {
+        return -5;
+    }
+    pWorkspace->solverUsed = solver;
+    if( NULL != pCall )
+    {
+        pCall->stats.solver = solver;
+    }
+
+    double *pSums = pWorkspace->pMemory;
+    double *pScratch = &(pSums[ (3 * coefficientCount) - 1 ]);
+
+    if( (POLYFIT_SOLVER_DEFAULT == pWorkspace->solver) && (coefficientCount >= 2) && (coefficientCount <= 4) )
+    {
+        rVal = polyfitFixed( coefficientCount, pointCount, xValues, yValues, coefficientResults, pCall );
+    }
+    else if( POLYFIT_SOLVER_QR != solver )
     {
-        for( int c = 0; c < rVal->cols; c++ )
+        attachAccumulator( &accum, coefficientCount, pSums );
+        POLYFIT_STATS_PHASE( pCall, buildNs );
+        polyfit_accum_add_many( &accum, pointCount, xValues, yValues );
+        POLYFIT_STATS_PHASE( pCall, accumulateNs );
+        rVal = polyfitSolveSums( solver, coefficientCount, accum.pPowerSums, accum.pRhsSums, pScratch,
+                                 coefficientResults );
+        POLYFIT_STATS_PHASE( pCall, solveNs );
+        if( NULL != pCall )
         {
-            *MATRIX_VALUE_PTR(rVal, r, c) = *MATRIX_VALUE_PTR(pMat, c, r);
+            pCall->stats.conditionEstimate = polyfitStatsCondition( coefficientCount, accum.pPowerSums );
         }
     }
+
+    // The default solver falls back on QR when Cholesky refuses a pivot,
+    // if the workspace has room for A.
+    if( (-4 == rVal) && (POLYFIT_SOLVER_DEFAULT == pWorkspace->solver) &&
+        (pWorkspace->size >= polyfit_workspace_size_for_solver( POLYFIT_SOLVER_QR, pointCount, coefficientCount )) )
+    {
+        solver = POLYFIT_SOLVER_QR;
+        pWorkspace->solverUsed = solver;
+        if( NULL != pCall )
+        {
+            pCall->stats.solver = solver;
+        }
+    }
+    if( POLYFIT_SOLVER_QR == solver )
+    {
+        POLYFIT_STATS_PHASE( pCall, buildNs );
+        rVal = solveQR( pointCount, xValues, yValues, coefficientCount, pScratch, coefficientResults );
+        POLYFIT_STATS_PHASE( pCall, solveNs );
+    }
     return rVal;
 }
 
 //--------------------------------------------------------
-// createProduct()
-// Returns the product of two matrices, or NULL.
+// loadNormalEquations()
+// Fills (AT)A and (AT)b from power sums and right hand
+// side sums, as kept by an accumulator.
 //
-// The caller must free both the allocated product matrix
-// and its contents array.
+// Coefficients are ordered from the highest power to the
+// lowest, so element [r, c] of (AT)A is the sum of
+// x^(2 * degree - r - c), and element r of (AT)b is the
+// sum of x^(degree - r) * y.
 //--------------------------------------------------------
-static matrix_t * createProduct( matrix_t *pLeft, matrix_t *pRight )
+static void loadNormalEquations( int coefficientCount, double *pPowerSums, double *pRhsSums,
+                                 matrix_t *pMatATA, matrix_t *pMatATB )
 {
-    matrix_t *rVal = NULL;
-    if( (NULL == pLeft) || (NULL == pRight) || (pLeft->cols != pRight->rows) )
+    int degree = coefficientCount - 1;
+
+    for( int r = 0; r < pMatATA->rows; r++ )
     {
-        printf( "Illegal parameter passed to createProduct().\n");
+        for( int c = 0; c < pMatATA->cols; c++ )
+        {
+            *MATRIX_VALUE_PTR(pMatATA, r, c) = pPowerSums[ (2 * degree) - r - c ];
+        }
+        *MATRIX_VALUE_PTR(pMatATB, r, 0) = pRhsSums[ degree - r ];
     }
-    else
+
+    showMatrix( pMatATA );
+    showMatrix( pMatATB );
+}
+
+//--------------------------------------------------------
+// solveFromSums()
+// Loads the normal equations from the sums into the given
+// (AT)A and (AT)b matrices, solves them, and on success
+// copies the coefficients to coefficientResults.
+//
+// Returns   0 if success,
+//          -4 if unable to solve equations.
+//--------------------------------------------------------
+static int solveFromSums( int coefficientCount, double *pPowerSums, double *pRhsSums,
+                          matrix_t *pMatATA, matrix_t *pMatATB, double *coefficientResults )
+{
+    loadNormalEquations( coefficientCount, pPowerSums, pRhsSums, pMatATA, pMatATB );
+
+    int rVal = solveGaussJordan( pMatATA, pMatATB );
+    if( 0 == rVal )
     {
-        // Allocate the product matrix.
-        rVal = (matrix_t *) calloc(1, sizeof(matrix_t));
-        rVal->rows = pLeft->rows;
-        rVal->cols = pRight->cols;
-        rVal->pContents = (double *) calloc( rVal->rows * rVal->cols, sizeof( double ));
+        for( int i = 0; i < coefficientCount; i++)
+        {
+            coefficientResults[i] = *MATRIX_VALUE_PTR(pMatATB, i, 0);
+        }
+    }
+    return rVal;
+}
 
-        // Initialize the product matrix contents:
-        // product[i,j] = sum{k = 0 .. (pLeft->cols - 1)} (pLeft[i,k] * pRight[ k, j])
-        for( int i = 0; i < rVal->rows; i++)
+//--------------------------------------------------------
+// solveGaussJordan()
+// Solves the system of linear equations (AT)Ax = (AT)b
+// for "x", the coefficients of the polynomial, leaving
+// them in pMatATB. Both matrices are overwritten.
+//
+// Returns   0 if success,
+//          -4 if unable to solve equations.
+//--------------------------------------------------------
+static int solveGaussJordan( matrix_t *pMatATA, matrix_t *pMatATB )
+{
+    int rVal = 0;
+
+    for( int c = 0; c < pMatATA->cols; c++ )
+    {
+        int pr = c;     // pr is the pivot row.
+        double prVal = *MATRIX_VALUE_PTR(pMatATA, pr, c);
+        // If it's zero, we can't solve the equations.
+        if( 0.0 == prVal )
+        {
+            showMatrix( pMatATA );
+            rVal = -4;
+            break;
+        }
+        for( int r = 0; r < pMatATA->rows; r++)
         {
-            for( int j = 0; j < rVal->cols; j++ )
+            if( r != pr )
             {
-                for( int k = 0; k < pLeft->cols; k++)
+                double targetRowVal = *MATRIX_VALUE_PTR(pMatATA, r, c);
+                double factor = targetRowVal / prVal;
+                for( int c2 = 0; c2 < pMatATA->cols; c2++ )
                 {
-                    *MATRIX_VALUE_PTR(rVal, i, j) +=
-                        (*MATRIX_VALUE_PTR(pLeft, i, k)) * (*MATRIX_VALUE_PTR(pRight, k, j));
+                    *MATRIX_VALUE_PTR(pMatATA, r, c2) -=  *MATRIX_VALUE_PTR(pMatATA, pr, c2) * factor;
                 }
+                *MATRIX_VALUE_PTR(pMatATB, r, 0) -=  *MATRIX_VALUE_PTR(pMatATB, pr, 0) * factor;
+
+                showMatrix( pMatATB );
             }
         }
-    }    
-       
+    }
+    if( 0 == rVal )
+    {
+        for( int c = 0; c < pMatATA->cols; c++ )
+        {
+            int pr = c;
+            // now, pr is the pivot row.
+            double prVal = *MATRIX_VALUE_PTR(pMatATA, pr, c);
+            *MATRIX_VALUE_PTR(pMatATA, pr, c) /= prVal;
+            *MATRIX_VALUE_PTR(pMatATB, pr, 0) /= prVal;
+        }
+    }
+
+    showMatrix( pMatATA );
+    showMatrix( pMatATB );
+
     return rVal;
 }
 
 //--------------------------------------------------------
-// destroyMatrix()
-// Frees both the allocated matrix and its contents array.
+// solveCholesky()
+// Solves the normal equations held in power sums by
+// Cholesky factorization, (AT)A = L * (L)T, which needs
+// about k^3/6 multiply-adds against Gauss-Jordan's k^3.
+// The factor is packed into the start of pScratch, and
+// the right hand side, highest power first like the rows,
+// follows it.
+//
+// Returns   0 if success,
+//          -4 if (AT)A is not numerically positive
+//             definite, so the equations can't be solved.
 //--------------------------------------------------------
-static void destroyMatrix( matrix_t *pMat )
+static int solveCholesky( int coefficientCount, double *pPowerSums, double *pRhsSums, double *pScratch,
+                          double *coefficientResults )
 {
-    if(NULL != pMat)
+    int degree = coefficientCount - 1;
+    double *pL = pScratch;
+    double *pZ = &(pScratch[ (coefficientCount * (coefficientCount + 1)) / 2 ]);
+
+    int rVal = polyfitCholeskyFactor( coefficientCount, pPowerSums, pL );
+    if( 0 == rVal )
     {
-        if(NULL != pMat->pContents)
+        for( int r = 0; r < coefficientCount; r++ )
         {
-            free(pMat->pContents);
+            pZ[r] = pRhsSums[ degree - r ];
         }
-        free( pMat );
+        polyfitCholeskySolve( coefficientCount, pL, pZ, coefficientResults );
     }
+    return rVal;
 }
 
 //--------------------------------------------------------
-// createMatrix()
-// Allocates the matrix and clears its contents array.
+// solveQR()
+// Solves the least squares problem A * x = b directly, by
+// Householder QR factorization of A. This avoids forming
+// (AT)A, whose condition number is the square of A's, so
+// it copes with much worse conditioned inputs, at the
+// cost of O(pointCount * coefficientCount^2) work on
+// pointCount * (coefficientCount + 1) doubles of pScratch.
+//
+// A is stored column by column, highest power first, so
+// each reflection works down contiguous memory. Once R
+// is formed, back substitution of R * x = (Q)T * b gives
+// the coefficients.
+//
+// Returns   0 if success,
+//          -4 if A is numerically rank deficient.
 //--------------------------------------------------------
-static matrix_t *createMatrix( int rows, int cols )
+static int solveQR( int pointCount, double *xValues, double *yValues, int coefficientCount,
+                    double *pScratch, double *coefficientResults )
 {
-    matrix_t *rVal = (matrix_t *) calloc(1, sizeof(matrix_t));
-    if(NULL != rVal)
+    double *pA = pScratch;                                          // Column c at pA[c * pointCount].
+    double *pB = &(pScratch[ (size_t) coefficientCount * pointCount ]);
+    int degree = coefficientCount - 1;
+
+    // Build the columns of A from the lowest power up, by repeated multiplication.
+    for( int i = 0; i < pointCount; i++ )
     {
-        rVal->rows = rows;
-        rVal->cols = cols;
-        rVal->pContents = (double *) calloc( rows * cols, sizeof( double ));
-        if(NULL == rVal->pContents)
+        double xPower = 1.0;
+        for( int c = degree; c >= 0; c-- )
         {
-            free( rVal );
-            rVal = NULL;
+            pA[ ((size_t) c * pointCount) + i ] = xPower;
+            xPower *= xValues[i];
         }
+        pB[i] = yValues[i];
     }
 
-    return rVal;
-}
+    for( int c = 0; c < coefficientCount; c++ )
+    {
+        double *pColumn = &(pA[ (size_t) c * pointCount ]);
+
+        double columnNorm = 0.0;
+        double norm = 0.0;
+        for( int i = 0; i < pointCount; i++ )
+        {
+            columnNorm += pColumn[i] * pColumn[i];
+        }
+        for( int i = c; i < pointCount; i++ )
+        {
+            norm += pColumn[i] * pColumn[i];
+        }
+        columnNorm = sqrt( columnNorm );
+        norm = sqrt( norm );
 
- 
+        // What is left of this column, after removing its projection on
+        // the earlier ones, must be more than rounding noise.
+        if( !(norm > 1e-13 * columnNorm) )
+        {
+            return -4;
+        }
+
+        // Reflector v = column - alpha * e_c, with alpha's sign chosen to avoid cancellation.
+        double alpha = (pColumn[c] > 0.0) ? -norm : norm;
+        pColumn[c] -= alpha;
+        double vNormSquared = 0.0;
+        for( int i = c; i < pointCount; i++ )
+        {
+            vNormSquared += pColumn[i] * pColumn[i];
+        }
+
+        for( int c2 = c + 1; c2 <= coefficientCount; c2++ )
+        {
+            // Column coefficientCount is b.
+            double *pTarget = (c2 < coefficientCount) ? &(pA[ (size_t) c2 * pointCount ]) : pB;
+            double dot = 0.0;
+            for( int i = c; i < pointCount; i++ )
+            {
+                dot += pColumn[i] * pTarget[i];
+            }
+            double factor = (2.0 * dot) / vNormSquared;
+            for( int i = c; i < pointCount; i++ )
+            {
+                pTarget[i] -= factor * pColumn[i];
+            }
+        }
+
+        // The reflector has done its job; keep R's diagonal in its place.
+        pColumn[c] = alpha;
+    }
+
+    // Back substitution: R * x = (Q)T * b, with R[r, c] at pA[c * pointCount + r].
+    for( int r = degree; r >= 0; r-- )
+    {
+        double sum = pB[r];
+        for( int c = r + 1; c < coefficientCount; c++ )
+        {
+            sum -= pA[ ((size_t) c * pointCount) + r ] * coefficientResults[c];
+        }
+        coefficientResults[r] = sum / pA[ ((size_t) r * pointCount) + r ];
+    }
+
+    return 0;
+}
@@ -0,0 +1,270 @@
+// file: polyfit_internal.h
+// Description: Private declarations shared by the polyfit source files.
+// Author: Henry Forson, Melbourne, FL
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+
+#ifndef POLYFIT_INTERNAL_H
+#define POLYFIT_INTERNAL_H
+
+#include "polyfit.h"
+
+
+//------------------------------------------------
+// Private Types and Macros (polystats.c)
+//------------------------------------------------
+
+// The measurements of a fit in progress, and the clock
+// reading at the end of its last phase.
+typedef struct polyfitCall_s
+{
+    polyfit_call_stats_t    stats;
+    double                  markNs;
+} polyfitCall_t;
+
+// Set while stats are enabled. Building with POLYFIT_NO_STATS
+// defined leaves the measurement out altogether.
+extern int polyfitStatsFlag;
+
+#ifdef POLYFIT_NO_STATS
+#define POLYFIT_STATS_ON()  (false)
+#else   // POLYFIT_NO_STATS
+#define POLYFIT_STATS_ON()  (0 != __atomic_load_n( &polyfitStatsFlag, __ATOMIC_RELAXED ))
+#endif  // POLYFIT_NO_STATS
+
+// Ends a phase of a measured fit, adding its time to the named
+// field of pCall->stats. Does nothing if pCall is NULL.
+#define POLYFIT_STATS_PHASE( pCall, phase ) do {\
+    if( NULL != (pCall) )\
+    {\
+        polyfitStatsPhase( (pCall), &((pCall)->stats.phase) );\
+    }\
+} while( 0 )
+
+
+//------------------------------------------------
+// Private Function Prototypes (polyfit.c)
+//------------------------------------------------
+
+//--------------------------------------------------------
+// polyfitCalloc()
+// Allocates cleared memory through the allocator set by
+// polyfit_set_allocator(). All library heap memory comes
+// from here.
+//--------------------------------------------------------
+void *polyfitCalloc( size_t count, size_t size );
+
+//--------------------------------------------------------
+// polyfitFree()
+// Frees memory from polyfitCalloc(). NULL is ignored.
+//--------------------------------------------------------
+void polyfitFree( void *pMemory );
+
+//--------------------------------------------------------
+// polyfitSolveSums()
+// Solves the normal equations held in power sums and
+// right hand side sums (ascending powers) with a solver
+// other than QR, giving the coefficients highest power
+// first. pScratch must hold
+// coefficientCount * (coefficientCount + 1) doubles.
+// Returns 0 if success, -4 if unable to solve.
+//--------------------------------------------------------
+int polyfitSolveSums( polyfit_solver_t solver, int coefficientCount, double *pPowerSums, double *pRhsSums,
+                      double *pScratch, double *coefficientResults );
+
+
+//--------------------------------------------------------
+// polyfitCholeskyFactor()
+// Computes the packed Cholesky factor of the normal matrix
+// held in power sums, highest power first, into pFactor,
+// which must hold k * (k + 1) / 2 doubles.
+// Returns 0 if success, -4 if unable to factor.
+//--------------------------------------------------------
+int polyfitCholeskyFactor( int coefficientCount, double *pPowerSums, double *pFactor );
+
+//--------------------------------------------------------
+// polyfitCholeskyFactorPacked()
+// Same as polyfitCholeskyFactor(), for a general normal
+// matrix whose lower triangle is packed in pMatrix as the
+// factor is, factored in place.
+// Returns 0 if success, -4 if unable to factor.
+//--------------------------------------------------------
+int polyfitCholeskyFactorPacked( int size, double *pMatrix );
+
+//--------------------------------------------------------
+// polyfitCholeskySolve()
+// Solves with a factor from polyfitCholeskyFactor(). The
+// right hand side in pRhs, highest power first, is
+// overwritten.
+//--------------------------------------------------------
+void polyfitCholeskySolve( int coefficientCount, double *pFactor, double *pRhs, double *coefficientResults );
+
+
+//------------------------------------------------
+// Private Function Prototypes (polykernel.c)
+//------------------------------------------------
+
+//--------------------------------------------------------
+// polyfitKernelPowerSums()
+// Adds the power sums of an array of points into
+// pPowerSums and pRhsSums, and the sum of y^2 into
+// *pYSquareSum unless it is NULL, using the fastest
+// kernel the CPU supports.
+//--------------------------------------------------------
+void polyfitKernelPowerSums( int coefficientCount, int pointCount, double *xValues, double *yValues,
+                             double *pPowerSums, double *pRhsSums, double *pYSquareSum );
+
+//--------------------------------------------------------
+// polyfitKernelPowerSumsFloat()
+// Same as polyfitKernelPowerSums(), for float points. The
+// sums are still kept in double.
+//--------------------------------------------------------
+void polyfitKernelPowerSumsFloat( int coefficientCount, int pointCount, float *xValues, float *yValues,
+                                  double *pPowerSums, double *pRhsSums );
+
+//--------------------------------------------------------
+// polyfitKernelPowerSumsWidened()
+// Same as polyfitKernelPowerSumsFloat(), but the points
+// are widened to double before their powers are taken,
+// so the sums are as accurate as a double fit's.
+//--------------------------------------------------------
+void polyfitKernelPowerSumsWidened( int coefficientCount, int pointCount, float *xValues, float *yValues,
+                                    double *pPowerSums, double *pRhsSums );
+
+//--------------------------------------------------------
+// polyfitKernelUniformRhsSums()
+// Adds only the coefficientCount right hand side sums,
+// of x^j * y, of the evenly spaced points
+// x = (indexOffset + i) * xScale into pRhsSums.
+//--------------------------------------------------------
+void polyfitKernelUniformRhsSums( int coefficientCount, int pointCount, double indexOffset, double xScale,
+                                  double *yValues, double *pRhsSums );
+
+//--------------------------------------------------------
+// polyfitKernelDots()
+// Computes the dot products of count weights with each of
+// valueCount arrays of count values, the v'th
+// starting at pValues[v * valueStride], into pSums[v].
+//--------------------------------------------------------
+void polyfitKernelDots( int count, double *weights, double *pValues, int valueCount, size_t valueStride,
+                        double *pSums );
+
+//--------------------------------------------------------
+// polyfitKernelResidualSums()
+// Adds, for each float point, x^j * (y - p(x)) into
+// pRhsSums[j] for j below coefficientCount, computed in
+// double. p's coefficients are highest power first.
+//--------------------------------------------------------
+void polyfitKernelResidualSums( int coefficientCount, int pointCount, float *xValues, float *yValues,
+                                double *coefficients, double *pRhsSums );
+
+//--------------------------------------------------------
+// polyfitKernelConvolve()
+// Computes outputCount correlation outputs,
+//     outValues[i] = sum over j of weights[j] * inValues[i + j],
+// for j below weightCount, using the fastest kernel the
+// CPU supports.
+//--------------------------------------------------------
+void polyfitKernelConvolve( int outputCount, double *inValues, double *weights, int weightCount,
+                            double *outValues );
+
+//--------------------------------------------------------
+// polyfitKernelEvaluate()
+// Evaluates a polynomial, coefficients highest power
+// first, at each of pointCount x values into yValues, and
+// its first and second derivatives into firstDerivatives
+// and secondDerivatives unless they are NULL.
+//--------------------------------------------------------
+void polyfitKernelEvaluate( int coefficientCount, double *coefficients, int pointCount, double *xValues,
+                            double *yValues, double *firstDerivatives, double *secondDerivatives );
+
+
+//------------------------------------------------
+// Private Function Prototypes (polyfixed.c)
+//------------------------------------------------
+
+//--------------------------------------------------------
+// polyfitFixed()
+// Runs the fixed degree fit for 2, 3 or 4 coefficients,
+// measuring its phases into pCall unless it is NULL.
+// Returns 0 if success, -5 if there is none for
+// coefficientCount, or as polyfit() otherwise.
+//--------------------------------------------------------
+int polyfitFixed( int coefficientCount, int pointCount, double *xValues, double *yValues,
+                  double *coefficientResults, polyfitCall_t *pCall );
+
+//--------------------------------------------------------
+// polyfitFixedBatch()
+// Fits every series of a polyfit_batch() batch by the
+// fixed degree fit for 2, 3 or 4 coefficients, short
+// series four at a time where the CPU has AVX2. Returns 0
+// if success, -5 if there is none for coefficientCount.
+//--------------------------------------------------------
+int polyfitFixedBatch( int coefficientCount, int seriesCount, int *seriesOffsets, double *xValues, double *yValues,
+                       double *coefficientResults, int *seriesStatus );
+
+
+//------------------------------------------------
+// Private Function Prototypes (polystats.c)
+//------------------------------------------------
+
+//--------------------------------------------------------
+// polyfitStatsBegin()
+// Starts measuring a fit.
+//--------------------------------------------------------
+void polyfitStatsBegin( polyfitCall_t *pCall, int pointCount, int coefficientCount );
+
+//--------------------------------------------------------
+// polyfitStatsPhase()
+// Adds the time since the last phase ended to *pPhaseNs.
+//--------------------------------------------------------
+void polyfitStatsPhase( polyfitCall_t *pCall, double *pPhaseNs );
+
+//--------------------------------------------------------
+// polyfitStatsEnd()
+// Adds a measured fit that returned status to the totals,
+// and passes it to the hook.
+//--------------------------------------------------------
+void polyfitStatsEnd( polyfitCall_t *pCall, int status );
+
+//--------------------------------------------------------
+// polyfitStatsAllocation()
+// Counts a heap allocation of byteCount bytes.
+//--------------------------------------------------------
+void polyfitStatsAllocation( size_t byteCount );
+
+//--------------------------------------------------------
+// polyfitStatsCondition()
+// Estimates the condition number of the normal matrix
+// held in power sums, as the squared ratio of the largest
+// to the smallest diagonal of its Cholesky factor.
+// Returns the estimate, infinity if the matrix can't be
+// factored, or 0 if coefficientCount is too large.
+//--------------------------------------------------------
+double polyfitStatsCondition( int coefficientCount, double *pPowerSums );
+
+
+#endif	// POLYFIT_INTERNAL_H
@@ -0,0 +1,823 @@
+// Name: polyfixed.c
+// Description: Fits of fixed degree 1, 2 and 3, specialized at compile time.
+// Author: Henry M. Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+
+#include <float.h>      // DBL_EPSILON
+
+#include "polyfit_internal.h"
+
+// SSE2 is part of every x86-64 CPU, so where the compiler targets it the
+// short series sums use it directly, with no run-time check.
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif  // __SSE2__
+
+// The batch fits use AVX2 through per-function target attributes, as the
+// vector kernels do, and only where polyfit_kernel_detect() finds it.
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define POLYFIXED_X86 1
+#include <immintrin.h>
+#endif  // __x86_64__ || __i386__
+
+// The largest fit specialized here: a cubic.
+#define FIXED_MAX_COEFFICIENTS  (4)
+
+// From this many points on, the power sums come from the vector kernels,
+// whose call overhead is then small beside the work.
+#define FIXED_VECTOR_POINTS     (128)
+
+// Short series of a batch are fitted this many at a time, one to each
+// lane of an AVX2 register, so one pass of the sums and of the solver
+// serves them all.
+#define FIXED_BATCH_LANES       (4)
+
+// Each helper below is called with a constant coefficientCount, and is
+// always inlined, so the compiler makes a copy per degree. Its loops over
+// coefficients are then fully unrolled, which lets the sums and the
+// factor live in registers.
+#define FIXED_INLINE            static inline __attribute__(( always_inline ))
+#define FIXED_UNROLL            _Pragma( "GCC unroll 8" )
+#define FIXED_AVX2_INLINE       static inline __attribute__(( always_inline, target( "avx2" ) ))
+
+
+//------------------------------------------------
+// Private Function Prototypes
+//------------------------------------------------
+
+FIXED_INLINE int    fitFixed( int coefficientCount, int pointCount, double *xValues, double *yValues,
+                              double *coefficientResults, polyfitCall_t *pCall );
+FIXED_INLINE void   sumFixed( int coefficientCount, int pointCount, double *xValues, double *yValues,
+                              double *pPowerSums, double *pRhsSums );
+FIXED_INLINE int    solveFixed( int coefficientCount, double *pPowerSums, double *pRhsSums,
+                                double *coefficientResults );
+#ifdef POLYFIXED_X86
+static void         batchAvx2( int coefficientCount, int seriesCount, int *seriesOffsets, double *xValues,
+                               double *yValues, double *coefficientResults, int *seriesStatus );
+FIXED_AVX2_INLINE void  batchLanes( int coefficientCount, int seriesCount, int *seriesOffsets, double *xValues,
+                                    double *yValues, double *coefficientResults, int *seriesStatus );
+FIXED_AVX2_INLINE void  fitLanes( int coefficientCount, int *laneSeries, int *seriesOffsets, double *xValues,
+                                  double *yValues, double *coefficientResults, int *seriesStatus );
+FIXED_AVX2_INLINE void  transposeLanes( __m256d *pRows );
+FIXED_AVX2_INLINE void  addLanes( int coefficientCount, __m256d power, __m256d x, __m256d y, __m256d *pPowerSums,
+                                  __m256d *pRhsSums );
+FIXED_AVX2_INLINE int   solveLanes( int coefficientCount, __m256d *pPowerSums, __m256d *pRhsSums,
+                                    __m256d *pSolution );
+#endif  // POLYFIXED_X86
+
+
+//=========================================================
+//      Global function definitions
+//=========================================================
+
+
+//--------------------------------------------------------
+// polyfit_linear()
+// Same as polyfit() with a coefficientCount of 2, which
+// it calls: fits a straight line, giving the slope and
+// then the intercept.
+//
+// The fixed degree fits make no heap calls. For short
+// series they add up the power sums in registers with an
+// unrolled loop, and for longer ones use the vector
+// kernels. They solve the normal equations by a fully
+// unrolled, square root free Cholesky factorization, so
+// their coefficients match those of the general Cholesky
+// solver to rounding. If it refuses a pivot, they fall
+// back on QR, as polyfit() does, which allocates. While
+// stats are enabled, they are polyfit().
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < 2),
+//          -3 if unable to allocate memory for QR,
+//          -4 if unable to solve equations.
+//--------------------------------------------------------
+int polyfit_linear( int pointCount, double *xValues, double *yValues, double *coefficientResults )
+{
+    if( POLYFIT_STATS_ON() )
+    {
+        return polyfit( pointCount, xValues, yValues, 2, coefficientResults );
+    }
+    int rVal = fitFixed( 2, pointCount, xValues, yValues, coefficientResults, NULL );
+    return (-4 == rVal) ? polyfit_with_solver( pointCount, xValues, yValues, 2, coefficientResults,
+                                               POLYFIT_SOLVER_QR, NULL ) : rVal;
+}
+
+//--------------------------------------------------------
+// polyfit_quadratic()
+// Same as polyfit() with a coefficientCount of 3; see
+// polyfit_linear().
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < 3),
+//          -3 if unable to allocate memory for QR,
+//          -4 if unable to solve equations.
+//--------------------------------------------------------
+int polyfit_quadratic( int pointCount, double *xValues, double *yValues, double *coefficientResults )
+{
+    if( POLYFIT_STATS_ON() )
+    {
+        return polyfit( pointCount, xValues, yValues, 3, coefficientResults );
+    }
+    int rVal = fitFixed( 3, pointCount, xValues, yValues, coefficientResults, NULL );
+    return (-4 == rVal) ? polyfit_with_solver( pointCount, xValues, yValues, 3, coefficientResults,
+                                               POLYFIT_SOLVER_QR, NULL ) : rVal;
+}
+
+//--------------------------------------------------------
+// polyfit_cubic()
+// Same as polyfit() with a coefficientCount of 4; see
+// polyfit_linear().
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < 4),
+//          -3 if unable to allocate memory for QR,
+//          -4 if unable to solve equations.
+//--------------------------------------------------------
+int polyfit_cubic( int pointCount, double *xValues, double *yValues, double *coefficientResults )
+{
+    if( POLYFIT_STATS_ON() )
+    {
+        return polyfit( pointCount, xValues, yValues, 4, coefficientResults );
+    }
+    int rVal = fitFixed( 4, pointCount, xValues, yValues, coefficientResults, NULL );
+    return (-4 == rVal) ? polyfit_with_solver( pointCount, xValues, yValues, 4, coefficientResults,
+                                               POLYFIT_SOLVER_QR, NULL ) : rVal;
+}
+
+//--------------------------------------------------------
+// polyfitFixed()
+// Runs the fixed degree fit for coefficientCount,
+// measuring it into pCall unless it is NULL.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < coefficientCount),
+//          -4 if unable to solve equations,
+//          -5 if there is no fixed degree fit for
+//             coefficientCount.
+//--------------------------------------------------------
+int polyfitFixed( int coefficientCount, int pointCount, double *xValues, double *yValues,
+                  double *coefficientResults, polyfitCall_t *pCall )
+{
+    // Keep the unmeasured copies free of the stats code.
+    if( NULL != pCall )
+    {
+        switch( coefficientCount )
+        {
+            case 2:     return fitFixed( 2, pointCount, xValues, yValues, coefficientResults, pCall );
+            case 3:     return fitFixed( 3, pointCount, xValues, yValues, coefficientResults, pCall );
+            case 4:     return fitFixed( 4, pointCount, xValues, yValues, coefficientResults, pCall );
+            default:    return -5;
+        }
+    }
+
+    switch( coefficientCount )
+    {
+        case 2:     return fitFixed( 2, pointCount, xValues, yValues, coefficientResults, NULL );
+        case 3:     return fitFixed( 3, pointCount, xValues, yValues, coefficientResults, NULL );
+        case 4:     return fitFixed( 4, pointCount, xValues, yValues, coefficientResults, NULL );
+        default:    return -5;
+    }
+}
+
+//--------------------------------------------------------
+// polyfitFixedBatch()
+// Fits every series of a batch, as polyfit_batch() packs
+// them, by the fixed degree fit for coefficientCount,
+// setting each seriesStatus[s] as polyfitFixed() would.
+//
+// Where the CPU has AVX2, series too short for the vector
+// kernels are fitted FIXED_BATCH_LANES at a time, each in
+// its own lane, through both the sums and the solve. Each
+// lane does the arithmetic of sumFixed() and solveFixed()
+// in the same order, so its coefficients are bit for bit
+// those polyfitFixed() gives.
+//
+// Returns   0 if success,
+//          -5 if there is no fixed degree fit for
+//             coefficientCount.
+//--------------------------------------------------------
+int polyfitFixedBatch( int coefficientCount, int seriesCount, int *seriesOffsets, double *xValues, double *yValues,
+                       double *coefficientResults, int *seriesStatus )
+{
+    if( (coefficientCount < 2) || (coefficientCount > FIXED_MAX_COEFFICIENTS) )
+    {
+        return -5;
+    }
+#ifdef POLYFIXED_X86
+    if( polyfit_kernel_detect() >= POLYFIT_KERNEL_AVX2 )
+    {
+        batchAvx2( coefficientCount, seriesCount, seriesOffsets, xValues, yValues, coefficientResults,
+                   seriesStatus );
+        return 0;
+    }
+#endif  // POLYFIXED_X86
+
+    for( int s = 0; s < seriesCount; s++ )
+    {
+        int first = seriesOffsets[s];
+        seriesStatus[s] = polyfitFixed( coefficientCount, seriesOffsets[s + 1] - first, &(xValues[ first ]),
+                                        &(yValues[ first ]), &(coefficientResults[ s * coefficientCount ]), NULL );
+    }
+    return 0;
+}
+
+
+//=========================================================
+//      Private function definitions
+//=========================================================
+
+//--------------------------------------------------------
+// fitFixed()
+// Checks the arguments, then sums and solves. The phases
+// are measured into pCall unless it is NULL; callers pass
+// a constant NULL to get a copy with no measurement in it.
+//--------------------------------------------------------
+FIXED_INLINE int fitFixed( int coefficientCount, int pointCount, double *xValues, double *yValues,
+                           double *coefficientResults, polyfitCall_t *pCall )
+{
+    int rVal = 0;
+    double powerSums[ (2 * FIXED_MAX_COEFFICIENTS) - 1 ] = { 0.0 };
+    double rhsSums[ FIXED_MAX_COEFFICIENTS ] = { 0.0 };
+
+    if( (NULL == xValues) || (NULL == yValues) || (NULL == coefficientResults) )
+    {
+        return -1;
+    }
+    if( pointCount < coefficientCount )
+    {
+        return -2;
+    }
+    if( NULL != pCall )
+    {
+        pCall->stats.solver = POLYFIT_SOLVER_CHOLESKY;
+    }
+    POLYFIT_STATS_PHASE( pCall, buildNs );
+
+    if( pointCount >= FIXED_VECTOR_POINTS )
+    {
+        polyfitKernelPowerSums( coefficientCount, pointCount, xValues, yValues, powerSums, rhsSums, NULL );
+    }
+    else
+    {
+        sumFixed( coefficientCount, pointCount, xValues, yValues, powerSums, rhsSums );
+    }
+    POLYFIT_STATS_PHASE( pCall, accumulateNs );
+    rVal = solveFixed( coefficientCount, powerSums, rhsSums, coefficientResults );
+    POLYFIT_STATS_PHASE( pCall, solveNs );
+    if( NULL != pCall )
+    {
+        pCall->stats.conditionEstimate = polyfitStatsCondition( coefficientCount, powerSums );
+    }
+    return rVal;
+}
+
+//--------------------------------------------------------
+// sumFixed()
+// Sets the power sums and right hand side sums of a short
+// series, two points per step into two sets of sums, as
+// the two lanes of SSE2 registers where available.
+//--------------------------------------------------------
+FIXED_INLINE void sumFixed( int coefficientCount, int pointCount, double *xValues, double *yValues,
+                            double *pPowerSums, double *pRhsSums )
+{
+    int powerSumCount = (2 * coefficientCount) - 1;
+    double powerSumsA[ (2 * FIXED_MAX_COEFFICIENTS) - 1 ] = { 0.0 };
+    double powerSumsB[ (2 * FIXED_MAX_COEFFICIENTS) - 1 ] = { 0.0 };
+    double rhsSumsA[ FIXED_MAX_COEFFICIENTS ] = { 0.0 };
+    double rhsSumsB[ FIXED_MAX_COEFFICIENTS ] = { 0.0 };
+    int i = 0;
+
+#ifdef __SSE2__
+    // Points i and i + 1 in the two lanes of each sum.
+    __m128d powerSumPairs[ (2 * FIXED_MAX_COEFFICIENTS) - 1 ];
+    __m128d rhsSumPairs[ FIXED_MAX_COEFFICIENTS ];
+
+    FIXED_UNROLL
+    for( int j = 0; j < powerSumCount; j++ )
+    {
+        powerSumPairs[j] = _mm_setzero_pd();
+    }
+    FIXED_UNROLL
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        rhsSumPairs[j] = _mm_setzero_pd();
+    }
+
+    for( ; (i + 2) <= pointCount; i += 2 )
+    {
+        __m128d x = _mm_loadu_pd( &xValues[i] );
+        __m128d y = _mm_loadu_pd( &yValues[i] );
+        __m128d power = _mm_set1_pd( 1.0 );
+
+        FIXED_UNROLL
+        for( int j = 0; j < powerSumCount; j++ )
+        {
+            powerSumPairs[j] = _mm_add_pd( powerSumPairs[j], power );
+            if( j < coefficientCount )
+            {
+                rhsSumPairs[j] = _mm_add_pd( rhsSumPairs[j], _mm_mul_pd( power, y ));
+            }
+            power = _mm_mul_pd( power, x );
+        }
+    }
+
+    FIXED_UNROLL
+    for( int j = 0; j < powerSumCount; j++ )
+    {
+        _mm_storel_pd( &powerSumsA[j], powerSumPairs[j] );
+        _mm_storeh_pd( &powerSumsB[j], powerSumPairs[j] );
+    }
+    FIXED_UNROLL
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        _mm_storel_pd( &rhsSumsA[j], rhsSumPairs[j] );
+        _mm_storeh_pd( &rhsSumsB[j], rhsSumPairs[j] );
+    }
+#else   // __SSE2__
+    for( ; (i + 2) <= pointCount; i += 2 )
+    {
+        double xA = xValues[i], yA = yValues[i], powerA = 1.0;
+        double xB = xValues[i + 1], yB = yValues[i + 1], powerB = 1.0;
+
+        FIXED_UNROLL
+        for( int j = 0; j < powerSumCount; j++ )
+        {
+            powerSumsA[j] += powerA;
+            powerSumsB[j] += powerB;
+            if( j < coefficientCount )
+            {
+                rhsSumsA[j] += powerA * yA;
+                rhsSumsB[j] += powerB * yB;
+            }
+            powerA *= xA;
+            powerB *= xB;
+        }
+    }
+#endif  // __SSE2__
+
+    if( i < pointCount )
+    {
+        double power = 1.0;
+        FIXED_UNROLL
+        for( int j = 0; j < powerSumCount; j++ )
+        {
+            powerSumsA[j] += power;
+            if( j < coefficientCount )
+            {
+                rhsSumsA[j] += power * yValues[i];
+            }
+            power *= xValues[i];
+        }
+    }
+
+    FIXED_UNROLL
+    for( int j = 0; j < powerSumCount; j++ )
+    {
+        pPowerSums[j] = powerSumsA[j] + powerSumsB[j];
+    }
+    FIXED_UNROLL
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        pRhsSums[j] = rhsSumsA[j] + rhsSumsB[j];
+    }
+}
+
+//--------------------------------------------------------
+// solveFixed()
+// Solves the normal equations by the square root free
+// form of Cholesky, (AT)A = L * D * (L)T with L unit lower
+// triangular, which needs one division per coefficient
+// and no square roots. Each pivot of D is the square of
+// the matching general Cholesky pivot, so the same test
+// rejects the same singular equations.
+//
+// Returns   0 if success,
+//          -4 if unable to solve equations.
+//--------------------------------------------------------
+FIXED_INLINE int solveFixed( int coefficientCount, double *pPowerSums, double *pRhsSums,
+                             double *coefficientResults )
+{
+    int degree = coefficientCount - 1;
+    double unitLower[ FIXED_MAX_COEFFICIENTS ][ FIXED_MAX_COEFFICIENTS ];
+    double scaledLower[ FIXED_MAX_COEFFICIENTS ][ FIXED_MAX_COEFFICIENTS ];    // L * D, below the diagonal.
+    double inversePivots[ FIXED_MAX_COEFFICIENTS ];
+    double z[ FIXED_MAX_COEFFICIENTS ];
+    double solution[ FIXED_MAX_COEFFICIENTS ];
+
+    // Rows are highest power first, as in polyfitCholeskyFactor().
+    FIXED_UNROLL
+    for( int r = 0; r < coefficientCount; r++ )
+    {
+        FIXED_UNROLL
+        for( int c = 0; c < r; c++ )
+        {
+            double sum = pPowerSums[ (2 * degree) - r - c ];
+            FIXED_UNROLL
+            for( int m = 0; m < c; m++ )
+            {
+                sum -= scaledLower[r][m] * unitLower[c][m];
+            }
+            scaledLower[r][c] = sum;
+            unitLower[r][c] = sum * inversePivots[c];
+        }
+
+        double diagonal = pPowerSums[ (2 * degree) - (2 * r) ];
+        double pivot = diagonal;
+        FIXED_UNROLL
+        for( int m = 0; m < r; m++ )
+        {
+            pivot -= scaledLower[r][m] * unitLower[r][m];
+        }
+        if( !(pivot > coefficientCount * DBL_EPSILON * diagonal) )
+        {
+            return -4;
+        }
+        inversePivots[r] = 1.0 / pivot;
+    }
+
+    // Forward substitution: L * z = b, with b highest power first.
+    FIXED_UNROLL
+    for( int r = 0; r < coefficientCount; r++ )
+    {
+        double sum = pRhsSums[ degree - r ];
+        FIXED_UNROLL
+        for( int m = 0; m < r; m++ )
+        {
+            sum -= unitLower[r][m] * z[m];
+        }
+        z[r] = sum;
+    }
+
+    // Back substitution: (L)T * x = (D)^-1 * z.
+    FIXED_UNROLL
+    for( int r = degree; r >= 0; r-- )
+    {
+        double sum = z[r] * inversePivots[r];
+        FIXED_UNROLL
+        for( int m = r + 1; m < coefficientCount; m++ )
+        {
+            sum -= unitLower[m][r] * solution[m];
+        }
+        solution[r] = sum;
+    }
+    FIXED_UNROLL
+    for( int r = 0; r < coefficientCount; r++ )
+    {
+        coefficientResults[r] = solution[r];
+    }
+
+    return 0;
+}
+
+#ifdef POLYFIXED_X86
+//--------------------------------------------------------
+// batchAvx2()
+// polyfitFixedBatch() on a CPU with AVX2: one copy of
+// batchLanes() per coefficientCount.
+//--------------------------------------------------------
+__attribute__(( target( "avx2" ) ))
+static void batchAvx2( int coefficientCount, int seriesCount, int *seriesOffsets, double *xValues,
+                       double *yValues, double *coefficientResults, int *seriesStatus )
+{
+    switch( coefficientCount )
+    {
+        case 2:
+            batchLanes( 2, seriesCount, seriesOffsets, xValues, yValues, coefficientResults, seriesStatus );
+            break;
+        case 3:
+            batchLanes( 3, seriesCount, seriesOffsets, xValues, yValues, coefficientResults, seriesStatus );
+            break;
+        default:
+            batchLanes( 4, seriesCount, seriesOffsets, xValues, yValues, coefficientResults, seriesStatus );
+            break;
+    }
+}
+
+//--------------------------------------------------------
+// batchLanes()
+// Gathers the short series of a batch into groups of
+// FIXED_BATCH_LANES for fitLanes(). Longer series, those
+// too short to fit, and any left over at the end without
+// a full group are fitted one at a time by fitFixed().
+//--------------------------------------------------------
+FIXED_AVX2_INLINE void batchLanes( int coefficientCount, int seriesCount, int *seriesOffsets, double *xValues,
+                                   double *yValues, double *coefficientResults, int *seriesStatus )
+{
+    int laneSeries[ FIXED_BATCH_LANES ];
+    int laneCount = 0;
+
+    for( int s = 0; s < seriesCount; s++ )
+    {
+        int first = seriesOffsets[s];
+        int pointCount = seriesOffsets[s + 1] - first;
+
+        if( (pointCount >= coefficientCount) && (pointCount < FIXED_VECTOR_POINTS) )
+        {
+            laneSeries[ laneCount++ ] = s;
+            if( FIXED_BATCH_LANES == laneCount )
+            {
+                fitLanes( coefficientCount, laneSeries, seriesOffsets, xValues, yValues, coefficientResults,
+                          seriesStatus );
+                laneCount = 0;
+            }
+        }
+        else
+        {
+            seriesStatus[s] = fitFixed( coefficientCount, pointCount, &(xValues[ first ]), &(yValues[ first ]),
+                                        &(coefficientResults[ s * coefficientCount ]), NULL );
+        }
+    }
+
+    for( int l = 0; l < laneCount; l++ )
+    {
+        int s = laneSeries[l];
+        int first = seriesOffsets[s];
+        seriesStatus[s] = fitFixed( coefficientCount, seriesOffsets[s + 1] - first, &(xValues[ first ]),
+                                    &(yValues[ first ]), &(coefficientResults[ s * coefficientCount ]), NULL );
+    }
+}
+
+//--------------------------------------------------------
+// fitLanes()
+// Fits the series laneSeries[l], each in lane l of every
+// register. Four points of each are read at a time, for
+// as many as the shortest has, and turned into four
+// points across the lanes; the rest of the longer ones
+// are then added with zeros in the lanes of those that
+// have ended.
+//--------------------------------------------------------
+FIXED_AVX2_INLINE void fitLanes( int coefficientCount, int *laneSeries, int *seriesOffsets, double *xValues,
+                                 double *yValues, double *coefficientResults, int *seriesStatus )
+{
+    int powerSumCount = (2 * coefficientCount) - 1;
+    __m256d powerSums[2][ (2 * FIXED_MAX_COEFFICIENTS) - 1 ];
+    __m256d rhsSums[2][ FIXED_MAX_COEFFICIENTS ];
+    __m256d solution[ FIXED_MAX_COEFFICIENTS ];
+    double *laneX[ FIXED_BATCH_LANES ];
+    double *laneY[ FIXED_BATCH_LANES ];
+    int laneCounts[ FIXED_BATCH_LANES ];
+    int commonCount = FIXED_VECTOR_POINTS;
+    int longestCount = 0;
+
+    FIXED_UNROLL
+    for( int l = 0; l < FIXED_BATCH_LANES; l++ )
+    {
+        int first = seriesOffsets[ laneSeries[l] ];
+        laneX[l] = &(xValues[ first ]);
+        laneY[l] = &(yValues[ first ]);
+        laneCounts[l] = seriesOffsets[ laneSeries[l] + 1 ] - first;
+        commonCount = (laneCounts[l] < commonCount) ? laneCounts[l] : commonCount;
+        longestCount = (laneCounts[l] > longestCount) ? laneCounts[l] : longestCount;
+    }
+    FIXED_UNROLL
+    for( int j = 0; j < powerSumCount; j++ )
+    {
+        powerSums[0][j] = _mm256_setzero_pd();
+        powerSums[1][j] = _mm256_setzero_pd();
+    }
+    FIXED_UNROLL
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        rhsSums[0][j] = _mm256_setzero_pd();
+        rhsSums[1][j] = _mm256_setzero_pd();
+    }
+
+    // Even points go into the first set of sums and odd points into the
+    // second, as sumFixed() adds them, so every lane's sums, and so its
+    // coefficients, are those polyfitFixed() would give.
+    int i = 0;
+    for( ; (i + FIXED_BATCH_LANES) <= commonCount; i += FIXED_BATCH_LANES )
+    {
+        __m256d x[ FIXED_BATCH_LANES ];
+        __m256d y[ FIXED_BATCH_LANES ];
+
+        FIXED_UNROLL
+        for( int l = 0; l < FIXED_BATCH_LANES; l++ )
+        {
+            x[l] = _mm256_loadu_pd( &(laneX[l][i]) );
+            y[l] = _mm256_loadu_pd( &(laneY[l][i]) );
+        }
+        transposeLanes( x );
+        transposeLanes( y );
+        FIXED_UNROLL
+        for( int p = 0; p < FIXED_BATCH_LANES; p++ )
+        {
+            addLanes( coefficientCount, _mm256_set1_pd( 1.0 ), x[p], y[p], powerSums[ p % 2 ], rhsSums[ p % 2 ] );
+        }
+    }
+    for( ; i < longestCount; i++ )
+    {
+        __m256d power = _mm256_set1_pd( 1.0 );
+        __m256d x;
+        __m256d y;
+
+        if( i < commonCount )
+        {
+            x = _mm256_set_pd( laneX[3][i], laneX[2][i], laneX[1][i], laneX[0][i] );
+            y = _mm256_set_pd( laneY[3][i], laneY[2][i], laneY[1][i], laneY[0][i] );
+        }
+        else
+        {
+            double weights[ FIXED_BATCH_LANES ];
+            double xLanes[ FIXED_BATCH_LANES ];
+            double yLanes[ FIXED_BATCH_LANES ];
+
+            FIXED_UNROLL
+            for( int l = 0; l < FIXED_BATCH_LANES; l++ )
+            {
+                bool inSeries = (i < laneCounts[l]);
+                weights[l] = inSeries ? 1.0 : 0.0;
+                xLanes[l] = inSeries ? laneX[l][i] : 0.0;
+                yLanes[l] = inSeries ? laneY[l][i] : 0.0;
+            }
+            power = _mm256_loadu_pd( weights );
+            x = _mm256_loadu_pd( xLanes );
+            y = _mm256_loadu_pd( yLanes );
+        }
+
+        if( 0 == (i % 2) )
+        {
+            addLanes( coefficientCount, power, x, y, powerSums[0], rhsSums[0] );
+        }
+        else
+        {
+            addLanes( coefficientCount, power, x, y, powerSums[1], rhsSums[1] );
+        }
+    }
+    FIXED_UNROLL
+    for( int j = 0; j < powerSumCount; j++ )
+    {
+        powerSums[0][j] = _mm256_add_pd( powerSums[0][j], powerSums[1][j] );
+    }
+    FIXED_UNROLL
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        rhsSums[0][j] = _mm256_add_pd( rhsSums[0][j], rhsSums[1][j] );
+    }
+
+    int solvedMask = solveLanes( coefficientCount, powerSums[0], rhsSums[0], solution );
+
+    FIXED_UNROLL
+    for( int r = 0; r < coefficientCount; r++ )
+    {
+        double laneValues[ FIXED_BATCH_LANES ];
+        _mm256_storeu_pd( laneValues, solution[r] );
+        FIXED_UNROLL
+        for( int l = 0; l < FIXED_BATCH_LANES; l++ )
+        {
+            coefficientResults[ (laneSeries[l] * coefficientCount) + r ] = laneValues[l];
+        }
+    }
+    FIXED_UNROLL
+    for( int l = 0; l < FIXED_BATCH_LANES; l++ )
+    {
+        seriesStatus[ laneSeries[l] ] = (solvedMask & (1 << l)) ? 0 : -4;
+    }
+}
+
+//--------------------------------------------------------
+// transposeLanes()
+// Turns four registers, each holding four consecutive
+// points of one series, into four registers each holding
+// one point of every series, lane l from series l.
+//--------------------------------------------------------
+FIXED_AVX2_INLINE void transposeLanes( __m256d *pRows )
+{
+    __m256d low01 = _mm256_unpacklo_pd( pRows[0], pRows[1] );      // Points 0 and 2 of series 0 and 1.
+    __m256d high01 = _mm256_unpackhi_pd( pRows[0], pRows[1] );     // Points 1 and 3.
+    __m256d low23 = _mm256_unpacklo_pd( pRows[2], pRows[3] );
+    __m256d high23 = _mm256_unpackhi_pd( pRows[2], pRows[3] );
+
+    pRows[0] = _mm256_permute2f128_pd( low01, low23, 0x20 );
+    pRows[1] = _mm256_permute2f128_pd( high01, high23, 0x20 );
+    pRows[2] = _mm256_permute2f128_pd( low01, low23, 0x31 );
+    pRows[3] = _mm256_permute2f128_pd( high01, high23, 0x31 );
+}
+
+//--------------------------------------------------------
+// addLanes()
+// Adds one point per lane into the power sums and right
+// hand side sums. The powers start from power, which is
+// zero in a lane that has no point to add.
+//--------------------------------------------------------
+FIXED_AVX2_INLINE void addLanes( int coefficientCount, __m256d power, __m256d x, __m256d y, __m256d *pPowerSums,
+                                 __m256d *pRhsSums )
+{
+    FIXED_UNROLL
+    for( int j = 0; j < (2 * coefficientCount) - 1; j++ )
+    {
+        pPowerSums[j] = _mm256_add_pd( pPowerSums[j], power );
+        if( j < coefficientCount )
+        {
+            pRhsSums[j] = _mm256_add_pd( pRhsSums[j], _mm256_mul_pd( power, y ));
+        }
+        power = _mm256_mul_pd( power, x );
+    }
+}
+
+//--------------------------------------------------------
+// solveLanes()
+// The same factorization and substitutions as
+// solveFixed(), a series to a lane. A lane whose pivot is
+// refused goes on with a pivot of 1, so the others are
+// unaffected, and its solution is not used.
+//
+// Returns a mask with bit l set if lane l was solved.
+//--------------------------------------------------------
+FIXED_AVX2_INLINE int solveLanes( int coefficientCount, __m256d *pPowerSums, __m256d *pRhsSums,
+                                  __m256d *pSolution )
+{
+    int degree = coefficientCount - 1;
+    __m256d unitLower[ FIXED_MAX_COEFFICIENTS ][ FIXED_MAX_COEFFICIENTS ];
+    __m256d scaledLower[ FIXED_MAX_COEFFICIENTS ][ FIXED_MAX_COEFFICIENTS ];    // L * D, below the diagonal.
+    __m256d inversePivots[ FIXED_MAX_COEFFICIENTS ];
+    __m256d z[ FIXED_MAX_COEFFICIENTS ];
+    __m256d one = _mm256_set1_pd( 1.0 );
+    __m256d tolerance = _mm256_set1_pd( coefficientCount * DBL_EPSILON );
+    int solvedMask = (1 << FIXED_BATCH_LANES) - 1;
+
+    FIXED_UNROLL
+    for( int r = 0; r < coefficientCount; r++ )
+    {
+        FIXED_UNROLL
+        for( int c = 0; c < r; c++ )
+        {
+            __m256d sum = pPowerSums[ (2 * degree) - r - c ];
+            FIXED_UNROLL
+            for( int m = 0; m < c; m++ )
+            {
+                sum = _mm256_sub_pd( sum, _mm256_mul_pd( scaledLower[r][m], unitLower[c][m] ));
+            }
+            scaledLower[r][c] = sum;
+            unitLower[r][c] = _mm256_mul_pd( sum, inversePivots[c] );
+        }
+
+        __m256d diagonal = pPowerSums[ (2 * degree) - (2 * r) ];
+        __m256d pivot = diagonal;
+        FIXED_UNROLL
+        for( int m = 0; m < r; m++ )
+        {
+            pivot = _mm256_sub_pd( pivot, _mm256_mul_pd( scaledLower[r][m], unitLower[r][m] ));
+        }
+        // An ordered compare, so a NaN pivot is refused, as in solveFixed().
+        __m256d accepted = _mm256_cmp_pd( pivot, _mm256_mul_pd( tolerance, diagonal ), _CMP_GT_OQ );
+        solvedMask &= _mm256_movemask_pd( accepted );
+        inversePivots[r] = _mm256_div_pd( one, _mm256_blendv_pd( one, pivot, accepted ));
+    }
+
+    FIXED_UNROLL
+    for( int r = 0; r < coefficientCount; r++ )
+    {
+        __m256d sum = pRhsSums[ degree - r ];
+        FIXED_UNROLL
+        for( int m = 0; m < r; m++ )
+        {
+            sum = _mm256_sub_pd( sum, _mm256_mul_pd( unitLower[r][m], z[m] ));
+        }
+        z[r] = sum;
+    }
+
+    FIXED_UNROLL
+    for( int r = degree; r >= 0; r-- )
+    {
+        __m256d sum = _mm256_mul_pd( z[r], inversePivots[r] );
+        FIXED_UNROLL
+        for( int m = r + 1; m < coefficientCount; m++ )
+        {
+            sum = _mm256_sub_pd( sum, _mm256_mul_pd( unitLower[m][r], pSolution[m] ));
+        }
+        pSolution[r] = sum;
+    }
+
+    return solvedMask;
+}
+#endif  // POLYFIXED_X86
@@ -0,0 +1,290 @@
+// Name: polyfloat.c
+// Description: Single and mixed precision fitting of float data.
+// Author: Henry M. Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+#include <math.h>       // fabs(), fmax(), HUGE_VAL
+#include <stdbool.h>    // bool
+
+#include "polyfit_internal.h"
+
+// polyfitf_mixed() stops refining once a correction is no larger than
+// this fraction of the largest coefficient. It gives up on a set of
+// sums once a correction is more than MIXED_MIN_SHRINK times the one
+// before, since starting again from double sums then takes fewer
+// passes, or after MIXED_MAX_REFINEMENTS corrections.
+#define MIXED_TOLERANCE         (1e-13)
+#define MIXED_MIN_SHRINK        (0.1)
+#define MIXED_MAX_REFINEMENTS   (30)
+
+
+//------------------------------------------------
+// Private Function Prototypes
+//------------------------------------------------
+
+static int      fitFloatSums( int pointCount, float *xValues, float *yValues, int coefficientCount,
+                              double *pTemp, double *coefficientResults );
+static int      refine( int pointCount, float *xValues, float *yValues, int coefficientCount, double *pTemp,
+                        double *coefficientResults, bool *pConverged );
+
+
+//=========================================================
+//      Global function definitions
+//=========================================================
+
+
+//--------------------------------------------------------
+// polyfitf()
+// Same as polyfit(), for float data. The power sums are
+// computed in float vector lanes, which hold twice as
+// many points per instruction as double ones, and added
+// into double sums every few hundred points. The normal
+// equations are solved in double, and the coefficients
+// rounded to float.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < coefficientCount),
+//          -3 if unable to allocate memory,
+//          -4 if unable to solve equations,
+//          -5 if coefficientCount < 1.
+//--------------------------------------------------------
+int polyfitf( int pointCount, float *xValues, float *yValues, int coefficientCount, float *coefficientResults )
+{
+    int rVal = 0;
+
+    if( (NULL == xValues) || (NULL == yValues) || (NULL == coefficientResults) )
+    {
+        return -1;
+    }
+    if( pointCount < coefficientCount )
+    {
+        return -2;
+    }
+    if( coefficientCount < 1 )
+    {
+        return -5;
+    }
+
+    // The sums, the solver's scratch, then the double coefficients.
+    int tempCount = ((3 * coefficientCount) - 1) + (coefficientCount * (coefficientCount + 1));
+    double *pTemp = (double *) polyfitCalloc( tempCount + coefficientCount, sizeof( double ));
+    if( NULL == pTemp )
+    {
+        return -3;
+    }
+
+    double *pResults = &(pTemp[ tempCount ]);
+    rVal = fitFloatSums( pointCount, xValues, yValues, coefficientCount, pTemp, pResults );
+    if( 0 == rVal )
+    {
+        for( int c = 0; c < coefficientCount; c++ )
+        {
+            coefficientResults[c] = (float) pResults[c];
+        }
+    }
+    polyfitFree( pTemp );
+
+    return rVal;
+}
+
+//--------------------------------------------------------
+// polyfitf_mixed()
+// Fits float data to double precision accuracy, with
+// mixed precision iterative refinement.
+//
+// A first fit is made as in polyfitf(). Its residuals,
+// y - p(x), are then computed in double, along with their
+// right hand side sums, and the normal equations from the
+// float pass are solved again for a correction to the
+// coefficients. Because the residuals are exact to double
+// precision, the corrections converge on the double
+// precision fit, as long as the float sums are close
+// enough to the double ones for the correction to shrink
+// each time. Each correction costs one more pass over the
+// points, so this is slower than polyfitf(), but needs
+// no double copy of the data.
+//
+// When the equations are too ill conditioned for the float
+// sums, as with higher degrees on data far from [-1, 1],
+// the corrections stop shrinking, or the float sums can't
+// be solved at all. The power sums are then taken again
+// from the points widened to double, and the fit from them
+// refined in the same way, so the result is never less
+// accurate than that of polyfit().
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < coefficientCount),
+//          -3 if unable to allocate memory,
+//          -4 if unable to solve equations,
+//          -5 if coefficientCount < 1.
+//--------------------------------------------------------
+int polyfitf_mixed( int pointCount, float *xValues, float *yValues, int coefficientCount,
+                    double *coefficientResults )
+{
+    int rVal = 0;
+
+    if( (NULL == xValues) || (NULL == yValues) || (NULL == coefficientResults) )
+    {
+        return -1;
+    }
+    if( pointCount < coefficientCount )
+    {
+        return -2;
+    }
+    if( coefficientCount < 1 )
+    {
+        return -5;
+    }
+
+    // The sums and the solver's scratch, then the correction.
+    int tempCount = ((3 * coefficientCount) - 1) + (coefficientCount * (coefficientCount + 1));
+    double *pTemp = (double *) polyfitCalloc( tempCount + coefficientCount, sizeof( double ));
+    if( NULL == pTemp )
+    {
+        return -3;
+    }
+
+    bool converged = false;
+    rVal = fitFloatSums( pointCount, xValues, yValues, coefficientCount, pTemp, coefficientResults );
+    if( 0 == rVal )
+    {
+        rVal = refine( pointCount, xValues, yValues, coefficientCount, pTemp, coefficientResults, &converged );
+    }
+
+    // The float sums are too coarse for these equations: start again
+    // from double sums, which the refinement can only improve on.
+    if( ((0 == rVal) || (-4 == rVal)) && !converged )
+    {
+        double *pPowerSums = pTemp;
+        double *pRhsSums = &(pPowerSums[ (2 * coefficientCount) - 1 ]);
+        double *pScratch = &(pRhsSums[ coefficientCount ]);
+
+        for( int j = 0; j < ((3 * coefficientCount) - 1); j++ )
+        {
+            pPowerSums[j] = 0.0;
+        }
+        polyfitKernelPowerSumsWidened( coefficientCount, pointCount, xValues, yValues, pPowerSums, pRhsSums );
+        rVal = polyfitSolveSums( POLYFIT_SOLVER_CHOLESKY, coefficientCount, pPowerSums, pRhsSums, pScratch,
+                                 coefficientResults );
+        if( 0 == rVal )
+        {
+            rVal = refine( pointCount, xValues, yValues, coefficientCount, pTemp, coefficientResults, &converged );
+        }
+    }
+    polyfitFree( pTemp );
+
+    return rVal;
+}
+
+
+//=========================================================
+//      Private function definitions
+//=========================================================
+
+//--------------------------------------------------------
+// fitFloatSums()
+// Computes the power sums of float points into pTemp,
+// which must hold (3 * coefficientCount - 1) sums and
+// (coefficientCount * (coefficientCount + 1)) doubles of
+// scratch, and solves them into double coefficients. The
+// power sums are left in pTemp for refinement.
+//
+// Returns   0 if success,
+//          -4 if unable to solve equations.
+//--------------------------------------------------------
+static int fitFloatSums( int pointCount, float *xValues, float *yValues, int coefficientCount,
+                         double *pTemp, double *coefficientResults )
+{
+    double *pPowerSums = pTemp;
+    double *pRhsSums = &(pPowerSums[ (2 * coefficientCount) - 1 ]);
+    double *pScratch = &(pRhsSums[ coefficientCount ]);
+
+    polyfitKernelPowerSumsFloat( coefficientCount, pointCount, xValues, yValues, pPowerSums, pRhsSums );
+    return polyfitSolveSums( POLYFIT_SOLVER_CHOLESKY, coefficientCount, pPowerSums, pRhsSums, pScratch,
+                             coefficientResults );
+}
+
+//--------------------------------------------------------
+// refine()
+// Refines coefficientResults with the power sums at the
+// start of pTemp, laid out as by fitFloatSums(), with the
+// correction after the solver's scratch, while each
+// correction is at most MIXED_MIN_SHRINK times the one
+// before. A correction that isn't is left out.
+// *pConverged is set true once a correction is within
+// MIXED_TOLERANCE of the largest coefficient.
+//
+// Returns   0 if success,
+//          -4 if unable to solve equations.
+//--------------------------------------------------------
+static int refine( int pointCount, float *xValues, float *yValues, int coefficientCount, double *pTemp,
+                   double *coefficientResults, bool *pConverged )
+{
+    int rVal = 0;
+    double *pPowerSums = pTemp;
+    double *pRhsSums = &(pPowerSums[ (2 * coefficientCount) - 1 ]);
+    double *pScratch = &(pRhsSums[ coefficientCount ]);
+    double *pCorrection = &(pScratch[ coefficientCount * (coefficientCount + 1) ]);
+    double lastCorrection = HUGE_VAL;
+
+    *pConverged = false;
+    for( int step = 0; (0 == rVal) && (step < MIXED_MAX_REFINEMENTS); step++ )
+    {
+        for( int j = 0; j < coefficientCount; j++ )
+        {
+            pRhsSums[j] = 0.0;
+        }
+        polyfitKernelResidualSums( coefficientCount, pointCount, xValues, yValues, coefficientResults, pRhsSums );
+        rVal = polyfitSolveSums( POLYFIT_SOLVER_CHOLESKY, coefficientCount, pPowerSums, pRhsSums, pScratch,
+                                 pCorrection );
+
+        double largestCoefficient = 0.0;
+        double largestCorrection = 0.0;
+        for( int c = 0; (0 == rVal) && (c < coefficientCount); c++ )
+        {
+            largestCoefficient = fmax( largestCoefficient, fabs( coefficientResults[c] + pCorrection[c] ));
+            largestCorrection = fmax( largestCorrection, fabs( pCorrection[c] ));
+        }
+        if( (0 != rVal) || (largestCorrection > MIXED_MIN_SHRINK * lastCorrection) )
+        {
+            break;
+        }
+        for( int c = 0; c < coefficientCount; c++ )
+        {
+            coefficientResults[c] += pCorrection[c];
+        }
+        if( largestCorrection <= MIXED_TOLERANCE * largestCoefficient )
+        {
+            *pConverged = true;
+            break;
+        }
+        lastCorrection = largestCorrection;
+    }
+
+    return rVal;
+}
@@ -0,0 +1,211 @@
+// Name: polygoodness.c
+// Description: Goodness of fit and coefficient standard errors from the normal equations.
+// Author: Henry M. Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+#include <math.h>       // sqrt(), NAN
+
+#include "polyfit_internal.h"
+
+
+//------------------------------------------------
+// Private Function Prototypes
+//------------------------------------------------
+
+static void     describeFit( polyfit_accum_t *pAccum, double *coefficientResults, polyfit_goodness_t *pGoodness );
+
+
+//=========================================================
+//      Global function definitions
+//=========================================================
+
+
+//--------------------------------------------------------
+// polyfit_goodness()
+// Same as polyfit(), and also fills *pGoodness with the
+// sum of squared residuals, R^2, adjusted R^2 and residual
+// variance, and, unless standardErrors is NULL, stores the
+// standard error of each coefficient there, highest power
+// first like the coefficients.
+//
+// The points are read only once. Besides the power sums,
+// the kernels also sum y^2, and everything else follows
+// from the normal equations; see polyfit_accum_goodness().
+// The fit is solved by Cholesky, so for 2 to 4
+// coefficients it may differ from polyfit()'s by rounding.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < coefficientCount),
+//          -3 if unable to allocate memory,
+//          -4 if unable to solve equations,
+//          -5 if coefficientCount < 1.
+//--------------------------------------------------------
+int polyfit_goodness( int pointCount, double *xValues, double *yValues, int coefficientCount,
+                      double *coefficientResults, double *standardErrors, polyfit_goodness_t *pGoodness )
+{
+    int rVal = 0;
+    polyfit_accum_t accum;
+
+    if( (NULL == xValues) || (NULL == yValues) || (NULL == coefficientResults) || (NULL == pGoodness) )
+    {
+        return -1;
+    }
+    if( pointCount < coefficientCount )
+    {
+        return -2;
+    }
+
+    rVal = polyfit_accum_init( &accum, coefficientCount );
+    if( 0 == rVal )
+    {
+        rVal = polyfit_accum_add_many( &accum, pointCount, xValues, yValues );
+    }
+    if( 0 == rVal )
+    {
+        rVal = polyfit_accum_goodness( &accum, coefficientResults, standardErrors, pGoodness );
+    }
+    polyfit_accum_free( &accum );
+
+    return rVal;
+}
+
+//--------------------------------------------------------
+// polyfit_accum_goodness()
+// Same as polyfit_accum_solve(), and also reports the
+// goodness of fit of all the points added so far, as
+// polyfit_goodness() does.
+//
+// With c the coefficients, the least squares solution of
+// (AT)A c = (AT)b, the sum of squared residuals is
+//      |b - Ac|^2 = (b)T b - (c)T (AT)b,
+// where (b)T b is the accumulator's sum of y^2, and the
+// total sum of squares is that less (sum of y)^2 / n. The
+// covariance of the coefficients is the residual variance
+// times the inverse of (AT)A, whose diagonal comes from
+// k more solves with the Cholesky factor of the fit.
+//
+// Both sums of squares are differences of large sums, so
+// an SSE below about 1e-15 of the sum of y^2 is rounding
+// noise; negative results are taken as 0.
+//
+// The accumulator is left unchanged.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < coefficientCount),
+//          -3 if unable to allocate memory,
+//          -4 if unable to solve equations.
+//--------------------------------------------------------
+int polyfit_accum_goodness( polyfit_accum_t *pAccum, double *coefficientResults, double *standardErrors,
+                            polyfit_goodness_t *pGoodness )
+{
+    int rVal = 0;
+
+    if( (NULL == pAccum) || (NULL == pAccum->pPowerSums) || (NULL == coefficientResults) || (NULL == pGoodness) )
+    {
+        return -1;
+    }
+    if( pAccum->pointCount < pAccum->coefficientCount )
+    {
+        return -2;
+    }
+
+    int coefficientCount = pAccum->coefficientCount;
+    int degree = coefficientCount - 1;
+    int factorCount = (coefficientCount * (coefficientCount + 1)) / 2;
+    double *pTemp = (double *) polyfitCalloc( factorCount + (2 * coefficientCount), sizeof( double ));
+    if( NULL == pTemp )
+    {
+        return -3;
+    }
+
+    double *pFactor = pTemp;
+    double *pRhs = &(pFactor[ factorCount ]);           // Highest power first; overwritten by each solve.
+    double *pColumn = &(pRhs[ coefficientCount ]);      // A column of the inverse of (AT)A.
+
+    rVal = polyfitCholeskyFactor( coefficientCount, pAccum->pPowerSums, pFactor );
+    if( 0 == rVal )
+    {
+        for( int r = 0; r < coefficientCount; r++ )
+        {
+            pRhs[r] = pAccum->pRhsSums[ degree - r ];
+        }
+        polyfitCholeskySolve( coefficientCount, pFactor, pRhs, coefficientResults );
+        describeFit( pAccum, coefficientResults, pGoodness );
+
+        for( int j = 0; (NULL != standardErrors) && (j < coefficientCount); j++ )
+        {
+            for( int r = 0; r < coefficientCount; r++ )
+            {
+                pRhs[r] = (r == j) ? 1.0 : 0.0;
+            }
+            polyfitCholeskySolve( coefficientCount, pFactor, pRhs, pColumn );
+            standardErrors[j] = sqrt( pGoodness->residualVariance * pColumn[j] );
+        }
+    }
+
+    polyfitFree( pTemp );
+    return rVal;
+}
+
+
+//=========================================================
+//      Private function definitions
+//=========================================================
+
+//--------------------------------------------------------
+// describeFit()
+// Fills *pGoodness for solved coefficients from the
+// accumulator's sums.
+//--------------------------------------------------------
+static void describeFit( polyfit_accum_t *pAccum, double *coefficientResults, polyfit_goodness_t *pGoodness )
+{
+    int degree = pAccum->coefficientCount - 1;
+    double pointCount = (double) pAccum->pointCount;
+    long long degreesOfFreedom = pAccum->pointCount - pAccum->coefficientCount;
+
+    double explained = 0.0;             // (c)T (AT)b
+    for( int r = 0; r <= degree; r++ )
+    {
+        explained += coefficientResults[r] * pAccum->pRhsSums[ degree - r ];
+    }
+    double ySum = pAccum->pRhsSums[0];
+    double sst = fmax( pAccum->ySquareSum - ((ySum * ySum) / pointCount), 0.0 );
+
+    // The constant term makes the fit at least as good as the mean, so the
+    // SSE never really exceeds the SST.
+    double sse = fmin( fmax( pAccum->ySquareSum - explained, 0.0 ), sst );
+
+    pGoodness->pointCount = pAccum->pointCount;
+    pGoodness->degreesOfFreedom = degreesOfFreedom;
+    pGoodness->sse = sse;
+    pGoodness->sst = sst;
+    pGoodness->rSquared = (sst > 0.0) ? 1.0 - (sse / sst) : NAN;
+    pGoodness->adjustedRSquared = ((sst > 0.0) && (degreesOfFreedom > 0)) ?
+                                  1.0 - ((sse / sst) * (pointCount - 1.0) / (double) degreesOfFreedom) : NAN;
+    pGoodness->residualVariance = (degreesOfFreedom > 0) ? sse / (double) degreesOfFreedom : NAN;
+}
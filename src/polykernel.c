@@ -0,0 +1,1733 @@
+// Name: polykernel.c
+// Description: Vector kernels for polynomial fitting, with runtime CPU dispatch.
+// Author: Henry M. Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+#include <stdlib.h>     // NULL
+
+#include "polyfit_internal.h"
+
+// The vector kernels are built with per-function target attributes, so the
+// whole file compiles without -mavx flags and runs on any x86 host; which
+// kernel is used is decided at run time from the CPUID feature bits.
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define POLYKERNEL_X86 1
+#include <immintrin.h>
+#endif  // __x86_64__ || __i386__
+
+// The vector kernels keep one register-sized accumulator per sum on the
+// stack, so they handle up to this many coefficients and hand larger fits
+// to the scalar kernel.
+#define KERNEL_MAX_COEFFICIENTS  (32)
+#define KERNEL_MAX_SUMS          ((2 * KERNEL_MAX_COEFFICIENTS) - 1)
+
+// The float kernels add points into float lanes for at most this many
+// points at a time, then add the lanes into the double sums, so the
+// rounding error of the float adds doesn't grow with the point count.
+#define FLOAT_BLOCK_POINTS       (256)
+
+// The dot product kernels take this many value arrays per pass over the
+// weights: 8 vector accumulators, leaving registers for the weights.
+#define KERNEL_DOT_BLOCK         (4)
+
+// MXCSR flush-to-zero and denormals-are-zero bits.
+#define FLUSH_DENORMALS_CSR      (0x8040u)
+
+// Signature shared by all of the power sum kernels.
+typedef void (*powerSumsFn_t)( int coefficientCount, int pointCount, double *xValues, double *yValues,
+                               double *pPowerSums, double *pRhsSums, double *pYSquareSum );
+
+
+//------------------------------------------------
+// Private Function Prototypes
+//------------------------------------------------
+
+static void             powerSumsScalar( int coefficientCount, int pointCount, double *xValues, double *yValues,
+                                         double *pPowerSums, double *pRhsSums, double *pYSquareSum );
+#ifdef POLYKERNEL_X86
+static void             powerSumsSse2( int coefficientCount, int pointCount, double *xValues, double *yValues,
+                                       double *pPowerSums, double *pRhsSums, double *pYSquareSum );
+static void             powerSumsAvx2( int coefficientCount, int pointCount, double *xValues, double *yValues,
+                                       double *pPowerSums, double *pRhsSums, double *pYSquareSum );
+static void             powerSumsAvx512( int coefficientCount, int pointCount, double *xValues, double *yValues,
+                                         double *pPowerSums, double *pRhsSums, double *pYSquareSum );
+#endif  // POLYKERNEL_X86
+static powerSumsFn_t    powerSumsFor( polyfit_kernel_t kernel );
+static void             powerSumsFloatScalar( powerSumsFn_t pKernel, int coefficientCount, int pointCount,
+                                              float *xValues, float *yValues, double *pPowerSums, double *pRhsSums );
+static void             uniformRhsSumsScalar( int coefficientCount, int pointCount, double indexOffset, double xScale,
+                                              double *yValues, double *pRhsSums );
+#ifdef POLYKERNEL_X86
+static void             uniformRhsSumsAvx2( int coefficientCount, int pointCount, double indexOffset, double xScale,
+                                            double *yValues, double *pRhsSums );
+static void             uniformRhsSumsAvx512( int coefficientCount, int pointCount, double indexOffset, double xScale,
+                                              double *yValues, double *pRhsSums );
+#endif  // POLYKERNEL_X86
+static void             dotsScalar( int count, double *weights, double *pValues, int valueCount, size_t valueStride,
+                                    double *pSums );
+#ifdef POLYKERNEL_X86
+static void             dotsAvx2( int count, double *weights, double *pValues, int valueCount, size_t valueStride,
+                                  double *pSums );
+static void             dotsAvx512( int count, double *weights, double *pValues, int valueCount, size_t valueStride,
+                                    double *pSums );
+#endif  // POLYKERNEL_X86
+static void             residualSumsScalar( int coefficientCount, int pointCount, float *xValues, float *yValues,
+                                            double *coefficients, double *pRhsSums );
+#ifdef POLYKERNEL_X86
+static void             residualSumsAvx2( int coefficientCount, int pointCount, float *xValues, float *yValues,
+                                          double *coefficients, double *pRhsSums );
+static void             residualSumsAvx512( int coefficientCount, int pointCount, float *xValues, float *yValues,
+                                            double *coefficients, double *pRhsSums );
+static void             powerSumsFloatAvx2( int coefficientCount, int pointCount, float *xValues, float *yValues,
+                                            double *pPowerSums, double *pRhsSums );
+static void             powerSumsFloatAvx512( int coefficientCount, int pointCount, float *xValues, float *yValues,
+                                              double *pPowerSums, double *pRhsSums );
+#endif  // POLYKERNEL_X86
+static void             convolveScalar( int outputCount, double *inValues, double *weights, int weightCount,
+                                        double *outValues );
+#ifdef POLYKERNEL_X86
+static void             convolveAvx2( int outputCount, double *inValues, double *weights, int weightCount,
+                                      double *outValues );
+static void             convolveAvx512( int outputCount, double *inValues, double *weights, int weightCount,
+                                        double *outValues );
+#endif  // POLYKERNEL_X86
+static void             evaluateScalar( int coefficientCount, double *coefficients, int pointCount, double *xValues,
+                                        double *yValues, double *firstDerivatives, double *secondDerivatives );
+#ifdef POLYKERNEL_X86
+static void             evaluateAvx2( int coefficientCount, double *coefficients, int pointCount, double *xValues,
+                                      double *yValues, double *firstDerivatives, double *secondDerivatives );
+static void             evaluateAvx512( int coefficientCount, double *coefficients, int pointCount, double *xValues,
+                                        double *yValues, double *firstDerivatives, double *secondDerivatives );
+#endif  // POLYKERNEL_X86
+
+
+//=========================================================
+//      Global function definitions
+//=========================================================
+
+
+//--------------------------------------------------------
+// polyfit_kernel_detect()
+// Returns the fastest power sum kernel that the CPU
+// supports. The CPUID query runs once; later calls
+// return the cached answer.
+//--------------------------------------------------------
+polyfit_kernel_t polyfit_kernel_detect( void )
+{
+    static int detected = (int) POLYFIT_KERNEL_AUTO;   // AUTO until the CPU has been queried.
+
+    int kernel = __atomic_load_n( &detected, __ATOMIC_RELAXED );
+    if( (int) POLYFIT_KERNEL_AUTO == kernel )
+    {
+        kernel = (int) POLYFIT_KERNEL_SCALAR;
+#ifdef POLYKERNEL_X86
+        // __builtin_cpu_supports() reads the CPUID feature bits, and also
+        // checks that the OS saves the wider registers on context switches.
+        __builtin_cpu_init();
+        if( __builtin_cpu_supports( "avx512f" ) )
+        {
+            kernel = (int) POLYFIT_KERNEL_AVX512;
+        }
+        else if( __builtin_cpu_supports( "avx2" ) )
+        {
+            kernel = (int) POLYFIT_KERNEL_AVX2;
+        }
+        else if( __builtin_cpu_supports( "sse2" ) )
+        {
+            kernel = (int) POLYFIT_KERNEL_SSE2;
+        }
+#endif  // POLYKERNEL_X86
+        __atomic_store_n( &detected, kernel, __ATOMIC_RELAXED );
+    }
+    return (polyfit_kernel_t) kernel;
+}
+
+//--------------------------------------------------------
+// polyfit_kernel_supported()
+// Returns true if the given kernel can run on this CPU.
+//--------------------------------------------------------
+bool polyfit_kernel_supported( polyfit_kernel_t kernel )
+{
+    return (kernel >= POLYFIT_KERNEL_AUTO) && (kernel <= polyfit_kernel_detect());
+}
+
+//--------------------------------------------------------
+// polyfit_kernel_name()
+// Returns a printable name for a kernel.
+//--------------------------------------------------------
+const char *polyfit_kernel_name( polyfit_kernel_t kernel )
+{
+    switch( kernel )
+    {
+        case POLYFIT_KERNEL_AUTO:   return "auto";
+        case POLYFIT_KERNEL_SCALAR: return "scalar";
+        case POLYFIT_KERNEL_SSE2:   return "sse2";
+        case POLYFIT_KERNEL_AVX2:   return "avx2";
+        case POLYFIT_KERNEL_AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+//--------------------------------------------------------
+// polyfit_power_sums()
+// Adds the power sums of an array of points into
+// pPowerSums, which holds (2 * coefficientCount - 1) sums
+// of x^j, and pRhsSums, which holds coefficientCount sums
+// of (x^j * y), both in ascending order of j.
+//
+// The vector kernels add the points in a different order
+// from the scalar kernel, so the sums may differ from it
+// by a few units in the last place.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -5 if a count is out of range or the kernel
+//             is not supported by this CPU.
+//--------------------------------------------------------
+int polyfit_power_sums( polyfit_kernel_t kernel, int pointCount, double *xValues, double *yValues,
+                        int coefficientCount, double *pPowerSums, double *pRhsSums )
+{
+    if( (NULL == xValues) || (NULL == yValues) || (NULL == pPowerSums) || (NULL == pRhsSums) )
+    {
+        return -1;
+    }
+    if( (pointCount < 0) || (coefficientCount < 1) || !polyfit_kernel_supported( kernel ) )
+    {
+        return -5;
+    }
+
+    powerSumsFor( kernel )( coefficientCount, pointCount, xValues, yValues, pPowerSums, pRhsSums, NULL );
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfitKernelPowerSums()
+// Adds the power sums of an array of points using the
+// fastest kernel the CPU supports, and the sum of y^2
+// into *pYSquareSum unless it is NULL.
+//--------------------------------------------------------
+void polyfitKernelPowerSums( int coefficientCount, int pointCount, double *xValues, double *yValues,
+                             double *pPowerSums, double *pRhsSums, double *pYSquareSum )
+{
+    powerSumsFor( POLYFIT_KERNEL_AUTO )( coefficientCount, pointCount, xValues, yValues, pPowerSums, pRhsSums,
+                                         pYSquareSum );
+}
+
+//--------------------------------------------------------
+// polyfitKernelPowerSumsFloat()
+// Adds the power sums of an array of float points using
+// the fastest float kernel the CPU supports. SSE2 hosts
+// use the scalar kernel.
+//--------------------------------------------------------
+void polyfitKernelPowerSumsFloat( int coefficientCount, int pointCount, float *xValues, float *yValues,
+                                  double *pPowerSums, double *pRhsSums )
+{
+    switch( polyfit_kernel_detect() )
+    {
+#ifdef POLYKERNEL_X86
+        case POLYFIT_KERNEL_AVX512:
+            powerSumsFloatAvx512( coefficientCount, pointCount, xValues, yValues, pPowerSums, pRhsSums );
+            break;
+        case POLYFIT_KERNEL_AVX2:
+            powerSumsFloatAvx2( coefficientCount, pointCount, xValues, yValues, pPowerSums, pRhsSums );
+            break;
+#endif  // POLYKERNEL_X86
+        default:
+            powerSumsFloatScalar( powerSumsScalar, coefficientCount, pointCount, xValues, yValues, pPowerSums,
+                                  pRhsSums );
+            break;
+    }
+}
+
+//--------------------------------------------------------
+// polyfitKernelPowerSumsWidened()
+// Adds the power sums of an array of float points in
+// double, widening them a block at a time for the fastest
+// double kernel the CPU supports.
+//--------------------------------------------------------
+void polyfitKernelPowerSumsWidened( int coefficientCount, int pointCount, float *xValues, float *yValues,
+                                    double *pPowerSums, double *pRhsSums )
+{
+    powerSumsFloatScalar( powerSumsFor( POLYFIT_KERNEL_AUTO ), coefficientCount, pointCount, xValues, yValues,
+                          pPowerSums, pRhsSums );
+}
+
+//--------------------------------------------------------
+// polyfitKernelUniformRhsSums()
+// Adds only the right hand side sums of evenly spaced
+// points, x = (indexOffset + i) * xScale, for callers that
+// already know the power sums. The x values are made in registers,
+// so only the y values are read. Uses the fastest kernel
+// the CPU supports; SSE2 hosts use the scalar kernel.
+//--------------------------------------------------------
+void polyfitKernelUniformRhsSums( int coefficientCount, int pointCount, double indexOffset, double xScale,
+                                  double *yValues, double *pRhsSums )
+{
+    switch( polyfit_kernel_detect() )
+    {
+#ifdef POLYKERNEL_X86
+        case POLYFIT_KERNEL_AVX512:
+            uniformRhsSumsAvx512( coefficientCount, pointCount, indexOffset, xScale, yValues, pRhsSums );
+            break;
+        case POLYFIT_KERNEL_AVX2:
+            uniformRhsSumsAvx2( coefficientCount, pointCount, indexOffset, xScale, yValues, pRhsSums );
+            break;
+#endif  // POLYKERNEL_X86
+        default:
+            uniformRhsSumsScalar( coefficientCount, pointCount, indexOffset, xScale, yValues, pRhsSums );
+            break;
+    }
+}
+
+//--------------------------------------------------------
+// polyfitKernelDots()
+// Computes the dot products of one array of weights with
+// each of valueCount arrays of values, the
+// v'th starting at pValues[v * valueStride], into
+// pSums[v], using the fastest kernel the CPU supports.
+// SSE2 hosts use the scalar kernel. The kernels take the
+// value arrays KERNEL_DOT_BLOCK at a time, loading each
+// weight once for the block, so the weights are streamed
+// from memory once per block rather than once per array.
+//--------------------------------------------------------
+void polyfitKernelDots( int count, double *weights, double *pValues, int valueCount, size_t valueStride,
+                        double *pSums )
+{
+    switch( polyfit_kernel_detect() )
+    {
+#ifdef POLYKERNEL_X86
+        case POLYFIT_KERNEL_AVX512:
+            dotsAvx512( count, weights, pValues, valueCount, valueStride, pSums );
+            break;
+        case POLYFIT_KERNEL_AVX2:
+            dotsAvx2( count, weights, pValues, valueCount, valueStride, pSums );
+            break;
+#endif  // POLYKERNEL_X86
+        default:
+            dotsScalar( count, weights, pValues, valueCount, valueStride, pSums );
+            break;
+    }
+}
+
+//--------------------------------------------------------
+// polyfitKernelResidualSums()
+// Adds, for each float point, x^j * (y - p(x)) into
+// pRhsSums[j], computed in double, using the fastest
+// kernel the CPU supports.
+//--------------------------------------------------------
+void polyfitKernelResidualSums( int coefficientCount, int pointCount, float *xValues, float *yValues,
+                                double *coefficients, double *pRhsSums )
+{
+    switch( polyfit_kernel_detect() )
+    {
+#ifdef POLYKERNEL_X86
+        case POLYFIT_KERNEL_AVX512:
+            residualSumsAvx512( coefficientCount, pointCount, xValues, yValues, coefficients, pRhsSums );
+            break;
+        case POLYFIT_KERNEL_AVX2:
+            residualSumsAvx2( coefficientCount, pointCount, xValues, yValues, coefficients, pRhsSums );
+            break;
+#endif  // POLYKERNEL_X86
+        default:
+            residualSumsScalar( coefficientCount, pointCount, xValues, yValues, coefficients, pRhsSums );
+            break;
+    }
+}
+
+//--------------------------------------------------------
+// polyfitKernelConvolve()
+// Computes outputCount outputs of
+//     outValues[i] = sum over j of weights[j] * inValues[i + j]
+// using the fastest kernel the CPU supports. SSE2 hosts
+// use the scalar loop, which the compiler already issues
+// as SSE2 code.
+//--------------------------------------------------------
+void polyfitKernelConvolve( int outputCount, double *inValues, double *weights, int weightCount,
+                            double *outValues )
+{
+    switch( polyfit_kernel_detect() )
+    {
+#ifdef POLYKERNEL_X86
+        case POLYFIT_KERNEL_AVX512:
+            convolveAvx512( outputCount, inValues, weights, weightCount, outValues );
+            break;
+        case POLYFIT_KERNEL_AVX2:
+            convolveAvx2( outputCount, inValues, weights, weightCount, outValues );
+            break;
+#endif  // POLYKERNEL_X86
+        default:
+            convolveScalar( outputCount, inValues, weights, weightCount, outValues );
+            break;
+    }
+}
+
+//--------------------------------------------------------
+// polyfitKernelEvaluate()
+// Evaluates a polynomial, and optionally its first and
+// second derivatives, at each of an array of points, using
+// the fastest kernel the CPU supports. SSE2 hosts use the
+// scalar kernel.
+//--------------------------------------------------------
+void polyfitKernelEvaluate( int coefficientCount, double *coefficients, int pointCount, double *xValues,
+                            double *yValues, double *firstDerivatives, double *secondDerivatives )
+{
+    switch( polyfit_kernel_detect() )
+    {
+#ifdef POLYKERNEL_X86
+        case POLYFIT_KERNEL_AVX512:
+            evaluateAvx512( coefficientCount, coefficients, pointCount, xValues, yValues, firstDerivatives,
+                            secondDerivatives );
+            break;
+        case POLYFIT_KERNEL_AVX2:
+            evaluateAvx2( coefficientCount, coefficients, pointCount, xValues, yValues, firstDerivatives,
+                          secondDerivatives );
+            break;
+#endif  // POLYKERNEL_X86
+        default:
+            evaluateScalar( coefficientCount, coefficients, pointCount, xValues, yValues, firstDerivatives,
+                            secondDerivatives );
+            break;
+    }
+}
+
+//=========================================================
+//      Private function definitions
+//=========================================================
+
+//--------------------------------------------------------
+// powerSumsFor()
+// Returns the kernel function for a kernel selection,
+// resolving POLYFIT_KERNEL_AUTO to the best available.
+//--------------------------------------------------------
+static powerSumsFn_t powerSumsFor( polyfit_kernel_t kernel )
+{
+    if( POLYFIT_KERNEL_AUTO == kernel )
+    {
+        kernel = polyfit_kernel_detect();
+    }
+    switch( kernel )
+    {
+#ifdef POLYKERNEL_X86
+        case POLYFIT_KERNEL_SSE2:   return powerSumsSse2;
+        case POLYFIT_KERNEL_AVX2:   return powerSumsAvx2;
+        case POLYFIT_KERNEL_AVX512: return powerSumsAvx512;
+#endif  // POLYKERNEL_X86
+        default:                    return powerSumsScalar;
+    }
+}
+
+//--------------------------------------------------------
+// powerSumsScalar()
+// Portable kernel. Adds each point's powers of x into the
+// power sums, its powers of x times y into the right hand
+// side sums, and y^2 into *pYSquareSum unless it is NULL.
+// Every kernel sums y^2 whether or not it is wanted: it
+// costs one multiply-add per point, against the dozens of
+// the power sums, and saves a test in the inner loop.
+//--------------------------------------------------------
+static void powerSumsScalar( int coefficientCount, int pointCount, double *xValues, double *yValues,
+                             double *pPowerSums, double *pRhsSums, double *pYSquareSum )
+{
+    int sumCount = (2 * coefficientCount) - 1;
+    double ySquares = 0.0;
+    int i = 0;
+
+    // Four points at a time, so the four chains of multiplications
+    // that build their powers can overlap.
+    for( ; (i + 4) <= pointCount; i += 4 )
+    {
+        double x0 = xValues[i], x1 = xValues[i + 1], x2 = xValues[i + 2], x3 = xValues[i + 3];
+        double y0 = yValues[i], y1 = yValues[i + 1], y2 = yValues[i + 2], y3 = yValues[i + 3];
+        double p0 = 1.0, p1 = 1.0, p2 = 1.0, p3 = 1.0;
+
+        ySquares += ((y0 * y0) + (y1 * y1)) + ((y2 * y2) + (y3 * y3));
+        for( int j = 0; j < coefficientCount; j++ )
+        {
+            pPowerSums[j] += (p0 + p1) + (p2 + p3);
+            pRhsSums[j] += ((p0 * y0) + (p1 * y1)) + ((p2 * y2) + (p3 * y3));
+            p0 *= x0;
+            p1 *= x1;
+            p2 *= x2;
+            p3 *= x3;
+        }
+        for( int j = coefficientCount; j < sumCount; j++ )
+        {
+            pPowerSums[j] += (p0 + p1) + (p2 + p3);
+            p0 *= x0;
+            p1 *= x1;
+            p2 *= x2;
+            p3 *= x3;
+        }
+    }
+
+    for( ; i < pointCount; i++ )
+    {
+        double x = xValues[i];
+        double y = yValues[i];
+        double xPower = 1.0;    // x^j, built by repeated multiplication rather than pow().
+
+        ySquares += y * y;
+        for( int j = 0; j < coefficientCount; j++ )
+        {
+            pPowerSums[j] += xPower;
+            pRhsSums[j] += xPower * y;
+            xPower *= x;
+        }
+        for( int j = coefficientCount; j < sumCount; j++ )
+        {
+            pPowerSums[j] += xPower;
+            xPower *= x;
+        }
+    }
+
+    if( NULL != pYSquareSum )
+    {
+        *pYSquareSum += ySquares;
+    }
+}
+
+//--------------------------------------------------------
+// powerSumsFloatScalar()
+// Portable float kernel. Widens the points a block at a
+// time and hands them to the double kernel pKernel, so it
+// is as accurate as a double fit.
+//--------------------------------------------------------
+static void powerSumsFloatScalar( powerSumsFn_t pKernel, int coefficientCount, int pointCount, float *xValues,
+                                  float *yValues, double *pPowerSums, double *pRhsSums )
+{
+    double xBlock[ FLOAT_BLOCK_POINTS ];
+    double yBlock[ FLOAT_BLOCK_POINTS ];
+
+    for( int first = 0; first < pointCount; first += FLOAT_BLOCK_POINTS )
+    {
+        int count = pointCount - first;
+        if( count > FLOAT_BLOCK_POINTS )
+        {
+            count = FLOAT_BLOCK_POINTS;
+        }
+        for( int i = 0; i < count; i++ )
+        {
+            xBlock[i] = xValues[ first + i ];
+            yBlock[i] = yValues[ first + i ];
+        }
+        pKernel( coefficientCount, count, xBlock, yBlock, pPowerSums, pRhsSums, NULL );
+    }
+}
+
+//--------------------------------------------------------
+// uniformRhsSumsScalar()
+// Portable kernel for the right hand side sums of evenly
+// spaced points.
+//--------------------------------------------------------
+static void uniformRhsSumsScalar( int coefficientCount, int pointCount, double indexOffset, double xScale,
+                                  double *yValues, double *pRhsSums )
+{
+    int i = 0;
+
+    for( ; (i + 4) <= pointCount; i += 4 )
+    {
+        double x0 = (indexOffset + i) * xScale, x1 = (indexOffset + (i + 1)) * xScale;
+        double x2 = (indexOffset + (i + 2)) * xScale, x3 = (indexOffset + (i + 3)) * xScale;
+        double p0 = yValues[i], p1 = yValues[i + 1], p2 = yValues[i + 2], p3 = yValues[i + 3];
+
+        for( int j = 0; j < coefficientCount; j++ )
+        {
+            pRhsSums[j] += (p0 + p1) + (p2 + p3);
+            p0 *= x0;
+            p1 *= x1;
+            p2 *= x2;
+            p3 *= x3;
+        }
+    }
+
+    for( ; i < pointCount; i++ )
+    {
+        double x = (indexOffset + i) * xScale;
+        double xPowerY = yValues[i];    // x^j * y.
+
+        for( int j = 0; j < coefficientCount; j++ )
+        {
+            pRhsSums[j] += xPowerY;
+            xPowerY *= x;
+        }
+    }
+}
+
+//--------------------------------------------------------
+// dotsScalar()
+// Portable dot product kernel, with four partial sums per
+// dot product so the adds can overlap.
+//--------------------------------------------------------
+static void dotsScalar( int count, double *weights, double *pValues, int valueCount, size_t valueStride,
+                        double *pSums )
+{
+    int v = 0;
+
+    for( ; (v + KERNEL_DOT_BLOCK) <= valueCount; v += KERNEL_DOT_BLOCK )
+    {
+        double *pV = &(pValues[ v * valueStride ]);
+        double sum0 = 0.0, sum1 = 0.0, sum2 = 0.0, sum3 = 0.0;
+
+        for( int i = 0; i < count; i++ )
+        {
+            double weight = weights[i];
+            sum0 += weight * pV[i];
+            sum1 += weight * pV[ valueStride + i ];
+            sum2 += weight * pV[ (2 * valueStride) + i ];
+            sum3 += weight * pV[ (3 * valueStride) + i ];
+        }
+        pSums[v] = sum0;
+        pSums[v + 1] = sum1;
+        pSums[v + 2] = sum2;
+        pSums[v + 3] = sum3;
+    }
+    for( ; v < valueCount; v++ )
+    {
+        double *pV = &(pValues[ v * valueStride ]);
+        double sum0 = 0.0, sum1 = 0.0, sum2 = 0.0, sum3 = 0.0;
+        int i = 0;
+
+        for( ; (i + 4) <= count; i += 4 )
+        {
+            sum0 += weights[i] * pV[i];
+            sum1 += weights[i + 1] * pV[i + 1];
+            sum2 += weights[i + 2] * pV[i + 2];
+            sum3 += weights[i + 3] * pV[i + 3];
+        }
+        for( ; i < count; i++ )
+        {
+            sum0 += weights[i] * pV[i];
+        }
+        pSums[v] = (sum0 + sum1) + (sum2 + sum3);
+    }
+}
+
+//--------------------------------------------------------
+// residualSumsScalar()
+// Portable residual kernel. Evaluates the polynomial by
+// Horner's rule, then adds the residual times each power
+// of x into the right hand side sums.
+//--------------------------------------------------------
+static void residualSumsScalar( int coefficientCount, int pointCount, float *xValues, float *yValues,
+                                double *coefficients, double *pRhsSums )
+{
+    for( int i = 0; i < pointCount; i++ )
+    {
+        double x = xValues[i];
+        double fit = coefficients[0];
+        for( int c = 1; c < coefficientCount; c++ )
+        {
+            fit = (fit * x) + coefficients[c];
+        }
+
+        double xPower = yValues[i] - fit;     // The residual times x^j.
+        for( int j = 0; j < coefficientCount; j++ )
+        {
+            pRhsSums[j] += xPower;
+            xPower *= x;
+        }
+    }
+}
+
+//--------------------------------------------------------
+// convolveScalar()
+// Portable convolution kernel.
+//--------------------------------------------------------
+static void convolveScalar( int outputCount, double *inValues, double *weights, int weightCount,
+                            double *outValues )
+{
+    for( int i = 0; i < outputCount; i++ )
+    {
+        double sum = 0.0;
+        for( int j = 0; j < weightCount; j++ )
+        {
+            sum += weights[j] * inValues[i + j];
+        }
+        outValues[i] = sum;
+    }
+}
+
+//--------------------------------------------------------
+// evaluateScalar()
+// Portable evaluation kernel, by Horner's rule. With
+// derivatives, p' and p''/2 are carried along by the same
+// rule: each step folds the lower order value into the
+// higher order one before updating it.
+//--------------------------------------------------------
+static void evaluateScalar( int coefficientCount, double *coefficients, int pointCount, double *xValues,
+                            double *yValues, double *firstDerivatives, double *secondDerivatives )
+{
+    if( (NULL == firstDerivatives) && (NULL == secondDerivatives) )
+    {
+        for( int i = 0; i < pointCount; i++ )
+        {
+            double x = xValues[i];
+            double value = coefficients[0];
+            for( int c = 1; c < coefficientCount; c++ )
+            {
+                value = (value * x) + coefficients[c];
+            }
+            yValues[i] = value;
+        }
+        return;
+    }
+
+    for( int i = 0; i < pointCount; i++ )
+    {
+        double x = xValues[i];
+        double value = coefficients[0];
+        double slope = 0.0;
+        double halfCurvature = 0.0;
+        for( int c = 1; c < coefficientCount; c++ )
+        {
+            halfCurvature = (halfCurvature * x) + slope;
+            slope = (slope * x) + value;
+            value = (value * x) + coefficients[c];
+        }
+        yValues[i] = value;
+        if( NULL != firstDerivatives )
+        {
+            firstDerivatives[i] = slope;
+        }
+        if( NULL != secondDerivatives )
+        {
+            secondDerivatives[i] = 2.0 * halfCurvature;
+        }
+    }
+}
+
+#ifdef POLYKERNEL_X86
+
+//--------------------------------------------------------
+// powerSumsSse2()
+// Two lanes of doubles, two vectors of points per step.
+// The lane sums are combined in a fixed order at the end,
+// and the leftover points go to the scalar kernel.
+//--------------------------------------------------------
+__attribute__(( target( "sse2" ) ))
+static void powerSumsSse2( int coefficientCount, int pointCount, double *xValues, double *yValues,
+                           double *pPowerSums, double *pRhsSums, double *pYSquareSum )
+{
+    if( coefficientCount > KERNEL_MAX_COEFFICIENTS )
+    {
+        powerSumsScalar( coefficientCount, pointCount, xValues, yValues, pPowerSums, pRhsSums, pYSquareSum );
+        return;
+    }
+
+    int sumCount = (2 * coefficientCount) - 1;
+    __m128d powerAcc[ KERNEL_MAX_SUMS ];
+    __m128d rhsAcc[ KERNEL_MAX_COEFFICIENTS ];
+    __m128d squareAcc = _mm_setzero_pd();
+    int i = 0;
+
+    for( int j = 0; j < sumCount; j++ )
+    {
+        powerAcc[j] = _mm_setzero_pd();
+    }
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        rhsAcc[j] = _mm_setzero_pd();
+    }
+
+    for( ; (i + 4) <= pointCount; i += 4 )
+    {
+        __m128d x0 = _mm_loadu_pd( &xValues[i] ), x1 = _mm_loadu_pd( &xValues[i + 2] );
+        __m128d y0 = _mm_loadu_pd( &yValues[i] ), y1 = _mm_loadu_pd( &yValues[i + 2] );
+        __m128d p0 = _mm_set1_pd( 1.0 ), p1 = p0;
+
+        squareAcc = _mm_add_pd( squareAcc, _mm_add_pd( _mm_mul_pd( y0, y0 ), _mm_mul_pd( y1, y1 )));
+        for( int j = 0; j < coefficientCount; j++ )
+        {
+            powerAcc[j] = _mm_add_pd( powerAcc[j], _mm_add_pd( p0, p1 ));
+            rhsAcc[j] = _mm_add_pd( rhsAcc[j], _mm_add_pd( _mm_mul_pd( p0, y0 ), _mm_mul_pd( p1, y1 )));
+            p0 = _mm_mul_pd( p0, x0 );
+            p1 = _mm_mul_pd( p1, x1 );
+        }
+        for( int j = coefficientCount; j < sumCount; j++ )
+        {
+            powerAcc[j] = _mm_add_pd( powerAcc[j], _mm_add_pd( p0, p1 ));
+            p0 = _mm_mul_pd( p0, x0 );
+            p1 = _mm_mul_pd( p1, x1 );
+        }
+    }
+
+    for( int j = 0; j < sumCount; j++ )
+    {
+        double lanes[2];
+        _mm_storeu_pd( lanes, powerAcc[j] );
+        pPowerSums[j] += lanes[0] + lanes[1];
+    }
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        double lanes[2];
+        _mm_storeu_pd( lanes, rhsAcc[j] );
+        pRhsSums[j] += lanes[0] + lanes[1];
+    }
+
+    if( NULL != pYSquareSum )
+    {
+        double lanes[2];
+        _mm_storeu_pd( lanes, squareAcc );
+        *pYSquareSum += lanes[0] + lanes[1];
+    }
+
+    powerSumsScalar( coefficientCount, pointCount - i, &xValues[i], &yValues[i], pPowerSums, pRhsSums,
+                     pYSquareSum );
+}
+
+//--------------------------------------------------------
+// powerSumsAvx2()
+// Four lanes of doubles, two vectors of points per step.
+//--------------------------------------------------------
+__attribute__(( target( "avx2" ) ))
+static void powerSumsAvx2( int coefficientCount, int pointCount, double *xValues, double *yValues,
+                           double *pPowerSums, double *pRhsSums, double *pYSquareSum )
+{
+    if( coefficientCount > KERNEL_MAX_COEFFICIENTS )
+    {
+        powerSumsScalar( coefficientCount, pointCount, xValues, yValues, pPowerSums, pRhsSums, pYSquareSum );
+        return;
+    }
+
+    int sumCount = (2 * coefficientCount) - 1;
+    __m256d powerAcc[ KERNEL_MAX_SUMS ];
+    __m256d rhsAcc[ KERNEL_MAX_COEFFICIENTS ];
+    __m256d squareAcc = _mm256_setzero_pd();
+    int i = 0;
+
+    for( int j = 0; j < sumCount; j++ )
+    {
+        powerAcc[j] = _mm256_setzero_pd();
+    }
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        rhsAcc[j] = _mm256_setzero_pd();
+    }
+
+    for( ; (i + 8) <= pointCount; i += 8 )
+    {
+        __m256d x0 = _mm256_loadu_pd( &xValues[i] ), x1 = _mm256_loadu_pd( &xValues[i + 4] );
+        __m256d y0 = _mm256_loadu_pd( &yValues[i] ), y1 = _mm256_loadu_pd( &yValues[i + 4] );
+        __m256d p0 = _mm256_set1_pd( 1.0 ), p1 = p0;
+
+        squareAcc = _mm256_add_pd( squareAcc, _mm256_add_pd( _mm256_mul_pd( y0, y0 ), _mm256_mul_pd( y1, y1 )));
+        for( int j = 0; j < coefficientCount; j++ )
+        {
+            powerAcc[j] = _mm256_add_pd( powerAcc[j], _mm256_add_pd( p0, p1 ));
+            rhsAcc[j] = _mm256_add_pd( rhsAcc[j], _mm256_add_pd( _mm256_mul_pd( p0, y0 ), _mm256_mul_pd( p1, y1 )));
+            p0 = _mm256_mul_pd( p0, x0 );
+            p1 = _mm256_mul_pd( p1, x1 );
+        }
+        for( int j = coefficientCount; j < sumCount; j++ )
+        {
+            powerAcc[j] = _mm256_add_pd( powerAcc[j], _mm256_add_pd( p0, p1 ));
+            p0 = _mm256_mul_pd( p0, x0 );
+            p1 = _mm256_mul_pd( p1, x1 );
+        }
+    }
+
+    for( int j = 0; j < sumCount; j++ )
+    {
+        double lanes[4];
+        _mm256_storeu_pd( lanes, powerAcc[j] );
+        pPowerSums[j] += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        double lanes[4];
+        _mm256_storeu_pd( lanes, rhsAcc[j] );
+        pRhsSums[j] += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+
+    if( NULL != pYSquareSum )
+    {
+        double lanes[4];
+        _mm256_storeu_pd( lanes, squareAcc );
+        *pYSquareSum += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+
+    powerSumsScalar( coefficientCount, pointCount - i, &xValues[i], &yValues[i], pPowerSums, pRhsSums,
+                     pYSquareSum );
+}
+
+//--------------------------------------------------------
+// powerSumsAvx512()
+// Eight lanes of doubles, two vectors of points per step.
+//--------------------------------------------------------
+__attribute__(( target( "avx512f" ) ))
+static void powerSumsAvx512( int coefficientCount, int pointCount, double *xValues, double *yValues,
+                             double *pPowerSums, double *pRhsSums, double *pYSquareSum )
+{
+    if( coefficientCount > KERNEL_MAX_COEFFICIENTS )
+    {
+        powerSumsScalar( coefficientCount, pointCount, xValues, yValues, pPowerSums, pRhsSums, pYSquareSum );
+        return;
+    }
+
+    int sumCount = (2 * coefficientCount) - 1;
+    __m512d powerAcc[ KERNEL_MAX_SUMS ];
+    __m512d rhsAcc[ KERNEL_MAX_COEFFICIENTS ];
+    __m512d squareAcc = _mm512_setzero_pd();
+    int i = 0;
+
+    for( int j = 0; j < sumCount; j++ )
+    {
+        powerAcc[j] = _mm512_setzero_pd();
+    }
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        rhsAcc[j] = _mm512_setzero_pd();
+    }
+
+    for( ; (i + 16) <= pointCount; i += 16 )
+    {
+        __m512d x0 = _mm512_loadu_pd( &xValues[i] ), x1 = _mm512_loadu_pd( &xValues[i + 8] );
+        __m512d y0 = _mm512_loadu_pd( &yValues[i] ), y1 = _mm512_loadu_pd( &yValues[i + 8] );
+        __m512d p0 = _mm512_set1_pd( 1.0 ), p1 = p0;
+
+        squareAcc = _mm512_add_pd( squareAcc, _mm512_add_pd( _mm512_mul_pd( y0, y0 ), _mm512_mul_pd( y1, y1 )));
+        for( int j = 0; j < coefficientCount; j++ )
+        {
+            powerAcc[j] = _mm512_add_pd( powerAcc[j], _mm512_add_pd( p0, p1 ));
+            rhsAcc[j] = _mm512_add_pd( rhsAcc[j], _mm512_add_pd( _mm512_mul_pd( p0, y0 ), _mm512_mul_pd( p1, y1 )));
+            p0 = _mm512_mul_pd( p0, x0 );
+            p1 = _mm512_mul_pd( p1, x1 );
+        }
+        for( int j = coefficientCount; j < sumCount; j++ )
+        {
+            powerAcc[j] = _mm512_add_pd( powerAcc[j], _mm512_add_pd( p0, p1 ));
+            p0 = _mm512_mul_pd( p0, x0 );
+            p1 = _mm512_mul_pd( p1, x1 );
+        }
+    }
+
+    for( int j = 0; j < sumCount; j++ )
+    {
+        double lanes[8];
+        _mm512_storeu_pd( lanes, powerAcc[j] );
+        pPowerSums[j] += ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+                         ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        double lanes[8];
+        _mm512_storeu_pd( lanes, rhsAcc[j] );
+        pRhsSums[j] += ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+                       ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+
+    if( NULL != pYSquareSum )
+    {
+        double lanes[8];
+        _mm512_storeu_pd( lanes, squareAcc );
+        *pYSquareSum += ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+                        ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+
+    powerSumsScalar( coefficientCount, pointCount - i, &xValues[i], &yValues[i], pPowerSums, pRhsSums,
+                     pYSquareSum );
+}
+
+//--------------------------------------------------------
+// powerSumsFloatAvx2()
+// Eight lanes of floats, two vectors of points per step:
+// twice the points per instruction of powerSumsAvx2().
+// Each block of FLOAT_BLOCK_POINTS points is summed in
+// float lanes, which are then widened and added into
+// double lanes.
+//--------------------------------------------------------
+__attribute__(( target( "avx2" ) ))
+static void powerSumsFloatAvx2( int coefficientCount, int pointCount, float *xValues, float *yValues,
+                                double *pPowerSums, double *pRhsSums )
+{
+    if( coefficientCount > KERNEL_MAX_COEFFICIENTS )
+    {
+        powerSumsFloatScalar( powerSumsScalar, coefficientCount, pointCount, xValues, yValues, pPowerSums, pRhsSums );
+        return;
+    }
+
+    int sumCount = (2 * coefficientCount) - 1;
+    __m256 powerAcc[ KERNEL_MAX_SUMS ];
+    __m256 rhsAcc[ KERNEL_MAX_COEFFICIENTS ];
+    __m256d powerDbl[ KERNEL_MAX_SUMS ];
+    __m256d rhsDbl[ KERNEL_MAX_COEFFICIENTS ];
+    int i = 0;
+
+    // Tiny powers of small x would otherwise become float denormals, which
+    // are many times slower to add. They are far below the rounding of the
+    // sums, so flush them to zero while the kernel runs.
+    unsigned int savedCsr = _mm_getcsr();
+    _mm_setcsr( savedCsr | FLUSH_DENORMALS_CSR );
+
+    for( int j = 0; j < sumCount; j++ )
+    {
+        powerDbl[j] = _mm256_setzero_pd();
+    }
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        rhsDbl[j] = _mm256_setzero_pd();
+    }
+
+    while( (i + 16) <= pointCount )
+    {
+        int blockEnd = i + FLOAT_BLOCK_POINTS;
+        if( blockEnd > pointCount )
+        {
+            blockEnd = pointCount;
+        }
+
+        for( int j = 0; j < sumCount; j++ )
+        {
+            powerAcc[j] = _mm256_setzero_ps();
+        }
+        for( int j = 0; j < coefficientCount; j++ )
+        {
+            rhsAcc[j] = _mm256_setzero_ps();
+        }
+
+        for( ; (i + 16) <= blockEnd; i += 16 )
+        {
+            __m256 x0 = _mm256_loadu_ps( &xValues[i] ), x1 = _mm256_loadu_ps( &xValues[i + 8] );
+            __m256 y0 = _mm256_loadu_ps( &yValues[i] ), y1 = _mm256_loadu_ps( &yValues[i + 8] );
+            __m256 p0 = _mm256_set1_ps( 1.0f ), p1 = p0;
+
+            for( int j = 0; j < coefficientCount; j++ )
+            {
+                powerAcc[j] = _mm256_add_ps( powerAcc[j], _mm256_add_ps( p0, p1 ));
+                rhsAcc[j] = _mm256_add_ps( rhsAcc[j], _mm256_add_ps( _mm256_mul_ps( p0, y0 ), _mm256_mul_ps( p1, y1 )));
+                p0 = _mm256_mul_ps( p0, x0 );
+                p1 = _mm256_mul_ps( p1, x1 );
+            }
+            for( int j = coefficientCount; j < sumCount; j++ )
+            {
+                powerAcc[j] = _mm256_add_ps( powerAcc[j], _mm256_add_ps( p0, p1 ));
+                p0 = _mm256_mul_ps( p0, x0 );
+                p1 = _mm256_mul_ps( p1, x1 );
+            }
+        }
+
+        // Widen the float lanes and add them into double lanes, so only the
+        // adds within a block round in single precision.
+        for( int j = 0; j < sumCount; j++ )
+        {
+            powerDbl[j] = _mm256_add_pd( powerDbl[j], _mm256_add_pd(
+                              _mm256_cvtps_pd( _mm256_castps256_ps128( powerAcc[j] )),
+                              _mm256_cvtps_pd( _mm256_extractf128_ps( powerAcc[j], 1 ))));
+        }
+        for( int j = 0; j < coefficientCount; j++ )
+        {
+            rhsDbl[j] = _mm256_add_pd( rhsDbl[j], _mm256_add_pd(
+                            _mm256_cvtps_pd( _mm256_castps256_ps128( rhsAcc[j] )),
+                            _mm256_cvtps_pd( _mm256_extractf128_ps( rhsAcc[j], 1 ))));
+        }
+    }
+
+    for( int j = 0; j < sumCount; j++ )
+    {
+        double lanes[4];
+        _mm256_storeu_pd( lanes, powerDbl[j] );
+        pPowerSums[j] += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        double lanes[4];
+        _mm256_storeu_pd( lanes, rhsDbl[j] );
+        pRhsSums[j] += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+
+    _mm_setcsr( savedCsr );
+    powerSumsFloatScalar( powerSumsScalar, coefficientCount, pointCount - i, &xValues[i], &yValues[i], pPowerSums,
+                          pRhsSums );
+}
+
+//--------------------------------------------------------
+// powerSumsFloatAvx512()
+// Sixteen lanes of floats, two vectors of points per step.
+//--------------------------------------------------------
+__attribute__(( target( "avx512f" ) ))
+static void powerSumsFloatAvx512( int coefficientCount, int pointCount, float *xValues, float *yValues,
+                                  double *pPowerSums, double *pRhsSums )
+{
+    if( coefficientCount > KERNEL_MAX_COEFFICIENTS )
+    {
+        powerSumsFloatScalar( powerSumsScalar, coefficientCount, pointCount, xValues, yValues, pPowerSums, pRhsSums );
+        return;
+    }
+
+    int sumCount = (2 * coefficientCount) - 1;
+    __m512 powerAcc[ KERNEL_MAX_SUMS ];
+    __m512 rhsAcc[ KERNEL_MAX_COEFFICIENTS ];
+    __m512d powerDbl[ KERNEL_MAX_SUMS ];
+    __m512d rhsDbl[ KERNEL_MAX_COEFFICIENTS ];
+    int i = 0;
+
+    // Tiny powers of small x would otherwise become float denormals, which
+    // are many times slower to add. They are far below the rounding of the
+    // sums, so flush them to zero while the kernel runs.
+    unsigned int savedCsr = _mm_getcsr();
+    _mm_setcsr( savedCsr | FLUSH_DENORMALS_CSR );
+
+    for( int j = 0; j < sumCount; j++ )
+    {
+        powerDbl[j] = _mm512_setzero_pd();
+    }
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        rhsDbl[j] = _mm512_setzero_pd();
+    }
+
+    while( (i + 32) <= pointCount )
+    {
+        int blockEnd = i + FLOAT_BLOCK_POINTS;
+        if( blockEnd > pointCount )
+        {
+            blockEnd = pointCount;
+        }
+
+        for( int j = 0; j < sumCount; j++ )
+        {
+            powerAcc[j] = _mm512_setzero_ps();
+        }
+        for( int j = 0; j < coefficientCount; j++ )
+        {
+            rhsAcc[j] = _mm512_setzero_ps();
+        }
+
+        for( ; (i + 32) <= blockEnd; i += 32 )
+        {
+            __m512 x0 = _mm512_loadu_ps( &xValues[i] ), x1 = _mm512_loadu_ps( &xValues[i + 16] );
+            __m512 y0 = _mm512_loadu_ps( &yValues[i] ), y1 = _mm512_loadu_ps( &yValues[i + 16] );
+            __m512 p0 = _mm512_set1_ps( 1.0f ), p1 = p0;
+
+            for( int j = 0; j < coefficientCount; j++ )
+            {
+                powerAcc[j] = _mm512_add_ps( powerAcc[j], _mm512_add_ps( p0, p1 ));
+                rhsAcc[j] = _mm512_add_ps( rhsAcc[j], _mm512_add_ps( _mm512_mul_ps( p0, y0 ), _mm512_mul_ps( p1, y1 )));
+                p0 = _mm512_mul_ps( p0, x0 );
+                p1 = _mm512_mul_ps( p1, x1 );
+            }
+            for( int j = coefficientCount; j < sumCount; j++ )
+            {
+                powerAcc[j] = _mm512_add_ps( powerAcc[j], _mm512_add_ps( p0, p1 ));
+                p0 = _mm512_mul_ps( p0, x0 );
+                p1 = _mm512_mul_ps( p1, x1 );
+            }
+        }
+
+        for( int j = 0; j < sumCount; j++ )
+        {
+            powerDbl[j] = _mm512_add_pd( powerDbl[j], _mm512_add_pd(
+                              _mm512_cvtps_pd( _mm512_castps512_ps256( powerAcc[j] )),
+                              _mm512_cvtps_pd( _mm256_castpd_ps( _mm512_extractf64x4_pd(
+                                                   _mm512_castps_pd( powerAcc[j] ), 1 )))));
+        }
+        for( int j = 0; j < coefficientCount; j++ )
+        {
+            rhsDbl[j] = _mm512_add_pd( rhsDbl[j], _mm512_add_pd(
+                            _mm512_cvtps_pd( _mm512_castps512_ps256( rhsAcc[j] )),
+                            _mm512_cvtps_pd( _mm256_castpd_ps( _mm512_extractf64x4_pd(
+                                                 _mm512_castps_pd( rhsAcc[j] ), 1 )))));
+        }
+    }
+
+    for( int j = 0; j < sumCount; j++ )
+    {
+        double lanes[8];
+        _mm512_storeu_pd( lanes, powerDbl[j] );
+        pPowerSums[j] += ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+                         ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        double lanes[8];
+        _mm512_storeu_pd( lanes, rhsDbl[j] );
+        pRhsSums[j] += ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+                       ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+
+    _mm_setcsr( savedCsr );
+    powerSumsFloatScalar( powerSumsScalar, coefficientCount, pointCount - i, &xValues[i], &yValues[i], pPowerSums,
+                          pRhsSums );
+}
+
+//--------------------------------------------------------
+// uniformRhsSumsAvx2()
+// Four lanes of doubles, two vectors of points per step.
+//--------------------------------------------------------
+__attribute__(( target( "avx2" ) ))
+static void uniformRhsSumsAvx2( int coefficientCount, int pointCount, double indexOffset, double xScale,
+                                double *yValues, double *pRhsSums )
+{
+    if( coefficientCount > KERNEL_MAX_COEFFICIENTS )
+    {
+        uniformRhsSumsScalar( coefficientCount, pointCount, indexOffset, xScale, yValues, pRhsSums );
+        return;
+    }
+
+    __m256d rhsAcc[ KERNEL_MAX_COEFFICIENTS ];
+    __m256d lanes0 = _mm256_set_pd( 3.0, 2.0, 1.0, 0.0 );
+    __m256d lanes1 = _mm256_set_pd( 7.0, 6.0, 5.0, 4.0 );
+    __m256d scale = _mm256_set1_pd( xScale );
+    int i = 0;
+
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        rhsAcc[j] = _mm256_setzero_pd();
+    }
+
+    for( ; (i + 8) <= pointCount; i += 8 )
+    {
+        __m256d base = _mm256_set1_pd( indexOffset + i );
+        __m256d x0 = _mm256_mul_pd( _mm256_add_pd( base, lanes0 ), scale );
+        __m256d x1 = _mm256_mul_pd( _mm256_add_pd( base, lanes1 ), scale );
+        __m256d p0 = _mm256_loadu_pd( &yValues[i] ), p1 = _mm256_loadu_pd( &yValues[i + 4] );
+
+        for( int j = 0; j < coefficientCount; j++ )
+        {
+            rhsAcc[j] = _mm256_add_pd( rhsAcc[j], _mm256_add_pd( p0, p1 ));
+            p0 = _mm256_mul_pd( p0, x0 );
+            p1 = _mm256_mul_pd( p1, x1 );
+        }
+    }
+
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        double lanes[4];
+        _mm256_storeu_pd( lanes, rhsAcc[j] );
+        pRhsSums[j] += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+
+    uniformRhsSumsScalar( coefficientCount, pointCount - i, indexOffset + i, xScale, &yValues[i], pRhsSums );
+}
+
+//--------------------------------------------------------
+// uniformRhsSumsAvx512()
+// Eight lanes of doubles, two vectors of points per step.
+//--------------------------------------------------------
+__attribute__(( target( "avx512f" ) ))
+static void uniformRhsSumsAvx512( int coefficientCount, int pointCount, double indexOffset, double xScale,
+                                  double *yValues, double *pRhsSums )
+{
+    if( coefficientCount > KERNEL_MAX_COEFFICIENTS )
+    {
+        uniformRhsSumsScalar( coefficientCount, pointCount, indexOffset, xScale, yValues, pRhsSums );
+        return;
+    }
+
+    __m512d rhsAcc[ KERNEL_MAX_COEFFICIENTS ];
+    __m512d lanes0 = _mm512_set_pd( 7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0 );
+    __m512d lanes1 = _mm512_set_pd( 15.0, 14.0, 13.0, 12.0, 11.0, 10.0, 9.0, 8.0 );
+    __m512d scale = _mm512_set1_pd( xScale );
+    int i = 0;
+
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        rhsAcc[j] = _mm512_setzero_pd();
+    }
+
+    for( ; (i + 16) <= pointCount; i += 16 )
+    {
+        __m512d base = _mm512_set1_pd( indexOffset + i );
+        __m512d x0 = _mm512_mul_pd( _mm512_add_pd( base, lanes0 ), scale );
+        __m512d x1 = _mm512_mul_pd( _mm512_add_pd( base, lanes1 ), scale );
+        __m512d p0 = _mm512_loadu_pd( &yValues[i] ), p1 = _mm512_loadu_pd( &yValues[i + 8] );
+
+        for( int j = 0; j < coefficientCount; j++ )
+        {
+            rhsAcc[j] = _mm512_add_pd( rhsAcc[j], _mm512_add_pd( p0, p1 ));
+            p0 = _mm512_mul_pd( p0, x0 );
+            p1 = _mm512_mul_pd( p1, x1 );
+        }
+    }
+
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        double lanes[8];
+        _mm512_storeu_pd( lanes, rhsAcc[j] );
+        pRhsSums[j] += ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+                       ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+
+    uniformRhsSumsScalar( coefficientCount, pointCount - i, indexOffset + i, xScale, &yValues[i], pRhsSums );
+}
+
+//--------------------------------------------------------
+// dotsAvx2()
+// Four lanes of doubles, four vectors per step, each with
+// its own accumulator so the adds can overlap.
+//--------------------------------------------------------
+__attribute__(( target( "avx2" ) ))
+static void dotsAvx2( int count, double *weights, double *pValues, int valueCount, size_t valueStride,
+                      double *pSums )
+{
+    int v = 0;
+
+    // A block of value arrays: each vector of weights is loaded once for
+    // all of them, with two accumulators per array, all in registers.
+    for( ; (v + KERNEL_DOT_BLOCK) <= valueCount; v += KERNEL_DOT_BLOCK )
+    {
+        double *pV0 = &(pValues[ v * valueStride ]);
+        double *pV1 = &(pV0[ valueStride ]);
+        double *pV2 = &(pV1[ valueStride ]);
+        double *pV3 = &(pV2[ valueStride ]);
+        __m256d acc0A = _mm256_setzero_pd(), acc0B = acc0A, acc1A = acc0A, acc1B = acc0A;
+        __m256d acc2A = acc0A, acc2B = acc0A, acc3A = acc0A, acc3B = acc0A;
+        int i = 0;
+
+        for( ; (i + 8) <= count; i += 8 )
+        {
+            __m256d weightA = _mm256_loadu_pd( &weights[i] );
+            __m256d weightB = _mm256_loadu_pd( &weights[i + 4] );
+            acc0A = _mm256_add_pd( acc0A, _mm256_mul_pd( weightA, _mm256_loadu_pd( &pV0[i] )));
+            acc0B = _mm256_add_pd( acc0B, _mm256_mul_pd( weightB, _mm256_loadu_pd( &pV0[i + 4] )));
+            acc1A = _mm256_add_pd( acc1A, _mm256_mul_pd( weightA, _mm256_loadu_pd( &pV1[i] )));
+            acc1B = _mm256_add_pd( acc1B, _mm256_mul_pd( weightB, _mm256_loadu_pd( &pV1[i + 4] )));
+            acc2A = _mm256_add_pd( acc2A, _mm256_mul_pd( weightA, _mm256_loadu_pd( &pV2[i] )));
+            acc2B = _mm256_add_pd( acc2B, _mm256_mul_pd( weightB, _mm256_loadu_pd( &pV2[i + 4] )));
+            acc3A = _mm256_add_pd( acc3A, _mm256_mul_pd( weightA, _mm256_loadu_pd( &pV3[i] )));
+            acc3B = _mm256_add_pd( acc3B, _mm256_mul_pd( weightB, _mm256_loadu_pd( &pV3[i + 4] )));
+        }
+
+        double lanes[ KERNEL_DOT_BLOCK ][4];
+        _mm256_storeu_pd( lanes[0], _mm256_add_pd( acc0A, acc0B ));
+        _mm256_storeu_pd( lanes[1], _mm256_add_pd( acc1A, acc1B ));
+        _mm256_storeu_pd( lanes[2], _mm256_add_pd( acc2A, acc2B ));
+        _mm256_storeu_pd( lanes[3], _mm256_add_pd( acc3A, acc3B ));
+        for( int b = 0; b < KERNEL_DOT_BLOCK; b++ )
+        {
+            double *pV = &(pV0[ b * valueStride ]);
+            double sum = (lanes[b][0] + lanes[b][1]) + (lanes[b][2] + lanes[b][3]);
+            for( int j = i; j < count; j++ )
+            {
+                sum += weights[j] * pV[j];
+            }
+            pSums[ v + b ] = sum;
+        }
+    }
+    for( ; v < valueCount; v++ )
+    {
+        double *pV = &(pValues[ v * valueStride ]);
+        __m256d acc0 = _mm256_setzero_pd(), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+        int i = 0;
+
+        for( ; (i + 16) <= count; i += 16 )
+        {
+            acc0 = _mm256_add_pd( acc0, _mm256_mul_pd( _mm256_loadu_pd( &weights[i] ), _mm256_loadu_pd( &pV[i] )));
+            acc1 = _mm256_add_pd( acc1, _mm256_mul_pd( _mm256_loadu_pd( &weights[i + 4] ), _mm256_loadu_pd( &pV[i + 4] )));
+            acc2 = _mm256_add_pd( acc2, _mm256_mul_pd( _mm256_loadu_pd( &weights[i + 8] ), _mm256_loadu_pd( &pV[i + 8] )));
+            acc3 = _mm256_add_pd( acc3, _mm256_mul_pd( _mm256_loadu_pd( &weights[i + 12] ), _mm256_loadu_pd( &pV[i + 12] )));
+        }
+
+        double lanes[4];
+        _mm256_storeu_pd( lanes, _mm256_add_pd( _mm256_add_pd( acc0, acc1 ), _mm256_add_pd( acc2, acc3 )));
+        double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        for( ; i < count; i++ )
+        {
+            sum += weights[i] * pV[i];
+        }
+        pSums[v] = sum;
+    }
+}
+
+//--------------------------------------------------------
+// dotsAvx512()
+// Eight lanes of doubles, four vectors per step.
+//--------------------------------------------------------
+__attribute__(( target( "avx512f" ) ))
+static void dotsAvx512( int count, double *weights, double *pValues, int valueCount, size_t valueStride,
+                        double *pSums )
+{
+    int v = 0;
+
+    // As in dotsAvx2(), a block of value arrays per load of the weights.
+    for( ; (v + KERNEL_DOT_BLOCK) <= valueCount; v += KERNEL_DOT_BLOCK )
+    {
+        double *pV0 = &(pValues[ v * valueStride ]);
+        double *pV1 = &(pV0[ valueStride ]);
+        double *pV2 = &(pV1[ valueStride ]);
+        double *pV3 = &(pV2[ valueStride ]);
+        __m512d acc0A = _mm512_setzero_pd(), acc0B = acc0A, acc1A = acc0A, acc1B = acc0A;
+        __m512d acc2A = acc0A, acc2B = acc0A, acc3A = acc0A, acc3B = acc0A;
+        int i = 0;
+
+        for( ; (i + 16) <= count; i += 16 )
+        {
+            __m512d weightA = _mm512_loadu_pd( &weights[i] );
+            __m512d weightB = _mm512_loadu_pd( &weights[i + 8] );
+            acc0A = _mm512_add_pd( acc0A, _mm512_mul_pd( weightA, _mm512_loadu_pd( &pV0[i] )));
+            acc0B = _mm512_add_pd( acc0B, _mm512_mul_pd( weightB, _mm512_loadu_pd( &pV0[i + 8] )));
+            acc1A = _mm512_add_pd( acc1A, _mm512_mul_pd( weightA, _mm512_loadu_pd( &pV1[i] )));
+            acc1B = _mm512_add_pd( acc1B, _mm512_mul_pd( weightB, _mm512_loadu_pd( &pV1[i + 8] )));
+            acc2A = _mm512_add_pd( acc2A, _mm512_mul_pd( weightA, _mm512_loadu_pd( &pV2[i] )));
+            acc2B = _mm512_add_pd( acc2B, _mm512_mul_pd( weightB, _mm512_loadu_pd( &pV2[i + 8] )));
+            acc3A = _mm512_add_pd( acc3A, _mm512_mul_pd( weightA, _mm512_loadu_pd( &pV3[i] )));
+            acc3B = _mm512_add_pd( acc3B, _mm512_mul_pd( weightB, _mm512_loadu_pd( &pV3[i + 8] )));
+        }
+
+        double lanes[ KERNEL_DOT_BLOCK ][8];
+        _mm512_storeu_pd( lanes[0], _mm512_add_pd( acc0A, acc0B ));
+        _mm512_storeu_pd( lanes[1], _mm512_add_pd( acc1A, acc1B ));
+        _mm512_storeu_pd( lanes[2], _mm512_add_pd( acc2A, acc2B ));
+        _mm512_storeu_pd( lanes[3], _mm512_add_pd( acc3A, acc3B ));
+        for( int b = 0; b < KERNEL_DOT_BLOCK; b++ )
+        {
+            double *pV = &(pV0[ b * valueStride ]);
+            double sum = ((lanes[b][0] + lanes[b][1]) + (lanes[b][2] + lanes[b][3])) +
+                         ((lanes[b][4] + lanes[b][5]) + (lanes[b][6] + lanes[b][7]));
+            for( int j = i; j < count; j++ )
+            {
+                sum += weights[j] * pV[j];
+            }
+            pSums[ v + b ] = sum;
+        }
+    }
+    for( ; v < valueCount; v++ )
+    {
+        double *pV = &(pValues[ v * valueStride ]);
+        __m512d acc0 = _mm512_setzero_pd(), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+        int i = 0;
+
+        for( ; (i + 32) <= count; i += 32 )
+        {
+            acc0 = _mm512_add_pd( acc0, _mm512_mul_pd( _mm512_loadu_pd( &weights[i] ), _mm512_loadu_pd( &pV[i] )));
+            acc1 = _mm512_add_pd( acc1, _mm512_mul_pd( _mm512_loadu_pd( &weights[i + 8] ), _mm512_loadu_pd( &pV[i + 8] )));
+            acc2 = _mm512_add_pd( acc2, _mm512_mul_pd( _mm512_loadu_pd( &weights[i + 16] ), _mm512_loadu_pd( &pV[i + 16] )));
+            acc3 = _mm512_add_pd( acc3, _mm512_mul_pd( _mm512_loadu_pd( &weights[i + 24] ), _mm512_loadu_pd( &pV[i + 24] )));
+        }
+
+        double lanes[8];
+        _mm512_storeu_pd( lanes, _mm512_add_pd( _mm512_add_pd( acc0, acc1 ), _mm512_add_pd( acc2, acc3 )));
+        double sum = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+        for( ; i < count; i++ )
+        {
+            sum += weights[i] * pV[i];
+        }
+        pSums[v] = sum;
+    }
+}
+
+//--------------------------------------------------------
+// residualSumsAvx2()
+// Four lanes of doubles, two vectors of points per step.
+//--------------------------------------------------------
+__attribute__(( target( "avx2" ) ))
+static void residualSumsAvx2( int coefficientCount, int pointCount, float *xValues, float *yValues,
+                              double *coefficients, double *pRhsSums )
+{
+    if( coefficientCount > KERNEL_MAX_COEFFICIENTS )
+    {
+        residualSumsScalar( coefficientCount, pointCount, xValues, yValues, coefficients, pRhsSums );
+        return;
+    }
+
+    __m256d rhsAcc[ KERNEL_MAX_COEFFICIENTS ];
+    int i = 0;
+
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        rhsAcc[j] = _mm256_setzero_pd();
+    }
+
+    for( ; (i + 8) <= pointCount; i += 8 )
+    {
+        __m256d x0 = _mm256_cvtps_pd( _mm_loadu_ps( &xValues[i] )), x1 = _mm256_cvtps_pd( _mm_loadu_ps( &xValues[i + 4] ));
+        __m256d f0 = _mm256_set1_pd( coefficients[0] ), f1 = f0;
+
+        for( int c = 1; c < coefficientCount; c++ )
+        {
+            __m256d coefficient = _mm256_set1_pd( coefficients[c] );
+            f0 = _mm256_add_pd( _mm256_mul_pd( f0, x0 ), coefficient );
+            f1 = _mm256_add_pd( _mm256_mul_pd( f1, x1 ), coefficient );
+        }
+
+        __m256d p0 = _mm256_sub_pd( _mm256_cvtps_pd( _mm_loadu_ps( &yValues[i] )), f0 );
+        __m256d p1 = _mm256_sub_pd( _mm256_cvtps_pd( _mm_loadu_ps( &yValues[i + 4] )), f1 );
+        for( int j = 0; j < coefficientCount; j++ )
+        {
+            rhsAcc[j] = _mm256_add_pd( rhsAcc[j], _mm256_add_pd( p0, p1 ));
+            p0 = _mm256_mul_pd( p0, x0 );
+            p1 = _mm256_mul_pd( p1, x1 );
+        }
+    }
+
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        double lanes[4];
+        _mm256_storeu_pd( lanes, rhsAcc[j] );
+        pRhsSums[j] += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+
+    residualSumsScalar( coefficientCount, pointCount - i, &xValues[i], &yValues[i], coefficients, pRhsSums );
+}
+
+//--------------------------------------------------------
+// residualSumsAvx512()
+// Eight lanes of doubles, two vectors of points per step.
+//--------------------------------------------------------
+__attribute__(( target( "avx512f" ) ))
+static void residualSumsAvx512( int coefficientCount, int pointCount, float *xValues, float *yValues,
+                                double *coefficients, double *pRhsSums )
+{
+    if( coefficientCount > KERNEL_MAX_COEFFICIENTS )
+    {
+        residualSumsScalar( coefficientCount, pointCount, xValues, yValues, coefficients, pRhsSums );
+        return;
+    }
+
+    __m512d rhsAcc[ KERNEL_MAX_COEFFICIENTS ];
+    int i = 0;
+
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        rhsAcc[j] = _mm512_setzero_pd();
+    }
+
+    for( ; (i + 16) <= pointCount; i += 16 )
+    {
+        __m512d x0 = _mm512_cvtps_pd( _mm256_loadu_ps( &xValues[i] ));
+        __m512d x1 = _mm512_cvtps_pd( _mm256_loadu_ps( &xValues[i + 8] ));
+        __m512d f0 = _mm512_set1_pd( coefficients[0] ), f1 = f0;
+
+        for( int c = 1; c < coefficientCount; c++ )
+        {
+            __m512d coefficient = _mm512_set1_pd( coefficients[c] );
+            f0 = _mm512_add_pd( _mm512_mul_pd( f0, x0 ), coefficient );
+            f1 = _mm512_add_pd( _mm512_mul_pd( f1, x1 ), coefficient );
+        }
+
+        __m512d p0 = _mm512_sub_pd( _mm512_cvtps_pd( _mm256_loadu_ps( &yValues[i] )), f0 );
+        __m512d p1 = _mm512_sub_pd( _mm512_cvtps_pd( _mm256_loadu_ps( &yValues[i + 8] )), f1 );
+        for( int j = 0; j < coefficientCount; j++ )
+        {
+            rhsAcc[j] = _mm512_add_pd( rhsAcc[j], _mm512_add_pd( p0, p1 ));
+            p0 = _mm512_mul_pd( p0, x0 );
+            p1 = _mm512_mul_pd( p1, x1 );
+        }
+    }
+
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        double lanes[8];
+        _mm512_storeu_pd( lanes, rhsAcc[j] );
+        pRhsSums[j] += ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+                       ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+
+    residualSumsScalar( coefficientCount, pointCount - i, &xValues[i], &yValues[i], coefficients, pRhsSums );
+}
+
+//--------------------------------------------------------
+// convolveAvx2()
+// Computes four neighbouring outputs per vector, each
+// lane adding its terms in the same order as the scalar
+// kernel, so the results match it exactly.
+//--------------------------------------------------------
+__attribute__(( target( "avx2" ) ))
+static void convolveAvx2( int outputCount, double *inValues, double *weights, int weightCount,
+                          double *outValues )
+{
+    int i = 0;
+
+    for( ; (i + 4) <= outputCount; i += 4 )
+    {
+        __m256d sum = _mm256_setzero_pd();
+        for( int j = 0; j < weightCount; j++ )
+        {
+            sum = _mm256_add_pd( sum, _mm256_mul_pd( _mm256_set1_pd( weights[j] ), _mm256_loadu_pd( &inValues[i + j] )));
+        }
+        _mm256_storeu_pd( &outValues[i], sum );
+    }
+    convolveScalar( outputCount - i, &inValues[i], weights, weightCount, &outValues[i] );
+}
+
+//--------------------------------------------------------
+// convolveAvx512()
+// Computes eight neighbouring outputs per vector.
+//--------------------------------------------------------
+__attribute__(( target( "avx512f" ) ))
+static void convolveAvx512( int outputCount, double *inValues, double *weights, int weightCount,
+                            double *outValues )
+{
+    int i = 0;
+
+    for( ; (i + 8) <= outputCount; i += 8 )
+    {
+        __m512d sum = _mm512_setzero_pd();
+        for( int j = 0; j < weightCount; j++ )
+        {
+            sum = _mm512_add_pd( sum, _mm512_mul_pd( _mm512_set1_pd( weights[j] ), _mm512_loadu_pd( &inValues[i + j] )));
+        }
+        _mm512_storeu_pd( &outValues[i], sum );
+    }
+    convolveScalar( outputCount - i, &inValues[i], weights, weightCount, &outValues[i] );
+}
+
+//--------------------------------------------------------
+// evaluateAvx2()
+// Four points per vector. Each point's Horner chain
+// depends on its previous step, so several vectors are
+// evaluated side by side to keep the multiplier busy:
+// four for values alone, two with derivatives. Each lane
+// does the scalar kernel's arithmetic, so the results
+// match it exactly.
+//--------------------------------------------------------
+__attribute__(( target( "avx2" ) ))
+static void evaluateAvx2( int coefficientCount, double *coefficients, int pointCount, double *xValues,
+                          double *yValues, double *firstDerivatives, double *secondDerivatives )
+{
+    int i = 0;
+
+    if( (NULL == firstDerivatives) && (NULL == secondDerivatives) )
+    {
+        for( ; (i + 16) <= pointCount; i += 16 )
+        {
+            __m256d x0 = _mm256_loadu_pd( &xValues[i] ), x1 = _mm256_loadu_pd( &xValues[i + 4] );
+            __m256d x2 = _mm256_loadu_pd( &xValues[i + 8] ), x3 = _mm256_loadu_pd( &xValues[i + 12] );
+            __m256d v0 = _mm256_set1_pd( coefficients[0] ), v1 = v0, v2 = v0, v3 = v0;
+            for( int c = 1; c < coefficientCount; c++ )
+            {
+                __m256d coefficient = _mm256_set1_pd( coefficients[c] );
+                v0 = _mm256_add_pd( _mm256_mul_pd( v0, x0 ), coefficient );
+                v1 = _mm256_add_pd( _mm256_mul_pd( v1, x1 ), coefficient );
+                v2 = _mm256_add_pd( _mm256_mul_pd( v2, x2 ), coefficient );
+                v3 = _mm256_add_pd( _mm256_mul_pd( v3, x3 ), coefficient );
+            }
+            _mm256_storeu_pd( &yValues[i], v0 );
+            _mm256_storeu_pd( &yValues[i + 4], v1 );
+            _mm256_storeu_pd( &yValues[i + 8], v2 );
+            _mm256_storeu_pd( &yValues[i + 12], v3 );
+        }
+    }
+    else
+    {
+        __m256d two = _mm256_set1_pd( 2.0 );
+        for( ; (i + 8) <= pointCount; i += 8 )
+        {
+            __m256d x0 = _mm256_loadu_pd( &xValues[i] ), x1 = _mm256_loadu_pd( &xValues[i + 4] );
+            __m256d v0 = _mm256_set1_pd( coefficients[0] ), v1 = v0;
+            __m256d s0 = _mm256_setzero_pd(), s1 = s0;          // Slopes.
+            __m256d h0 = _mm256_setzero_pd(), h1 = h0;          // Half curvatures.
+            for( int c = 1; c < coefficientCount; c++ )
+            {
+                __m256d coefficient = _mm256_set1_pd( coefficients[c] );
+                h0 = _mm256_add_pd( _mm256_mul_pd( h0, x0 ), s0 );
+                h1 = _mm256_add_pd( _mm256_mul_pd( h1, x1 ), s1 );
+                s0 = _mm256_add_pd( _mm256_mul_pd( s0, x0 ), v0 );
+                s1 = _mm256_add_pd( _mm256_mul_pd( s1, x1 ), v1 );
+                v0 = _mm256_add_pd( _mm256_mul_pd( v0, x0 ), coefficient );
+                v1 = _mm256_add_pd( _mm256_mul_pd( v1, x1 ), coefficient );
+            }
+            _mm256_storeu_pd( &yValues[i], v0 );
+            _mm256_storeu_pd( &yValues[i + 4], v1 );
+            if( NULL != firstDerivatives )
+            {
+                _mm256_storeu_pd( &firstDerivatives[i], s0 );
+                _mm256_storeu_pd( &firstDerivatives[i + 4], s1 );
+            }
+            if( NULL != secondDerivatives )
+            {
+                _mm256_storeu_pd( &secondDerivatives[i], _mm256_mul_pd( two, h0 ));
+                _mm256_storeu_pd( &secondDerivatives[i + 4], _mm256_mul_pd( two, h1 ));
+            }
+        }
+    }
+
+    evaluateScalar( coefficientCount, coefficients, pointCount - i, &xValues[i], &yValues[i],
+                    (NULL != firstDerivatives) ? &firstDerivatives[i] : NULL,
+                    (NULL != secondDerivatives) ? &secondDerivatives[i] : NULL );
+}
+
+//--------------------------------------------------------
+// evaluateAvx512()
+// Eight points per vector, otherwise as evaluateAvx2().
+//--------------------------------------------------------
+__attribute__(( target( "avx512f" ) ))
+static void evaluateAvx512( int coefficientCount, double *coefficients, int pointCount, double *xValues,
+                            double *yValues, double *firstDerivatives, double *secondDerivatives )
+{
+    int i = 0;
+
+    if( (NULL == firstDerivatives) && (NULL == secondDerivatives) )
+    {
+        for( ; (i + 32) <= pointCount; i += 32 )
+        {
+            __m512d x0 = _mm512_loadu_pd( &xValues[i] ), x1 = _mm512_loadu_pd( &xValues[i + 8] );
+            __m512d x2 = _mm512_loadu_pd( &xValues[i + 16] ), x3 = _mm512_loadu_pd( &xValues[i + 24] );
+            __m512d v0 = _mm512_set1_pd( coefficients[0] ), v1 = v0, v2 = v0, v3 = v0;
+            for( int c = 1; c < coefficientCount; c++ )
+            {
+                __m512d coefficient = _mm512_set1_pd( coefficients[c] );
+                v0 = _mm512_add_pd( _mm512_mul_pd( v0, x0 ), coefficient );
+                v1 = _mm512_add_pd( _mm512_mul_pd( v1, x1 ), coefficient );
+                v2 = _mm512_add_pd( _mm512_mul_pd( v2, x2 ), coefficient );
+                v3 = _mm512_add_pd( _mm512_mul_pd( v3, x3 ), coefficient );
+            }
+            _mm512_storeu_pd( &yValues[i], v0 );
+            _mm512_storeu_pd( &yValues[i + 8], v1 );
+            _mm512_storeu_pd( &yValues[i + 16], v2 );
+            _mm512_storeu_pd( &yValues[i + 24], v3 );
+        }
+    }
+    else
+    {
+        __m512d two = _mm512_set1_pd( 2.0 );
+        for( ; (i + 16) <= pointCount; i += 16 )
+        {
+            __m512d x0 = _mm512_loadu_pd( &xValues[i] ), x1 = _mm512_loadu_pd( &xValues[i + 8] );
+            __m512d v0 = _mm512_set1_pd( coefficients[0] ), v1 = v0;
+            __m512d s0 = _mm512_setzero_pd(), s1 = s0;          // Slopes.
+            __m512d h0 = _mm512_setzero_pd(), h1 = h0;          // Half curvatures.
+            for( int c = 1; c < coefficientCount; c++ )
+            {
+                __m512d coefficient = _mm512_set1_pd( coefficients[c] );
+                h0 = _mm512_add_pd( _mm512_mul_pd( h0, x0 ), s0 );
+                h1 = _mm512_add_pd( _mm512_mul_pd( h1, x1 ), s1 );
+                s0 = _mm512_add_pd( _mm512_mul_pd( s0, x0 ), v0 );
+                s1 = _mm512_add_pd( _mm512_mul_pd( s1, x1 ), v1 );
+                v0 = _mm512_add_pd( _mm512_mul_pd( v0, x0 ), coefficient );
+                v1 = _mm512_add_pd( _mm512_mul_pd( v1, x1 ), coefficient );
+            }
+            _mm512_storeu_pd( &yValues[i], v0 );
+            _mm512_storeu_pd( &yValues[i + 8], v1 );
+            if( NULL != firstDerivatives )
+            {
+                _mm512_storeu_pd( &firstDerivatives[i], s0 );
+                _mm512_storeu_pd( &firstDerivatives[i + 8], s1 );
+            }
+            if( NULL != secondDerivatives )
+            {
+                _mm512_storeu_pd( &secondDerivatives[i], _mm512_mul_pd( two, h0 ));
+                _mm512_storeu_pd( &secondDerivatives[i + 8], _mm512_mul_pd( two, h1 ));
+            }
+        }
+    }
+
+    evaluateScalar( coefficientCount, coefficients, pointCount - i, &xValues[i], &yValues[i],
+                    (NULL != firstDerivatives) ? &firstDerivatives[i] : NULL,
+                    (NULL != secondDerivatives) ? &secondDerivatives[i] : NULL );
+}
+
+#endif  // POLYKERNEL_X86
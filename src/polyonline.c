@@ -0,0 +1,481 @@
+// Name: polyonline.c
+// Description: Online fits of a stream's latest points, by sliding window or forgetting factor.
+// Author: Henry M. Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+#include "polyfit_internal.h"
+
+
+//------------------------------------------------
+// Private Function Prototypes
+//------------------------------------------------
+
+static void     addPoint( polyfit_online_t *pOnline, double x, double y, double weight );
+static void     updateState( polyfit_online_t *pOnline, double x, double y );
+static int      rebuild( polyfit_online_t *pOnline );
+static int      solveSums( polyfit_online_t *pOnline, double *pTResults );
+
+
+//=========================================================
+//      Global function definitions
+//=========================================================
+
+
+//--------------------------------------------------------
+// polyfit_online_init()
+// Prepares an online fit with coefficientCount
+// coefficients, keeping the latest windowLength points.
+//
+// With a forgetting of 1 it fits exactly the points in
+// the window, as polyfit() would. Each point added to, or
+// dropped from, the window adds its powers to, or takes
+// them from, the window's power sums, in O(coefficientCount)
+// time, and the fit is only solved when asked for.
+//
+// With a forgetting below 1 it fits every point so far,
+// each weighted by forgetting to the power of its age in
+// points, by recursive least squares: each point updates
+// the coefficients and the matrix P, the inverse of the
+// weighted normal matrix, in O(coefficientCount^2) time,
+// so the fit is always ready. The window then only keeps
+// points for rebuilds; those older than it weigh less
+// than forgetting^windowLength, and are dropped at the
+// next rebuild.
+//
+// Either way, the sums or state are rebuilt from the kept
+// points every rebuildInterval points, windowLength by
+// default, undoing any drift from rounding, and moving
+// the origin to the weighted mean of the kept x values,
+// which keeps the sums well conditioned.
+//
+// Release it with polyfit_online_free().
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (windowLength < coefficientCount),
+//          -3 if unable to allocate memory,
+//          -5 if coefficientCount < 1, or forgetting is
+//             not above 0 and at most 1.
+//--------------------------------------------------------
+int polyfit_online_init( polyfit_online_t *pOnline, int coefficientCount, int windowLength, double forgetting )
+{
+    if( NULL == pOnline )
+    {
+        return -1;
+    }
+
+    pOnline->coefficientCount = 0;
+    pOnline->windowLength = 0;
+    pOnline->pointCount = 0;
+    pOnline->pXValues = NULL;
+
+    if( (coefficientCount < 1) || !(forgetting > 0.0) || !(forgetting <= 1.0) )
+    {
+        return -5;
+    }
+    if( windowLength < coefficientCount )
+    {
+        return -2;
+    }
+
+    int sumCount = (3 * coefficientCount) - 1;
+    int stateCount = coefficientCount * (coefficientCount + 1);
+    int scratchCount = ((coefficientCount * (coefficientCount + 1)) / 2) + (4 * coefficientCount);
+    double *pMemory = (double *) polyfitCalloc( (2 * (size_t) windowLength) + sumCount + stateCount + scratchCount,
+                                                sizeof( double ));
+    if( NULL == pMemory )
+    {
+        return -3;
+    }
+
+    pOnline->coefficientCount = coefficientCount;
+    pOnline->windowLength = windowLength;
+    pOnline->forgetting = forgetting;
+    pOnline->rebuildInterval = windowLength;
+    pOnline->oldest = 0;
+    pOnline->sinceRebuild = 0;
+    pOnline->primed = false;
+    pOnline->origin = 0.0;
+    pOnline->pXValues = pMemory;
+    pOnline->pYValues = &(pOnline->pXValues[ windowLength ]);
+    pOnline->pSums = &(pOnline->pYValues[ windowLength ]);
+    pOnline->pState = &(pOnline->pSums[ sumCount ]);
+    pOnline->pScratch = &(pOnline->pState[ stateCount ]);
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_online_add()
+// Adds the newest point. If the window is full, its
+// oldest point is dropped first. The x values need not be
+// evenly spaced, or even in order.
+//
+// With a forgetting below 1, the fit starts once there
+// are coefficientCount points, and waits for more if
+// those can't be solved.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer.
+//--------------------------------------------------------
+int polyfit_online_add( polyfit_online_t *pOnline, double x, double y )
+{
+    if( (NULL == pOnline) || (NULL == pOnline->pXValues) )
+    {
+        return -1;
+    }
+
+    bool window = (1.0 == pOnline->forgetting);
+    if( pOnline->pointCount == pOnline->windowLength )
+    {
+        if( window )
+        {
+            addPoint( pOnline, pOnline->pXValues[ pOnline->oldest ], pOnline->pYValues[ pOnline->oldest ], -1.0 );
+        }
+        pOnline->oldest = (pOnline->oldest + 1) % pOnline->windowLength;
+        pOnline->pointCount--;
+    }
+
+    int newest = (pOnline->oldest + pOnline->pointCount) % pOnline->windowLength;
+    pOnline->pXValues[ newest ] = x;
+    pOnline->pYValues[ newest ] = y;
+    pOnline->pointCount++;
+    pOnline->sinceRebuild++;
+
+    // A window starts afresh around its first point.
+    if( (pOnline->sinceRebuild >= pOnline->rebuildInterval) || (window && (1 == pOnline->pointCount)) ||
+        (!window && !pOnline->primed && (pOnline->pointCount >= pOnline->coefficientCount)) )
+    {
+        // If the rebuild fails, the old state carries on.
+        if( (0 != rebuild( pOnline )) && pOnline->primed )
+        {
+            updateState( pOnline, x, y );
+        }
+    }
+    else if( window )
+    {
+        addPoint( pOnline, x, y, 1.0 );
+    }
+    else if( pOnline->primed )
+    {
+        updateState( pOnline, x, y );
+    }
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_online_remove()
+// Drops the oldest point from a sliding window, so
+// callers can keep, say, only the points of the last
+// minute.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if the window is empty,
+//          -5 if forgetting is below 1.
+//--------------------------------------------------------
+int polyfit_online_remove( polyfit_online_t *pOnline )
+{
+    if( (NULL == pOnline) || (NULL == pOnline->pXValues) )
+    {
+        return -1;
+    }
+    if( 1.0 != pOnline->forgetting )
+    {
+        return -5;
+    }
+    if( 0 == pOnline->pointCount )
+    {
+        return -2;
+    }
+
+    addPoint( pOnline, pOnline->pXValues[ pOnline->oldest ], pOnline->pYValues[ pOnline->oldest ], -1.0 );
+    pOnline->oldest = (pOnline->oldest + 1) % pOnline->windowLength;
+    pOnline->pointCount--;
+    if( 0 == pOnline->pointCount )
+    {
+        rebuild( pOnline );
+    }
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_online_solve()
+// Gets the coefficients of the current fit, highest power
+// first, in x rather than x - origin, as polyfit() gives
+// them. A sliding window is solved from its power sums by
+// Cholesky, in O(coefficientCount^3) time; with a
+// forgetting below 1 the coefficients are already known.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if there are fewer points than coefficients,
+//          -4 if unable to solve equations.
+//--------------------------------------------------------
+int polyfit_online_solve( polyfit_online_t *pOnline, double *coefficientResults )
+{
+    int rVal = 0;
+
+    if( (NULL == pOnline) || (NULL == pOnline->pXValues) || (NULL == coefficientResults) )
+    {
+        return -1;
+    }
+
+    int coefficientCount = pOnline->coefficientCount;
+    if( pOnline->pointCount < coefficientCount )
+    {
+        return -2;
+    }
+
+    double *pTResults = pOnline->pState;
+    if( 1.0 == pOnline->forgetting )
+    {
+        pTResults = &(pOnline->pScratch[ ((coefficientCount * (coefficientCount + 1)) / 2) + (3 * coefficientCount) ]);
+        rVal = solveSums( pOnline, pTResults );
+    }
+    else if( !pOnline->primed )
+    {
+        rVal = -4;
+    }
+
+    if( 0 == rVal )
+    {
+        // Substitute t = x - origin by Horner's rule on polynomials, as
+        // polyfit_uniform() does.
+        double offset = -pOnline->origin;
+        coefficientResults[0] = pTResults[0];
+        for( int c = 1; c < coefficientCount; c++ )
+        {
+            coefficientResults[c] = offset * coefficientResults[ c - 1 ];
+            for( int r = c - 1; r > 0; r-- )
+            {
+                coefficientResults[r] += offset * coefficientResults[ r - 1 ];
+            }
+            coefficientResults[c] += pTResults[c];
+        }
+    }
+    return rVal;
+}
+
+//--------------------------------------------------------
+// polyfit_online_free()
+// Releases the memory held by an online fit.
+//--------------------------------------------------------
+void polyfit_online_free( polyfit_online_t *pOnline )
+{
+    if( NULL != pOnline )
+    {
+        // Everything shares the kept x values' allocation.
+        polyfitFree( pOnline->pXValues );
+        pOnline->pXValues = NULL;
+        pOnline->pointCount = 0;
+    }
+}
+
+
+//=========================================================
+//      Private function definitions
+//=========================================================
+
+//--------------------------------------------------------
+// addPoint()
+// Adds weight times a point's powers of x - origin to the
+// power sums; a weight of -1 takes them away.
+//--------------------------------------------------------
+static void addPoint( polyfit_online_t *pOnline, double x, double y, double weight )
+{
+    int coefficientCount = pOnline->coefficientCount;
+    int powerSumCount = (2 * coefficientCount) - 1;
+    double *pRhsSums = &(pOnline->pSums[ powerSumCount ]);
+    double t = x - pOnline->origin;
+    double power = weight;
+
+    for( int j = 0; j < powerSumCount; j++ )
+    {
+        pOnline->pSums[j] += power;
+        if( j < coefficientCount )
+        {
+            pRhsSums[j] += power * y;
+        }
+        power *= t;
+    }
+}
+
+//--------------------------------------------------------
+// updateState()
+// One step of recursive least squares with forgetting
+// factor f. With phi the powers of t = x - origin, highest
+// first, and P the inverse of the weighted normal matrix,
+//      v = P phi,  d = f + (phi)T v,
+//      c = c + v (y - (phi)T c) / d,
+//      P = (P - v (v)T / d) / f.
+//--------------------------------------------------------
+static void updateState( polyfit_online_t *pOnline, double x, double y )
+{
+    int coefficientCount = pOnline->coefficientCount;
+    double *pCoefficients = pOnline->pState;
+    double *pInverse = &(pCoefficients[ coefficientCount ]);
+    double *pPhi = &(pOnline->pScratch[ ((coefficientCount * (coefficientCount + 1)) / 2) + coefficientCount ]);
+    double *pGain = &(pPhi[ coefficientCount ]);
+    double t = x - pOnline->origin;
+
+    pPhi[ coefficientCount - 1 ] = 1.0;
+    for( int r = coefficientCount - 2; r >= 0; r-- )
+    {
+        pPhi[r] = pPhi[ r + 1 ] * t;
+    }
+
+    double denominator = pOnline->forgetting;
+    double error = y;
+    for( int r = 0; r < coefficientCount; r++ )
+    {
+        double sum = 0.0;
+        for( int c = 0; c < coefficientCount; c++ )
+        {
+            sum += pInverse[ (r * coefficientCount) + c ] * pPhi[c];
+        }
+        pGain[r] = sum;
+        denominator += pPhi[r] * sum;
+        error -= pPhi[r] * pCoefficients[r];
+    }
+
+    for( int r = 0; r < coefficientCount; r++ )
+    {
+        pCoefficients[r] += pGain[r] * error / denominator;
+        for( int c = 0; c < coefficientCount; c++ )
+        {
+            pInverse[ (r * coefficientCount) + c ] = (pInverse[ (r * coefficientCount) + c ] -
+                                                      (pGain[r] * pGain[c] / denominator)) / pOnline->forgetting;
+        }
+    }
+}
+
+//--------------------------------------------------------
+// rebuild()
+// Recomputes the power sums from the kept points, each
+// weighted by forgetting to the power of its age, about
+// their weighted mean x. With forgetting below 1, then
+// solves them for the coefficients and P.
+// Returns   0 if success,
+//          -4 if unable to solve equations, leaving any
+//             earlier state in place.
+//--------------------------------------------------------
+static int rebuild( polyfit_online_t *pOnline )
+{
+    int coefficientCount = pOnline->coefficientCount;
+    int rVal = 0;
+    double oldOrigin = pOnline->origin;
+
+    pOnline->sinceRebuild = 0;
+    double weightSum = 0.0;
+    double xSum = 0.0;
+    for( int i = 0; i < pOnline->pointCount; i++ )
+    {
+        weightSum = (weightSum * pOnline->forgetting) + 1.0;
+        xSum = (xSum * pOnline->forgetting) + pOnline->pXValues[ (pOnline->oldest + i) % pOnline->windowLength ];
+    }
+    pOnline->origin = (pOnline->pointCount > 0) ? xSum / weightSum : 0.0;
+    for( int j = 0; j < (3 * coefficientCount) - 1; j++ )
+    {
+        pOnline->pSums[j] = 0.0;
+    }
+    for( int i = 0; i < pOnline->pointCount; i++ )
+    {
+        int p = (pOnline->oldest + i) % pOnline->windowLength;
+        if( 1.0 != pOnline->forgetting )
+        {
+            for( int j = 0; j < (3 * coefficientCount) - 1; j++ )
+            {
+                pOnline->pSums[j] *= pOnline->forgetting;
+            }
+        }
+        addPoint( pOnline, pOnline->pXValues[p], pOnline->pYValues[p], 1.0 );
+    }
+
+    if( (1.0 != pOnline->forgetting) && (pOnline->pointCount >= coefficientCount) )
+    {
+        double *pFactor = pOnline->pScratch;
+        double *pUnit = &(pFactor[ (coefficientCount * (coefficientCount + 1)) / 2 ]);
+        double *pColumn = &(pUnit[ coefficientCount ]);
+        double *pInverse = &(pOnline->pState[ coefficientCount ]);
+
+        rVal = solveSums( pOnline, pColumn );
+        if( 0 == rVal )
+        {
+            for( int r = 0; r < coefficientCount; r++ )
+            {
+                pOnline->pState[r] = pColumn[r];
+            }
+            // P is the inverse of the normal matrix, a column at a time.
+            for( int c = 0; c < coefficientCount; c++ )
+            {
+                for( int r = 0; r < coefficientCount; r++ )
+                {
+                    pUnit[r] = (r == c) ? 1.0 : 0.0;
+                }
+                polyfitCholeskySolve( coefficientCount, pFactor, pUnit, pColumn );
+                for( int r = 0; r < coefficientCount; r++ )
+                {
+                    pInverse[ (r * coefficientCount) + c ] = pColumn[r];
+                }
+            }
+            pOnline->primed = true;
+        }
+        else
+        {
+            // The state still belongs to the old origin.
+            pOnline->origin = oldOrigin;
+        }
+    }
+    return rVal;
+}
+
+//--------------------------------------------------------
+// solveSums()
+// Solves the power sums for the coefficients in
+// x - origin, highest power first, leaving the Cholesky
+// factor at the start of the scratch memory.
+// Returns   0 if success,
+//          -4 if unable to solve equations.
+//--------------------------------------------------------
+static int solveSums( polyfit_online_t *pOnline, double *pTResults )
+{
+    int coefficientCount = pOnline->coefficientCount;
+    int degree = coefficientCount - 1;
+    double *pFactor = pOnline->pScratch;
+    double *pRhs = &(pFactor[ (coefficientCount * (coefficientCount + 1)) / 2 ]);
+    double *pRhsSums = &(pOnline->pSums[ (2 * coefficientCount) - 1 ]);
+
+    int rVal = polyfitCholeskyFactor( coefficientCount, pOnline->pSums, pFactor );
+    if( 0 == rVal )
+    {
+        for( int r = 0; r < coefficientCount; r++ )
+        {
+            pRhs[r] = pRhsSums[ degree - r ];
+        }
+        polyfitCholeskySolve( coefficientCount, pFactor, pRhs, pTResults );
+    }
+    return rVal;
+}
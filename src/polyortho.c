@@ -0,0 +1,445 @@
+// Name: polyortho.c
+// Description: Least squares fitting by discrete orthogonal polynomials, with Chebyshev series output.
+// Author: Henry M. Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+#include <float.h>      // DBL_EPSILON
+
+#include "polyfit_internal.h"
+
+
+//------------------------------------------------
+// Private Function Prototypes
+//------------------------------------------------
+
+static void     getInterval( double low, double high, double *pMiddle, double *pHalfWidth );
+static void     multiplyByT( int count, double *pSeries, double *pProduct );
+static void     stepPoints( int pointCount, double *pT, double *pCurrent, double *pPrevious, double *pResidual,
+                            double coefficient, double alpha, double beta, double *pSums );
+
+
+//=========================================================
+//      Global function definitions
+//=========================================================
+
+
+//--------------------------------------------------------
+// polyfit_orthogonal()
+// Same as polyfit(), but fits by discrete orthogonal
+// polynomials, never forming the normal equations; see
+// polyfit_chebyshev(). The fit is then rewritten in the
+// monomial form, highest power first, that polyfit()
+// gives.
+//
+// The monomial form of a high degree polynomial is itself
+// sensitive to rounding, more so the farther the points
+// are from x = 0, so for high degrees the Chebyshev
+// series from polyfit_chebyshev() keeps more of the fit's
+// accuracy.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < coefficientCount),
+//          -3 if unable to allocate memory,
+//          -4 if there are fewer distinct x values than
+//             coefficients,
+//          -5 if coefficientCount < 1.
+//--------------------------------------------------------
+int polyfit_orthogonal( int pointCount, double *xValues, double *yValues, int coefficientCount,
+                        double *coefficientResults )
+{
+    double low = 0.0;
+    double high = 0.0;
+    double middle = 0.0;
+    double halfWidth = 1.0;
+
+    if( NULL == coefficientResults )
+    {
+        return -1;
+    }
+
+    int rVal = polyfit_chebyshev( pointCount, xValues, yValues, coefficientCount, &low, &high, coefficientResults );
+    if( 0 != rVal )
+    {
+        return rVal;
+    }
+    getInterval( low, high, &middle, &halfWidth );
+
+    // The series is turned into powers of t = (x - middle) / halfWidth,
+    // lowest first, expanding each T_m as 2t T_(m-1) - T_(m-2). Then
+    // Horner's rule in the linear t = scale * x + offset gives powers of x.
+    double *pWork = (double *) polyfitCalloc( 5 * (size_t) coefficientCount, sizeof( double ));
+    if( NULL == pWork )
+    {
+        return -3;
+    }
+    double *pTPowers = pWork;                                   // The fit in powers of t.
+    double *pXPowers = &(pWork[ coefficientCount ]);            // The fit in powers of x.
+    double *pOlder = &(pWork[ 2 * coefficientCount ]);          // T_(m-2) in powers of t.
+    double *pOld = &(pWork[ 3 * coefficientCount ]);            // T_(m-1).
+    double *pNew = &(pWork[ 4 * coefficientCount ]);            // T_m.
+
+    pTPowers[0] = coefficientResults[0];
+    pOld[0] = 1.0;
+    for( int m = 1; m < coefficientCount; m++ )
+    {
+        for( int p = 0; p <= m; p++ )
+        {
+            double shifted = (p > 0) ? pOld[ p - 1 ] : 0.0;
+            pNew[p] = (1 == m) ? shifted : (2.0 * shifted) - pOlder[p];
+        }
+        double *pSwap = pOlder;
+        pOlder = pOld;
+        pOld = pNew;
+        pNew = pSwap;
+        for( int p = 0; p <= m; p++ )
+        {
+            pTPowers[p] += coefficientResults[m] * pOld[p];
+        }
+    }
+
+    double scale = 1.0 / halfWidth;
+    double offset = -middle / halfWidth;
+    pXPowers[0] = pTPowers[ coefficientCount - 1 ];
+    for( int m = coefficientCount - 2; m >= 0; m-- )
+    {
+        int degree = coefficientCount - 2 - m;
+        for( int p = degree + 1; p >= 0; p-- )
+        {
+            double raised = (p > 0) ? scale * pXPowers[ p - 1 ] : 0.0;
+            pXPowers[p] = raised + ((p <= degree) ? offset * pXPowers[p] : 0.0);
+        }
+        pXPowers[0] += pTPowers[m];
+    }
+    for( int c = 0; c < coefficientCount; c++ )
+    {
+        coefficientResults[c] = pXPowers[ coefficientCount - 1 - c ];
+    }
+
+    polyfitFree( pWork );
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_chebyshev()
+// Fits a polynomial with coefficientCount coefficients to
+// a set of points by discrete orthogonal polynomials
+// (Forsythe's method), and gives it as a Chebyshev series
+//      y = c0 T0(t) + c1 T1(t) + ...
+// in t = (2x - (low + high)) / (high - low), where low and
+// high are the least and greatest x, so t covers -1 .. 1.
+// chebyshevResults receives c0, c1, ..., lowest first, and
+// *pLow and *pHigh the interval; evaluate the series with
+// polyval_chebyshev().
+//
+// The polynomials orthogonal over the points are built by
+// the three term recurrence
+//      p(j+1) = (t - a(j+1)) p(j) - b(j) p(j-1),
+// each coefficient is the projection of what's left of y
+// onto the next of them, and each is rewritten as a
+// Chebyshev series as it goes. So there is no normal
+// matrix to solve, the cost is O(pointCount *
+// coefficientCount), and the fit stays accurate at
+// degrees where the normal equations can't be solved.
+//
+// One allocation holds t, the last two orthogonal
+// polynomials and the residual at each point, and those
+// polynomials as Chebyshev series. Each degree takes one
+// pass over the points, which takes its part from the
+// residual, steps the recurrence, and sums what the next
+// degree's coefficient and recurrence constants need.
+// Projecting the residual, rather than y, keeps the
+// coefficients accurate when rounding leaves the
+// polynomials slightly short of orthogonal.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < coefficientCount),
+//          -3 if unable to allocate memory,
+//          -4 if there are fewer distinct x values than
+//             coefficients,
+//          -5 if coefficientCount < 1.
+//--------------------------------------------------------
+int polyfit_chebyshev( int pointCount, double *xValues, double *yValues, int coefficientCount,
+                       double *pLow, double *pHigh, double *chebyshevResults )
+{
+    double middle = 0.0;
+    double halfWidth = 1.0;
+
+    if( (NULL == xValues) || (NULL == yValues) || (NULL == pLow) || (NULL == pHigh) || (NULL == chebyshevResults) )
+    {
+        return -1;
+    }
+    if( coefficientCount < 1 )
+    {
+        return -5;
+    }
+    if( pointCount < coefficientCount )
+    {
+        return -2;
+    }
+
+    double *pWork = (double *) polyfitCalloc( (4 * (size_t) pointCount) + (3 * (size_t) coefficientCount),
+                                              sizeof( double ));
+    if( NULL == pWork )
+    {
+        return -3;
+    }
+    double *pT = pWork;
+    double *pCurrent = &(pT[ pointCount ]);                     // p(j) at each point.
+    double *pPrevious = &(pCurrent[ pointCount ]);              // p(j-1), then p(j+1).
+    double *pResidual = &(pPrevious[ pointCount ]);
+    double *pSeries = &(pResidual[ pointCount ]);               // p(j) as a Chebyshev series.
+    double *pPreviousSeries = &(pSeries[ coefficientCount ]);
+    double *pProduct = &(pPreviousSeries[ coefficientCount ]);  // t p(j), likewise.
+
+    double low = xValues[0];
+    double high = xValues[0];
+    for( int i = 1; i < pointCount; i++ )
+    {
+        low = (xValues[i] < low) ? xValues[i] : low;
+        high = (xValues[i] > high) ? xValues[i] : high;
+    }
+    getInterval( low, high, &middle, &halfWidth );
+
+    // p(0) = 1, so its sums are of t and y alone.
+    double sums[4] = { (double) pointCount, 0.0, 0.0, 0.0 };
+    double scale = 1.0 / halfWidth;
+    for( int i = 0; i < pointCount; i++ )
+    {
+        double t = (xValues[i] - middle) * scale;
+        pT[i] = t;
+        pCurrent[i] = 1.0;
+        pResidual[i] = yValues[i];
+        sums[1] += yValues[i];
+        sums[2] += t;
+        sums[3] += t * t;
+    }
+    for( int c = 0; c < coefficientCount; c++ )
+    {
+        chebyshevResults[c] = 0.0;
+    }
+    pSeries[0] = 1.0;
+
+    int rVal = 0;
+    double previousNorm = 1.0;
+    double stretchedNorm = 0.0;         // The sum of (t p(j-1))^2, which p(j) is what's left of.
+    for( int j = 0; j < coefficientCount; j++ )
+    {
+        double norm = sums[0];
+
+        // With no more distinct x values than j, p(j) is zero at every
+        // point but for rounding.
+        if( (j > 0) && !(norm > coefficientCount * DBL_EPSILON * stretchedNorm) )
+        {
+            rVal = -4;
+            break;
+        }
+
+        double coefficient = sums[1] / norm;
+        for( int c = 0; c <= j; c++ )
+        {
+            chebyshevResults[c] += coefficient * pSeries[c];
+        }
+        if( j == coefficientCount - 1 )
+        {
+            break;
+        }
+
+        double alpha = sums[2] / norm;
+        double beta = (j > 0) ? norm / previousNorm : 0.0;
+        stretchedNorm = sums[3];
+        stepPoints( pointCount, pT, pCurrent, pPrevious, pResidual, coefficient, alpha, beta, sums );
+        double *pSwap = pPrevious;
+        pPrevious = pCurrent;
+        pCurrent = pSwap;
+
+        multiplyByT( j + 2, pSeries, pProduct );
+        for( int c = 0; c <= j + 1; c++ )
+        {
+            double next = pProduct[c] - (alpha * pSeries[c]) - (beta * pPreviousSeries[c]);
+            pPreviousSeries[c] = pSeries[c];
+            pSeries[c] = next;
+        }
+        previousNorm = norm;
+    }
+
+    polyfitFree( pWork );
+    if( 0 == rVal )
+    {
+        *pLow = low;
+        *pHigh = high;
+    }
+    return rVal;
+}
+
+//--------------------------------------------------------
+// polyval_chebyshev()
+// Evaluates a Chebyshev series over low .. high, as
+// polyfit_chebyshev() gives it, at each of pointCount x
+// values, storing the results in yValues. Each value
+// takes one pass of Clenshaw's recurrence,
+//      b(m) = 2t b(m+1) - b(m+2) + c(m),
+// which is as cheap as Horner's rule and as stable as the
+// series.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -5 if coefficientCount < 1, pointCount < 0 or
+//             high < low.
+//--------------------------------------------------------
+int polyval_chebyshev( int coefficientCount, double *chebyshevCoefficients, double low, double high,
+                       int pointCount, double *xValues, double *yValues )
+{
+    double middle = 0.0;
+    double halfWidth = 1.0;
+
+    if( (NULL == chebyshevCoefficients) || (NULL == xValues) || (NULL == yValues) )
+    {
+        return -1;
+    }
+    if( (coefficientCount < 1) || (pointCount < 0) || !(high >= low) )
+    {
+        return -5;
+    }
+    getInterval( low, high, &middle, &halfWidth );
+
+    for( int i = 0; i < pointCount; i++ )
+    {
+        double t = (xValues[i] - middle) / halfWidth;
+        double twoT = 2.0 * t;
+        double b1 = 0.0;
+        double b2 = 0.0;
+        for( int m = coefficientCount - 1; m >= 1; m-- )
+        {
+            double b0 = (twoT * b1) - b2 + chebyshevCoefficients[m];
+            b2 = b1;
+            b1 = b0;
+        }
+        yValues[i] = (t * b1) - b2 + chebyshevCoefficients[0];
+    }
+    return 0;
+}
+
+
+//=========================================================
+//      Private function definitions
+//=========================================================
+
+//--------------------------------------------------------
+// getInterval()
+// Finds the middle and half width of low .. high, which
+// map x to t = (x - middle) / halfWidth in -1 .. 1. If
+// they are equal, the half width is taken as 1, so every
+// x there maps to t = 0.
+//--------------------------------------------------------
+static void getInterval( double low, double high, double *pMiddle, double *pHalfWidth )
+{
+    *pMiddle = 0.5 * (low + high);
+    *pHalfWidth = (high > low) ? 0.5 * (high - low) : 1.0;
+}
+
+//--------------------------------------------------------
+// multiplyByT()
+// Multiplies a Chebyshev series of (count - 1) terms,
+// whose last place is 0, by t, giving count terms, from
+//      t T0 = T1,   t Tm = (T(m+1) + T(m-1)) / 2.
+//--------------------------------------------------------
+static void multiplyByT( int count, double *pSeries, double *pProduct )
+{
+    for( int c = 0; c < count; c++ )
+    {
+        pProduct[c] = 0.0;
+    }
+    for( int m = 0; m < count - 1; m++ )
+    {
+        if( 0 == m )
+        {
+            pProduct[1] += pSeries[0];
+        }
+        else
+        {
+            pProduct[ m + 1 ] += 0.5 * pSeries[m];
+            pProduct[ m - 1 ] += 0.5 * pSeries[m];
+        }
+    }
+}
+
+//--------------------------------------------------------
+// stepPoints()
+// At each point, takes coefficient * p(j) from the
+// residual, and writes p(j+1) = (t - alpha) p(j) -
+// beta p(j-1) over p(j-1) in pPrevious. pSums receives
+// the sums over the points of p(j+1)^2, residual *
+// p(j+1), t p(j+1)^2 and (t p(j+1))^2. Two points are
+// taken at a time into separate sums, halving the chains
+// of dependent additions.
+//--------------------------------------------------------
+static void stepPoints( int pointCount, double *pT, double *pCurrent, double *pPrevious, double *pResidual,
+                        double coefficient, double alpha, double beta, double *pSums )
+{
+    double even[4] = { 0.0, 0.0, 0.0, 0.0 };
+    double odd[4] = { 0.0, 0.0, 0.0, 0.0 };
+    int i = 0;
+
+    for( ; i + 1 < pointCount; i += 2 )
+    {
+        double residual0 = pResidual[i] - (coefficient * pCurrent[i]);
+        double residual1 = pResidual[ i + 1 ] - (coefficient * pCurrent[ i + 1 ]);
+        double next0 = ((pT[i] - alpha) * pCurrent[i]) - (beta * pPrevious[i]);
+        double next1 = ((pT[ i + 1 ] - alpha) * pCurrent[ i + 1 ]) - (beta * pPrevious[ i + 1 ]);
+        double tNext0 = pT[i] * next0;
+        double tNext1 = pT[ i + 1 ] * next1;
+        pResidual[i] = residual0;
+        pResidual[ i + 1 ] = residual1;
+        pPrevious[i] = next0;
+        pPrevious[ i + 1 ] = next1;
+        even[0] += next0 * next0;
+        odd[0] += next1 * next1;
+        even[1] += residual0 * next0;
+        odd[1] += residual1 * next1;
+        even[2] += tNext0 * next0;
+        odd[2] += tNext1 * next1;
+        even[3] += tNext0 * tNext0;
+        odd[3] += tNext1 * tNext1;
+    }
+    for( ; i < pointCount; i++ )
+    {
+        double residual = pResidual[i] - (coefficient * pCurrent[i]);
+        double next = ((pT[i] - alpha) * pCurrent[i]) - (beta * pPrevious[i]);
+        double tNext = pT[i] * next;
+        pResidual[i] = residual;
+        pPrevious[i] = next;
+        even[0] += next * next;
+        even[1] += residual * next;
+        even[2] += tNext * next;
+        even[3] += tNext * tNext;
+    }
+    for( int s = 0; s < 4; s++ )
+    {
+        pSums[s] = even[s] + odd[s];
+    }
+}
@@ -0,0 +1,247 @@
+// Name: polyparallel.c
+// Description: Multithreaded power sum accumulation for very large point counts.
+// Author: Henry M. Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+#define _POSIX_C_SOURCE 200809L     // sysconf()
+
+#include <pthread.h>    // pthread_create()
+#include <unistd.h>     // sysconf()
+
+#include "polyfit_internal.h"
+
+// The points are split into blocks of this many points. Each block's
+// power sums are kept separately and merged in block order, so the result
+// is the same whatever the thread count, and from run to run.
+#define PARALLEL_BLOCK_POINTS   (65536)
+
+// Work handed to one thread: a contiguous run of blocks.
+typedef struct parallelTask_s
+{
+    int         coefficientCount;
+    int         pointCount;         // Total points, to size the last block.
+    int         firstBlock;
+    int         endBlock;           // One past the last block.
+    double *    xValues;
+    double *    yValues;
+    double *    pBlockSums;         // (3 * coefficientCount) sums per block, the last of y^2.
+} parallelTask_t;
+
+
+//------------------------------------------------
+// Private Function Prototypes
+//------------------------------------------------
+
+static void *   sumBlocks( void *pArg );
+
+
+//=========================================================
+//      Global function definitions
+//=========================================================
+
+
+//--------------------------------------------------------
+// polyfit_parallel()
+// Same as polyfit(), but spreads the accumulation of the
+// power sums over threadCount threads. A threadCount of 0
+// uses one thread per online CPU.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < coefficientCount),
+//          -3 if unable to allocate memory,
+//          -4 if unable to solve equations,
+//          -5 if coefficientCount < 1 or threadCount < 0.
+//--------------------------------------------------------
+int polyfit_parallel( int pointCount, double *xValues, double *yValues, int coefficientCount,
+                      double *coefficientResults, int threadCount )
+{
+    int rVal = 0;
+    polyfit_accum_t accum;
+
+    if( (NULL == xValues) || (NULL == yValues) || (NULL == coefficientResults) )
+    {
+        return -1;
+    }
+    if(pointCount < coefficientCount)
+    {
+        return -2;
+    }
+
+    rVal = polyfit_accum_init( &accum, coefficientCount );
+    if( 0 == rVal )
+    {
+        rVal = polyfit_accum_add_many_parallel( &accum, pointCount, xValues, yValues, threadCount );
+    }
+    if( 0 == rVal )
+    {
+        rVal = polyfit_accum_solve( &accum, coefficientResults );
+    }
+    polyfit_accum_free( &accum );
+
+    return rVal;
+}
+
+//--------------------------------------------------------
+// polyfit_accum_add_many_parallel()
+// Adds an array of points to an accumulator, using up to
+// threadCount threads. A threadCount of 0 uses one thread
+// per online CPU.
+//
+// The points are cut into fixed size blocks, each thread
+// sums a contiguous run of blocks, and the block sums are
+// then added to the accumulator in block order. So for
+// the same points the sums are bit for bit the same with
+// any number of threads. The calling thread does one
+// share of the work itself. If a thread can't be started,
+// its share is done by the calling thread instead.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -3 if unable to allocate memory,
+//          -5 if pointCount < 0 or threadCount < 0.
+//--------------------------------------------------------
+int polyfit_accum_add_many_parallel( polyfit_accum_t *pAccum, int pointCount, double *xValues, double *yValues,
+                                     int threadCount )
+{
+    if( (NULL == pAccum) || (NULL == pAccum->pPowerSums) || (NULL == xValues) || (NULL == yValues) )
+    {
+        return -1;
+    }
+    if( (pointCount < 0) || (threadCount < 0) )
+    {
+        return -5;
+    }
+
+    if( 0 == threadCount )
+    {
+        long cpuCount = sysconf( _SC_NPROCESSORS_ONLN );
+        threadCount = (cpuCount > 0) ? (int) cpuCount : 1;
+    }
+
+    int coefficientCount = pAccum->coefficientCount;
+    int powerSumCount = (2 * coefficientCount) - 1;
+    int blockSumCount = powerSumCount + coefficientCount + 1;
+    int blockCount = (pointCount + PARALLEL_BLOCK_POINTS - 1) / PARALLEL_BLOCK_POINTS;
+    if( threadCount > blockCount )
+    {
+        threadCount = (blockCount > 0) ? blockCount : 1;
+    }
+
+    double *pBlockSums = (double *) polyfitCalloc( (size_t) blockCount * blockSumCount + 1, sizeof( double ));
+    parallelTask_t *pTasks = (parallelTask_t *) polyfitCalloc( threadCount, sizeof( parallelTask_t ));
+    pthread_t *pThreads = (pthread_t *) polyfitCalloc( threadCount, sizeof( pthread_t ));
+    bool *pStarted = (bool *) polyfitCalloc( threadCount, sizeof( bool ));
+    if( (NULL == pBlockSums) || (NULL == pTasks) || (NULL == pThreads) || (NULL == pStarted) )
+    {
+        polyfitFree( pBlockSums );
+        polyfitFree( pTasks );
+        polyfitFree( pThreads );
+        polyfitFree( pStarted );
+        return -3;
+    }
+
+    // Give each thread a contiguous run of blocks, so each streams
+    // through its own part of the arrays.
+    for( int t = 0; t < threadCount; t++ )
+    {
+        pTasks[t].coefficientCount = coefficientCount;
+        pTasks[t].pointCount = pointCount;
+        pTasks[t].firstBlock = (int) (((long long) blockCount * t) / threadCount);
+        pTasks[t].endBlock = (int) (((long long) blockCount * (t + 1)) / threadCount);
+        pTasks[t].xValues = xValues;
+        pTasks[t].yValues = yValues;
+        pTasks[t].pBlockSums = pBlockSums;
+    }
+    for( int t = 1; t < threadCount; t++ )
+    {
+        pStarted[t] = (0 == pthread_create( &pThreads[t], NULL, sumBlocks, &pTasks[t] ));
+    }
+    sumBlocks( &pTasks[0] );
+    for( int t = 1; t < threadCount; t++ )
+    {
+        if( pStarted[t] )
+        {
+            pthread_join( pThreads[t], NULL );
+        }
+        else
+        {
+            sumBlocks( &pTasks[t] );
+        }
+    }
+
+    // Merge in block order.
+    for( int b = 0; b < blockCount; b++ )
+    {
+        double *pSums = &(pBlockSums[ (size_t) b * blockSumCount ]);
+        for( int j = 0; j < powerSumCount; j++ )
+        {
+            pAccum->pPowerSums[j] += pSums[j];
+        }
+        for( int j = 0; j < coefficientCount; j++ )
+        {
+            pAccum->pRhsSums[j] += pSums[ powerSumCount + j ];
+        }
+        pAccum->ySquareSum += pSums[ blockSumCount - 1 ];
+    }
+    pAccum->pointCount += pointCount;
+
+    polyfitFree( pBlockSums );
+    polyfitFree( pTasks );
+    polyfitFree( pThreads );
+    polyfitFree( pStarted );
+    return 0;
+}
+
+//=========================================================
+//      Private function definitions
+//=========================================================
+
+//--------------------------------------------------------
+// sumBlocks()
+// Thread body: computes the power sums of each block in a
+// task into that block's slot of pBlockSums.
+//--------------------------------------------------------
+static void *sumBlocks( void *pArg )
+{
+    parallelTask_t *pTask = (parallelTask_t *) pArg;
+    int powerSumCount = (2 * pTask->coefficientCount) - 1;
+    int blockSumCount = powerSumCount + pTask->coefficientCount + 1;
+
+    for( int b = pTask->firstBlock; b < pTask->endBlock; b++ )
+    {
+        int first = b * PARALLEL_BLOCK_POINTS;
+        int count = pTask->pointCount - first;
+        if( count > PARALLEL_BLOCK_POINTS )
+        {
+            count = PARALLEL_BLOCK_POINTS;
+        }
+        double *pSums = &(pTask->pBlockSums[ (size_t) b * blockSumCount ]);
+        polyfitKernelPowerSums( pTask->coefficientCount, count, &(pTask->xValues[ first ]), &(pTask->yValues[ first ]),
+                                pSums, &(pSums[ powerSumCount ]), &(pSums[ blockSumCount - 1 ]) );
+    }
+    return NULL;
+}
@@ -0,0 +1,880 @@
+// Name: polypiecewise.c
+// Description: Piecewise polynomial fitting of long sorted series, one segment per task.
+// Author: Henry M. Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+#define _POSIX_C_SOURCE 200809L     // sysconf()
+
+#include <float.h>      // DBL_EPSILON
+#include <math.h>       // sqrt(), fmax()
+#include <pthread.h>    // pthread_create()
+#include <unistd.h>     // sysconf()
+
+#include "polyfit_internal.h"
+
+// Each segment's points are moved to its own coordinate, t = 0 at its
+// first knot and 1 at its last, in blocks of this many points on the way
+// to the power sum kernel.
+#define PIECEWISE_BLOCK_POINTS  (256)
+
+// A fit shared by the threads working on it. Each thread claims the next
+// unfitted segment by an atomic add on nextSegment, so threads that get
+// short or cheap segments simply take more of them.
+typedef struct piecewiseJob_s
+{
+    int         coefficientCount;
+    int         segmentCount;
+    int         constraintCount;    // Per knot: continuityOrder + 1, or 0 if unjoined.
+    double *    xValues;
+    double *    yValues;
+    double *    pKnots;
+    int *       pFirstPoints;       // segmentCount + 1 point indexes; the last is one past the end.
+    double *    pCoefficients;      // The fit of each segment in t, highest power first.
+    double *    pSegmentWork;       // segmentStride doubles per segment.
+    size_t      segmentStride;
+    int *       pStatus;            // Result of each segment's fit.
+    int         nextSegment;
+} piecewiseJob_t;
+
+
+//------------------------------------------------
+// Private Function Prototypes
+//------------------------------------------------
+
+static void     chooseKnots( piecewiseJob_t *pJob, int pointCount, double *pSse );
+static int      fitSegment( piecewiseJob_t *pJob, int segment, double *pSse );
+static void *   fitSegments( void *pArg );
+static int      joinSegments( piecewiseJob_t *pJob );
+static double   knotValue( int coefficientCount, int order, int index );
+static double   startValue( int coefficientCount, int order, int index, double widthRatio );
+static int      factorDense( int size, double *pMatrix );
+static void     solveDense( int size, double *pFactor, double *pVector );
+static double   segmentWidth( double *pKnots, int segment );
+static int      firstAtLeast( double *xValues, int first, int end, double x );
+
+
+//=========================================================
+//      Global function definitions
+//=========================================================
+
+
+//--------------------------------------------------------
+// polyfit_piecewise_fit()
+// Fits a polynomial with coefficientCount coefficients to
+// each segment of a series of points sorted by x.
+//
+// If knots is not NULL it holds segmentCount + 1 strictly
+// ascending x values, and segment s takes the points from
+// knots[s] up to, but not including, knots[s + 1]; the
+// last segment also takes points equal to its last knot.
+// Points outside the knots are ignored.
+//
+// If knots is NULL they are chosen from the points: the
+// whole series starts as one segment, and the segment
+// with the largest sum of squared residuals is split at
+// its middle point until there are segmentCount segments,
+// or none can be split into two of at least
+// coefficientCount points. So the result may have fewer
+// segments than asked for. Each split reads the points of
+// the segment split, about log2(segmentCount) passes over
+// the series in all.
+//
+// The segments are then fitted on threadCount threads, 0
+// for one per online CPU, with the calling thread taking
+// part. Threads claim segments one at a time, so uneven
+// segments don't leave threads idle. If a thread can't be
+// started, the others do its share. Each segment's fit
+// depends only on its own points, so the result is the
+// same whatever the thread count.
+//
+// With a continuityOrder of 0 or more, the fits are then
+// joined: the least squares fit over all the points,
+// subject to each knot's value and derivatives up to
+// continuityOrder matching on both sides. The constraints
+// only couple neighbouring knots, so their Lagrange
+// multipliers come from a block tridiagonal system solved
+// in one sweep, with blocks of continuityOrder + 1, and
+// each segment's fit is then corrected by its knots'
+// multipliers. This adds little to the independent fits.
+//
+// Each segment is fitted in t = (x - knots[s]) / width,
+// which keeps the normal equations well conditioned, and
+// the results are then rescaled to be in (x - knots[s]).
+// Release the result with polyfit_piecewise_free().
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < coefficientCount), or a
+//             segment has fewer points than coefficients,
+//          -3 if unable to allocate memory,
+//          -4 if unable to solve equations,
+//          -5 if coefficientCount < 1, segmentCount < 1,
+//             continuityOrder is below -1 or not below
+//             coefficientCount, threadCount < 0, or the
+//             x values or knots are not ascending.
+//--------------------------------------------------------
+int polyfit_piecewise_fit( polyfit_piecewise_t *pPiecewise, int pointCount, double *xValues, double *yValues,
+                           int coefficientCount, int segmentCount, double *knots, int continuityOrder,
+                           int threadCount )
+{
+    int rVal = 0;
+
+    if( NULL == pPiecewise )
+    {
+        return -1;
+    }
+
+    pPiecewise->segmentCount = 0;
+    pPiecewise->coefficientCount = 0;
+    pPiecewise->pKnots = NULL;
+    pPiecewise->pCoefficients = NULL;
+
+    if( (NULL == xValues) || (NULL == yValues) )
+    {
+        return -1;
+    }
+    if( (coefficientCount < 1) || (segmentCount < 1) || (continuityOrder < -1) ||
+        (continuityOrder >= coefficientCount) || (threadCount < 0) )
+    {
+        return -5;
+    }
+    if( pointCount < coefficientCount )
+    {
+        return -2;
+    }
+    for( int i = 1; i < pointCount; i++ )
+    {
+        if( !(xValues[i] >= xValues[ i - 1 ]) )
+        {
+            return -5;
+        }
+    }
+    for( int s = 0; (NULL != knots) && (s < segmentCount); s++ )
+    {
+        if( !(knots[ s + 1 ] > knots[s]) )
+        {
+            return -5;
+        }
+    }
+
+    int constraintCount = continuityOrder + 1;
+    int factorCount = (coefficientCount * (coefficientCount + 1)) / 2;
+    size_t segmentStride = (size_t) (4 * coefficientCount) + factorCount + (2 * coefficientCount * constraintCount);
+
+    double *pTable = (double *) polyfitCalloc( (size_t) (segmentCount + 1) + ((size_t) segmentCount * coefficientCount),
+                                               sizeof( double ));
+    double *pSegmentWork = (double *) polyfitCalloc( (size_t) segmentCount * segmentStride + segmentCount,
+                                                     sizeof( double ));
+    int *pFirstPoints = (int *) polyfitCalloc( (size_t) (2 * segmentCount) + 1, sizeof( int ));
+    if( (NULL == pTable) || (NULL == pSegmentWork) || (NULL == pFirstPoints) )
+    {
+        polyfitFree( pTable );
+        polyfitFree( pSegmentWork );
+        polyfitFree( pFirstPoints );
+        return -3;
+    }
+
+    piecewiseJob_t job;
+    job.coefficientCount = coefficientCount;
+    job.segmentCount = segmentCount;
+    job.constraintCount = constraintCount;
+    job.xValues = xValues;
+    job.yValues = yValues;
+    job.pKnots = pTable;
+    job.pFirstPoints = pFirstPoints;
+    job.pCoefficients = &(pTable[ segmentCount + 1 ]);
+    job.pSegmentWork = pSegmentWork;
+    job.segmentStride = segmentStride;
+    job.pStatus = &(pFirstPoints[ segmentCount + 1 ]);
+    job.nextSegment = 0;
+
+    if( NULL == knots )
+    {
+        chooseKnots( &job, pointCount, &(pSegmentWork[ (size_t) segmentCount * segmentStride ]) );
+    }
+    else
+    {
+        for( int s = 0; s <= segmentCount; s++ )
+        {
+            job.pKnots[s] = knots[s];
+            job.pFirstPoints[s] = firstAtLeast( xValues, 0, pointCount, knots[s] );
+        }
+        // The last segment is closed at its end.
+        while( (job.pFirstPoints[ segmentCount ] < pointCount) &&
+               (xValues[ job.pFirstPoints[ segmentCount ] ] == knots[ segmentCount ]) )
+        {
+            job.pFirstPoints[ segmentCount ]++;
+        }
+    }
+
+    if( 0 == rVal )
+    {
+        if( 0 == threadCount )
+        {
+            long cpuCount = sysconf( _SC_NPROCESSORS_ONLN );
+            threadCount = (cpuCount > 0) ? (int) cpuCount : 1;
+        }
+        if( threadCount > job.segmentCount )
+        {
+            threadCount = job.segmentCount;
+        }
+
+        pthread_t *pThreads = (pthread_t *) polyfitCalloc( threadCount, sizeof( pthread_t ));
+        bool *pStarted = (bool *) polyfitCalloc( threadCount, sizeof( bool ));
+        if( (NULL == pThreads) || (NULL == pStarted) )
+        {
+            rVal = -3;
+        }
+        else
+        {
+            for( int t = 1; t < threadCount; t++ )
+            {
+                pStarted[t] = (0 == pthread_create( &pThreads[t], NULL, fitSegments, &job ));
+            }
+            fitSegments( &job );
+            for( int t = 1; t < threadCount; t++ )
+            {
+                if( pStarted[t] )
+                {
+                    pthread_join( pThreads[t], NULL );
+                }
+            }
+        }
+        polyfitFree( pThreads );
+        polyfitFree( pStarted );
+    }
+
+    // Report the first failure in segment order, whichever thread saw it first.
+    for( int s = 0; (0 == rVal) && (s < job.segmentCount); s++ )
+    {
+        rVal = job.pStatus[s];
+    }
+    if( (0 == rVal) && (constraintCount > 0) && (job.segmentCount > 1) )
+    {
+        rVal = joinSegments( &job );
+    }
+
+    // From t = (x - knots[s]) / width to (x - knots[s]).
+    for( int s = 0; (0 == rVal) && (s < job.segmentCount); s++ )
+    {
+        double *pRow = &(job.pCoefficients[ (size_t) s * coefficientCount ]);
+        double scale = 1.0 / segmentWidth( job.pKnots, s );
+        double power = 1.0;
+        for( int c = coefficientCount - 1; c >= 0; c-- )
+        {
+            pRow[c] *= power;
+            power *= scale;
+        }
+    }
+
+    polyfitFree( pSegmentWork );
+    polyfitFree( pFirstPoints );
+    if( 0 != rVal )
+    {
+        polyfitFree( pTable );
+        return rVal;
+    }
+
+    pPiecewise->segmentCount = job.segmentCount;
+    pPiecewise->coefficientCount = coefficientCount;
+    pPiecewise->pKnots = job.pKnots;
+    pPiecewise->pCoefficients = job.pCoefficients;
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_piecewise_eval()
+// Evaluates a piecewise polynomial at each of pointCount
+// x values into yValues. Each x is found among the knots
+// by binary search, unless it is in the same segment as
+// the x before it, and its segment's polynomial evaluated
+// by Horner's rule. x values before the first knot or
+// after the last use the first or last segment.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer.
+//--------------------------------------------------------
+int polyfit_piecewise_eval( polyfit_piecewise_t *pPiecewise, int pointCount, double *xValues, double *yValues )
+{
+    if( (NULL == pPiecewise) || (NULL == pPiecewise->pKnots) || (NULL == xValues) || (NULL == yValues) )
+    {
+        return -1;
+    }
+
+    int coefficientCount = pPiecewise->coefficientCount;
+    double *pKnots = pPiecewise->pKnots;
+    int lastSegment = pPiecewise->segmentCount - 1;
+    int segment = 0;
+
+    for( int i = 0; i < pointCount; i++ )
+    {
+        double x = xValues[i];
+        if( !((x >= pKnots[ segment ]) && (x < pKnots[ segment + 1 ])) )
+        {
+            // The last segment at or before x.
+            int low = 0;
+            int high = lastSegment;
+            while( low < high )
+            {
+                int middle = (low + high + 1) / 2;
+                if( pKnots[ middle ] <= x )
+                {
+                    low = middle;
+                }
+                else
+                {
+                    high = middle - 1;
+                }
+            }
+            segment = low;
+        }
+
+        double *pRow = &(pPiecewise->pCoefficients[ (size_t) segment * coefficientCount ]);
+        double t = x - pKnots[ segment ];
+        double y = 0.0;
+        for( int c = 0; c < coefficientCount; c++ )
+        {
+            y = (y * t) + pRow[c];
+        }
+        yValues[i] = y;
+    }
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_piecewise_free()
+// Releases the knots and coefficients of a piecewise
+// polynomial.
+//--------------------------------------------------------
+void polyfit_piecewise_free( polyfit_piecewise_t *pPiecewise )
+{
+    if( NULL != pPiecewise )
+    {
+        // The coefficients share the knots' allocation.
+        polyfitFree( pPiecewise->pKnots );
+        pPiecewise->pKnots = NULL;
+        pPiecewise->pCoefficients = NULL;
+        pPiecewise->segmentCount = 0;
+    }
+}
+
+
+//=========================================================
+//      Private function definitions
+//=========================================================
+
+//--------------------------------------------------------
+// chooseKnots()
+// Splits the points into up to pJob->segmentCount
+// segments, worst fit first, setting the knots, first
+// points and pJob->segmentCount. pSse holds each
+// segment's sum of squared residuals, or -1 if it can't
+// be split. There must be at least coefficientCount
+// points.
+//--------------------------------------------------------
+static void chooseKnots( piecewiseJob_t *pJob, int pointCount, double *pSse )
+{
+    int coefficientCount = pJob->coefficientCount;
+    int wanted = pJob->segmentCount;
+    double *pKnots = pJob->pKnots;
+    int *pFirstPoints = pJob->pFirstPoints;
+
+    pKnots[0] = pJob->xValues[0];
+    pKnots[1] = pJob->xValues[ pointCount - 1 ];
+    pFirstPoints[0] = 0;
+    pFirstPoints[1] = pointCount;
+    pJob->segmentCount = 1;
+    if( 0 != fitSegment( pJob, 0, &pSse[0] ))
+    {
+        pSse[0] = -1.0;
+    }
+
+    while( pJob->segmentCount < wanted )
+    {
+        int worst = -1;
+        for( int s = 0; s < pJob->segmentCount; s++ )
+        {
+            if( (pSse[s] >= 0.0) && ((worst < 0) || (pSse[s] > pSse[ worst ])) )
+            {
+                worst = s;
+            }
+        }
+        if( worst < 0 )
+        {
+            break;
+        }
+
+        // Split at the middle point, keeping equal x values on the same side.
+        int first = pFirstPoints[ worst ];
+        int end = pFirstPoints[ worst + 1 ];
+        double knot = pJob->xValues[ first + ((end - first) / 2) ];
+        int split = firstAtLeast( pJob->xValues, first, end, knot );
+        if( (split - first < coefficientCount) || (end - split < coefficientCount) ||
+            !(knot > pKnots[ worst ]) || !(pKnots[ worst + 1 ] > knot) )
+        {
+            pSse[ worst ] = -1.0;
+            continue;
+        }
+
+        for( int s = pJob->segmentCount; s > worst; s-- )
+        {
+            pKnots[ s + 1 ] = pKnots[s];
+            pFirstPoints[ s + 1 ] = pFirstPoints[s];
+            pSse[s] = pSse[ s - 1 ];
+        }
+        pKnots[ worst + 1 ] = knot;
+        pFirstPoints[ worst + 1 ] = split;
+        pJob->segmentCount++;
+
+        for( int s = worst; s <= worst + 1; s++ )
+        {
+            if( 0 != fitSegment( pJob, s, &pSse[s] ))
+            {
+                pSse[s] = -1.0;
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------
+// fitSegment()
+// Fits one segment in its t coordinate, into its row of
+// pJob->pCoefficients. If its segment is to be joined to
+// others, also solves for the columns its knots' Lagrange
+// multipliers need; see joinSegments(). Unless pSse is
+// NULL, the sum of squared residuals goes to *pSse.
+// Returns   0 if success,
+//          -2 if it has fewer points than coefficients,
+//          -4 if unable to solve equations.
+//--------------------------------------------------------
+static int fitSegment( piecewiseJob_t *pJob, int segment, double *pSse )
+{
+    int coefficientCount = pJob->coefficientCount;
+    int degree = coefficientCount - 1;
+    int powerSumCount = (2 * coefficientCount) - 1;
+    int first = pJob->pFirstPoints[ segment ];
+    int end = pJob->pFirstPoints[ segment + 1 ];
+    double tBlock[ PIECEWISE_BLOCK_POINTS ];
+
+    if( end - first < coefficientCount )
+    {
+        return -2;
+    }
+
+    double *pPowerSums = &(pJob->pSegmentWork[ (size_t) segment * pJob->segmentStride ]);
+    double *pRhsSums = &(pPowerSums[ powerSumCount ]);
+    double *pYSquareSum = &(pRhsSums[ coefficientCount ]);
+    double *pRhs = &(pYSquareSum[1]);
+    double *pFactor = &(pRhs[ coefficientCount ]);
+    double *pEndColumns = &(pFactor[ (coefficientCount * (coefficientCount + 1)) / 2 ]);
+    double *pStartColumns = &(pEndColumns[ coefficientCount * pJob->constraintCount ]);
+    double *pResults = &(pJob->pCoefficients[ (size_t) segment * coefficientCount ]);
+
+    for( int j = 0; j < powerSumCount + coefficientCount + 1; j++ )
+    {
+        pPowerSums[j] = 0.0;
+    }
+
+    double knot = pJob->pKnots[ segment ];
+    double scale = 1.0 / segmentWidth( pJob->pKnots, segment );
+    for( int block = first; block < end; block += PIECEWISE_BLOCK_POINTS )
+    {
+        int count = end - block;
+        if( count > PIECEWISE_BLOCK_POINTS )
+        {
+            count = PIECEWISE_BLOCK_POINTS;
+        }
+        for( int i = 0; i < count; i++ )
+        {
+            tBlock[i] = (pJob->xValues[ block + i ] - knot) * scale;
+        }
+        polyfitKernelPowerSums( coefficientCount, count, tBlock, &(pJob->yValues[ block ]), pPowerSums, pRhsSums,
+                                pYSquareSum );
+    }
+
+    int rVal = polyfitCholeskyFactor( coefficientCount, pPowerSums, pFactor );
+    if( 0 != rVal )
+    {
+        return rVal;
+    }
+
+    double explained = 0.0;
+    for( int r = 0; r < coefficientCount; r++ )
+    {
+        pRhs[r] = pRhsSums[ degree - r ];
+    }
+    polyfitCholeskySolve( coefficientCount, pFactor, pRhs, pResults );
+    for( int r = 0; r < coefficientCount; r++ )
+    {
+        explained += pResults[r] * pRhsSums[ degree - r ];
+    }
+    if( NULL != pSse )
+    {
+        *pSse = fmax( *pYSquareSum - explained, 0.0 );
+    }
+
+    // Solve for the constraint rows at the segment's end knot, and at its
+    // start knot, each as a column of the inverse normal matrix times the row.
+    for( int d = 0; d < pJob->constraintCount; d++ )
+    {
+        if( segment < pJob->segmentCount - 1 )
+        {
+            for( int r = 0; r < coefficientCount; r++ )
+            {
+                pRhs[r] = knotValue( coefficientCount, d, r );
+            }
+            polyfitCholeskySolve( coefficientCount, pFactor, pRhs, &(pEndColumns[ d * coefficientCount ]) );
+        }
+        if( segment > 0 )
+        {
+            double widthRatio = segmentWidth( pJob->pKnots, segment - 1 ) * scale;
+            for( int r = 0; r < coefficientCount; r++ )
+            {
+                pRhs[r] = startValue( coefficientCount, d, r, widthRatio );
+            }
+            polyfitCholeskySolve( coefficientCount, pFactor, pRhs, &(pStartColumns[ d * coefficientCount ]) );
+        }
+    }
+
+    return 0;
+}
+
+//--------------------------------------------------------
+// fitSegments()
+// Thread body: fits segments until none are left.
+//--------------------------------------------------------
+static void *fitSegments( void *pArg )
+{
+    piecewiseJob_t *pJob = (piecewiseJob_t *) pArg;
+
+    for( ;; )
+    {
+        int segment = __atomic_fetch_add( &pJob->nextSegment, 1, __ATOMIC_RELAXED );
+        if( segment >= pJob->segmentCount )
+        {
+            break;
+        }
+        pJob->pStatus[ segment ] = fitSegment( pJob, segment, NULL );
+    }
+    return NULL;
+}
+
+//--------------------------------------------------------
+// joinSegments()
+// Corrects the independent fits of the segments to the
+// least squares fit subject to continuity at the knots.
+//
+// In t coordinates, knot j's constraint is
+//      E_j c_j - S_j c_(j+1) = 0,
+// where row d of E_j takes the d'th derivative of segment
+// j at t = 1, and row d of S_j that of segment j + 1 at
+// t = 0, scaled by the ratio of their widths to the d'th
+// power so that both are derivatives in x. With M_s the
+// normal matrix of segment s and u_s its independent fit,
+// the joined fit is
+//      c = u - M^-1 (C)T L,
+// where C stacks the constraints and L is the multipliers
+// solving (C M^-1 (C)T) L = C u. That matrix is block
+// tridiagonal and positive definite, so L comes from a
+// block Cholesky sweep down the knots and back.
+//
+// fitSegment() has left M_s^-1 (E_s)T in each segment's
+// end columns, and M_s^-1 (S_(s-1))T in its start columns.
+// Returns   0 if success,
+//          -3 if unable to allocate memory,
+//          -4 if unable to solve equations.
+//--------------------------------------------------------
+static int joinSegments( piecewiseJob_t *pJob )
+{
+    int rVal = 0;
+    int coefficientCount = pJob->coefficientCount;
+    int q = pJob->constraintCount;
+    int knotCount = pJob->segmentCount - 1;
+    size_t knotStride = (size_t) (3 * q * q) + (2 * q);
+
+    double *pKnotWork = (double *) polyfitCalloc( (size_t) knotCount * knotStride, sizeof( double ));
+    if( NULL == pKnotWork )
+    {
+        return -3;
+    }
+
+    // Per knot: the diagonal block, then its Cholesky factor in place; the
+    // block coupling it to the next knot; that block times the inverse of
+    // this one; the forward swept right hand side, then the multipliers.
+    for( int j = 0; (0 == rVal) && (j < knotCount); j++ )
+    {
+        double *pDiagonal = &(pKnotWork[ (size_t) j * knotStride ]);
+        double *pCoupling = &(pDiagonal[ q * q ]);
+        double *pReduced = &(pCoupling[ q * q ]);
+        double *pSwept = &(pReduced[ q * q ]);
+
+        double *pLeft = &(pJob->pSegmentWork[ (size_t) j * pJob->segmentStride ]);
+        double *pRight = &(pLeft[ pJob->segmentStride ]);
+        double *pLeftEnd = &(pLeft[ (4 * coefficientCount) + ((coefficientCount * (coefficientCount + 1)) / 2) ]);
+        double *pRightEnd = &(pRight[ (4 * coefficientCount) + ((coefficientCount * (coefficientCount + 1)) / 2) ]);
+        double *pRightStart = &(pRightEnd[ coefficientCount * q ]);
+        double *pLeftFit = &(pJob->pCoefficients[ (size_t) j * coefficientCount ]);
+        double *pRightFit = &(pLeftFit[ coefficientCount ]);
+        double widthRatio = segmentWidth( pJob->pKnots, j ) / segmentWidth( pJob->pKnots, j + 1 );
+
+        for( int a = 0; a < q; a++ )
+        {
+            int index = coefficientCount - 1 - a;      // Of t^a, the only term S_j's row a takes.
+            double start = startValue( coefficientCount, a, index, widthRatio );
+            for( int b = 0; b < q; b++ )
+            {
+                double sum = start * pRightStart[ (b * coefficientCount) + index ];
+                for( int r = 0; r < coefficientCount; r++ )
+                {
+                    sum += knotValue( coefficientCount, a, r ) * pLeftEnd[ (b * coefficientCount) + r ];
+                }
+                pDiagonal[ (a * q) + b ] = sum;
+                pCoupling[ (a * q) + b ] = (j < knotCount - 1) ? -start * pRightEnd[ (b * coefficientCount) + index ]
+                                                               : 0.0;
+            }
+            double sum = -start * pRightFit[ index ];
+            for( int r = 0; r < coefficientCount; r++ )
+            {
+                sum += knotValue( coefficientCount, a, r ) * pLeftFit[r];
+            }
+            pSwept[a] = sum;
+        }
+
+        // Eliminate the previous knot.
+        if( j > 0 )
+        {
+            double *pPrevious = &(pKnotWork[ (size_t) (j - 1) * knotStride ]);
+            double *pPreviousCoupling = &(pPrevious[ q * q ]);
+            double *pPreviousReduced = &(pPreviousCoupling[ q * q ]);
+            double *pPreviousSwept = &(pPreviousReduced[ q * q ]);
+            for( int a = 0; a < q; a++ )
+            {
+                for( int m = 0; m < q; m++ )
+                {
+                    double coupling = pPreviousCoupling[ (m * q) + a ];
+                    for( int b = 0; b < q; b++ )
+                    {
+                        pDiagonal[ (a * q) + b ] -= coupling * pPreviousReduced[ (m * q) + b ];
+                    }
+                    pSwept[a] -= coupling * pPreviousSwept[m];
+                }
+            }
+        }
+
+        rVal = factorDense( q, pDiagonal );
+        if( 0 == rVal )
+        {
+            solveDense( q, pDiagonal, pSwept );
+            for( int b = 0; b < q; b++ )
+            {
+                double *pColumn = &(pSwept[q]);     // The multipliers' slot, free until the back sweep.
+                for( int a = 0; a < q; a++ )
+                {
+                    pColumn[a] = pCoupling[ (a * q) + b ];
+                }
+                solveDense( q, pDiagonal, pColumn );
+                for( int a = 0; a < q; a++ )
+                {
+                    pReduced[ (a * q) + b ] = pColumn[a];
+                }
+            }
+        }
+    }
+
+    // Back sweep, leaving each knot's multipliers in its swept slot.
+    for( int j = knotCount - 2; (0 == rVal) && (j >= 0); j-- )
+    {
+        double *pReduced = &(pKnotWork[ ((size_t) j * knotStride) + (2 * q * q) ]);
+        double *pSwept = &(pReduced[ q * q ]);
+        double *pNextSwept = &(pSwept[ knotStride ]);
+        for( int a = 0; a < q; a++ )
+        {
+            for( int b = 0; b < q; b++ )
+            {
+                pSwept[a] -= pReduced[ (a * q) + b ] * pNextSwept[b];
+            }
+        }
+    }
+
+    // c_s = u_s - M_s^-1 ((E_s)T L_s - (S_(s-1))T L_(s-1)).
+    for( int s = 0; (0 == rVal) && (s <= knotCount); s++ )
+    {
+        double *pWork = &(pJob->pSegmentWork[ (size_t) s * pJob->segmentStride ]);
+        double *pEndColumns = &(pWork[ (4 * coefficientCount) + ((coefficientCount * (coefficientCount + 1)) / 2) ]);
+        double *pStartColumns = &(pEndColumns[ coefficientCount * q ]);
+        double *pFit = &(pJob->pCoefficients[ (size_t) s * coefficientCount ]);
+
+        for( int d = 0; d < q; d++ )
+        {
+            for( int r = 0; (s < knotCount) && (r < coefficientCount); r++ )
+            {
+                double multiplier = pKnotWork[ ((size_t) s * knotStride) + (3 * q * q) + d ];
+                pFit[r] -= pEndColumns[ (d * coefficientCount) + r ] * multiplier;
+            }
+            for( int r = 0; (s > 0) && (r < coefficientCount); r++ )
+            {
+                double multiplier = pKnotWork[ ((size_t) (s - 1) * knotStride) + (3 * q * q) + d ];
+                pFit[r] += pStartColumns[ (d * coefficientCount) + r ] * multiplier;
+            }
+        }
+    }
+
+    polyfitFree( pKnotWork );
+    return rVal;
+}
+
+//--------------------------------------------------------
+// knotValue()
+// Returns coefficient index's share of the order'th
+// derivative of a polynomial in t at t = 1, highest power
+// first: p! / (p - order)! for its power p.
+//--------------------------------------------------------
+static double knotValue( int coefficientCount, int order, int index )
+{
+    int power = coefficientCount - 1 - index;
+    double value = (power >= order) ? 1.0 : 0.0;
+
+    for( int f = power; f > power - order; f-- )
+    {
+        value *= f;
+    }
+    return value;
+}
+
+//--------------------------------------------------------
+// startValue()
+// Returns coefficient index's share of the order'th
+// derivative of a polynomial in t at t = 0, times
+// widthRatio to the order'th power: only t^order counts.
+//--------------------------------------------------------
+static double startValue( int coefficientCount, int order, int index, double widthRatio )
+{
+    if( coefficientCount - 1 - index != order )
+    {
+        return 0.0;
+    }
+
+    double value = 1.0;
+    for( int f = 1; f <= order; f++ )
+    {
+        value *= f * widthRatio;
+    }
+    return value;
+}
+
+//--------------------------------------------------------
+// factorDense()
+// Replaces the lower triangle of a size by size symmetric
+// matrix, row by row, with its Cholesky factor.
+// Returns   0 if success,
+//          -4 if it is not numerically positive definite.
+//--------------------------------------------------------
+static int factorDense( int size, double *pMatrix )
+{
+    for( int r = 0; r < size; r++ )
+    {
+        for( int c = 0; c <= r; c++ )
+        {
+            double diagonal = pMatrix[ (r * size) + c ];
+            double sum = diagonal;
+            for( int m = 0; m < c; m++ )
+            {
+                sum -= pMatrix[ (r * size) + m ] * pMatrix[ (c * size) + m ];
+            }
+            if( r == c )
+            {
+                if( !(sum > size * DBL_EPSILON * diagonal) )
+                {
+                    return -4;
+                }
+                pMatrix[ (r * size) + c ] = sqrt( sum );
+            }
+            else
+            {
+                pMatrix[ (r * size) + c ] = sum / pMatrix[ (c * size) + c ];
+            }
+        }
+    }
+    return 0;
+}
+
+//--------------------------------------------------------
+// solveDense()
+// Solves with a factor from factorDense(), replacing the
+// right hand side in pVector with the solution.
+//--------------------------------------------------------
+static void solveDense( int size, double *pFactor, double *pVector )
+{
+    for( int r = 0; r < size; r++ )
+    {
+        for( int m = 0; m < r; m++ )
+        {
+            pVector[r] -= pFactor[ (r * size) + m ] * pVector[m];
+        }
+        pVector[r] /= pFactor[ (r * size) + r ];
+    }
+    for( int r = size - 1; r >= 0; r-- )
+    {
+        for( int m = r + 1; m < size; m++ )
+        {
+            pVector[r] -= pFactor[ (m * size) + r ] * pVector[m];
+        }
+        pVector[r] /= pFactor[ (r * size) + r ];
+    }
+}
+
+//--------------------------------------------------------
+// segmentWidth()
+// Returns the x width of a segment, or 1 if it has none.
+//--------------------------------------------------------
+static double segmentWidth( double *pKnots, int segment )
+{
+    double width = pKnots[ segment + 1 ] - pKnots[ segment ];
+    return (width > 0.0) ? width : 1.0;
+}
+
+//--------------------------------------------------------
+// firstAtLeast()
+// Returns the index of the first of the sorted x values
+// from first up to end that is at least x, or end if
+// there is none.
+//--------------------------------------------------------
+static int firstAtLeast( double *xValues, int first, int end, double x )
+{
+    while( first < end )
+    {
+        int middle = first + ((end - first) / 2);
+        if( xValues[ middle ] < x )
+        {
+            first = middle + 1;
+        }
+        else
+        {
+            end = middle;
+        }
+    }
+    return first;
+}
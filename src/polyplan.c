@@ -0,0 +1,225 @@
+// Name: polyplan.c
+// Description: Precomputed fit plans for repeated fits over a fixed set of x positions.
+// Author: Henry M. Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+#include "polyfit_internal.h"
+
+// polyfit_plan_execute_many() fits this many series at a time. It is
+// the dot product kernels' block size, so they load each element of a
+// projection row once for all of them.
+#define PLAN_SERIES_BLOCK   (4)
+
+
+//=========================================================
+//      Global function definitions
+//=========================================================
+
+
+//--------------------------------------------------------
+// polyfit_plan_init()
+// Prepares a plan for fitting any number of y series that
+// share the same pointCount x positions.
+//
+// The least squares coefficients are a linear function of
+// y: c = ((AT)A)^-1 * (AT) * y. The plan computes that
+// coefficientCount x pointCount projection matrix once,
+// from the Cholesky factor of (AT)A, so each later fit is
+// a single matrix-vector product with y, O(pointCount *
+// coefficientCount), with nothing to solve.
+//
+// The plan keeps its own copy of everything it needs, so
+// xValues may change afterwards. Release it with
+// polyfit_plan_free().
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < coefficientCount),
+//          -3 if unable to allocate memory,
+//          -4 if unable to solve equations,
+//          -5 if coefficientCount < 1.
+//--------------------------------------------------------
+int polyfit_plan_init( polyfit_plan_t *pPlan, int pointCount, double *xValues, int coefficientCount )
+{
+    int rVal = 0;
+
+    if( (NULL == pPlan) || (NULL == xValues) )
+    {
+        return -1;
+    }
+
+    pPlan->pointCount = 0;
+    pPlan->coefficientCount = 0;
+    pPlan->pProjection = NULL;
+
+    if( pointCount < coefficientCount )
+    {
+        return -2;
+    }
+    if( coefficientCount < 1 )
+    {
+        return -5;
+    }
+
+    int powerSumCount = (2 * coefficientCount) - 1;
+    int factorCount = (coefficientCount * (coefficientCount + 1)) / 2;
+
+    double *pProjection = (double *) polyfitCalloc( (size_t) coefficientCount * pointCount, sizeof( double ));
+    double *pTemp = (double *) polyfitCalloc( powerSumCount + coefficientCount + factorCount + (2 * coefficientCount),
+                                              sizeof( double ));
+    if( (NULL == pProjection) || (NULL == pTemp) )
+    {
+        polyfitFree( pProjection );
+        polyfitFree( pTemp );
+        return -3;
+    }
+
+    double *pPowerSums = pTemp;
+    double *pRhsSums = &(pPowerSums[ powerSumCount ]);         // Unused; the kernel needs somewhere to put them.
+    double *pFactor = &(pRhsSums[ coefficientCount ]);
+    double *pColumn = &(pFactor[ factorCount ]);                // One row of A, highest power first.
+    double *pSolution = &(pColumn[ coefficientCount ]);        // The same column of the projection.
+
+    polyfitKernelPowerSums( coefficientCount, pointCount, xValues, xValues, pPowerSums, pRhsSums, NULL );
+    rVal = polyfitCholeskyFactor( coefficientCount, pPowerSums, pFactor );
+
+    // Column i of the projection is ((AT)A)^-1 times row i of A.
+    for( int i = 0; (0 == rVal) && (i < pointCount); i++ )
+    {
+        double xPower = 1.0;
+        for( int c = coefficientCount - 1; c >= 0; c-- )
+        {
+            pColumn[c] = xPower;
+            xPower *= xValues[i];
+        }
+        polyfitCholeskySolve( coefficientCount, pFactor, pColumn, pSolution );
+        for( int c = 0; c < coefficientCount; c++ )
+        {
+            pProjection[ ((size_t) c * pointCount) + i ] = pSolution[c];
+        }
+    }
+
+    polyfitFree( pTemp );
+    if( 0 != rVal )
+    {
+        polyfitFree( pProjection );
+        return rVal;
+    }
+
+    pPlan->pointCount = pointCount;
+    pPlan->coefficientCount = coefficientCount;
+    pPlan->pProjection = pProjection;
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_plan_execute()
+// Fits one series of the plan's pointCount y values, in
+// the same order as the plan's x values.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer.
+//--------------------------------------------------------
+int polyfit_plan_execute( polyfit_plan_t *pPlan, double *yValues, double *coefficientResults )
+{
+    if( (NULL == pPlan) || (NULL == pPlan->pProjection) || (NULL == yValues) || (NULL == coefficientResults) )
+    {
+        return -1;
+    }
+
+    int pointCount = pPlan->pointCount;
+    for( int c = 0; c < pPlan->coefficientCount; c++ )
+    {
+        polyfitKernelDots( pointCount, &(pPlan->pProjection[ (size_t) c * pointCount ]), yValues, 1, 0,
+                           &(coefficientResults[c]) );
+    }
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_plan_execute_many()
+// Fits seriesCount series at once, as the matrix-matrix
+// product of the series with the projection. Series s
+// holds the plan's pointCount y values starting at
+// yValues[s * pointCount], and its coefficients are
+// stored starting at coefficientResults[s *
+// coefficientCount], as for polyfit_batch().
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -5 if seriesCount < 0.
+//--------------------------------------------------------
+int polyfit_plan_execute_many( polyfit_plan_t *pPlan, int seriesCount, double *yValues, double *coefficientResults )
+{
+    if( (NULL == pPlan) || (NULL == pPlan->pProjection) || (NULL == yValues) || (NULL == coefficientResults) )
+    {
+        return -1;
+    }
+    if( seriesCount < 0 )
+    {
+        return -5;
+    }
+
+    int pointCount = pPlan->pointCount;
+    int coefficientCount = pPlan->coefficientCount;
+
+    // Blocks of series: the kernel loads each projection row once for
+    // every series in the block.
+    for( int s = 0; s < seriesCount; s += PLAN_SERIES_BLOCK )
+    {
+        double sums[ PLAN_SERIES_BLOCK ];
+        int blockCount = seriesCount - s;
+        if( blockCount > PLAN_SERIES_BLOCK )
+        {
+            blockCount = PLAN_SERIES_BLOCK;
+        }
+
+        for( int c = 0; c < coefficientCount; c++ )
+        {
+            polyfitKernelDots( pointCount, &(pPlan->pProjection[ (size_t) c * pointCount ]),
+                               &(yValues[ (size_t) s * pointCount ]), blockCount, (size_t) pointCount, sums );
+            for( int b = 0; b < blockCount; b++ )
+            {
+                coefficientResults[ ((s + b) * coefficientCount) + c ] = sums[b];
+            }
+        }
+    }
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_plan_free()
+// Releases the memory held by a plan.
+//--------------------------------------------------------
+void polyfit_plan_free( polyfit_plan_t *pPlan )
+{
+    if( NULL != pPlan )
+    {
+        polyfitFree( pPlan->pProjection );
+        pPlan->pProjection = NULL;
+        pPlan->pointCount = 0;
+    }
+}
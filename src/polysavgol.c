@@ -0,0 +1,243 @@
+// Name: polysavgol.c
+// Description: Savitzky-Golay smoothing and differentiation of evenly spaced signals.
+// Author: Henry M. Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+#include "polyfit_internal.h"
+
+
+//=========================================================
+//      Global function definitions
+//=========================================================
+
+
+//--------------------------------------------------------
+// polyfit_savgol_init()
+// Precomputes the convolution weights of a Savitzky-Golay
+// filter: fitting a polynomial with coefficientCount
+// coefficients to each window of windowLength samples,
+// and taking the derivativeOrder'th derivative of the fit
+// (0 for smoothing). sampleSpacing is the x distance
+// between samples, which scales the derivatives.
+//
+// Weights are made for every position in the window, not
+// just the centre. The centre row filters the interior of
+// a signal, and the others evaluate the fit of the first
+// and last windows at the samples near each end.
+//
+// Each row of weights comes from the least squares normal
+// equations of the window, solved once for the unit
+// vector of the wanted derivative at that position. The
+// window's x positions are scaled to -1 .. 1 to keep the
+// equations well conditioned.
+//
+// Release the filter with polyfit_savgol_free().
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (windowLength < coefficientCount),
+//          -3 if unable to allocate memory,
+//          -4 if unable to solve equations,
+//          -5 if windowLength is not a positive odd number,
+//             coefficientCount < 1, derivativeOrder is not
+//             below coefficientCount, or sampleSpacing <= 0.
+//--------------------------------------------------------
+int polyfit_savgol_init( polyfit_savgol_t *pFilter, int windowLength, int coefficientCount, int derivativeOrder,
+                         double sampleSpacing )
+{
+    int rVal = 0;
+
+    if( NULL == pFilter )
+    {
+        return -1;
+    }
+
+    pFilter->windowLength = 0;
+    pFilter->coefficientCount = 0;
+    pFilter->derivativeOrder = 0;
+    pFilter->pWeights = NULL;
+
+    if( (windowLength < 1) || (0 == (windowLength % 2)) || (coefficientCount < 1) ||
+        (derivativeOrder < 0) || (derivativeOrder >= coefficientCount) || !(sampleSpacing > 0.0) )
+    {
+        return -5;
+    }
+    if( windowLength < coefficientCount )
+    {
+        return -2;
+    }
+
+    int halfWidth = (windowLength - 1) / 2;
+    double scale = (halfWidth > 0) ? (double) halfWidth : 1.0;
+    int sumCount = (3 * coefficientCount) - 1;
+    int scratchCount = coefficientCount * (coefficientCount + 1);
+
+    double *pWeights = (double *) polyfitCalloc( (size_t) windowLength * windowLength, sizeof( double ));
+    double *pTemp = (double *) polyfitCalloc( (2 * windowLength) + sumCount + scratchCount + (2 * coefficientCount),
+                                              sizeof( double ));
+    if( (NULL == pWeights) || (NULL == pTemp) )
+    {
+        polyfitFree( pWeights );
+        polyfitFree( pTemp );
+        return -3;
+    }
+
+    double *pPositions = pTemp;                                 // Scaled x of each sample.
+    double *pZeros = &(pPositions[ windowLength ]);             // y values for the power sums; unused.
+    double *pPowerSums = &(pZeros[ windowLength ]);
+    double *pRhsSums = &(pPowerSums[ (2 * coefficientCount) - 1 ]);
+    double *pScratch = &(pPowerSums[ sumCount ]);
+    double *pUnit = &(pScratch[ scratchCount ]);                // The derivative at one position.
+    double *pSolution = &(pUnit[ coefficientCount ]);           // Its least squares weights, highest power first.
+
+    for( int i = 0; i < windowLength; i++ )
+    {
+        pPositions[i] = (double) (i - halfWidth) / scale;
+    }
+    polyfitKernelPowerSums( coefficientCount, windowLength, pPositions, pZeros, pPowerSums, pRhsSums, NULL );
+
+    // d/dx = (1 / (scale * sampleSpacing)) * d/dt, once per derivative order.
+    double derivativeScale = 1.0;
+    for( int d = 0; d < derivativeOrder; d++ )
+    {
+        derivativeScale /= scale * sampleSpacing;
+    }
+
+    for( int r = 0; (0 == rVal) && (r < windowLength); r++ )
+    {
+        // pUnit[p] is the derivativeOrder'th derivative of t^p at t = pPositions[r].
+        double tPower = 1.0;
+        for( int p = 0; p < coefficientCount; p++ )
+        {
+            pUnit[p] = 0.0;
+            if( p >= derivativeOrder )
+            {
+                double factor = 1.0;
+                for( int f = p; f > p - derivativeOrder; f-- )
+                {
+                    factor *= f;
+                }
+                pUnit[p] = factor * tPower;
+                tPower *= pPositions[r];
+            }
+        }
+
+        rVal = polyfitSolveSums( POLYFIT_SOLVER_DEFAULT, coefficientCount, pPowerSums, pUnit, pScratch, pSolution );
+
+        // The weight of sample i is the solution polynomial evaluated at its position.
+        for( int i = 0; (0 == rVal) && (i < windowLength); i++ )
+        {
+            double weight = 0.0;
+            for( int c = 0; c < coefficientCount; c++ )
+            {
+                weight = (weight * pPositions[i]) + pSolution[c];
+            }
+            pWeights[ (r * windowLength) + i ] = weight * derivativeScale;
+        }
+    }
+
+    polyfitFree( pTemp );
+    if( 0 != rVal )
+    {
+        polyfitFree( pWeights );
+        return rVal;
+    }
+
+    pFilter->windowLength = windowLength;
+    pFilter->coefficientCount = coefficientCount;
+    pFilter->derivativeOrder = derivativeOrder;
+    pFilter->pWeights = pWeights;
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_savgol_apply()
+// Filters a signal of sampleCount evenly spaced samples.
+// Each output is the filter's derivative of the fit to
+// the window centred on that sample. Within half a window
+// of either end, the first or last full window is used
+// instead, evaluated at the sample's own position.
+//
+// The interior is a straight convolution with the centre
+// weights, run by the vector convolution kernel, so the
+// cost is O(sampleCount * windowLength). inValues and
+// outValues must not overlap.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (sampleCount < windowLength).
+//--------------------------------------------------------
+int polyfit_savgol_apply( polyfit_savgol_t *pFilter, int sampleCount, double *inValues, double *outValues )
+{
+    if( (NULL == pFilter) || (NULL == pFilter->pWeights) || (NULL == inValues) || (NULL == outValues) )
+    {
+        return -1;
+    }
+
+    int windowLength = pFilter->windowLength;
+    int halfWidth = (windowLength - 1) / 2;
+    if( sampleCount < windowLength )
+    {
+        return -2;
+    }
+
+    // Leading and trailing edges: rows 0 .. halfWidth-1 of the first window,
+    // and rows halfWidth+1 .. windowLength-1 of the last.
+    double *pLastWindow = &(inValues[ sampleCount - windowLength ]);
+    for( int r = 0; r < halfWidth; r++ )
+    {
+        double *pHeadWeights = &(pFilter->pWeights[ r * windowLength ]);
+        double *pTailWeights = &(pFilter->pWeights[ (r + halfWidth + 1) * windowLength ]);
+        double head = 0.0;
+        double tail = 0.0;
+        for( int i = 0; i < windowLength; i++ )
+        {
+            head += pHeadWeights[i] * inValues[i];
+            tail += pTailWeights[i] * pLastWindow[i];
+        }
+        outValues[r] = head;
+        outValues[ sampleCount - halfWidth + r ] = tail;
+    }
+
+    polyfitKernelConvolve( sampleCount - (2 * halfWidth), inValues,
+                           &(pFilter->pWeights[ halfWidth * windowLength ]), windowLength,
+                           &(outValues[ halfWidth ]) );
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_savgol_free()
+// Releases the weights held by a filter.
+//--------------------------------------------------------
+void polyfit_savgol_free( polyfit_savgol_t *pFilter )
+{
+    if( NULL != pFilter )
+    {
+        polyfitFree( pFilter->pWeights );
+        pFilter->pWeights = NULL;
+        pFilter->windowLength = 0;
+    }
+}
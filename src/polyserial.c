@@ -0,0 +1,1039 @@
+// Name: polyserial.c
+// Description: Binary and JSON encoding of coefficient vectors, with shortest round trip decimals,
+//              and binary encoding of accumulator state.
+// Author: Henry M. Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+#include <float.h>      // DBL_MIN
+#include <limits.h>     // INT_MAX, LLONG_MAX
+#include <locale.h>     // localeconv()
+#include <math.h>       // isfinite()
+#include <stdbool.h>    // bool
+#include <stdint.h>     // uint64_t
+#include <stdio.h>      // snprintf()
+#include <stdlib.h>     // strtod()
+#include <string.h>     // memcpy()
+
+#include "polyfit_internal.h"
+
+// Enough for any double printed by formatShortest(), with its NUL.
+#define SHORTEST_MAX_LENGTH     (32)
+
+// The most significant digits a double needs to round trip (DBL_DECIMAL_DIG),
+// and the fewest that a normal double may not, plus one (DBL_DIG + 1).
+#define SHORTEST_MAX_DIGITS     (17)
+#define SHORTEST_SAFE_DIGITS    (15)
+
+// Grisu scales values by a cached power of ten so that their binary
+// exponent lands in -60 .. -32, which keeps the integer part of the
+// scaled value within 32 bits.
+#define GRISU_MIN_EXPONENT      (-60)
+
+// The cached powers are 10^-348, 10^-340, ... 10^340.
+#define GRISU_FIRST_POWER       (-348)
+#define GRISU_POWER_STEP        (8)
+
+// Bytes of the binary encoding's count, and of each coefficient.
+#define BINARY_COUNT_BYTES      (4)
+#define BINARY_VALUE_BYTES      (8)
+
+// Accumulator state starts with a tag, a format version, the coefficient
+// count and the point count, then holds the sum of y^2 and the power and
+// right hand side sums as doubles.
+#define STATE_TAG               "PFAS"
+#define STATE_TAG_BYTES         (4)
+#define STATE_VERSION           (1)
+#define STATE_VERSION_BYTES     (4)
+#define STATE_POINTS_BYTES      (8)
+#define STATE_HEADER_BYTES      (STATE_TAG_BYTES + STATE_VERSION_BYTES + BINARY_COUNT_BYTES + STATE_POINTS_BYTES)
+
+
+// A floating point value f * 2^e with a 64 bit significand.
+typedef struct grisuFp_s
+{
+    uint64_t    f;
+    int         e;
+} grisuFp_t;
+
+// A power of ten, rounded to a normalized grisuFp_t.
+typedef struct grisuPower_s
+{
+    uint64_t    f;
+    int         e;
+    int         decimalExponent;
+} grisuPower_t;
+
+static const grisuPower_t grisuPowers[] =
+{
+    { 0xfa8fd5a0081c0288ull, -1220, -348 },
+    { 0xbaaee17fa23ebf76ull, -1193, -340 },
+    { 0x8b16fb203055ac76ull, -1166, -332 },
+    { 0xcf42894a5dce35eaull, -1140, -324 },
+    { 0x9a6bb0aa55653b2dull, -1113, -316 },
+    { 0xe61acf033d1a45dfull, -1087, -308 },
+    { 0xab70fe17c79ac6caull, -1060, -300 },
+    { 0xff77b1fcbebcdc4full, -1034, -292 },
+    { 0xbe5691ef416bd60cull, -1007, -284 },
+    { 0x8dd01fad907ffc3cull,  -980, -276 },
+    { 0xd3515c2831559a83ull,  -954, -268 },
+    { 0x9d71ac8fada6c9b5ull,  -927, -260 },
+    { 0xea9c227723ee8bcbull,  -901, -252 },
+    { 0xaecc49914078536dull,  -874, -244 },
+    { 0x823c12795db6ce57ull,  -847, -236 },
+    { 0xc21094364dfb5637ull,  -821, -228 },
+    { 0x9096ea6f3848984full,  -794, -220 },
+    { 0xd77485cb25823ac7ull,  -768, -212 },
+    { 0xa086cfcd97bf97f4ull,  -741, -204 },
+    { 0xef340a98172aace5ull,  -715, -196 },
+    { 0xb23867fb2a35b28eull,  -688, -188 },
+    { 0x84c8d4dfd2c63f3bull,  -661, -180 },
+    { 0xc5dd44271ad3cdbaull,  -635, -172 },
+    { 0x936b9fcebb25c996ull,  -608, -164 },
+    { 0xdbac6c247d62a584ull,  -582, -156 },
+    { 0xa3ab66580d5fdaf6ull,  -555, -148 },
+    { 0xf3e2f893dec3f126ull,  -529, -140 },
+    { 0xb5b5ada8aaff80b8ull,  -502, -132 },
+    { 0x87625f056c7c4a8bull,  -475, -124 },
+    { 0xc9bcff6034c13053ull,  -449, -116 },
+    { 0x964e858c91ba2655ull,  -422, -108 },
+    { 0xdff9772470297ebdull,  -396, -100 },
+    { 0xa6dfbd9fb8e5b88full,  -369,  -92 },
+    { 0xf8a95fcf88747d94ull,  -343,  -84 },
+    { 0xb94470938fa89bcfull,  -316,  -76 },
+    { 0x8a08f0f8bf0f156bull,  -289,  -68 },
+    { 0xcdb02555653131b6ull,  -263,  -60 },
+    { 0x993fe2c6d07b7facull,  -236,  -52 },
+    { 0xe45c10c42a2b3b06ull,  -210,  -44 },
+    { 0xaa242499697392d3ull,  -183,  -36 },
+    { 0xfd87b5f28300ca0eull,  -157,  -28 },
+    { 0xbce5086492111aebull,  -130,  -20 },
+    { 0x8cbccc096f5088ccull,  -103,  -12 },
+    { 0xd1b71758e219652cull,   -77,   -4 },
+    { 0x9c40000000000000ull,   -50,    4 },
+    { 0xe8d4a51000000000ull,   -24,   12 },
+    { 0xad78ebc5ac620000ull,     3,   20 },
+    { 0x813f3978f8940984ull,    30,   28 },
+    { 0xc097ce7bc90715b3ull,    56,   36 },
+    { 0x8f7e32ce7bea5c70ull,    83,   44 },
+    { 0xd5d238a4abe98068ull,   109,   52 },
+    { 0x9f4f2726179a2245ull,   136,   60 },
+    { 0xed63a231d4c4fb27ull,   162,   68 },
+    { 0xb0de65388cc8ada8ull,   189,   76 },
+    { 0x83c7088e1aab65dbull,   216,   84 },
+    { 0xc45d1df942711d9aull,   242,   92 },
+    { 0x924d692ca61be758ull,   269,  100 },
+    { 0xda01ee641a708deaull,   295,  108 },
+    { 0xa26da3999aef774aull,   322,  116 },
+    { 0xf209787bb47d6b85ull,   348,  124 },
+    { 0xb454e4a179dd1877ull,   375,  132 },
+    { 0x865b86925b9bc5c2ull,   402,  140 },
+    { 0xc83553c5c8965d3dull,   428,  148 },
+    { 0x952ab45cfa97a0b3ull,   455,  156 },
+    { 0xde469fbd99a05fe3ull,   481,  164 },
+    { 0xa59bc234db398c25ull,   508,  172 },
+    { 0xf6c69a72a3989f5cull,   534,  180 },
+    { 0xb7dcbf5354e9beceull,   561,  188 },
+    { 0x88fcf317f22241e2ull,   588,  196 },
+    { 0xcc20ce9bd35c78a5ull,   614,  204 },
+    { 0x98165af37b2153dfull,   641,  212 },
+    { 0xe2a0b5dc971f303aull,   667,  220 },
+    { 0xa8d9d1535ce3b396ull,   694,  228 },
+    { 0xfb9b7cd9a4a7443cull,   720,  236 },
+    { 0xbb764c4ca7a44410ull,   747,  244 },
+    { 0x8bab8eefb6409c1aull,   774,  252 },
+    { 0xd01fef10a657842cull,   800,  260 },
+    { 0x9b10a4e5e9913129ull,   827,  268 },
+    { 0xe7109bfba19c0c9dull,   853,  276 },
+    { 0xac2820d9623bf429ull,   880,  284 },
+    { 0x80444b5e7aa7cf85ull,   907,  292 },
+    { 0xbf21e44003acdd2dull,   933,  300 },
+    { 0x8e679c2f5e44ff8full,   960,  308 },
+    { 0xd433179d9c8cb841ull,   986,  316 },
+    { 0x9e19db92b4e31ba9ull,  1013,  324 },
+    { 0xeb96bf6ebadf77d9ull,  1039,  332 },
+    { 0xaf87023b9bf0ee6bull,  1066,  340 }
+};
+
+
+//------------------------------------------------
+// Private Function Prototypes
+//------------------------------------------------
+
+static size_t       formatShortest( char *pText, double value );
+static bool         grisuDigits( double value, char *pDigits, int *pDigitCount, int *pExponent );
+static grisuFp_t    grisuNormalize( grisuFp_t x );
+static grisuFp_t    grisuMultiply( grisuFp_t x, grisuFp_t y );
+static bool         grisuGenerate( grisuFp_t low, grisuFp_t w, grisuFp_t high, char *pDigits, int *pDigitCount,
+                                   int *pKappa );
+static bool         grisuRoundWeed( char *pDigits, int digitCount, uint64_t distanceTooHighW,
+                                    uint64_t unsafeInterval, uint64_t rest, uint64_t tenKappa, uint64_t unit );
+static void         searchDigits( double value, char *pDigits, int *pDigitCount, int *pExponent );
+static void         putText( char *buffer, size_t bufferSize, size_t *pPosition, const char *pText, size_t length );
+static size_t       skipSpace( const char *text, size_t textLength, size_t position );
+static bool         readNumber( const char *pText, size_t length, double *pValue );
+static void         putLittleEndian( unsigned char *pBytes, uint64_t value, int byteCount );
+static uint64_t     getLittleEndian( const unsigned char *pBytes, int byteCount );
+static void         putDouble( unsigned char *pBytes, double value );
+static double       getDouble( const unsigned char *pBytes );
+
+
+//=========================================================
+//      Global function definitions
+//=========================================================
+
+
+//--------------------------------------------------------
+// polyfit_format_double()
+// Writes the shortest decimal text that reads back as
+// exactly value, with a NUL after it if there's room.
+// *pLength receives the length of the text, without the
+// NUL, whether or not it fits, as snprintf() reports it.
+// Infinities and NaN are written as inf, -inf and nan.
+//
+// The digits are found with 64 bit integer arithmetic
+// by Grisu3, falling back to a search with snprintf() and
+// strtod() for the rare values it can't settle. They are
+// written in plain or exponent notation, whichever is
+// shorter, as in 0.25, 1e-7, 123 and 1.5e300.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -5 if the buffer is too small.
+//--------------------------------------------------------
+int polyfit_format_double( char *buffer, size_t bufferSize, double value, size_t *pLength )
+{
+    char text[ SHORTEST_MAX_LENGTH ];
+
+    if( (NULL == pLength) || ((NULL == buffer) && (bufferSize > 0)) )
+    {
+        return -1;
+    }
+
+    size_t length = formatShortest( text, value );
+    size_t position = 0;
+    putText( buffer, bufferSize, &position, text, length );
+    *pLength = length;
+    return (length < bufferSize) ? 0 : -5;
+}
+
+//--------------------------------------------------------
+// polyfit_encode_json()
+// Writes coefficients as a JSON array of numbers, each in
+// its shortest round trip form, as
+//      [c0,c1,...]
+// with a NUL after it if there's room. Infinities and
+// NaN, which JSON can't hold, are written as null. The
+// write position is carried along, so nothing is scanned
+// twice. *pLength receives the length of the text,
+// without the NUL, whether or not it fits; passing a NULL
+// buffer and a bufferSize of 0 just measures it.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -5 if coefficientCount < 1 or the buffer is too
+//             small.
+//--------------------------------------------------------
+int polyfit_encode_json( char *buffer, size_t bufferSize, int coefficientCount, double *coefficients,
+                         size_t *pLength )
+{
+    char text[ SHORTEST_MAX_LENGTH ];
+    size_t position = 0;
+
+    if( (NULL == coefficients) || (NULL == pLength) || ((NULL == buffer) && (bufferSize > 0)) )
+    {
+        return -1;
+    }
+    if( coefficientCount < 1 )
+    {
+        return -5;
+    }
+
+    putText( buffer, bufferSize, &position, "[", 1 );
+    for( int c = 0; c < coefficientCount; c++ )
+    {
+        if( c > 0 )
+        {
+            putText( buffer, bufferSize, &position, ",", 1 );
+        }
+        if( isfinite( coefficients[c] ) )
+        {
+            putText( buffer, bufferSize, &position, text, formatShortest( text, coefficients[c] ) );
+        }
+        else
+        {
+            putText( buffer, bufferSize, &position, "null", 4 );
+        }
+    }
+    putText( buffer, bufferSize, &position, "]", 1 );
+
+    *pLength = position;
+    return (position < bufferSize) ? 0 : -5;
+}
+
+//--------------------------------------------------------
+// polyfit_decode_json()
+// Reads a JSON array of numbers, as written by
+// polyfit_encode_json(), from the first textLength
+// characters of text, which need not end with a NUL.
+// Space around the values is allowed, and null reads as
+// NaN. Numbers are read with a '.' decimal point, as JSON
+// has it, whatever the LC_NUMERIC locale.
+// *pCoefficientCount receives the number of values,
+// and *pLength the characters read, up to and including
+// the closing bracket, so arrays can be read one after
+// another from a stream.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -5 if the text is not such an array, or holds
+//             more than maxCoefficients values.
+//--------------------------------------------------------
+int polyfit_decode_json( const char *text, size_t textLength, int maxCoefficients, double *coefficients,
+                         int *pCoefficientCount, size_t *pLength )
+{
+    int count = 0;
+
+    if( (NULL == text) || (NULL == coefficients) || (NULL == pCoefficientCount) || (NULL == pLength) )
+    {
+        return -1;
+    }
+
+    size_t position = skipSpace( text, textLength, 0 );
+    if( (position >= textLength) || ('[' != text[ position ]) )
+    {
+        return -5;
+    }
+    position += 1;
+
+    for( ;; )
+    {
+        position = skipSpace( text, textLength, position );
+        size_t start = position;
+        while( (position < textLength) && ('\0' != text[ position ]) &&
+               (NULL != strchr( "0123456789+-.eEnul", text[ position ] )) )
+        {
+            position += 1;
+        }
+        size_t length = position - start;
+        if( (0 == length) || (count >= maxCoefficients) )
+        {
+            return -5;
+        }
+
+        if( (4 == length) && (0 == strncmp( &(text[ start ]), "null", 4 )) )
+        {
+            coefficients[ count ] = NAN;
+        }
+        else if( !readNumber( &(text[ start ]), length, &(coefficients[ count ]) ))
+        {
+            return -5;
+        }
+        count += 1;
+
+        position = skipSpace( text, textLength, position );
+        if( (position < textLength) && (']' == text[ position ]) )
+        {
+            break;
+        }
+        if( (position >= textLength) || (',' != text[ position ]) )
+        {
+            return -5;
+        }
+        position += 1;
+    }
+
+    *pCoefficientCount = count;
+    *pLength = position + 1;
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_encode_binary()
+// Writes coefficients in a compact binary form: the count
+// as a 4 byte little endian integer, then each
+// coefficient as an 8 byte little endian IEEE 754 double,
+// highest power first. The bytes are the same on every
+// host, and every value, including infinities, NaN and
+// the sign of zero, reads back exactly. *pLength receives
+// the length, 4 + 8 * coefficientCount bytes, whether or
+// not it fits.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -5 if coefficientCount < 1 or the buffer is too
+//             small.
+//--------------------------------------------------------
+int polyfit_encode_binary( void *buffer, size_t bufferSize, int coefficientCount, double *coefficients,
+                           size_t *pLength )
+{
+    unsigned char *pBytes = (unsigned char *) buffer;
+
+    if( (NULL == coefficients) || (NULL == pLength) || ((NULL == buffer) && (bufferSize > 0)) )
+    {
+        return -1;
+    }
+    if( coefficientCount < 1 )
+    {
+        return -5;
+    }
+
+    *pLength = BINARY_COUNT_BYTES + ((size_t) coefficientCount * BINARY_VALUE_BYTES);
+    if( bufferSize < *pLength )
+    {
+        return -5;
+    }
+
+    putLittleEndian( pBytes, (uint32_t) coefficientCount, BINARY_COUNT_BYTES );
+    for( int c = 0; c < coefficientCount; c++ )
+    {
+        putDouble( &(pBytes[ BINARY_COUNT_BYTES + (c * BINARY_VALUE_BYTES) ]), coefficients[c] );
+    }
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_decode_binary()
+// Reads coefficients written by polyfit_encode_binary()
+// from the start of a buffer of bufferSize bytes.
+// *pCoefficientCount receives their number, and *pLength
+// the bytes read, so encodings can be read one after
+// another from a stream.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -5 if the buffer is too short for the count it
+//             starts with, or the count is below 1 or
+//             above maxCoefficients.
+//--------------------------------------------------------
+int polyfit_decode_binary( const void *buffer, size_t bufferSize, int maxCoefficients, double *coefficients,
+                           int *pCoefficientCount, size_t *pLength )
+{
+    const unsigned char *pBytes = (const unsigned char *) buffer;
+
+    if( (NULL == buffer) || (NULL == coefficients) || (NULL == pCoefficientCount) || (NULL == pLength) )
+    {
+        return -1;
+    }
+    if( bufferSize < BINARY_COUNT_BYTES )
+    {
+        return -5;
+    }
+
+    uint32_t count = (uint32_t) getLittleEndian( pBytes, BINARY_COUNT_BYTES );
+    if( (count < 1) || (maxCoefficients < 1) || (count > (uint32_t) maxCoefficients) ||
+        ((bufferSize - BINARY_COUNT_BYTES) / BINARY_VALUE_BYTES < count) )
+    {
+        return -5;
+    }
+
+    for( int c = 0; c < (int) count; c++ )
+    {
+        coefficients[c] = getDouble( &(pBytes[ BINARY_COUNT_BYTES + (c * BINARY_VALUE_BYTES) ]) );
+    }
+
+    *pCoefficientCount = (int) count;
+    *pLength = BINARY_COUNT_BYTES + ((size_t) count * BINARY_VALUE_BYTES);
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_accum_encode()
+// Writes the state of an accumulator, so that a partial
+// fit made in one process can be shipped to another and
+// merged there with polyfit_accum_merge(). The format is:
+//
+//      4 bytes   the tag "PFAS"
+//      4 bytes   the format version, now 1
+//      4 bytes   coefficientCount
+//      8 bytes   pointCount
+//      8 bytes   the sum of y^2
+//      8 bytes   each of the (2 * coefficientCount - 1)
+//                power sums, ascending power
+//      8 bytes   each of the coefficientCount right hand
+//                side sums, ascending power
+//
+// with every integer and IEEE 754 double little endian, so
+// the bytes are the same on every host and the sums read
+// back exactly. *pLength receives the length,
+// 20 + 24 * coefficientCount bytes, whether or not it
+// fits, so the size can be found with a bufferSize of 0.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -5 if the buffer is too small.
+//--------------------------------------------------------
+int polyfit_accum_encode( void *buffer, size_t bufferSize, polyfit_accum_t *pAccum, size_t *pLength )
+{
+    unsigned char *pBytes = (unsigned char *) buffer;
+
+    if( (NULL == pAccum) || (NULL == pAccum->pPowerSums) || (NULL == pAccum->pRhsSums) || (NULL == pLength) ||
+        ((NULL == buffer) && (bufferSize > 0)) )
+    {
+        return -1;
+    }
+
+    int coefficientCount = pAccum->coefficientCount;
+    int powerSumCount = (2 * coefficientCount) - 1;
+    int sumCount = (3 * coefficientCount) - 1;
+    *pLength = STATE_HEADER_BYTES + ((size_t) (sumCount + 1) * BINARY_VALUE_BYTES);
+    if( bufferSize < *pLength )
+    {
+        return -5;
+    }
+
+    memcpy( pBytes, STATE_TAG, STATE_TAG_BYTES );
+    pBytes += STATE_TAG_BYTES;
+    putLittleEndian( pBytes, STATE_VERSION, STATE_VERSION_BYTES );
+    pBytes += STATE_VERSION_BYTES;
+    putLittleEndian( pBytes, (uint32_t) coefficientCount, BINARY_COUNT_BYTES );
+    pBytes += BINARY_COUNT_BYTES;
+    putLittleEndian( pBytes, (uint64_t) pAccum->pointCount, STATE_POINTS_BYTES );
+    pBytes += STATE_POINTS_BYTES;
+
+    // The y squared sum, the power sums, then the right hand side sums.
+    putDouble( pBytes, pAccum->ySquareSum );
+    pBytes += BINARY_VALUE_BYTES;
+    for( int s = 0; s < powerSumCount; s++ )
+    {
+        putDouble( &(pBytes[ s * BINARY_VALUE_BYTES ]), pAccum->pPowerSums[s] );
+    }
+    pBytes += (size_t) powerSumCount * BINARY_VALUE_BYTES;
+    for( int s = 0; s < coefficientCount; s++ )
+    {
+        putDouble( &(pBytes[ s * BINARY_VALUE_BYTES ]), pAccum->pRhsSums[s] );
+    }
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_accum_decode()
+// Reads accumulator state written by
+// polyfit_accum_encode() from the start of a buffer of
+// bufferSize bytes into pAccum, which is prepared as by
+// polyfit_accum_init(); release it with
+// polyfit_accum_free(). *pLength receives the bytes read.
+// State written by a later version of the format is
+// refused, rather than misread.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -3 if unable to allocate memory,
+//          -5 if the buffer doesn't start with accumulator
+//             state of a known version, or is too short
+//             for it.
+//--------------------------------------------------------
+int polyfit_accum_decode( const void *buffer, size_t bufferSize, polyfit_accum_t *pAccum, size_t *pLength )
+{
+    const unsigned char *pBytes = (const unsigned char *) buffer;
+
+    if( (NULL == buffer) || (NULL == pAccum) || (NULL == pLength) )
+    {
+        return -1;
+    }
+    pAccum->pPowerSums = NULL;
+    pAccum->pRhsSums = NULL;
+    if( (bufferSize < STATE_HEADER_BYTES) || (0 != memcmp( pBytes, STATE_TAG, STATE_TAG_BYTES )) )
+    {
+        return -5;
+    }
+    pBytes += STATE_TAG_BYTES;
+
+    uint64_t version = getLittleEndian( pBytes, STATE_VERSION_BYTES );
+    pBytes += STATE_VERSION_BYTES;
+    uint64_t count = getLittleEndian( pBytes, BINARY_COUNT_BYTES );
+    pBytes += BINARY_COUNT_BYTES;
+    uint64_t pointCount = getLittleEndian( pBytes, STATE_POINTS_BYTES );
+    pBytes += STATE_POINTS_BYTES;
+
+    // Check the length before the count is used to allocate anything.
+    if( (version < 1) || (version > STATE_VERSION) || (count < 1) || (count > INT_MAX / 3) ||
+        (pointCount > (uint64_t) LLONG_MAX) ||
+        ((bufferSize - STATE_HEADER_BYTES) / (3 * BINARY_VALUE_BYTES) < count) )
+    {
+        return -5;
+    }
+
+    int rVal = polyfit_accum_init( pAccum, (int) count );
+    if( 0 != rVal )
+    {
+        return rVal;
+    }
+    int sumCount = (3 * (int) count) - 1;
+    int powerSumCount = (2 * (int) count) - 1;
+    pAccum->pointCount = (long long) pointCount;
+    pAccum->ySquareSum = getDouble( pBytes );
+    pBytes += BINARY_VALUE_BYTES;
+    for( int s = 0; s < powerSumCount; s++ )
+    {
+        pAccum->pPowerSums[s] = getDouble( &(pBytes[ s * BINARY_VALUE_BYTES ]) );
+    }
+    pBytes += (size_t) powerSumCount * BINARY_VALUE_BYTES;
+    for( int s = 0; s < (int) count; s++ )
+    {
+        pAccum->pRhsSums[s] = getDouble( &(pBytes[ s * BINARY_VALUE_BYTES ]) );
+    }
+
+    *pLength = STATE_HEADER_BYTES + ((size_t) (sumCount + 1) * BINARY_VALUE_BYTES);
+    return 0;
+}
+
+//=========================================================
+//      Private function definitions
+//=========================================================
+
+//--------------------------------------------------------
+// formatShortest()
+// Writes the shortest round trip text of a value into
+// pText, which must hold SHORTEST_MAX_LENGTH characters.
+// The digits come from Grisu3, which proves its answer
+// shortest and correct for all but about 0.5% of values,
+// and otherwise from searchDigits(). They are written in
+// plain or exponent notation, whichever is shorter, plain
+// on a tie, with the exponent as e7 or e-7.
+// Returns its length.
+//--------------------------------------------------------
+static size_t formatShortest( char *pText, double value )
+{
+    char digits[ SHORTEST_MAX_DIGITS + 1 ];
+    int digitCount = 0;
+    int exponent = 0;                   // Of the first digit.
+    size_t length = 0;
+
+    if( !isfinite( value ) )
+    {
+        return (size_t) snprintf( pText, SHORTEST_MAX_LENGTH, "%s", isnan( value ) ? "nan" :
+                                                                    ((value < 0.0) ? "-inf" : "inf") );
+    }
+    if( signbit( value ) )
+    {
+        pText[ length++ ] = '-';
+        value = -value;
+    }
+    if( 0.0 == value )
+    {
+        pText[ length++ ] = '0';
+        pText[ length ] = '\0';
+        return length;
+    }
+
+    if( grisuDigits( value, digits, &digitCount, &exponent ) )
+    {
+        exponent += digitCount - 1;
+    }
+    else
+    {
+        searchDigits( value, digits, &digitCount, &exponent );
+    }
+
+    // Plain notation is the digits padded with zeros, or split by a
+    // point, or after "0." and zeros; exponent notation is d.ddd then e
+    // and the exponent.
+    int plainLength = (exponent >= digitCount - 1) ? (exponent + 1) :
+                      ((exponent >= 0) ? (digitCount + 1) : (digitCount + 1 - exponent));
+    int magnitude = (exponent < 0) ? -exponent : exponent;
+    int exponentLength = digitCount + ((digitCount > 1) ? 1 : 0) + 1 + ((exponent < 0) ? 1 : 0) +
+                         ((magnitude >= 100) ? 3 : ((magnitude >= 10) ? 2 : 1));
+
+    if( plainLength <= exponentLength )
+    {
+        if( exponent < 0 )
+        {
+            pText[ length++ ] = '0';
+            pText[ length++ ] = '.';
+            for( int z = -1; z > exponent; z-- )
+            {
+                pText[ length++ ] = '0';
+            }
+        }
+        for( int d = 0; d < digitCount; d++ )
+        {
+            if( (d == exponent + 1) && (exponent >= 0) )
+            {
+                pText[ length++ ] = '.';
+            }
+            pText[ length++ ] = digits[d];
+        }
+        for( int z = digitCount - 1; z < exponent; z++ )
+        {
+            pText[ length++ ] = '0';
+        }
+        pText[ length ] = '\0';
+        return length;
+    }
+
+    pText[ length++ ] = digits[0];
+    if( digitCount > 1 )
+    {
+        pText[ length++ ] = '.';
+        memcpy( &(pText[ length ]), &(digits[1]), digitCount - 1 );
+        length += digitCount - 1;
+    }
+    length += (size_t) snprintf( &(pText[ length ]), SHORTEST_MAX_LENGTH - length, "e%d", exponent );
+    return length;
+}
+
+//--------------------------------------------------------
+// grisuDigits()
+// Finds the shortest digits that read back as a positive,
+// finite value, by Florian Loitsch's Grisu3 ("Printing
+// Floating-Point Numbers Quickly and Accurately with
+// Integers", PLDI 2010). The value is the digits, read as
+// an integer, times 10^*pExponent.
+// Returns true if success, or false if Grisu3 can't be
+// sure of its answer, when nothing is stored.
+//--------------------------------------------------------
+static bool grisuDigits( double value, char *pDigits, int *pDigitCount, int *pExponent )
+{
+    uint64_t bits = 0;
+    memcpy( &bits, &value, sizeof( bits ));
+
+    // value = v.f * 2^v.e exactly.
+    uint64_t hiddenBit = (uint64_t) 1 << 52;
+    int biasedExponent = (int) ((bits >> 52) & 0x7FF);
+    grisuFp_t v = { bits & (hiddenBit - 1), -1074 };
+    if( 0 != biasedExponent )
+    {
+        v.f += hiddenBit;
+        v.e = biasedExponent - 1075;
+    }
+
+    // The boundaries half way to the neighbouring doubles. The one below
+    // is closer when v is a power of two above the subnormals.
+    grisuFp_t plus = grisuNormalize( (grisuFp_t) { (v.f << 1) + 1, v.e - 1 } );
+    grisuFp_t minus = ((hiddenBit == v.f) && (biasedExponent > 1)) ? (grisuFp_t) { (v.f << 2) - 1, v.e - 2 }
+                                                                    : (grisuFp_t) { (v.f << 1) - 1, v.e - 1 };
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+    grisuFp_t w = grisuNormalize( v );
+
+    // Pick the cached power that brings w's exponent into range.
+    int minExponent = GRISU_MIN_EXPONENT - (w.e + 64);
+    int k = (int) ceil( (minExponent + 63) * 0.30102999566398114 );
+    int index = ((-GRISU_FIRST_POWER) + k - 1) / GRISU_POWER_STEP + 1;
+    grisuFp_t power = { grisuPowers[ index ].f, grisuPowers[ index ].e };
+
+    int kappa = 0;
+    if( !grisuGenerate( grisuMultiply( minus, power ), grisuMultiply( w, power ), grisuMultiply( plus, power ),
+                        pDigits, pDigitCount, &kappa ) )
+    {
+        return false;
+    }
+    *pExponent = kappa - grisuPowers[ index ].decimalExponent;
+    return true;
+}
+
+//--------------------------------------------------------
+// grisuNormalize()
+// Shifts a non-zero value left until its top bit is set.
+//--------------------------------------------------------
+static grisuFp_t grisuNormalize( grisuFp_t x )
+{
+    while( 0 == (x.f & ((uint64_t) 1 << 63)) )
+    {
+        x.f <<= 1;
+        x.e -= 1;
+    }
+    return x;
+}
+
+//--------------------------------------------------------
+// grisuMultiply()
+// Returns the product of two values, its significand the
+// top 64 bits of the 128 bit product, rounded.
+//--------------------------------------------------------
+static grisuFp_t grisuMultiply( grisuFp_t x, grisuFp_t y )
+{
+    uint64_t mask = 0xFFFFFFFFu;
+    uint64_t a = x.f >> 32;
+    uint64_t b = x.f & mask;
+    uint64_t c = y.f >> 32;
+    uint64_t d = y.f & mask;
+    uint64_t ac = a * c;
+    uint64_t bc = b * c;
+    uint64_t ad = a * d;
+    uint64_t bd = b * d;
+    uint64_t middle = (bd >> 32) + (ad & mask) + (bc & mask) + ((uint64_t) 1 << 31);
+    grisuFp_t product = { ac + (ad >> 32) + (bc >> 32) + (middle >> 32), x.e + y.e + 64 };
+    return product;
+}
+
+//--------------------------------------------------------
+// grisuGenerate()
+// Generates the digits of the scaled value high, stopping
+// as soon as they lie between the scaled boundaries low
+// and high, then rounds the last digit toward w.
+// Returns true if the digits are proven shortest and
+// correctly rounded.
+//--------------------------------------------------------
+static bool grisuGenerate( grisuFp_t low, grisuFp_t w, grisuFp_t high, char *pDigits, int *pDigitCount,
+                           int *pKappa )
+{
+    uint64_t unit = 1;
+    uint64_t tooLow = low.f - unit;
+    uint64_t tooHigh = high.f + unit;
+    uint64_t unsafeInterval = tooHigh - tooLow;
+    int shift = -w.e;
+    uint64_t one = (uint64_t) 1 << shift;
+    uint32_t integrals = (uint32_t) (tooHigh >> shift);
+    uint64_t fractionals = tooHigh & (one - 1);
+
+    uint32_t divisor = 1;
+    int kappa = 0;
+    if( integrals > 0 )
+    {
+        kappa = 1;
+        while( integrals / divisor >= 10 )
+        {
+            divisor *= 10;
+            kappa += 1;
+        }
+    }
+
+    int digitCount = 0;
+    while( kappa > 0 )
+    {
+        pDigits[ digitCount++ ] = (char) ('0' + (integrals / divisor));
+        integrals %= divisor;
+        kappa -= 1;
+        uint64_t rest = ((uint64_t) integrals << shift) + fractionals;
+        if( rest < unsafeInterval )
+        {
+            *pDigitCount = digitCount;
+            *pKappa = kappa;
+            return grisuRoundWeed( pDigits, digitCount, tooHigh - w.f, unsafeInterval, rest,
+                                   (uint64_t) divisor << shift, unit );
+        }
+        divisor /= 10;
+    }
+
+    for( ;; )
+    {
+        fractionals *= 10;
+        unit *= 10;
+        unsafeInterval *= 10;
+        pDigits[ digitCount++ ] = (char) ('0' + (fractionals >> shift));
+        fractionals &= one - 1;
+        kappa -= 1;
+        if( fractionals < unsafeInterval )
+        {
+            *pDigitCount = digitCount;
+            *pKappa = kappa;
+            return grisuRoundWeed( pDigits, digitCount, (tooHigh - w.f) * unit, unsafeInterval, fractionals, one,
+                                   unit );
+        }
+        if( digitCount >= SHORTEST_MAX_DIGITS )
+        {
+            return false;
+        }
+    }
+}
+
+//--------------------------------------------------------
+// grisuRoundWeed()
+// Moves the last digit toward w while that brings the
+// digits closer to it, then checks that the result is
+// certainly within the rounding interval and certainly
+// the closest.
+// Returns true if it is.
+//--------------------------------------------------------
+static bool grisuRoundWeed( char *pDigits, int digitCount, uint64_t distanceTooHighW, uint64_t unsafeInterval,
+                            uint64_t rest, uint64_t tenKappa, uint64_t unit )
+{
+    uint64_t smallDistance = distanceTooHighW - unit;
+    uint64_t bigDistance = distanceTooHighW + unit;
+
+    while( (rest < smallDistance) && (unsafeInterval - rest >= tenKappa) &&
+           ((rest + tenKappa < smallDistance) || (smallDistance - rest >= rest + tenKappa - smallDistance)) )
+    {
+        pDigits[ digitCount - 1 ] -= 1;
+        rest += tenKappa;
+    }
+    if( (rest < bigDistance) && (unsafeInterval - rest >= tenKappa) &&
+        ((rest + tenKappa < bigDistance) || (bigDistance - rest > rest + tenKappa - bigDistance)) )
+    {
+        return false;
+    }
+    return (2 * unit <= rest) && (rest <= unsafeInterval - (4 * unit));
+}
+
+//--------------------------------------------------------
+// searchDigits()
+// Finds the shortest digits of a positive, finite value
+// with the C library: a double needs at most 17
+// significant digits to round trip, and any normal value
+// that can be written in 15 or fewer is found by printing
+// 15, so it prints 15, 16 and then 17 until one reads
+// back exactly. Subnormals, which hold fewer digits, are
+// tried from 1 digit up. *pExponent receives the exponent
+// of the first digit.
+//--------------------------------------------------------
+static void searchDigits( double value, char *pDigits, int *pDigitCount, int *pExponent )
+{
+    char text[ SHORTEST_MAX_LENGTH ];
+    int firstTry = (value < DBL_MIN) ? 1 : SHORTEST_SAFE_DIGITS;
+
+    for( int digits = firstTry; digits <= SHORTEST_MAX_DIGITS; digits++ )
+    {
+        snprintf( text, sizeof( text ), "%.*e", digits - 1, value );
+        if( strtod( text, NULL ) == value )
+        {
+            break;
+        }
+    }
+
+    // text is d.ddde[+-]x, the point being the locale's, which may be ','
+    // or longer; keep the digits without trailing zeros.
+    int digitCount = 0;
+    char *pChar = text;
+    for( ; 'e' != *pChar; pChar++ )
+    {
+        if( ('0' <= *pChar) && ('9' >= *pChar) )
+        {
+            pDigits[ digitCount++ ] = *pChar;
+        }
+    }
+    while( (digitCount > 1) && ('0' == pDigits[ digitCount - 1 ]) )
+    {
+        digitCount -= 1;
+    }
+    *pDigitCount = digitCount;
+    *pExponent = atoi( pChar + 1 );
+}
+
+//--------------------------------------------------------
+// putText()
+// Copies as much of length characters of text to
+// buffer[ *pPosition ] as fits with a NUL after it, and
+// advances *pPosition by the full length regardless.
+//--------------------------------------------------------
+static void putText( char *buffer, size_t bufferSize, size_t *pPosition, const char *pText, size_t length )
+{
+    size_t position = *pPosition;
+
+    if( position < bufferSize )
+    {
+        size_t room = bufferSize - position - 1;
+        size_t copied = (length < room) ? length : room;
+        memcpy( &(buffer[ position ]), pText, copied );
+        buffer[ position + copied ] = '\0';
+    }
+    *pPosition = position + length;
+}
+
+//--------------------------------------------------------
+// skipSpace()
+// Returns the position of the first character at or after
+// position that isn't JSON white space.
+//--------------------------------------------------------
+static size_t skipSpace( const char *text, size_t textLength, size_t position )
+{
+    while( (position < textLength) && ('\0' != text[ position ]) && (NULL != strchr( " \t\r\n", text[ position ] )) )
+    {
+        position += 1;
+    }
+    return position;
+}
+
+//--------------------------------------------------------
+// readNumber()
+// Reads the length characters at pText, a number with a
+// '.' decimal point, into *pValue with strtod(), which
+// rounds correctly but expects the LC_NUMERIC locale's
+// decimal point, so the '.' is first replaced by that.
+// Returns true if all of the characters were read.
+//--------------------------------------------------------
+static bool readNumber( const char *pText, size_t length, double *pValue )
+{
+    char number[ SHORTEST_MAX_LENGTH * 2 ];
+    const char *pPoint = localeconv()->decimal_point;
+    size_t pointLength = strlen( pPoint );
+    size_t used = 0;
+
+    for( size_t i = 0; i < length; i++ )
+    {
+        const char *pPart = ('.' == pText[i]) ? pPoint : &(pText[i]);
+        size_t partLength = ('.' == pText[i]) ? pointLength : 1;
+        if( used + partLength >= sizeof( number ))
+        {
+            return false;
+        }
+        memcpy( &(number[ used ]), pPart, partLength );
+        used += partLength;
+    }
+    number[ used ] = '\0';
+
+    char *pEnd = NULL;
+    *pValue = strtod( number, &pEnd );
+    return (0 < used) && (&(number[ used ]) == pEnd);
+}
+
+//--------------------------------------------------------
+// putLittleEndian(), getLittleEndian()
+// Write and read the low byteCount bytes of an unsigned
+// integer, least significant first. Shifting each byte is
+// the same on hosts of either byte order, and compiles to
+// plain loads and stores on little endian ones.
+//--------------------------------------------------------
+static void putLittleEndian( unsigned char *pBytes, uint64_t value, int byteCount )
+{
+    for( int b = 0; b < byteCount; b++ )
+    {
+        pBytes[b] = (unsigned char) (value >> (8 * b));
+    }
+}
+
+static uint64_t getLittleEndian( const unsigned char *pBytes, int byteCount )
+{
+    uint64_t value = 0;
+
+    for( int b = 0; b < byteCount; b++ )
+    {
+        value |= (uint64_t) pBytes[b] << (8 * b);
+    }
+    return value;
+}
+
+//--------------------------------------------------------
+// putDouble(), getDouble()
+// Write and read a double as the 8 little endian bytes of
+// its IEEE 754 bits.
+//--------------------------------------------------------
+static void putDouble( unsigned char *pBytes, double value )
+{
+    uint64_t bits;
+
+    memcpy( &bits, &value, sizeof( bits ));
+    putLittleEndian( pBytes, bits, BINARY_VALUE_BYTES );
+}
+
+static double getDouble( const unsigned char *pBytes )
+{
+    uint64_t bits = getLittleEndian( pBytes, BINARY_VALUE_BYTES );
+    double value;
+
+    memcpy( &value, &bits, sizeof( value ));
+    return value;
+}
@@ -0,0 +1,645 @@
+// Name: polyservice.c
+// Description: Thread pool that fits jobs submitted from any thread, through a lock-free queue.
+// Author: Henry M. Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+#define _POSIX_C_SOURCE 200809L     // sysconf(), clock_gettime()
+
+#include <errno.h>      // errno, EINTR
+#include <limits.h>     // INT_MAX
+#include <math.h>       // log2(), exp2()
+#include <pthread.h>    // pthread_create()
+#include <sched.h>      // sched_yield()
+#include <semaphore.h>  // sem_wait()
+#include <time.h>       // clock_gettime()
+#include <unistd.h>     // sysconf()
+
+#include "polyfit_internal.h"
+
+// Latencies are counted in buckets an eighth of a power of 2 wide, about
+// 9%, from 1 ns up to 2^40 ns, about 18 minutes.
+#define SERVICE_BUCKETS_PER_OCTAVE  (8)
+#define SERVICE_LATENCY_BUCKETS     (40 * SERVICE_BUCKETS_PER_OCTAVE)
+
+// Bytes kept between the fields written by submitting threads and those
+// written by workers, so they don't share a cache line.
+#define SERVICE_CACHE_LINE          (64)
+
+// One slot of the queue. Its sequence says whose turn it is: equal to a
+// position, it is free for the job submitted at that position; one more,
+// it holds that job for a worker.
+typedef struct serviceCell_s
+{
+    size_t              sequence;
+    polyfit_job_t *     pJob;
+} serviceCell_t;
+
+// What one worker thread is given.
+typedef struct serviceWorker_s
+{
+    polyfit_service_t *     pService;
+    polyfit_workspace_t     workspace;
+} serviceWorker_t;
+
+struct polyfit_service_s
+{
+    // The queue: a ring of cells, a power of 2 of them, after Vyukov's
+    // bounded multi-producer multi-consumer queue. Submitting threads and
+    // workers each claim a position with a compare and swap, and no lock
+    // is taken. The semaphores count the free slots and the queued jobs,
+    // so threads sleep, rather than spin, on a full or an empty queue.
+    serviceCell_t *     pCells;
+    size_t              mask;               // Cells - 1.
+    char                pad0[ SERVICE_CACHE_LINE ];
+    size_t              enqueuePosition;
+    char                pad1[ SERVICE_CACHE_LINE ];
+    size_t              dequeuePosition;
+    char                pad2[ SERVICE_CACHE_LINE ];
+    sem_t               freeSlots;
+    sem_t               queuedJobs;
+
+    int                 threadCount;
+    pthread_t *         pThreads;
+    serviceWorker_t *   pWorkers;
+    void *              pWorkspaceMemory;
+    int                 stopping;
+
+    // Only waiting threads take the mutex. Workers signal only while
+    // waiterCount says someone is waiting.
+    pthread_mutex_t     doneMutex;
+    pthread_cond_t      doneCondition;
+    int                 waiterCount;
+
+    long long           submitted;
+    long long           completed;
+    long long           rejected;
+    int                 maxQueueDepth;
+    long long           latencyTotalNs;
+    long long           maxLatencyNs;
+    long long           latencyCounts[ SERVICE_LATENCY_BUCKETS ];
+
+    // How many of freeSlots, queuedJobs, doneMutex and doneCondition, in
+    // that order, were made, so a failed create destroys just those.
+    int                 syncCount;
+};
+
+
+//------------------------------------------------
+// Private Function Prototypes
+//------------------------------------------------
+
+static void *   serveJobs( void *pArg );
+static void     finishJob( polyfit_service_t *pService, polyfit_job_t *pJob );
+static bool     enqueueJob( polyfit_service_t *pService, polyfit_job_t *pJob );
+static bool     dequeueJob( polyfit_service_t *pService, polyfit_job_t **ppJob );
+static void     releaseService( polyfit_service_t *pService );
+static double   percentileNs( long long *pCounts, long long total, double fraction );
+static double   clockNs( void );
+
+
+//=========================================================
+//      Global function definitions
+//=========================================================
+
+
+//--------------------------------------------------------
+// polyfit_service_create()
+// Creates a fitting service: threadCount worker threads,
+// 0 for one per online CPU, taking jobs from a queue with
+// room for queueCapacity of them. Each worker fits with
+// polyfit_ws() in its own workspace for up to
+// maxCoefficients coefficients, so no job touches the
+// heap, and jobs never contend for an allocator.
+//
+// If only some threads can be started, the service runs
+// with those. Release it with polyfit_service_destroy().
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -3 if unable to allocate memory, make the
+//             semaphores, mutex or condition variable, or
+//             start a thread,
+//          -5 if threadCount < 0, queueCapacity < 1 or
+//             maxCoefficients < 1.
+//--------------------------------------------------------
+int polyfit_service_create( polyfit_service_t **ppService, int threadCount, int queueCapacity, int maxCoefficients )
+{
+    if( NULL == ppService )
+    {
+        return -1;
+    }
+    *ppService = NULL;
+
+    if( (threadCount < 0) || (queueCapacity < 1) || (maxCoefficients < 1) )
+    {
+        return -5;
+    }
+    if( 0 == threadCount )
+    {
+        long cpuCount = sysconf( _SC_NPROCESSORS_ONLN );
+        threadCount = (cpuCount > 0) ? (int) cpuCount : 1;
+    }
+
+    size_t cellCount = 2;
+    while( cellCount < (size_t) queueCapacity )
+    {
+        cellCount *= 2;
+    }
+    // With the default solver the workspace doesn't grow with the points.
+    size_t workspaceSize = polyfit_workspace_size( INT_MAX, maxCoefficients );
+
+    polyfit_service_t *pService = (polyfit_service_t *) polyfitCalloc( 1, sizeof( polyfit_service_t ));
+    if( NULL == pService )
+    {
+        return -3;
+    }
+    pService->pCells = (serviceCell_t *) polyfitCalloc( cellCount, sizeof( serviceCell_t ));
+    pService->pThreads = (pthread_t *) polyfitCalloc( threadCount, sizeof( pthread_t ));
+    pService->pWorkers = (serviceWorker_t *) polyfitCalloc( threadCount, sizeof( serviceWorker_t ));
+    pService->pWorkspaceMemory = polyfitCalloc( (size_t) threadCount, workspaceSize );
+    if( (NULL == pService->pCells) || (NULL == pService->pThreads) || (NULL == pService->pWorkers) ||
+        (NULL == pService->pWorkspaceMemory) )
+    {
+        releaseService( pService );
+        return -3;
+    }
+
+    pService->mask = cellCount - 1;
+    for( size_t c = 0; c < cellCount; c++ )
+    {
+        pService->pCells[c].sequence = c;
+    }
+    // Unnamed semaphores aren't supported everywhere; macOS fails them
+    // with ENOSYS.
+    bool made = (0 == sem_init( &pService->freeSlots, 0, (unsigned int) queueCapacity ));
+    pService->syncCount += made ? 1 : 0;
+    made = made && (0 == sem_init( &pService->queuedJobs, 0, 0 ));
+    pService->syncCount += made ? 1 : 0;
+    made = made && (0 == pthread_mutex_init( &pService->doneMutex, NULL ));
+    pService->syncCount += made ? 1 : 0;
+    made = made && (0 == pthread_cond_init( &pService->doneCondition, NULL ));
+    pService->syncCount += made ? 1 : 0;
+    if( !made )
+    {
+        releaseService( pService );
+        return -3;
+    }
+
+    for( int t = 0; t < threadCount; t++ )
+    {
+        serviceWorker_t *pWorker = &(pService->pWorkers[t]);
+        pWorker->pService = pService;
+        polyfit_workspace_init( &pWorker->workspace, &(((char *) pService->pWorkspaceMemory)[ t * workspaceSize ]),
+                                workspaceSize, INT_MAX, maxCoefficients );
+    }
+    for( int t = 0; t < threadCount; t++ )
+    {
+        if( 0 != pthread_create( &pService->pThreads[t], NULL, serveJobs, &pService->pWorkers[t] ))
+        {
+            break;
+        }
+        pService->threadCount++;
+    }
+    if( 0 == pService->threadCount )
+    {
+        releaseService( pService );
+        return -3;
+    }
+
+    *ppService = pService;
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_service_submit()
+// Queues a job for the service's threads, from any
+// thread. Once its fit is done, its status is set to what
+// polyfit() would return (or -5 if it has more
+// coefficients than the service's maxCoefficients), its
+// callback, if any, is called on the worker thread, and
+// then it is marked done; see polyfit_job_done() and
+// polyfit_service_wait().
+//
+// The queue holds up to the service's queueCapacity jobs.
+// When it is full, a submission with wait true sleeps
+// until there is room; one with wait false is turned away
+// at once, and counted as rejected, so the caller can
+// shed or defer load.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -6 if the queue is full and wait is false, or
+//             waiting for room fails other than by being
+//             interrupted by a signal.
+//--------------------------------------------------------
+int polyfit_service_submit( polyfit_service_t *pService, polyfit_job_t *pJob, bool wait )
+{
+    if( (NULL == pService) || (NULL == pJob) )
+    {
+        return -1;
+    }
+
+    int waited = 0;
+    if( wait )
+    {
+        do
+        {
+            waited = sem_wait( &pService->freeSlots );
+        } while( (0 != waited) && (EINTR == errno) );   // Interrupted by a signal; keep waiting.
+    }
+    else
+    {
+        waited = sem_trywait( &pService->freeSlots );
+    }
+    if( 0 != waited )
+    {
+        __atomic_fetch_add( &pService->rejected, 1, __ATOMIC_RELAXED );
+        return -6;
+    }
+
+    pJob->status = 0;
+    pJob->done = 0;
+    pJob->submitNs = clockNs();
+    __atomic_fetch_add( &pService->submitted, 1, __ATOMIC_SEQ_CST );
+
+    // Holding a free slot, the job's cell can only still be in use for a
+    // moment, by a worker that has claimed it but not yet let it go.
+    while( !enqueueJob( pService, pJob ))
+    {
+        sched_yield();
+    }
+
+    int depth = (int) (__atomic_load_n( &pService->enqueuePosition, __ATOMIC_RELAXED ) -
+                       __atomic_load_n( &pService->dequeuePosition, __ATOMIC_RELAXED ));
+    int deepest = __atomic_load_n( &pService->maxQueueDepth, __ATOMIC_RELAXED );
+    while( (depth > deepest) &&
+           !__atomic_compare_exchange_n( &pService->maxQueueDepth, &deepest, depth, true, __ATOMIC_RELAXED,
+                                         __ATOMIC_RELAXED ))
+    {
+        // deepest now holds the latest value; try again.
+    }
+
+    sem_post( &pService->queuedJobs );
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_job_done()
+// Returns true once a submitted job is done, after which
+// its status and results may be read, and it may be
+// reused or released.
+//--------------------------------------------------------
+bool polyfit_job_done( polyfit_job_t *pJob )
+{
+    return (NULL != pJob) && (0 != __atomic_load_n( &pJob->done, __ATOMIC_SEQ_CST ));
+}
+
+//--------------------------------------------------------
+// polyfit_service_wait()
+// Sleeps until a submitted job is done.
+//
+// Returns the job's status, or -1 if passed a NULL
+// pointer.
+//--------------------------------------------------------
+int polyfit_service_wait( polyfit_service_t *pService, polyfit_job_t *pJob )
+{
+    if( (NULL == pService) || (NULL == pJob) )
+    {
+        return -1;
+    }
+
+    if( !polyfit_job_done( pJob ))
+    {
+        __atomic_fetch_add( &pService->waiterCount, 1, __ATOMIC_SEQ_CST );
+        pthread_mutex_lock( &pService->doneMutex );
+        while( !polyfit_job_done( pJob ))
+        {
+            pthread_cond_wait( &pService->doneCondition, &pService->doneMutex );
+        }
+        pthread_mutex_unlock( &pService->doneMutex );
+        __atomic_fetch_sub( &pService->waiterCount, 1, __ATOMIC_SEQ_CST );
+    }
+    return pJob->status;
+}
+
+//--------------------------------------------------------
+// polyfit_service_metrics()
+// Fills *pMetrics with a service's job counts, queue
+// depths and latencies, from submission until done, since
+// it was created. The counters are read one at a time
+// while the service runs, so they may be a job or two
+// apart. Latencies are 0 until a job has completed.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer.
+//--------------------------------------------------------
+int polyfit_service_metrics( polyfit_service_t *pService, polyfit_service_metrics_t *pMetrics )
+{
+    long long counts[ SERVICE_LATENCY_BUCKETS ];
+    long long total = 0;
+
+    if( (NULL == pService) || (NULL == pMetrics) )
+    {
+        return -1;
+    }
+
+    for( int b = 0; b < SERVICE_LATENCY_BUCKETS; b++ )
+    {
+        counts[b] = __atomic_load_n( &pService->latencyCounts[b], __ATOMIC_RELAXED );
+        total += counts[b];
+    }
+
+    pMetrics->submitted = __atomic_load_n( &pService->submitted, __ATOMIC_RELAXED );
+    pMetrics->completed = __atomic_load_n( &pService->completed, __ATOMIC_RELAXED );
+    pMetrics->rejected = __atomic_load_n( &pService->rejected, __ATOMIC_RELAXED );
+    pMetrics->queueDepth = (int) (__atomic_load_n( &pService->enqueuePosition, __ATOMIC_RELAXED ) -
+                                  __atomic_load_n( &pService->dequeuePosition, __ATOMIC_RELAXED ));
+    pMetrics->maxQueueDepth = __atomic_load_n( &pService->maxQueueDepth, __ATOMIC_RELAXED );
+    pMetrics->meanLatencyNs = (total > 0) ? (double) __atomic_load_n( &pService->latencyTotalNs, __ATOMIC_RELAXED ) /
+                                            (double) total : 0.0;
+    pMetrics->p50LatencyNs = percentileNs( counts, total, 0.50 );
+    pMetrics->p99LatencyNs = percentileNs( counts, total, 0.99 );
+    pMetrics->maxLatencyNs = (double) __atomic_load_n( &pService->maxLatencyNs, __ATOMIC_RELAXED );
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_service_destroy()
+// Waits for the queued jobs to be done, stops the worker
+// threads and releases the service. No job may be
+// submitted once this has been called.
+//--------------------------------------------------------
+void polyfit_service_destroy( polyfit_service_t *pService )
+{
+    if( NULL == pService )
+    {
+        return;
+    }
+
+    __atomic_fetch_add( &pService->waiterCount, 1, __ATOMIC_SEQ_CST );
+    pthread_mutex_lock( &pService->doneMutex );
+    while( __atomic_load_n( &pService->completed, __ATOMIC_SEQ_CST ) <
+           __atomic_load_n( &pService->submitted, __ATOMIC_SEQ_CST ))
+    {
+        pthread_cond_wait( &pService->doneCondition, &pService->doneMutex );
+    }
+    pthread_mutex_unlock( &pService->doneMutex );
+    __atomic_fetch_sub( &pService->waiterCount, 1, __ATOMIC_SEQ_CST );
+
+    // The queue is empty, so each worker's next wake up is one of these.
+    __atomic_store_n( &pService->stopping, 1, __ATOMIC_RELEASE );
+    for( int t = 0; t < pService->threadCount; t++ )
+    {
+        sem_post( &pService->queuedJobs );
+    }
+    for( int t = 0; t < pService->threadCount; t++ )
+    {
+        pthread_join( pService->pThreads[t], NULL );
+    }
+
+    releaseService( pService );
+}
+
+
+//=========================================================
+//      Private function definitions
+//=========================================================
+
+//--------------------------------------------------------
+// serveJobs()
+// Worker thread body: fits queued jobs until the service
+// stops.
+//--------------------------------------------------------
+static void *serveJobs( void *pArg )
+{
+    serviceWorker_t *pWorker = (serviceWorker_t *) pArg;
+    polyfit_service_t *pService = pWorker->pService;
+
+    for( ;; )
+    {
+        int waited = 0;
+        do
+        {
+            waited = sem_wait( &pService->queuedJobs );
+        } while( (0 != waited) && (EINTR == errno) );   // Interrupted by a signal; keep waiting.
+        if( (0 != waited) || (0 != __atomic_load_n( &pService->stopping, __ATOMIC_ACQUIRE )))
+        {
+            break;
+        }
+
+        // A job has been counted, but its submitter may not quite have
+        // finished publishing it, or an earlier one.
+        polyfit_job_t *pJob = NULL;
+        while( !dequeueJob( pService, &pJob ))
+        {
+            sched_yield();
+        }
+        sem_post( &pService->freeSlots );
+
+        pJob->status = polyfit_ws( &pWorker->workspace, pJob->pointCount, pJob->xValues, pJob->yValues,
+                                   pJob->coefficientCount, pJob->coefficientResults );
+        finishJob( pService, pJob );
+    }
+    return NULL;
+}
+
+//--------------------------------------------------------
+// finishJob()
+// Records a fitted job's latency, calls its callback,
+// marks it done and wakes any waiting threads. The job
+// belongs to its owner again once it is marked done, so
+// it isn't touched after that.
+//--------------------------------------------------------
+static void finishJob( polyfit_service_t *pService, polyfit_job_t *pJob )
+{
+    double latencyNs = clockNs() - pJob->submitNs;
+    long long wholeNs = (latencyNs > 0.0) ? (long long) latencyNs : 0;
+
+    int bucket = (wholeNs > 0) ? (int) (SERVICE_BUCKETS_PER_OCTAVE * log2( (double) wholeNs )) : 0;
+    if( bucket >= SERVICE_LATENCY_BUCKETS )
+    {
+        bucket = SERVICE_LATENCY_BUCKETS - 1;
+    }
+    __atomic_fetch_add( &pService->latencyCounts[ bucket ], 1, __ATOMIC_RELAXED );
+    __atomic_fetch_add( &pService->latencyTotalNs, wholeNs, __ATOMIC_RELAXED );
+    long long longest = __atomic_load_n( &pService->maxLatencyNs, __ATOMIC_RELAXED );
+    while( (wholeNs > longest) &&
+           !__atomic_compare_exchange_n( &pService->maxLatencyNs, &longest, wholeNs, true, __ATOMIC_RELAXED,
+                                         __ATOMIC_RELAXED ))
+    {
+        // longest now holds the latest value; try again.
+    }
+
+    if( NULL != pJob->callback )
+    {
+        pJob->callback( pJob, pJob->pUserData );
+    }
+
+    __atomic_fetch_add( &pService->completed, 1, __ATOMIC_SEQ_CST );
+    __atomic_store_n( &pJob->done, 1, __ATOMIC_SEQ_CST );
+    if( 0 != __atomic_load_n( &pService->waiterCount, __ATOMIC_SEQ_CST ))
+    {
+        pthread_mutex_lock( &pService->doneMutex );
+        pthread_cond_broadcast( &pService->doneCondition );
+        pthread_mutex_unlock( &pService->doneMutex );
+    }
+}
+
+//--------------------------------------------------------
+// enqueueJob()
+// Puts a job in the next free cell of the queue.
+// Returns true if success, false if the cell is still in
+// use.
+//--------------------------------------------------------
+static bool enqueueJob( polyfit_service_t *pService, polyfit_job_t *pJob )
+{
+    size_t position = __atomic_load_n( &pService->enqueuePosition, __ATOMIC_RELAXED );
+
+    for( ;; )
+    {
+        serviceCell_t *pCell = &(pService->pCells[ position & pService->mask ]);
+        size_t sequence = __atomic_load_n( &pCell->sequence, __ATOMIC_ACQUIRE );
+        if( sequence == position )
+        {
+            if( __atomic_compare_exchange_n( &pService->enqueuePosition, &position, position + 1, true,
+                                             __ATOMIC_RELAXED, __ATOMIC_RELAXED ))
+            {
+                pCell->pJob = pJob;
+                __atomic_store_n( &pCell->sequence, position + 1, __ATOMIC_RELEASE );
+                return true;
+            }
+            // Another thread took the position, and position now holds the next.
+        }
+        else if( sequence < position )
+        {
+            return false;
+        }
+        else
+        {
+            position = __atomic_load_n( &pService->enqueuePosition, __ATOMIC_RELAXED );
+        }
+    }
+}
+
+//--------------------------------------------------------
+// dequeueJob()
+// Takes the job from the next full cell of the queue into
+// *ppJob.
+// Returns true if success, false if that cell is not yet
+// full.
+//--------------------------------------------------------
+static bool dequeueJob( polyfit_service_t *pService, polyfit_job_t **ppJob )
+{
+    size_t position = __atomic_load_n( &pService->dequeuePosition, __ATOMIC_RELAXED );
+
+    for( ;; )
+    {
+        serviceCell_t *pCell = &(pService->pCells[ position & pService->mask ]);
+        size_t sequence = __atomic_load_n( &pCell->sequence, __ATOMIC_ACQUIRE );
+        if( sequence == position + 1 )
+        {
+            if( __atomic_compare_exchange_n( &pService->dequeuePosition, &position, position + 1, true,
+                                             __ATOMIC_RELAXED, __ATOMIC_RELAXED ))
+            {
+                *ppJob = pCell->pJob;
+                // Free the cell for the job submitted one lap later.
+                __atomic_store_n( &pCell->sequence, position + pService->mask + 1, __ATOMIC_RELEASE );
+                return true;
+            }
+        }
+        else if( sequence < position + 1 )
+        {
+            return false;
+        }
+        else
+        {
+            position = __atomic_load_n( &pService->dequeuePosition, __ATOMIC_RELAXED );
+        }
+    }
+}
+
+//--------------------------------------------------------
+// releaseService()
+// Frees a service whose threads have stopped, or never
+// started.
+//--------------------------------------------------------
+static void releaseService( polyfit_service_t *pService )
+{
+    if( pService->syncCount > 3 )
+    {
+        pthread_cond_destroy( &pService->doneCondition );
+    }
+    if( pService->syncCount > 2 )
+    {
+        pthread_mutex_destroy( &pService->doneMutex );
+    }
+    if( pService->syncCount > 1 )
+    {
+        sem_destroy( &pService->queuedJobs );
+    }
+    if( pService->syncCount > 0 )
+    {
+        sem_destroy( &pService->freeSlots );
+    }
+    polyfitFree( pService->pCells );
+    polyfitFree( pService->pThreads );
+    polyfitFree( pService->pWorkers );
+    polyfitFree( pService->pWorkspaceMemory );
+    polyfitFree( pService );
+}
+
+//--------------------------------------------------------
+// percentileNs()
+// Returns the latency below which the given fraction of
+// the counted jobs fell, as the middle of its bucket, or
+// 0 if none have been counted.
+//--------------------------------------------------------
+static double percentileNs( long long *pCounts, long long total, double fraction )
+{
+    long long seen = 0;
+
+    for( int b = 0; (total > 0) && (b < SERVICE_LATENCY_BUCKETS); b++ )
+    {
+        seen += pCounts[b];
+        if( (double) seen >= fraction * (double) total )
+        {
+            return exp2( (b + 0.5) / SERVICE_BUCKETS_PER_OCTAVE );
+        }
+    }
+    return 0.0;
+}
+
+//--------------------------------------------------------
+// clockNs()
+// Returns a monotonic clock reading in nanoseconds.
+//--------------------------------------------------------
+static double clockNs( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ((double) now.tv_sec * 1e9) + (double) now.tv_nsec;
+}
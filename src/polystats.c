@@ -0,0 +1,284 @@
+// Name: polystats.c
+// Description: Opt-in timing, counters and condition estimates of fits.
+// Author: Henry M. Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+#define _POSIX_C_SOURCE 200809L     // clock_gettime()
+
+#include <math.h>       // HUGE_VAL
+#include <time.h>       // clock_gettime()
+
+#include "polyfit_internal.h"
+
+// The largest fit whose condition is estimated; its factor is kept on
+// the stack.
+#define STATS_MAX_COEFFICIENTS  (32)
+
+int polyfitStatsFlag = 0;
+
+// The totals are only ever updated by atomic adds, so fits on any number
+// of threads can be measured at once.
+static polyfit_stats_t totals;
+static polyfit_stats_hook_t pHook = NULL;
+static void *pHookUserData = NULL;
+
+
+//------------------------------------------------
+// Private Function Prototypes
+//------------------------------------------------
+
+static double   clockNs( void );
+static void     addCount( unsigned long long *pCount, unsigned long long amount );
+
+
+//=========================================================
+//      Global function definitions
+//=========================================================
+
+
+//--------------------------------------------------------
+// polyfit_stats_enable()
+// Turns the measurement of fits on or off. While it is
+// on, each call of polyfit(), polyfit_with_solver(),
+// polyfit_ws() and the fixed degree fits has its phases
+// timed, its result counted and the condition of its
+// normal matrix estimated, and every heap allocation the
+// library makes is counted. While it is off, each fit
+// only tests a flag.
+//--------------------------------------------------------
+void polyfit_stats_enable( bool enable )
+{
+    __atomic_store_n( &polyfitStatsFlag, enable ? 1 : 0, __ATOMIC_RELAXED );
+}
+
+//--------------------------------------------------------
+// polyfit_stats_get()
+// Copies the running totals into *pStats. With fits
+// running on other threads, each total is read
+// atomically, but not all of them at one instant.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer.
+//--------------------------------------------------------
+int polyfit_stats_get( polyfit_stats_t *pStats )
+{
+    if( NULL == pStats )
+    {
+        return -1;
+    }
+
+    pStats->calls = __atomic_load_n( &totals.calls, __ATOMIC_RELAXED );
+    for( int e = 0; e < 6; e++ )
+    {
+        pStats->failures[e] = __atomic_load_n( &totals.failures[e], __ATOMIC_RELAXED );
+    }
+    pStats->allocations = __atomic_load_n( &totals.allocations, __ATOMIC_RELAXED );
+    pStats->bytesAllocated = __atomic_load_n( &totals.bytesAllocated, __ATOMIC_RELAXED );
+    pStats->buildNs = __atomic_load_n( &totals.buildNs, __ATOMIC_RELAXED );
+    pStats->accumulateNs = __atomic_load_n( &totals.accumulateNs, __ATOMIC_RELAXED );
+    pStats->solveNs = __atomic_load_n( &totals.solveNs, __ATOMIC_RELAXED );
+    __atomic_load( &totals.worstConditionEstimate, &pStats->worstConditionEstimate, __ATOMIC_RELAXED );
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_stats_reset()
+// Clears the running totals. Call it while no fits are
+// running, or some of their counts may be kept.
+//--------------------------------------------------------
+void polyfit_stats_reset( void )
+{
+    double zero = 0.0;
+
+    __atomic_store_n( &totals.calls, 0, __ATOMIC_RELAXED );
+    for( int e = 0; e < 6; e++ )
+    {
+        __atomic_store_n( &totals.failures[e], 0, __ATOMIC_RELAXED );
+    }
+    __atomic_store_n( &totals.allocations, 0, __ATOMIC_RELAXED );
+    __atomic_store_n( &totals.bytesAllocated, 0, __ATOMIC_RELAXED );
+    __atomic_store_n( &totals.buildNs, 0, __ATOMIC_RELAXED );
+    __atomic_store_n( &totals.accumulateNs, 0, __ATOMIC_RELAXED );
+    __atomic_store_n( &totals.solveNs, 0, __ATOMIC_RELAXED );
+    __atomic_store( &totals.worstConditionEstimate, &zero, __ATOMIC_RELAXED );
+}
+
+//--------------------------------------------------------
+// polyfit_stats_set_hook()
+// Sets a function to be called with the measurements of
+// each fit, after the totals are updated, on the thread
+// that ran the fit. pUserData is passed along to it. A
+// NULL hook removes it. As with polyfit_set_allocator(),
+// call it while no fits are running.
+//--------------------------------------------------------
+void polyfit_stats_set_hook( polyfit_stats_hook_t hook, void *pUserData )
+{
+    pHookUserData = pUserData;
+    pHook = hook;
+}
+
+//=========================================================
+//      Internal function definitions
+//=========================================================
+
+//--------------------------------------------------------
+// polyfitStatsBegin()
+// Clears the measurements of a fit and starts its clock.
+//--------------------------------------------------------
+void polyfitStatsBegin( polyfitCall_t *pCall, int pointCount, int coefficientCount )
+{
+    pCall->stats.status = 0;
+    pCall->stats.pointCount = pointCount;
+    pCall->stats.coefficientCount = coefficientCount;
+    pCall->stats.solver = POLYFIT_SOLVER_DEFAULT;
+    pCall->stats.buildNs = 0.0;
+    pCall->stats.accumulateNs = 0.0;
+    pCall->stats.solveNs = 0.0;
+    pCall->stats.conditionEstimate = 0.0;
+    pCall->markNs = clockNs();
+}
+
+//--------------------------------------------------------
+// polyfitStatsPhase()
+// Adds the time since the last phase ended to *pPhaseNs,
+// and starts the next phase.
+//--------------------------------------------------------
+void polyfitStatsPhase( polyfitCall_t *pCall, double *pPhaseNs )
+{
+    double now = clockNs();
+    *pPhaseNs += now - pCall->markNs;
+    pCall->markNs = now;
+}
+
+//--------------------------------------------------------
+// polyfitStatsEnd()
+// Adds a measured fit to the totals, then passes it to
+// the hook. Time since the last phase ended, which is
+// spent estimating the condition, belongs to no phase.
+//--------------------------------------------------------
+void polyfitStatsEnd( polyfitCall_t *pCall, int status )
+{
+    polyfit_call_stats_t *pStats = &(pCall->stats);
+
+    pStats->status = status;
+    addCount( &totals.calls, 1 );
+    if( (status < 0) && (status > -6) )
+    {
+        addCount( &totals.failures[ -status ], 1 );
+    }
+    addCount( &totals.buildNs, (unsigned long long) pStats->buildNs );
+    addCount( &totals.accumulateNs, (unsigned long long) pStats->accumulateNs );
+    addCount( &totals.solveNs, (unsigned long long) pStats->solveNs );
+
+    double worst = 0.0;
+    __atomic_load( &totals.worstConditionEstimate, &worst, __ATOMIC_RELAXED );
+    while( (pStats->conditionEstimate > worst) &&
+           !__atomic_compare_exchange( &totals.worstConditionEstimate, &worst, &pStats->conditionEstimate, false,
+                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+    {
+        // worst now holds the other thread's estimate; try again if ours is still larger.
+    }
+
+    polyfit_stats_hook_t hook = pHook;
+    if( NULL != hook )
+    {
+        hook( pStats, pHookUserData );
+    }
+}
+
+//--------------------------------------------------------
+// polyfitStatsAllocation()
+// Counts a heap allocation of byteCount bytes.
+//--------------------------------------------------------
+void polyfitStatsAllocation( size_t byteCount )
+{
+    addCount( &totals.allocations, 1 );
+    addCount( &totals.bytesAllocated, byteCount );
+}
+
+//--------------------------------------------------------
+// polyfitStatsCondition()
+// Estimates the condition number of the normal matrix
+// held in power sums, highest power first. The squared
+// ratio of the largest to the smallest diagonal of the
+// Cholesky factor is a lower bound on the condition
+// number, and in practice tracks it to within a modest
+// factor. It costs one factorization, about k^3/6 flops,
+// and no pass over the points.
+//
+// Returns the estimate, HUGE_VAL if the matrix can't be
+// factored, or 0 if there are more than
+// STATS_MAX_COEFFICIENTS coefficients.
+//--------------------------------------------------------
+double polyfitStatsCondition( int coefficientCount, double *pPowerSums )
+{
+    double factor[ (STATS_MAX_COEFFICIENTS * (STATS_MAX_COEFFICIENTS + 1)) / 2 ];
+
+    if( (coefficientCount < 1) || (coefficientCount > STATS_MAX_COEFFICIENTS) )
+    {
+        return 0.0;
+    }
+    if( 0 != polyfitCholeskyFactor( coefficientCount, pPowerSums, factor ) )
+    {
+        return HUGE_VAL;
+    }
+
+    // The diagonal of row r of the packed factor is its last entry.
+    double largest = 0.0;
+    double smallest = HUGE_VAL;
+    for( int r = 0; r < coefficientCount; r++ )
+    {
+        double diagonal = fabs( factor[ ((r * (r + 1)) / 2) + r ] );
+        largest = (diagonal > largest) ? diagonal : largest;
+        smallest = (diagonal < smallest) ? diagonal : smallest;
+    }
+    return (largest / smallest) * (largest / smallest);
+}
+
+//=========================================================
+//      Private function definitions
+//=========================================================
+
+//--------------------------------------------------------
+// clockNs()
+// Returns a monotonic clock reading in nanoseconds.
+//--------------------------------------------------------
+static double clockNs( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ((double) now.tv_sec * 1e9) + (double) now.tv_nsec;
+}
+
+//--------------------------------------------------------
+// addCount()
+// Atomically adds amount to a total.
+//--------------------------------------------------------
+static void addCount( unsigned long long *pCount, unsigned long long amount )
+{
+    __atomic_fetch_add( pCount, amount, __ATOMIC_RELAXED );
+}
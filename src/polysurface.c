@@ -0,0 +1,821 @@
+// Name: polysurface.c
+// Description: Least squares fitting of polynomials in several variables, with sparse term sets.
+// Author: Henry M. Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+#include <limits.h>     // INT_MAX
+#include <math.h>       // frexp(), ldexp(), fmin(), fmax()
+#include <string.h>     // memcpy(), memset()
+
+#include "polyfit_internal.h"
+
+// The points are taken this many at a time. Each block's terms are laid
+// out term by term, so every entry of the normal matrix the block adds to
+// is one dot product of two contiguous rows, done by the vector kernel.
+#define SURFACE_BLOCK_POINTS    (64)
+
+// polyfit_surface_eval() builds terms in a block of this many doubles on
+// the stack, taking fewer than SURFACE_BLOCK_POINTS points at a time when
+// there are more than 32 terms. A surface of more terms than this is
+// evaluated a term at a time, with no block at all.
+#define SURFACE_EVAL_DOUBLES    (2048)
+
+// Each step of building a point's terms is three ints: the term, the
+// earlier term it is a multiple of (or -1 if none is), and the variable
+// it is multiplied by.
+#define SURFACE_STEP_INTS       (3)
+
+
+//------------------------------------------------
+// Private Function Prototypes
+//------------------------------------------------
+
+static int      checkArguments( int pointCount, int dimensionCount, double *inputValues, double *zValues,
+                                int termCount, int *pExponents );
+static int      fitCentred( polyfit_workspace_t *pWorkspace, int pointCount, int dimensionCount,
+                            double *inputValues, double *zValues, int termCount, int *pExponents,
+                            double *pOffsets, double *pScales, double *pCentred );
+static void     chooseCentres( int pointCount, int dimensionCount, double *inputValues, int termCount,
+                               int *pExponents, double *pOffsets, double *pScales );
+static bool     loweringClosed( int dimensionCount, int termCount, int *pExponents, int dimension );
+static void     uncentre( int dimensionCount, int termCount, int *pExponents, int *pSteps, double *pOffsets,
+                          double *pScales, double *pCoefficients );
+static size_t   surfaceWorkDoubles( int termCount );
+static int *    surfaceSteps( double *pWork, int termCount );
+static void     listTerms( int dimensionCount, int dimension, int remaining, int *pCurrent, int *pExponents,
+                           int maxTerms, int *pTermCount );
+static void     planSteps( int dimensionCount, int termCount, int *pExponents, int *pSteps );
+static void     buildTerms( int dimensionCount, int termCount, int *pExponents, int *pSteps, double *pInputs,
+                            double *pTerms, size_t termStride );
+static void     centrePoint( int dimensionCount, double *pOffsets, double *pScales, double *pPoint,
+                             double *pInputs );
+static double   evaluateTerms( int dimensionCount, int termCount, int *pExponents, double *pCoefficients,
+                               double *pInputs );
+
+
+//=========================================================
+//      Global function definitions
+//=========================================================
+
+
+//--------------------------------------------------------
+// polyfit_surface_terms()
+// Writes the exponents of every term of total degree up
+// to totalDegree in dimensionCount variables into
+// pExponents, dimensionCount to a row, in order of total
+// degree, and within each degree with the higher powers
+// of the earlier variables first: for two variables and
+// degree 2, 1, x, y, x^2, xy, y^2. There are
+// (totalDegree + dimensionCount)! /
+// (totalDegree! * dimensionCount!) of them.
+// *pTermCount receives that number whether or not they
+// fit, so the size can be found with a maxTerms of 0.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -5 if dimensionCount is not 1 to
+//             POLYFIT_SURFACE_MAX_DIMENSIONS, totalDegree
+//             < 0, or there are more than maxTerms terms.
+//--------------------------------------------------------
+int polyfit_surface_terms( int dimensionCount, int totalDegree, int maxTerms, int *pExponents, int *pTermCount )
+{
+    int current[ POLYFIT_SURFACE_MAX_DIMENSIONS ];
+
+    if( (NULL == pTermCount) || ((NULL == pExponents) && (maxTerms > 0)) )
+    {
+        return -1;
+    }
+    if( (dimensionCount < 1) || (dimensionCount > POLYFIT_SURFACE_MAX_DIMENSIONS) || (totalDegree < 0) )
+    {
+        return -5;
+    }
+
+    *pTermCount = 0;
+    for( int degree = 0; degree <= totalDegree; degree++ )
+    {
+        listTerms( dimensionCount, 0, degree, current, pExponents, maxTerms, pTermCount );
+    }
+    return (*pTermCount > maxTerms) ? -5 : 0;
+}
+
+//--------------------------------------------------------
+// polyfit_surface_workspace_size()
+// Returns the bytes of working storage
+// polyfit_surface_fit_ws() needs for fits of up to
+// maxTerms terms, in any number of variables and with
+// any number of points, or 0 if maxTerms < 1. It is
+// never less than polyfit_workspace_size( INT_MAX,
+// maxTerms ), so polyfit_workspace_init() accepts it.
+//--------------------------------------------------------
+size_t polyfit_surface_workspace_size( int maxTerms )
+{
+    if( maxTerms < 1 )
+    {
+        return 0;
+    }
+
+    size_t surfaceSize = surfaceWorkDoubles( maxTerms ) * sizeof( double );
+    size_t polyfitSize = polyfit_workspace_size( INT_MAX, maxTerms );
+    return (surfaceSize > polyfitSize) ? surfaceSize : polyfitSize;
+}
+
+//--------------------------------------------------------
+// polyfit_surface_fit()
+// Fits z = f(x0, x1, ...) by least squares, where f is a
+// polynomial in dimensionCount variables with termCount
+// terms, whose exponents are the rows of pExponents: a
+// full set from polyfit_surface_terms(), or any sparse
+// set of the caller's. Point i's inputs are
+// inputValues[ i * dimensionCount ] onwards, and its z is
+// zValues[i]. The fit, with a copy of the exponents, goes
+// to pSurface; release it with polyfit_surface_free().
+//
+// The fit itself is that of polyfit_surface_fit_ws(), in
+// a workspace of polyfit_surface_workspace_size() bytes
+// that is freed on return. The surface keeps the
+// coefficients in the centred variables as well, for
+// polyfit_surface_eval(). Its own arrays take two more
+// allocations, however many points there are.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < termCount),
+//          -3 if unable to allocate memory,
+//          -4 if unable to solve equations,
+//          -5 if dimensionCount is not 1 to
+//             POLYFIT_SURFACE_MAX_DIMENSIONS, termCount
+//             < 1, or an exponent is negative.
+//--------------------------------------------------------
+int polyfit_surface_fit( polyfit_surface_t *pSurface, int pointCount, int dimensionCount, double *inputValues,
+                         double *zValues, int termCount, int *pExponents )
+{
+    int rVal = 0;
+    polyfit_workspace_t workspace;
+
+    if( NULL == pSurface )
+    {
+        return -1;
+    }
+    pSurface->dimensionCount = 0;
+    pSurface->termCount = 0;
+    pSurface->pExponents = NULL;
+    pSurface->pCoefficients = NULL;
+    pSurface->pSteps = NULL;
+    pSurface->pCentred = NULL;
+
+    rVal = checkArguments( pointCount, dimensionCount, inputValues, zValues, termCount, pExponents );
+    if( 0 != rVal )
+    {
+        return rVal;
+    }
+
+    // Exponents then steps; coefficients then centred ones.
+    size_t workspaceSize = polyfit_surface_workspace_size( termCount );
+    int *pInts = (int *) polyfitCalloc( (size_t) termCount * (dimensionCount + SURFACE_STEP_INTS), sizeof( int ));
+    double *pDoubles = (double *) polyfitCalloc( (size_t) termCount * 2, sizeof( double ));
+    void *pMemory = polyfitCalloc( 1, workspaceSize );
+    if( (NULL == pInts) || (NULL == pDoubles) || (NULL == pMemory) )
+    {
+        polyfitFree( pInts );
+        polyfitFree( pDoubles );
+        polyfitFree( pMemory );
+        return -3;
+    }
+
+    double *pCentred = &(pDoubles[ termCount ]);
+    rVal = polyfit_workspace_init( &workspace, pMemory, workspaceSize, INT_MAX, termCount );
+    if( 0 == rVal )
+    {
+        rVal = fitCentred( &workspace, pointCount, dimensionCount, inputValues, zValues, termCount, pExponents,
+                           pSurface->offsets, pSurface->scales, pCentred );
+    }
+    if( 0 == rVal )
+    {
+        int *pSteps = surfaceSteps( workspace.pMemory, termCount );
+        memcpy( pDoubles, pCentred, (size_t) termCount * sizeof( double ));
+        uncentre( dimensionCount, termCount, pExponents, pSteps, pSurface->offsets, pSurface->scales, pDoubles );
+        memcpy( pInts, pExponents, (size_t) termCount * dimensionCount * sizeof( int ));
+        memcpy( &(pInts[ termCount * dimensionCount ]), pSteps, (size_t) termCount * SURFACE_STEP_INTS * sizeof( int ));
+    }
+    polyfitFree( pMemory );
+    if( 0 != rVal )
+    {
+        polyfitFree( pInts );
+        polyfitFree( pDoubles );
+        return rVal;
+    }
+
+    pSurface->dimensionCount = dimensionCount;
+    pSurface->termCount = termCount;
+    pSurface->pExponents = pInts;
+    pSurface->pSteps = &(pInts[ termCount * dimensionCount ]);
+    pSurface->pCoefficients = pDoubles;
+    pSurface->pCentred = pCentred;
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_surface_fit_ws()
+// Same as polyfit_surface_fit(), but keeps all of its
+// working storage in a workspace, and stores the
+// coefficients, in the order of the terms, in
+// coefficientResults, so it makes no heap calls at all.
+// The workspace is set up by polyfit_workspace_init(),
+// with maxCoefficients of at least termCount, in memory
+// of polyfit_surface_workspace_size() bytes; its
+// maxPoints and solver are not used.
+//
+// Each point's terms are built by one multiplication
+// each, from an earlier term one power lower, where the
+// set has one, rather than with pow(). The points are
+// taken SURFACE_BLOCK_POINTS at a time, and each block's
+// share of the normal matrix is added by the vector dot
+// product kernel, one contiguous row of terms against the
+// rest. The packed normal matrix is then solved in place
+// by the same Cholesky factorization polyfit() uses.
+//
+// Each variable is first centred on its mid-range, where
+// that leaves the terms spanning the same polynomials,
+// and scaled by a power of 2 that brings it within
+// -1 .. 1. This keeps the normal matrix well conditioned
+// for data far from the origin, or whose variables'
+// ranges differ; the coefficients are then expanded back
+// into powers of x.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < termCount),
+//          -4 if unable to solve equations,
+//          -5 if dimensionCount is not 1 to
+//             POLYFIT_SURFACE_MAX_DIMENSIONS, termCount
+//             < 1, an exponent is negative, or the
+//             workspace is too small.
+//--------------------------------------------------------
+int polyfit_surface_fit_ws( polyfit_workspace_t *pWorkspace, int pointCount, int dimensionCount,
+                            double *inputValues, double *zValues, int termCount, int *pExponents,
+                            double *coefficientResults )
+{
+    int rVal = 0;
+    double offsets[ POLYFIT_SURFACE_MAX_DIMENSIONS ];
+    double scales[ POLYFIT_SURFACE_MAX_DIMENSIONS ];
+
+    if( NULL == coefficientResults )
+    {
+        return -1;
+    }
+
+    rVal = fitCentred( pWorkspace, pointCount, dimensionCount, inputValues, zValues, termCount, pExponents,
+                       offsets, scales, coefficientResults );
+    if( 0 == rVal )
+    {
+        uncentre( dimensionCount, termCount, pExponents, surfaceSteps( pWorkspace->pMemory, termCount ), offsets,
+                  scales, coefficientResults );
+    }
+    return rVal;
+}
+
+//--------------------------------------------------------
+// polyfit_surface_eval()
+// Evaluates a surface from polyfit_surface_fit() at each
+// of pointCount points, laid out as for the fit, storing
+// the results in zValues. The points are taken up to
+// SURFACE_BLOCK_POINTS at a time, as many as a block of
+// SURFACE_EVAL_DOUBLES on the stack holds the terms of:
+// each one's terms are built as in the fit, in the
+// centred variables, and each term's coefficient is then
+// added in across the block, a loop the compiler
+// vectorizes. A surface of more terms than the block
+// holds is evaluated a term at a time at each point. It
+// makes no heap calls and only reads the surface, so any
+// number of threads may evaluate one at once.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -5 if pointCount < 0.
+//--------------------------------------------------------
+int polyfit_surface_eval( polyfit_surface_t *pSurface, int pointCount, double *inputValues, double *zValues )
+{
+    if( (NULL == pSurface) || (NULL == pSurface->pCentred) || (NULL == inputValues) || (NULL == zValues) )
+    {
+        return -1;
+    }
+    if( pointCount < 0 )
+    {
+        return -5;
+    }
+
+    int dimensionCount = pSurface->dimensionCount;
+    int termCount = pSurface->termCount;
+    double terms[ SURFACE_EVAL_DOUBLES ];
+    double inputs[ POLYFIT_SURFACE_MAX_DIMENSIONS ];
+
+    if( termCount > SURFACE_EVAL_DOUBLES )
+    {
+        for( int i = 0; i < pointCount; i++ )
+        {
+            centrePoint( dimensionCount, pSurface->offsets, pSurface->scales,
+                         &(inputValues[ (size_t) i * dimensionCount ]), inputs );
+            zValues[i] = evaluateTerms( dimensionCount, termCount, pSurface->pExponents, pSurface->pCentred,
+                                        inputs );
+        }
+        return 0;
+    }
+
+    int blockPoints = SURFACE_EVAL_DOUBLES / termCount;
+    blockPoints = (blockPoints > SURFACE_BLOCK_POINTS) ? SURFACE_BLOCK_POINTS : blockPoints;
+    for( int first = 0; first < pointCount; first += blockPoints )
+    {
+        int count = (pointCount - first < blockPoints) ? pointCount - first : blockPoints;
+        double *pZ = &(zValues[ first ]);
+        for( int i = 0; i < count; i++ )
+        {
+            centrePoint( dimensionCount, pSurface->offsets, pSurface->scales,
+                         &(inputValues[ (size_t) (first + i) * dimensionCount ]), inputs );
+            buildTerms( dimensionCount, termCount, pSurface->pExponents, pSurface->pSteps, inputs, &(terms[i]),
+                        count );
+            pZ[i] = 0.0;
+        }
+        for( int t = 0; t < termCount; t++ )
+        {
+            double coefficient = pSurface->pCentred[t];
+            double *pRow = &(terms[ t * count ]);
+            for( int i = 0; i < count; i++ )
+            {
+                pZ[i] += coefficient * pRow[i];
+            }
+        }
+    }
+    return 0;
+}
+
+//--------------------------------------------------------
+// polyfit_surface_free()
+// Releases the terms and coefficients held by a surface.
+//--------------------------------------------------------
+void polyfit_surface_free( polyfit_surface_t *pSurface )
+{
+    if( NULL != pSurface )
+    {
+        polyfitFree( pSurface->pExponents );
+        polyfitFree( pSurface->pCoefficients );
+        pSurface->pExponents = NULL;
+        pSurface->pCoefficients = NULL;
+        pSurface->pSteps = NULL;
+        pSurface->pCentred = NULL;
+        pSurface->termCount = 0;
+    }
+}
+
+
+//=========================================================
+//      Private function definitions
+//=========================================================
+
+//--------------------------------------------------------
+// checkArguments()
+// Checks the arguments polyfit_surface_fit() and
+// polyfit_surface_fit_ws() share, returning their codes
+// for NULL pointers, bad counts and exponents, and too
+// few points, or 0 if they are fine.
+//--------------------------------------------------------
+static int checkArguments( int pointCount, int dimensionCount, double *inputValues, double *zValues,
+                           int termCount, int *pExponents )
+{
+    if( (NULL == inputValues) || (NULL == zValues) || (NULL == pExponents) )
+    {
+        return -1;
+    }
+    if( (dimensionCount < 1) || (dimensionCount > POLYFIT_SURFACE_MAX_DIMENSIONS) || (termCount < 1) )
+    {
+        return -5;
+    }
+    for( int e = 0; e < termCount * dimensionCount; e++ )
+    {
+        if( pExponents[e] < 0 )
+        {
+            return -5;
+        }
+    }
+    return (pointCount < termCount) ? -2 : 0;
+}
+
+//--------------------------------------------------------
+// fitCentred()
+// The fit of polyfit_surface_fit_ws(), up to the solve:
+// checks the arguments and workspace, plans the steps
+// into the workspace, chooses each variable's offset and
+// scale into pOffsets and pScales, and stores the
+// coefficients in the variables
+// u = (x - offset) * scale in pCentred.
+//
+// Returns   0 if success, or the codes of
+//          polyfit_surface_fit_ws().
+//--------------------------------------------------------
+static int fitCentred( polyfit_workspace_t *pWorkspace, int pointCount, int dimensionCount,
+                       double *inputValues, double *zValues, int termCount, int *pExponents,
+                       double *pOffsets, double *pScales, double *pCentred )
+{
+    int rVal = 0;
+    double inputs[ POLYFIT_SURFACE_MAX_DIMENSIONS ];
+
+    if( (NULL == pWorkspace) || (NULL == pWorkspace->pMemory) )
+    {
+        return -1;
+    }
+    rVal = checkArguments( pointCount, dimensionCount, inputValues, zValues, termCount, pExponents );
+    if( 0 != rVal )
+    {
+        return rVal;
+    }
+    if( (termCount > pWorkspace->maxCoefficients) ||
+        (pWorkspace->size < polyfit_surface_workspace_size( termCount )) )
+    {
+        return -5;
+    }
+
+    size_t matrixCount = ((size_t) termCount * (termCount + 1)) / 2;
+    double *pMatrix = pWorkspace->pMemory;                      // Lower triangle, packed, then its factor.
+    double *pRhs = &(pMatrix[ matrixCount ]);
+    double *pDots = &(pRhs[ termCount ]);
+    double *pBlockZ = &(pDots[ termCount ]);
+    double *pBlockTerms = &(pBlockZ[ SURFACE_BLOCK_POINTS ]);  // termCount rows of SURFACE_BLOCK_POINTS.
+    int *pSteps = surfaceSteps( pWorkspace->pMemory, termCount );
+
+    memset( pMatrix, 0, (matrixCount + termCount) * sizeof( double ));
+    planSteps( dimensionCount, termCount, pExponents, pSteps );
+    chooseCentres( pointCount, dimensionCount, inputValues, termCount, pExponents, pOffsets, pScales );
+
+    for( int first = 0; first < pointCount; first += SURFACE_BLOCK_POINTS )
+    {
+        int count = (pointCount - first < SURFACE_BLOCK_POINTS) ? pointCount - first : SURFACE_BLOCK_POINTS;
+        for( int i = 0; i < count; i++ )
+        {
+            centrePoint( dimensionCount, pOffsets, pScales, &(inputValues[ (size_t) (first + i) * dimensionCount ]),
+                         inputs );
+            buildTerms( dimensionCount, termCount, pExponents, pSteps, inputs, &(pBlockTerms[i]),
+                        SURFACE_BLOCK_POINTS );
+            pBlockZ[i] = zValues[ first + i ];
+        }
+
+        // Row r of the block against rows r .. termCount-1 gives column r
+        // of the lower triangle.
+        for( int r = 0; r < termCount; r++ )
+        {
+            double *pRow = &(pBlockTerms[ (size_t) r * SURFACE_BLOCK_POINTS ]);
+            polyfitKernelDots( count, pRow, pRow, termCount - r, SURFACE_BLOCK_POINTS, pDots );
+            for( int c = r; c < termCount; c++ )
+            {
+                pMatrix[ (((size_t) c * (c + 1)) / 2) + r ] += pDots[ c - r ];
+            }
+        }
+        polyfitKernelDots( count, pBlockZ, pBlockTerms, termCount, SURFACE_BLOCK_POINTS, pDots );
+        for( int t = 0; t < termCount; t++ )
+        {
+            pRhs[t] += pDots[t];
+        }
+    }
+
+    rVal = polyfitCholeskyFactorPacked( termCount, pMatrix );
+    if( 0 == rVal )
+    {
+        polyfitCholeskySolve( termCount, pMatrix, pRhs, pCentred );
+    }
+    return rVal;
+}
+
+//--------------------------------------------------------
+// chooseCentres()
+// Chooses each variable's offset, its mid-range over the
+// points, and scale, the power of 2 that then brings it
+// within -1 .. 1. A variable is only centred if the set
+// of terms is closed under lowering its power, for only
+// then do the terms in u span the same polynomials as
+// those in x; otherwise, as for a set with x^2 but not x,
+// its offset is 0.
+//--------------------------------------------------------
+static void chooseCentres( int pointCount, int dimensionCount, double *inputValues, int termCount,
+                           int *pExponents, double *pOffsets, double *pScales )
+{
+    for( int d = 0; d < dimensionCount; d++ )
+    {
+        double smallest = inputValues[d];
+        double largest = inputValues[d];
+        for( int i = 1; i < pointCount; i++ )
+        {
+            smallest = fmin( smallest, inputValues[ ((size_t) i * dimensionCount) + d ] );
+            largest = fmax( largest, inputValues[ ((size_t) i * dimensionCount) + d ] );
+        }
+
+        pOffsets[d] = 0.0;
+        if( isfinite( smallest ) && isfinite( largest ) && loweringClosed( dimensionCount, termCount, pExponents, d ) )
+        {
+            pOffsets[d] = (0.5 * smallest) + (0.5 * largest);
+        }
+
+        int scaleExponent = 0;
+        double reach = fmax( fabs( largest - pOffsets[d] ), fabs( smallest - pOffsets[d] ));
+        if( (reach > 0.0) && isfinite( reach ) )
+        {
+            (void) frexp( reach, &scaleExponent );
+        }
+        pScales[d] = ldexp( 1.0, -scaleExponent );
+    }
+}
+
+//--------------------------------------------------------
+// loweringClosed()
+// Returns true if, for every term with a power of the
+// variable dimension, the term one power of it lower is
+// in the set too.
+//--------------------------------------------------------
+static bool loweringClosed( int dimensionCount, int termCount, int *pExponents, int dimension )
+{
+    for( int t = 0; t < termCount; t++ )
+    {
+        int *pTerm = &(pExponents[ t * dimensionCount ]);
+        bool found = (0 == pTerm[ dimension ]);
+        for( int u = 0; !found && (u < termCount); u++ )
+        {
+            int *pLower = &(pExponents[ u * dimensionCount ]);
+            found = true;
+            for( int d = 0; found && (d < dimensionCount); d++ )
+            {
+                found = (pLower[d] == pTerm[d] - ((d == dimension) ? 1 : 0));
+            }
+        }
+        if( !found )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//--------------------------------------------------------
+// uncentre()
+// Turns coefficients in u = (x - offset) * scale into
+// coefficients in x, in place. Each term in u expands,
+// binomially, into the terms in x of no higher power of
+// any variable, which loweringClosed() ensures are in the
+// set wherever an offset isn't 0. The terms are taken in
+// the order of the steps, lowest degree first, so each
+// coefficient is replaced only once every term it gathers
+// from, of equal or higher power, has been read.
+//--------------------------------------------------------
+static void uncentre( int dimensionCount, int termCount, int *pExponents, int *pSteps, double *pOffsets,
+                      double *pScales, double *pCoefficients )
+{
+    for( int s = 0; s < termCount; s++ )
+    {
+        int t = pSteps[ s * SURFACE_STEP_INTS ];
+        int *pTerm = &(pExponents[ t * dimensionCount ]);
+        double sum = 0.0;
+
+        for( int u = 0; u < termCount; u++ )
+        {
+            int *pHigher = &(pExponents[ u * dimensionCount ]);
+            double weight = 1.0;
+            for( int d = 0; d < dimensionCount; d++ )
+            {
+                int power = pHigher[d];
+                int lowered = power - pTerm[d];
+                if( (lowered < 0) || ((lowered > 0) && (0.0 == pOffsets[d])) )
+                {
+                    weight = 0.0;
+                    break;
+                }
+                // C(power, lowered) * (-offset)^lowered * scale^power.
+                for( int k = 0; k < lowered; k++ )
+                {
+                    weight *= -pOffsets[d] * (power - k) / (k + 1);
+                }
+                for( int k = 0; k < power; k++ )
+                {
+                    weight *= pScales[d];
+                }
+            }
+            sum += weight * pCoefficients[u];
+        }
+        pCoefficients[t] = sum;
+    }
+}
+
+//--------------------------------------------------------
+// surfaceWorkDoubles(), surfaceSteps()
+// The working storage of a fit of termCount terms is its
+// packed normal matrix, right hand side, dot products,
+// and block of z values and terms, followed by the steps
+// planned for building the terms, in the space of
+// enough doubles. surfaceWorkDoubles() returns the number
+// of doubles, and surfaceSteps() where the steps start.
+//--------------------------------------------------------
+static size_t surfaceWorkDoubles( int termCount )
+{
+    size_t stepDoubles = ((size_t) termCount * SURFACE_STEP_INTS * sizeof( int ) + sizeof( double ) - 1) /
+                         sizeof( double );
+    return (((size_t) termCount * (termCount + 1)) / 2) + (2 * (size_t) termCount) +
+           ((size_t) (termCount + 1) * SURFACE_BLOCK_POINTS) + stepDoubles;
+}
+
+static int *surfaceSteps( double *pWork, int termCount )
+{
+    size_t stepDoubles = ((size_t) termCount * SURFACE_STEP_INTS * sizeof( int ) + sizeof( double ) - 1) /
+                         sizeof( double );
+    return (int *) &(pWork[ surfaceWorkDoubles( termCount ) - stepDoubles ]);
+}
+
+//--------------------------------------------------------
+// listTerms()
+// Appends, for polyfit_surface_terms(), every term whose
+// exponents from dimension onwards add up to remaining,
+// given the exponents before it in pCurrent, the higher
+// powers of each variable first. Terms past maxTerms are
+// counted but not written.
+//--------------------------------------------------------
+static void listTerms( int dimensionCount, int dimension, int remaining, int *pCurrent, int *pExponents,
+                       int maxTerms, int *pTermCount )
+{
+    if( dimension == dimensionCount - 1 )
+    {
+        pCurrent[ dimension ] = remaining;
+        if( *pTermCount < maxTerms )
+        {
+            for( int d = 0; d < dimensionCount; d++ )
+            {
+                pExponents[ (*pTermCount * dimensionCount) + d ] = pCurrent[d];
+            }
+        }
+        *pTermCount += 1;
+        return;
+    }
+    for( int e = remaining; e >= 0; e-- )
+    {
+        pCurrent[ dimension ] = e;
+        listTerms( dimensionCount, dimension + 1, remaining - e, pCurrent, pExponents, maxTerms, pTermCount );
+    }
+}
+
+//--------------------------------------------------------
+// planSteps()
+// Orders the terms by total degree, and finds for each an
+// earlier term that it is one variable times, so
+// buildTerms() needs one multiplication per term. A term
+// of a sparse set with no such term in the set is built
+// from its powers instead. O(termCount^2) work, once per
+// fit.
+//--------------------------------------------------------
+static void planSteps( int dimensionCount, int termCount, int *pExponents, int *pSteps )
+{
+    int maxDegree = 0;
+    int stepCount = 0;
+
+    for( int t = 0; t < termCount; t++ )
+    {
+        int degree = 0;
+        for( int d = 0; d < dimensionCount; d++ )
+        {
+            degree += pExponents[ (t * dimensionCount) + d ];
+        }
+        maxDegree = (degree > maxDegree) ? degree : maxDegree;
+    }
+
+    for( int degree = 0; degree <= maxDegree; degree++ )
+    {
+        for( int t = 0; t < termCount; t++ )
+        {
+            int *pTerm = &(pExponents[ t * dimensionCount ]);
+            int termDegree = 0;
+            for( int d = 0; d < dimensionCount; d++ )
+            {
+                termDegree += pTerm[d];
+            }
+            if( termDegree != degree )
+            {
+                continue;
+            }
+
+            int *pStep = &(pSteps[ stepCount * SURFACE_STEP_INTS ]);
+            pStep[0] = t;
+            pStep[1] = -1;
+            pStep[2] = 0;
+            for( int s = 0; (s < stepCount) && (pStep[1] < 0); s++ )
+            {
+                int *pEarlier = &(pExponents[ pSteps[ s * SURFACE_STEP_INTS ] * dimensionCount ]);
+                int differing = -1;
+                bool parent = true;
+                for( int d = 0; parent && (d < dimensionCount); d++ )
+                {
+                    if( pTerm[d] == pEarlier[d] + 1 )
+                    {
+                        parent = (differing < 0);
+                        differing = d;
+                    }
+                    else
+                    {
+                        parent = (pTerm[d] == pEarlier[d]);
+                    }
+                }
+                if( parent && (differing >= 0) )
+                {
+                    pStep[1] = pSteps[ s * SURFACE_STEP_INTS ];
+                    pStep[2] = differing;
+                }
+            }
+            stepCount += 1;
+        }
+    }
+}
+
+//--------------------------------------------------------
+// buildTerms()
+// Computes the value of each term at one point, in the
+// order planned by planSteps(), into
+// pTerms[ t * termStride ].
+//--------------------------------------------------------
+static void buildTerms( int dimensionCount, int termCount, int *pExponents, int *pSteps, double *pInputs,
+                        double *pTerms, size_t termStride )
+{
+    for( int s = 0; s < termCount; s++ )
+    {
+        int *pStep = &(pSteps[ s * SURFACE_STEP_INTS ]);
+        if( pStep[1] >= 0 )
+        {
+            pTerms[ pStep[0] * termStride ] = pTerms[ pStep[1] * termStride ] * pInputs[ pStep[2] ];
+        }
+        else
+        {
+            double value = 1.0;
+            for( int d = 0; d < dimensionCount; d++ )
+            {
+                for( int e = 0; e < pExponents[ (pStep[0] * dimensionCount) + d ]; e++ )
+                {
+                    value *= pInputs[d];
+                }
+            }
+            pTerms[ pStep[0] * termStride ] = value;
+        }
+    }
+}
+
+//--------------------------------------------------------
+// centrePoint()
+// Computes a point's inputs in the centred variables,
+// u = (x - offset) * scale, into pInputs.
+//--------------------------------------------------------
+static void centrePoint( int dimensionCount, double *pOffsets, double *pScales, double *pPoint, double *pInputs )
+{
+    for( int d = 0; d < dimensionCount; d++ )
+    {
+        pInputs[d] = (pPoint[d] - pOffsets[d]) * pScales[d];
+    }
+}
+
+//--------------------------------------------------------
+// evaluateTerms()
+// Returns the sum of each term's coefficient times its
+// value at one point, with each term's powers multiplied
+// out as it is reached, for surfaces with too many terms
+// to build into a block.
+//--------------------------------------------------------
+static double evaluateTerms( int dimensionCount, int termCount, int *pExponents, double *pCoefficients,
+                             double *pInputs )
+{
+    double sum = 0.0;
+
+    for( int t = 0; t < termCount; t++ )
+    {
+        double value = pCoefficients[t];
+        for( int d = 0; d < dimensionCount; d++ )
+        {
+            for( int e = 0; e < pExponents[ (t * dimensionCount) + d ]; e++ )
+            {
+                value *= pInputs[d];
+            }
+        }
+        sum += value;
+    }
+    return sum;
+}
@@ -0,0 +1,275 @@
+// Name: polyuniform.c
+// Description: Fitting of evenly spaced samples, with power sums in closed form.
+// Author: Henry M. Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+#include "polyfit_internal.h"
+
+// From this many points on, the power sums come from Faulhaber's formula.
+// Below it they are added up directly, which is cheap, and avoids the
+// large alternating terms the formula has when the sums are short.
+#define UNIFORM_CLOSED_FORM_POINTS  (256)
+
+// Points per block of scaled positions generated on the stack for the
+// direct sums.
+#define UNIFORM_BLOCK_POINTS        (256)
+
+// Points per block of the right hand side pass. Each block is summed on
+// its own and then added to the totals, which keeps the rounding error of
+// long series down.
+#define UNIFORM_RHS_BLOCK_POINTS    (4096)
+
+// Even Bernoulli numbers B(0), B(2), ... B(62), enough for the power sums
+// of fits of up to 32 coefficients. The odd ones are 0, except B(1),
+// taken as +1/2 so that Faulhaber's formula sums 1 .. N.
+#define UNIFORM_MAX_POWER           (62)
+static const double evenBernoulli[ (UNIFORM_MAX_POWER / 2) + 1 ] =
+{
+    1.0,                        0.16666666666666666,        -0.033333333333333333,      0.023809523809523808,
+    -0.033333333333333333,      0.07575757575757576,        -0.2531135531135531,        1.1666666666666667,
+    -7.0921568627450977,        54.971177944862156,         -529.12424242424242,        6192.123188405797,
+    -86580.253113553117,        1425517.1666666667,         -27298231.067816094,        601580873.9006424,
+    -15116315767.092157,        429614643061.16669,         -13711655205088.332,        488332318973593.19,
+    -19296579341940068.0,       8.4169304757368256e+17,     -4.0338071854059454e+19,    2.1150748638081993e+21,
+    -1.2086626522296526e+23,    7.5008667460769642e+24,     -5.0387781014810688e+26,    3.6528776484818122e+28,
+    -2.8498769302450882e+30,    2.3865427499683627e+32,     -2.1399949257225335e+34,    2.0500975723478097e+36
+};
+
+
+//------------------------------------------------
+// Private Function Prototypes
+//------------------------------------------------
+
+static double   scaledPowerSum( long long count, int power, double scale );
+static void     centredPowerSums( int pointCount, int sumCount, double halfSpan, double *pPowerSums );
+
+
+//=========================================================
+//      Global function definitions
+//=========================================================
+
+
+//--------------------------------------------------------
+// polyfit_uniform()
+// Same as polyfit(), for the pointCount points whose x
+// values are x0, x0 + dx, x0 + 2 * dx, and so on, so no
+// x array is needed.
+//
+// The fit is made in the centred and scaled variable
+// t = (x - xMid) / (halfSpan * dx), which runs from -1 to
+// 1, keeping the equations well conditioned. The power
+// sums of t depend only on pointCount, so for long series
+// they come from Faulhaber's formula rather than a pass
+// over the points; the odd ones are 0 by symmetry. Only
+// the right hand side sums need the y values, in a single
+// pass that makes each t in registers rather than loading
+// it. The coefficients in t are then expanded back into
+// powers of x.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < coefficientCount),
+//          -3 if unable to allocate memory,
+//          -4 if unable to solve equations,
+//          -5 if coefficientCount < 1 or dx is 0.
+//--------------------------------------------------------
+int polyfit_uniform( int pointCount, double x0, double dx, double *yValues, int coefficientCount,
+                     double *coefficientResults )
+{
+    int rVal = 0;
+    double tBlock[ UNIFORM_BLOCK_POINTS ];
+
+    if( (NULL == yValues) || (NULL == coefficientResults) )
+    {
+        return -1;
+    }
+    if( pointCount < coefficientCount )
+    {
+        return -2;
+    }
+    if( (coefficientCount < 1) || !(0.0 != dx) )
+    {
+        return -5;
+    }
+
+    int powerSumCount = (2 * coefficientCount) - 1;
+    double *pTemp = (double *) polyfitCalloc( powerSumCount + (3 * coefficientCount) +
+                                              (coefficientCount * (coefficientCount + 1)), sizeof( double ));
+    if( NULL == pTemp )
+    {
+        return -3;
+    }
+
+    double *pPowerSums = pTemp;
+    double *pRhsSums = &(pPowerSums[ powerSumCount ]);
+    double *pTResults = &(pRhsSums[ coefficientCount ]);         // Coefficients in t, highest power first.
+    double *pBlockRhsSums = &(pTResults[ coefficientCount ]);
+    double *pScratch = &(pBlockRhsSums[ coefficientCount ]);
+
+    double middle = 0.5 * (pointCount - 1);
+    double halfSpan = (pointCount > 1) ? middle : 1.0;
+    bool closedForm = (pointCount >= UNIFORM_CLOSED_FORM_POINTS) && (powerSumCount - 1 <= UNIFORM_MAX_POWER);
+
+    if( closedForm )
+    {
+        centredPowerSums( pointCount, powerSumCount, halfSpan, pPowerSums );
+        for( int first = 0; first < pointCount; first += UNIFORM_RHS_BLOCK_POINTS )
+        {
+            int count = pointCount - first;
+            if( count > UNIFORM_RHS_BLOCK_POINTS )
+            {
+                count = UNIFORM_RHS_BLOCK_POINTS;
+            }
+            for( int j = 0; j < coefficientCount; j++ )
+            {
+                pBlockRhsSums[j] = 0.0;
+            }
+            polyfitKernelUniformRhsSums( coefficientCount, count, first - middle, 1.0 / halfSpan,
+                                         &(yValues[ first ]), pBlockRhsSums );
+            for( int j = 0; j < coefficientCount; j++ )
+            {
+                pRhsSums[j] += pBlockRhsSums[j];
+            }
+        }
+    }
+    else
+    {
+        for( int first = 0; first < pointCount; first += UNIFORM_BLOCK_POINTS )
+        {
+            int count = pointCount - first;
+            if( count > UNIFORM_BLOCK_POINTS )
+            {
+                count = UNIFORM_BLOCK_POINTS;
+            }
+            for( int i = 0; i < count; i++ )
+            {
+                tBlock[i] = ((double) (first + i) - middle) / halfSpan;
+            }
+            polyfitKernelPowerSums( coefficientCount, count, tBlock, &(yValues[ first ]), pPowerSums, pRhsSums, NULL );
+        }
+    }
+
+    rVal = polyfitSolveSums( POLYFIT_SOLVER_DEFAULT, coefficientCount, pPowerSums, pRhsSums, pScratch, pTResults );
+    if( 0 == rVal )
+    {
+        // Substitute t = slope * x + offset by Horner's rule on polynomials:
+        // result = (...((c0 * t) + c1) * t + ...) + cDegree.
+        double slope = 1.0 / (halfSpan * dx);
+        double offset = -(x0 + (middle * dx)) * slope;
+
+        coefficientResults[0] = pTResults[0];
+        for( int c = 1; c < coefficientCount; c++ )
+        {
+            // Multiply the c coefficients so far by (slope * x + offset),
+            // giving c + 1 of them, then add the next t coefficient.
+            coefficientResults[c] = offset * coefficientResults[ c - 1 ];
+            for( int r = c - 1; r > 0; r-- )
+            {
+                coefficientResults[r] = (slope * coefficientResults[r]) + (offset * coefficientResults[ r - 1 ]);
+            }
+            coefficientResults[0] *= slope;
+            coefficientResults[c] += pTResults[c];
+        }
+    }
+    polyfitFree( pTemp );
+
+    return rVal;
+}
+
+
+//=========================================================
+//      Private function definitions
+//=========================================================
+
+//--------------------------------------------------------
+// scaledPowerSum()
+// Returns the sum of (q / scale)^power for q = 1 .. count,
+// by Faulhaber's formula:
+//     sum of q^p = (1 / (p + 1)) * sum over r of
+//                  C(p + 1, r) * B(r) * count^(p + 1 - r).
+// Each term is divided by scale^power as it is formed, so
+// nothing overflows, and the terms shrink quickly for the
+// long series it is used for.
+//--------------------------------------------------------
+static double scaledPowerSum( long long count, int power, double scale )
+{
+    double n = (double) count;
+    double ratio = n / scale;
+    double leading = n;                         // n^(p + 1) / scale^p.
+    for( int p = 0; p < power; p++ )
+    {
+        leading *= ratio;
+    }
+
+    // r = 0 and r = 1 terms, then the even r.
+    double sum = (leading / (power + 1)) + (0.5 * leading / n);
+    double binomial = power + 1;                // C(p + 1, r), updated as r grows.
+    double nPower = 1.0 / n;                    // n^-r.
+    for( int r = 2; r <= power; r++ )
+    {
+        binomial = binomial * (power + 2 - r) / r;
+        nPower /= n;
+        if( 0 == (r % 2) )
+        {
+            sum += binomial * evenBernoulli[ r / 2 ] * leading * nPower / (power + 1);
+        }
+    }
+    return sum;
+}
+
+//--------------------------------------------------------
+// centredPowerSums()
+// Sets pPowerSums[j], for j below sumCount, to the sum of
+// t^j over the points, where t = (i - middle) / halfSpan
+// for i = 0 .. pointCount - 1.
+//
+// The positions i - middle are symmetric about 0, so the
+// odd sums are 0. They are the integers -m .. m when
+// pointCount is odd, giving 2 * (sum of q^j for q = 1..m),
+// and the half integers when it is even, giving twice
+// (sum of (q / 2)^j for q = 1..pointCount) less
+// (sum of q^j for q = 1..pointCount / 2).
+//--------------------------------------------------------
+static void centredPowerSums( int pointCount, int sumCount, double halfSpan, double *pPowerSums )
+{
+    pPowerSums[0] = pointCount;
+    for( int j = 1; j < sumCount; j++ )
+    {
+        if( 0 != (j % 2) )
+        {
+            pPowerSums[j] = 0.0;
+        }
+        else if( 0 != (pointCount % 2) )
+        {
+            pPowerSums[j] = 2.0 * scaledPowerSum( pointCount / 2, j, halfSpan );
+        }
+        else
+        {
+            pPowerSums[j] = 2.0 * (scaledPowerSum( pointCount, j, 2.0 * halfSpan ) -
+                                   scaledPowerSum( pointCount / 2, j, halfSpan ));
+        }
+    }
+}
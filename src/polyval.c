@@ -0,0 +1,86 @@
+// Name: polyval.c
+// Description: Evaluation of fitted polynomials and their derivatives.
+// Author: Henry M. Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+
+#include "polyfit_internal.h"
+
+
+//=========================================================
+//      Global function definitions
+//=========================================================
+
+
+//--------------------------------------------------------
+// polyval()
+// Evaluates the polynomial whose coefficientCount
+// coefficients are in the highest power first order that
+// polyfit() produces, at each of pointCount x values,
+// storing the results in yValues.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -5 if coefficientCount < 1 or pointCount < 0.
+//--------------------------------------------------------
+int polyval( int coefficientCount, double *coefficients, int pointCount, double *xValues, double *yValues )
+{
+    return polyval_batch( coefficientCount, coefficients, pointCount, xValues, yValues, NULL, NULL );
+}
+
+//--------------------------------------------------------
+// polyval_batch()
+// Same as polyval(), but also stores the first and second
+// derivatives at each x, computed in the same pass, in
+// firstDerivatives and secondDerivatives. Either may be
+// NULL if it isn't wanted; with both NULL this is
+// polyval().
+//
+// The points are evaluated by Horner's rule, several
+// vectors of them at a time, with the vector kernel the
+// CPU supports. Nothing is allocated. The outputs must not
+// overlap xValues or each other.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -5 if coefficientCount < 1 or pointCount < 0.
+//--------------------------------------------------------
+int polyval_batch( int coefficientCount, double *coefficients, int pointCount, double *xValues, double *yValues,
+                   double *firstDerivatives, double *secondDerivatives )
+{
+    if( (NULL == coefficients) || (NULL == xValues) || (NULL == yValues) )
+    {
+        return -1;
+    }
+    if( (coefficientCount < 1) || (pointCount < 0) )
+    {
+        return -5;
+    }
+
+    polyfitKernelEvaluate( coefficientCount, coefficients, pointCount, xValues, yValues, firstDerivatives,
+                           secondDerivatives );
+    return 0;
+}
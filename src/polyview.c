@@ -0,0 +1,244 @@
+// Name: polyview.c
+// Description: Fitting points read in place through strided, typed views of the caller's memory.
+// Author: Henry M. Forson, Melbourne, Florida USA
+
+//------------------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2020 Henry M. Forson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------------
+
+#include <stdint.h>     // int32_t, int64_t, uintptr_t
+#include <string.h>     // memcpy()
+
+#include "polyfit_internal.h"
+
+// Points that aren't plain double arrays are converted this many at a
+// time into blocks on the stack, small enough to stay in the L1 cache,
+// and summed from there by the vector kernels.
+#define VIEW_BLOCK_POINTS       (512)
+
+// Timestamps are read in seconds.
+#define VIEW_SECONDS_PER_NS     (1e-9)
+
+
+//------------------------------------------------
+// Private Function Prototypes
+//------------------------------------------------
+
+static bool     viewIsValid( polyfit_view_t *pView );
+static bool     viewIsDoubleArray( polyfit_view_t *pView );
+static void     readView( polyfit_view_t *pView, int first, int count, double *pValues );
+
+
+//=========================================================
+//      Global function definitions
+//=========================================================
+
+
+//--------------------------------------------------------
+// polyfit_view_fit()
+// Same as polyfit(), but reads the points through views,
+// so callers holding records, or columns of other types,
+// needn't copy them into double arrays first. Point i has
+// the x value at pXView->pBase + i * pXView->stride and
+// the y value at pYView->pBase + i * pYView->stride, each
+// of its view's type.
+//
+// Integers and timestamps have the view's origin
+// subtracted in 64 bit integer arithmetic before they are
+// converted to double, so nanosecond timestamps of today,
+// about 1.7e18, lose nothing to the 53 bit mantissa as
+// long as they are within 2^53 ns, about 104 days, of the
+// origin. Timestamps are then scaled to seconds, and the
+// coefficients are in powers of seconds since the origin.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -2 if (pointCount < coefficientCount),
+//          -3 if unable to allocate memory,
+//          -4 if unable to solve equations,
+//          -5 if coefficientCount < 1 or a view's type is
+//             out of range.
+//--------------------------------------------------------
+int polyfit_view_fit( int pointCount, polyfit_view_t *pXView, polyfit_view_t *pYView, int coefficientCount,
+                      double *coefficientResults )
+{
+    int rVal = 0;
+    polyfit_accum_t accum;
+
+    if( (NULL == pXView) || (NULL == pYView) || (NULL == coefficientResults) )
+    {
+        return -1;
+    }
+    if( pointCount < coefficientCount )
+    {
+        return -2;
+    }
+
+    rVal = polyfit_accum_init( &accum, coefficientCount );
+    if( 0 == rVal )
+    {
+        rVal = polyfit_accum_add_view( &accum, pointCount, pXView, pYView );
+    }
+    if( 0 == rVal )
+    {
+        rVal = polyfit_accum_solve( &accum, coefficientResults );
+    }
+    polyfit_accum_free( &accum );
+
+    return rVal;
+}
+
+//--------------------------------------------------------
+// polyfit_accum_add_view()
+// Same as polyfit_accum_add_many(), but reads the points
+// through views; see polyfit_view_fit().
+//
+// Two views of aligned, contiguous doubles are summed in
+// place. Anything else is converted a block at a time
+// into a small buffer on the stack and summed from there,
+// so there is no copy of the whole input and no heap
+// allocation, whatever the layout.
+//
+// Returns   0 if success,
+//          -1 if passed a NULL pointer,
+//          -5 if pointCount < 0 or a view's type is out of
+//             range.
+//--------------------------------------------------------
+int polyfit_accum_add_view( polyfit_accum_t *pAccum, int pointCount, polyfit_view_t *pXView,
+                            polyfit_view_t *pYView )
+{
+    if( (NULL == pAccum) || (NULL == pAccum->pPowerSums) || (NULL == pXView) || (NULL == pXView->pBase) ||
+        (NULL == pYView) || (NULL == pYView->pBase) )
+    {
+        return -1;
+    }
+    if( (pointCount < 0) || !viewIsValid( pXView ) || !viewIsValid( pYView ) )
+    {
+        return -5;
+    }
+
+    if( viewIsDoubleArray( pXView ) && viewIsDoubleArray( pYView ) )
+    {
+        polyfitKernelPowerSums( pAccum->coefficientCount, pointCount, (double *) pXView->pBase,
+                                (double *) pYView->pBase, pAccum->pPowerSums, pAccum->pRhsSums,
+                                &(pAccum->ySquareSum) );
+    }
+    else
+    {
+        double xBlock[ VIEW_BLOCK_POINTS ];
+        double yBlock[ VIEW_BLOCK_POINTS ];
+
+        for( int first = 0; first < pointCount; first += VIEW_BLOCK_POINTS )
+        {
+            int count = (pointCount - first < VIEW_BLOCK_POINTS) ? pointCount - first : VIEW_BLOCK_POINTS;
+            readView( pXView, first, count, xBlock );
+            readView( pYView, first, count, yBlock );
+            polyfitKernelPowerSums( pAccum->coefficientCount, count, xBlock, yBlock, pAccum->pPowerSums,
+                                    pAccum->pRhsSums, &(pAccum->ySquareSum) );
+        }
+    }
+    pAccum->pointCount += pointCount;
+    return 0;
+}
+
+
+//=========================================================
+//      Private function definitions
+//=========================================================
+
+//--------------------------------------------------------
+// viewIsValid()
+// Says whether a view's type is one it can be read as.
+//--------------------------------------------------------
+static bool viewIsValid( polyfit_view_t *pView )
+{
+    return (pView->type >= POLYFIT_TYPE_DOUBLE) && (pView->type <= POLYFIT_TYPE_TIME_NS);
+}
+
+//--------------------------------------------------------
+// viewIsDoubleArray()
+// Says whether a view is a plain, aligned array of
+// doubles, which the kernels can read directly.
+//--------------------------------------------------------
+static bool viewIsDoubleArray( polyfit_view_t *pView )
+{
+    return (POLYFIT_TYPE_DOUBLE == pView->type) && (sizeof( double ) == pView->stride) &&
+           (0 == ((uintptr_t) pView->pBase % sizeof( double )));
+}
+
+//--------------------------------------------------------
+// readView()
+// Converts count values of a view, starting at index
+// first, to doubles in pValues. The type is tested once
+// per block rather than once per value, and each value is
+// read with memcpy(), so fields of packed records need
+// not be aligned; compilers turn it into a plain load.
+//--------------------------------------------------------
+static void readView( polyfit_view_t *pView, int first, int count, double *pValues )
+{
+    const unsigned char *pBytes = (const unsigned char *) pView->pBase + ((size_t) first * pView->stride);
+    size_t stride = pView->stride;
+
+    switch( pView->type )
+    {
+        case POLYFIT_TYPE_DOUBLE:
+            for( int i = 0; i < count; i++ )
+            {
+                memcpy( &(pValues[i]), &(pBytes[ i * stride ]), sizeof( double ));
+            }
+            break;
+
+        case POLYFIT_TYPE_FLOAT:
+            for( int i = 0; i < count; i++ )
+            {
+                float value;
+                memcpy( &value, &(pBytes[ i * stride ]), sizeof( value ));
+                pValues[i] = value;
+            }
+            break;
+
+        case POLYFIT_TYPE_INT32:
+            for( int i = 0; i < count; i++ )
+            {
+                int32_t value;
+                memcpy( &value, &(pBytes[ i * stride ]), sizeof( value ));
+                // Unsigned, as below, so an origin near the int64 limits can't overflow.
+                pValues[i] = (double) (int64_t) ((uint64_t) (int64_t) value - (uint64_t) pView->origin);
+            }
+            break;
+
+        case POLYFIT_TYPE_INT64:
+        case POLYFIT_TYPE_TIME_NS:
+        {
+            double scale = (POLYFIT_TYPE_TIME_NS == pView->type) ? VIEW_SECONDS_PER_NS : 1.0;
+            for( int i = 0; i < count; i++ )
+            {
+                int64_t value;
+                memcpy( &value, &(pBytes[ i * stride ]), sizeof( value ));
+                // Unsigned, so a difference beyond the int64 range wraps rather than overflowing.
+                pValues[i] = (double) (int64_t) ((uint64_t) value - (uint64_t) pView->origin) * scale;
+            }
+            break;
+        }
+    }
+}
@@ -26,7 +26,12 @@
 // SOFTWARE.
 //------------------------------------------------------------------------------------
 
+#include  <limits.h>
+#include  <locale.h>
+#include  <math.h>
+#include  <stdint.h>
 #include  <stdio.h>
+#include  <stdlib.h>
 #include  <string.h>
 #include  "polyfit.h"
 
@@ -72,6 +77,397 @@ double cr4[]  = {0, 0};                                       // coefficientResu
 int cc4       =  (int) (sizeof(cr4) / sizeof(cr4[0]));        // coefficientCount
 char *er4     = "(1.518293 * x) + 0.304878";                  // expected result
 
+// ---------------- TEST 5 DATA ------------------------
+// Feed the test 4 points to an accumulator in uneven chunks, which must
+// give the same line as fitting them all at once.
+double cr5[]  = {0, 0};                                       // coefficientResults
+int cc5       =  (int) (sizeof(cr5) / sizeof(cr5[0]));        // coefficientCount
+char *er5     = "(1.518293 * x) + 0.304878";                  // expected result
+
+// ---------------- TEST 6 DATA ------------------------
+// Fit lines to three packed series in one batch: the test 1 points, the
+// test 4 points, and a lone point that is too few for a line.
+double x6[]   = { 0, 1, 2,  2, 3, 5, 7, 9,  4};
+double y6[]   = { 6, 0, 0,  4, 5, 7, 10, 15,  1};
+int so6[]     = { 0, 3, 8, 9};                                // seriesOffsets
+int sc6       = (int) (sizeof(so6) / sizeof(so6[0])) - 1;     // seriesCount
+double cr6[]  = {0, 0, 0, 0, 0, 0};                           // coefficientResults
+int cc6       = 2;                                            // coefficientCount
+int ss6[]     = {0, 0, 0};                                    // seriesStatus
+// Then fit cubics to SC6C series of 0 to 140 points in one batch, where
+// short series are fitted four at a time in vector lanes. Each series
+// must get exactly the coefficients and status polyfit() gives it, even
+// the one starting at x = 1e4 that Cholesky refuses and QR fits.
+#define SC6C          (41)
+#define CC6C          (4)
+double x6c[SC6C * 141];
+double y6c[SC6C * 141];
+int so6c[SC6C + 1];
+double cr6c[SC6C * CC6C];
+int ss6c[SC6C];
+char *er6     = "(-3.000000 * x) + 5.000000; (1.518293 * x) + 0.304878; error = -2; "
+                "cubic batch -4, 41 of 41 as polyfit()";         // expected result
+
+// ---------------- TEST 7 DATA ------------------------
+// Compare every vector power sum kernel this CPU supports against the
+// scalar kernel on pseudo-random points. The vector kernels add in a
+// different order, so each sum may differ by rounding; the documented
+// tolerance is 1e-12 relative to the sum of the absolute values of its
+// terms. 1003 points leaves a tail that the vector loops don't cover.
+#define PC7           (1003)
+#define CC7           (6)
+double x7[PC7];
+double y7[PC7];
+char *er7     = "all kernels match scalar within 1e-12";      // expected result
+
+// ---------------- TEST 8 DATA ------------------------
+// Fit a noisy parabola to enough points to span several blocks of the
+// parallel accumulator. Every thread count must give exactly the same
+// coefficients, and they must agree with polyfit() to within rounding.
+#define PC8           (300007)
+double x8[PC8];
+double y8[PC8];
+double cr8[]  = {0, 0, 0};                                    // coefficientResults
+int cc8       =  (int) (sizeof(cr8) / sizeof(cr8[0]));        // coefficientCount
+char *er8     = "thread counts 1 to 4 agree exactly and match polyfit() within 1e-9";  // expected result
+
+// ---------------- TEST 9 DATA ------------------------
+// Smooth and differentiate a noisy signal with a Savitzky-Golay filter
+// (window 9, cubic, sample spacing 0.5), and check every output, ends
+// included, against polyfit() on the same window evaluated at that sample.
+#define PC9           (61)
+#define WL9           (9)
+#define CC9           (4)
+double y9[PC9];
+double sm9[PC9];                                              // smoothed
+double df9[PC9];                                              // first derivative
+char *er9     = "smoothing and derivative match polyfit() within 1e-9";  // expected result
+
+// ---------------- TEST 10 DATA ------------------------
+// Refit the test 2 parabola many times through a caller-owned workspace,
+// counting heap calls with a counting allocator. polyfit_ws() must make
+// none, and neither must polyfit(), which fits parabolas by the fixed
+// degree path.
+#define FITS10        (1000)
+char *er10    = "(-0.142857 * x^2) + 0.485714 after 1000 fits with 0 heap calls; polyfit() made 0";  // expected result
+int heapCalls10 = 0;
+// ---------------- TEST 11 DATA ------------------------
+// Fit the test 4 data with each solver. All must print the same, the
+// default must report that it ran Cholesky, and every solver must
+// refuse the impossible test 3 data. A parabola sampled 0.5 apart from
+// x = 1e6 on is too ill conditioned for Cholesky, so the default must
+// fall back on QR, as must polyfit_quadratic().
+#define PC11          (200)
+double x11[PC11];
+double y11[PC11];
+char *er11    = "(1.518293 * x) + 0.304878 from cholesky, qr, gauss-jordan; default ran cholesky; "
+                "test 3 data gives -4, -4, -4; parabola at 1e6 gives 0 by qr, "
+                "polyfit_quadratic() 0";                        // expected result
+// ---------------- TEST 12 DATA ------------------------
+// Fit float data: the test 4 points with polyfitf(), which must print
+// the same as polyfit(), then a noisy cubic with polyfitf_mixed(), whose
+// refined coefficients must match polyfit() on the widened data. Then
+// a degree 7 polynomial over 0 <= x <= 10, too ill conditioned for the
+// float sums, which must still match a QR fit of the widened data.
+#define PC12          (20000)
+#define CC12          (4)
+#define CC12W         (8)
+float xf12[PC12];
+float yf12[PC12];
+double x12[PC12];
+double y12[PC12];
+char *er12    = "(1.518293 * x) + 0.304878 from floats; mixed precision matches polyfit() within 1e-9; "
+                "degree 7 on [0, 10] matches qr within 1e-10";  // expected result
+// ---------------- TEST 13 DATA ------------------------
+// Make a plan for the test 4 x values, and fit the test 4 y values and
+// six more series (scaled and shifted copies of them) with it, singly
+// and all at once. All must match polyfit().
+#define SC13          (7)
+double y13[SC13 * 5];
+double cr13[SC13 * 2];
+char *er13    = "(1.518293 * x) + 0.304878; 7 series match polyfit() within 1e-12";  // expected result
+// ---------------- TEST 14 DATA ------------------------
+// Fit noisy cubics sampled every 0.25 from x = -3, with polyfit_uniform(),
+// for point counts that take the direct sums (5, 100, 101) and the closed
+// form sums (1000, 1001, 100000). Each must match the QR solver given
+// the x values, which is the most accurate reference for these far from
+// centred cubics.
+#define PC14          (100000)
+#define CC14          (4)
+double x14[PC14];
+double y14[PC14];
+char *er14    = "uniform fits of 5, 100, 101, 1000, 1001 and 100000 points match QR within 1e-9";  // expected result
+// ---------------- TEST 15 DATA ------------------------
+// Fit noisy cubics at random x in -2 .. 2 with polyfit_linear(), polyfit_quadratic() and
+// polyfit_cubic(), for point counts on both sides of the switch to the
+// vector kernels. Each must match the general Cholesky path, and the
+// parabola fit must refuse the impossible test 3 data.
+#define PC15          (1000)
+double x15[PC15];
+double y15[PC15];
+char *er15    = "fixed degree fits of 4 to 1000 points match the general path within 1e-9; "
+                "test 3 data gives -4";                         // expected result
+// ---------------- TEST 16 DATA ------------------------
+// Evaluate a degree 7 polynomial and its derivatives at 1003 points, a
+// count that leaves a tail after every vector width. The values must
+// equal a plain Horner loop exactly, and the derivatives must match
+// Horner on the differentiated coefficients.
+#define PC16          (1003)
+#define CC16          (8)
+double c16[CC16] = { 0.03, -0.2, 0.5, 1.25, -3.0, 0.75, 2.0, -1.0 };
+double x16[PC16];
+double y16[PC16];
+double d16[PC16];
+double dd16[PC16];
+double v16[PC16];
+char *er16    = "1003 values match Horner exactly; derivatives match within 1e-12";  // expected result
+// ---------------- TEST 17 DATA ------------------------
+// Measure four fits with stats enabled: the test 2 parabola, the
+// impossible test 3 data, which Cholesky and then QR refuse, a 5
+// coefficient fit of the test 15 data, and the test 2 parabola again by
+// QR. Each allocates once but the first. A
+// hook sees every fit, and a fit made after disabling stats is not
+// counted.
+#define CC17          (5)
+double cr17[CC17];
+int hookCalls17 = 0;
+int badPhases17 = 0;
+double condition17[4];
+char *er17    = "4 fits, 1 failed with -4, 3 allocations, 4 hook calls; condition estimates "
+                "finite, inf, finite, 0; none counted while disabled";  // expected result
+
+// ---------------- TEST 18 DATA ------------------------
+// Encode coefficients that need from 1 to 17 digits, a subnormal, the
+// largest double, a negative zero and a NaN as JSON, measuring the length
+// first. Both the JSON and the binary encodings must read back exactly,
+// NaN as NaN, and a buffer one byte short must be refused.
+#define CC18          (8)
+double c18[CC18] = { 0.1, 1.0 / 3.0, -1e-7, 5e-324, 1.7976931348623157e308, -0.0, 123456789012345678.0, NAN };
+double d18[CC18];
+unsigned char b18[ 4 + (8 * CC18) ];
+char *er18    = "[0.1,0.3333333333333333,-1e-7,5e-324,1.7976931348623157e308,-0,123456789012345680,null] "
+                "(87 chars); JSON and binary read back exactly; short buffers refused";  // expected result
+
+// ---------------- TEST 19 DATA ------------------------
+// Fit the test 2 parabola with its goodness of fit, worked out by hand:
+// residuals of 3, -12, 18, -12 and 3 / 35, and (AT)A of 34, 10, 5 on the
+// diagonal. Then fit a cubic to the 1000 noisy test 15 points, once in
+// one pass and once with the parallel accumulator, and check both against
+// the residuals computed point by point.
+#define CC19          (4)
+double cr19[CC19];
+double se19[CC19];
+char *er19    = "sse 0.514286, R2 0.357143, adjusted -0.285714, variance 0.257143, errors 0.135526 0.160357 "
+                "0.353409; cubic goodness matches a second pass";  // expected result
+
+// ---------------- TEST 20 DATA ------------------------
+// Let AIC, BIC and generalized cross-validation choose from 1 to 8
+// coefficients for the noisy test 15 cubic, where each should pick 4
+// and match polyfit(), and for an exact line, where each should pick 2.
+#define CC20          (8)
+double x20[]  = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+double y20[]  = { 1, 3, 5, 7, 9, 11, 13, 15, 17, 19 };
+double cr20[CC20];
+double scores20[CC20];
+char *er20    = "cubic: 4 4 4 coefficients, matching polyfit(); line: 2 2 2 coefficients, 2x + 1; "
+                "scores finite";  // expected result
+
+// ---------------- TEST 21 DATA ------------------------
+// Fit lines to a hinge of slopes 1, 2 and -1 between knots 0, 3, 6 and 9,
+// then constants, free and then joined, which makes each the mean of all
+// ten points. Then let 16 segments of parabolas with continuous slopes
+// follow a sine, checking the knots and that the thread count doesn't
+// change the result.
+#define PC21          (1000)
+double x21[]  = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+double y21[]  = { 0, 1, 2, 3, 5, 7, 9, 8, 7, 6 };
+double knots21[] = { 0, 3, 6, 9 };
+double xs21[PC21];
+double ys21[PC21];
+char *er21    = "hinge 1.5 6 7.5; constants 1 5 7.5, joined 4.8 4.8 4.8; adaptive 16 segments, C1 at knots, "
+                "same on 1 and 3 threads, fits sin";  // expected result
+
+// ---------------- TEST 22 DATA ------------------------
+// Submit 64 line fits to a service of 3 threads with a queue of 4, half
+// reporting by callback and half waited for, and check each result and
+// the metrics. Then hold the only worker of a service with a queue of 1
+// in a callback, fill the queue, and check the next job is turned away.
+#define JC22          (64)
+double x22[]  = { 0, 1, 2, 3, 4 };
+double y22[JC22][5];
+double cr22[JC22][2];
+polyfit_job_t jobs22[JC22];
+int callbacks22 = 0;
+int release22 = 0;
+char *er22    = "64 lines right, 32 callbacks, 64 completed, p99 >= p50 > 0; "
+                "full queue: -6, 1 rejected";  // expected result
+
+// ---------------- TEST 23 DATA ------------------------
+// Stream 200 irregularly spaced points of a noisy parabola far from x = 0
+// through a 50 point sliding window, comparing the fit after each point
+// once the window is full against polyfit() on the same 50 points, then
+// drop the 10 oldest. Then follow a noisy line with a forgetting factor
+// of 0.9, against the weighted least squares line worked out directly.
+#define PC23          (200)
+#define WL23          (50)
+double x23[PC23];
+double y23[PC23];
+double cr23[3];
+double fixed23[3];
+char *er23    = "window matches polyfit() at 151 of 151 points, and after dropping 10; "
+                "forgetting matches the weighted line";  // expected result
+// ---------------- TEST 24 DATA ------------------------
+// Shard 10000 points of a noisy cubic unevenly over 8 accumulators, as
+// separate processes would, encode each one's state, and decode and
+// merge them in order, in reverse and as a balanced tree. Each must
+// match polyfit() on all the points. The state must round trip byte
+// for byte, and state of a newer version, or a merge of accumulators of
+// different sizes, must be refused.
+#define PC24          (10000)
+#define SC24          (8)
+#define CC24          (4)
+#define SB24          (20 + (24 * CC24))
+double x24[PC24];
+double y24[PC24];
+int shardEnds24[SC24] = { 100, 1500, 1501, 4000, 4700, 7000, 9999, PC24 };
+unsigned char state24[SC24][SB24];
+double cr24[3][CC24];
+double fixed24[CC24];
+char *er24    = "8 shards merged in 3 orders match polyfit(); state round trips exactly; "
+                "newer version -5, other size -5";  // expected result
+// ---------------- TEST 25 DATA ------------------------
+// Fit fields of 2000 records in place through views: a parabola in
+// nanosecond timestamps near 1.7e18, and an int32 count against a float
+// column, each against polyfit() on copies converted by hand. Plain
+// double arrays read through views must sum exactly as the accumulator
+// does, and a view of an unknown type must be refused.
+#define PC25          (2000)
+typedef struct record25_s
+{
+  int64_t     timeNs;
+  float       level;
+  int32_t     count;
+  double      value;
+} record25_t;
+record25_t records25[PC25];
+double x25[PC25];
+double y25[PC25];
+double cr25[3];
+double fixed25[3];
+char *er25    = "timestamps 0.5 3 2 and match copies; float and int32 match copies; double arrays exact; "
+                "bad type -5";  // expected result
+// ---------------- TEST 26 DATA ------------------------
+// Fit a noisy cubic with 5 coefficients by orthogonal polynomials, which
+// must match polyfit(). Its values, refitted as a Chebyshev series, must
+// come back from Clenshaw's recurrence. Then fit cos(3x) over 1000 .. 1006
+// with 32 coefficients, where the normal equations can't be solved but
+// the Chebyshev series is right to rounding, and ask for 4 coefficients
+// from points at only 3 distinct x values.
+#define PC26          (500)
+#define CC26          (32)
+double x26[PC26];
+double y26[PC26];
+double v26[PC26];
+double cr26[CC26];
+double fixed26[CC26];
+double xs26[]  = { 1, 1, 2, 2, 3, 3 };
+char *er26    = "orthogonal matches polyfit(), Chebyshev matches monomial; cos(3x) with 32: "
+                "polyfit() -4, Chebyshev within 1e-11; 3 distinct x for 4: -4";  // expected result
+
+// ---------------- TEST 27 DATA ------------------------
+// List the terms of a cubic in two variables, and fit a surface made of
+// them, with x and y of very different ranges and every term of like
+// size, whose coefficients must come back to within 1e-8. Then fit a
+// sparse set of terms in three variables, some with no lower term in the
+// set, and evaluate it at the points; and fit with fewer points than
+// terms. A fit in a workspace must give the same coefficients, and one
+// sized for fewer terms must be refused. A cubic over x and y of 1000 to
+// 1010 must evaluate to within 1e-10 of its largest value.
+#define PC27          (200)
+#define TC27          (10)
+double in27[PC27 * 3];
+double z27[PC27];
+double v27[PC27];
+int terms27[TC27 * 2];
+double ws27[TC27];
+double cr27[TC27]    = { 2.0, -1.5e-2, 4e2, 2.5e-5, -3.0, 5e3, 1e-6, -2e-2, 75.0, 5e6 };
+int sparse27[]       = { 0, 0, 0,  1, 0, 0,  0, 0, 2,  1, 1, 1,  0, 3, 0 };
+double crs27[]       = { 1.0, -2.0, 0.5, 3.0, -0.25 };
+char *er27    = "10 terms, first x^3 at 6; 3 dimensions of degree 2: -5 with 10; "
+                "cubic recovered; sparse matches; 4 points for 5 terms: -2; "
+                "workspace fit identical, too small: -5; cubic at 1000 within 1e-10";  // expected result
+// ---------------- TEST 28 DATA ------------------------
+// Under a locale whose decimal point is a comma, if one is installed,
+// read back JSON written in the C locale, and write and read back
+// doubles of random bits, about 0.5% of which take the snprintf()
+// fallback. Text must keep its '.' and values must not change.
+#define VC28          (20000)
+const char *locales28[] = { "de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "fr_FR.utf8", "fr_FR",
+                            "nl_NL.UTF-8", "ru_RU.UTF-8" };
+const char *json28   = "[1.5, -2.25e-3, 0.1]";
+double d28[3];
+char *er28    = "[1.5, -2.25e-3, 0.1] read exactly; "
+                "20000 random doubles written with '.' and read back exactly";  // expected result
+//--------------------------------------------------------
+// countingCalloc(), countingFree()
+// Allocator hooks for test 10 that count every call.
+//--------------------------------------------------------
+static void *countingCalloc( size_t count, size_t size )
+{
+  heapCalls10 += 1;
+  return calloc( count, size );
+}
+
+static void countingFree( void *pMemory )
+{
+  heapCalls10 += 1;
+  free( pMemory );
+}
+
+
+//--------------------------------------------------------
+// statsHook17()
+// Stats hook for test 17 that keeps each fit's condition
+// estimate and checks that its phase times make sense.
+// The fourth fit is by QR alone, so accumulates nothing;
+// the second falls back on QR after accumulating.
+//--------------------------------------------------------
+static void statsHook17( const polyfit_call_stats_t *pCall, void *pUserData )
+{
+  int *pCalls = (int *) pUserData;
+
+  if( *pCalls < 4 )
+  {
+    condition17[ *pCalls ] = pCall->conditionEstimate;
+  }
+  if( (pCall->buildNs < 0.0) || (pCall->accumulateNs < 0.0) || (pCall->solveNs < 0.0) ||
+      ((3 == *pCalls) && ((POLYFIT_SOLVER_QR != pCall->solver) || (0.0 != pCall->accumulateNs))) ||
+      ((1 == *pCalls) && (POLYFIT_SOLVER_QR != pCall->solver)) )
+  {
+    badPhases17 += 1;
+  }
+  *pCalls += 1;
+}
+
+//--------------------------------------------------------
+// countJob22(), holdJob22()
+// Service callbacks for test 22: one counts the jobs done,
+// the other keeps the worker busy until released.
+//--------------------------------------------------------
+static void countJob22( polyfit_job_t *pJob, void *pUserData )
+{
+  (void) pJob;
+  __atomic_fetch_add( (int *) pUserData, 1, __ATOMIC_SEQ_CST );
+}
+
+static void holdJob22( polyfit_job_t *pJob, void *pUserData )
+{
+  (void) pJob;
+  while( 0 == __atomic_load_n( (int *) pUserData, __ATOMIC_SEQ_CST ) )
+  {
+    // Spin until the test lets go.
+  }
+}
 
 //--------------------------------------------------------
 // main()
@@ -175,6 +571,1842 @@ int main()
     failedCount += 1;
   }
   
+//---------------------TEST 5---------------------------
+  printf( "Test 5 expected %s\n", er5);
+  polyfit_accum_t accum5;
+  rVal = polyfit_accum_init( &accum5, cc5 );
+  if( 0 == rVal )
+  {
+    rVal = polyfit_accum_add( &accum5, x4[0], y4[0] );
+  }
+  if( 0 == rVal )
+  {
+    rVal = polyfit_accum_add_many( &accum5, 3, &x4[1], &y4[1] );
+  }
+  if( 0 == rVal )
+  {
+    rVal = polyfit_accum_add_many( &accum5, pc4 - 4, &x4[4], &y4[4] );
+  }
+  if( 0 == rVal )
+  {
+    rVal = polyfit_accum_solve( &accum5, cr5 );
+  }
+  polyfit_accum_free( &accum5 );
+  if( 0 == rVal)
+  { 
+    polyToString( polyStringBf, POLY_STRING_BF_SZ, cc5, cr5 );
+  }
+  else
+  {
+    snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+  }
+  printf( "Test 5 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er5) )
+  {
+    printf( "Test 5 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 6---------------------------
+  printf( "Test 6 expected %s\n", er6);
+  rVal = polyfit_batch( sc6, so6, x6, y6, cc6, cr6, ss6 );
+  polyStringBf[0] = 0;
+  for( int s = 0; s < sc6; s++ )
+  {
+    char seriesBf[POLY_STRING_BF_SZ];
+    if( 0 == ss6[s] )
+    {
+      polyToString( seriesBf, POLY_STRING_BF_SZ, cc6, &cr6[s * cc6] );
+    }
+    else
+    {
+      snprintf( seriesBf, POLY_STRING_BF_SZ, "error = %d", ss6[s] );
+    }
+    strncat( polyStringBf, (0 == s) ? "" : "; ", POLY_STRING_BF_SZ - strlen( polyStringBf ) - 1 );
+    strncat( polyStringBf, seriesBf, POLY_STRING_BF_SZ - strlen( polyStringBf ) - 1 );
+  }
+  {
+    int matchCount = 0;
+    int cubicStatus = 0;
+
+    so6c[0] = 0;
+    for( int s = 0; s < SC6C; s++ )
+    {
+      int pointCount = (s * 37) % 141;
+      so6c[s + 1] = so6c[s] + pointCount;
+      for( int i = 0; i < pointCount; i++ )
+      {
+        double x = (5 == s) ? 1e4 + (0.5 * i) : (0.1 * i) - s;
+        x6c[ so6c[s] + i ] = x;
+        y6c[ so6c[s] + i ] = sin( x ) + (0.01 * x * x) + (1e-3 * ((i * 7919) % 13));
+      }
+    }
+    cubicStatus = polyfit_batch( SC6C, so6c, x6c, y6c, CC6C, cr6c, ss6c );
+    for( int s = 0; s < SC6C; s++ )
+    {
+      double results[CC6C] = { 0 };
+      int status = polyfit( so6c[s + 1] - so6c[s], &x6c[ so6c[s] ], &y6c[ so6c[s] ], CC6C, results );
+      if( (status == ss6c[s]) && ((0 != status) || (0 == memcmp( results, &cr6c[s * CC6C], sizeof( results )))) )
+      {
+        matchCount += 1;
+      }
+    }
+    snprintf( polyStringBf + strlen( polyStringBf ), POLY_STRING_BF_SZ - strlen( polyStringBf ),
+              "; cubic batch %d, %d of %d as polyfit()", cubicStatus, matchCount, SC6C );
+  }
+  printf( "Test 6 produced %s\n", polyStringBf);
+  if( (-4 == rVal) && (0 == strcmp( polyStringBf, er6)) )
+  {
+    printf( "Test 6 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 7---------------------------
+  printf( "Test 7 expected %s\n", er7);
+  {
+    double absX7[PC7];
+    double absY7[PC7];
+    double scalarSums[(3 * CC7) - 1] = {0};
+    double magnitudes[(3 * CC7) - 1] = {0};
+    unsigned int seed = 12345u;
+
+    for( int i = 0; i < PC7; i++ )
+    {
+      seed = (seed * 1103515245u) + 12345u;
+      x7[i] = ((double) (seed >> 8) / (double) (1u << 24)) * 2.0 - 1.0;
+      seed = (seed * 1103515245u) + 12345u;
+      y7[i] = ((double) (seed >> 8) / (double) (1u << 24)) * 20.0 - 10.0;
+      absX7[i] = fabs( x7[i] );
+      absY7[i] = fabs( y7[i] );
+    }
+    polyfit_power_sums( POLYFIT_KERNEL_SCALAR, PC7, x7, y7, CC7, scalarSums, &scalarSums[(2 * CC7) - 1] );
+    polyfit_power_sums( POLYFIT_KERNEL_SCALAR, PC7, absX7, absY7, CC7, magnitudes, &magnitudes[(2 * CC7) - 1] );
+
+    snprintf( polyStringBf, POLY_STRING_BF_SZ, "%s", er7 );
+    for( int kernel = POLYFIT_KERNEL_SSE2; kernel <= POLYFIT_KERNEL_AVX512; kernel++ )
+    {
+      double kernelSums[(3 * CC7) - 1] = {0};
+      if( !polyfit_kernel_supported( (polyfit_kernel_t) kernel ) )
+      {
+        printf( "Test 7 skipped the %s kernel, which this CPU lacks.\n", polyfit_kernel_name( (polyfit_kernel_t) kernel ) );
+        continue;
+      }
+      rVal = polyfit_power_sums( (polyfit_kernel_t) kernel, PC7, x7, y7, CC7, kernelSums, &kernelSums[(2 * CC7) - 1] );
+      for( int j = 0; j < (3 * CC7) - 1; j++ )
+      {
+        if( (0 != rVal) || (fabs( kernelSums[j] - scalarSums[j] ) > 1e-12 * magnitudes[j]) )
+        {
+          snprintf( polyStringBf, POLY_STRING_BF_SZ, "%s kernel differs at sum %d",
+                    polyfit_kernel_name( (polyfit_kernel_t) kernel ), j );
+          break;
+        }
+      }
+    }
+  }
+  printf( "Test 7 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er7) )
+  {
+    printf( "Test 7 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 8---------------------------
+  printf( "Test 8 expected %s\n", er8);
+  {
+    double serialResults[3];
+    unsigned int seed = 777u;
+
+    for( int i = 0; i < PC8; i++ )
+    {
+      seed = (seed * 1103515245u) + 12345u;
+      x8[i] = (double) i / PC8;
+      y8[i] = (3.0 * x8[i] * x8[i]) - (2.0 * x8[i]) + 1.0 + ((double) (seed >> 16) / 65536.0 - 0.5) * 0.01;
+    }
+    snprintf( polyStringBf, POLY_STRING_BF_SZ, "%s", er8 );
+    rVal = polyfit( PC8, x8, y8, cc8, serialResults );
+    for( int threadCount = 1; (0 == rVal) && (threadCount <= 4); threadCount++ )
+    {
+      double threadResults[3];
+      rVal = polyfit_parallel( PC8, x8, y8, cc8, threadResults, threadCount );
+      for( int c = 0; (0 == rVal) && (c < cc8); c++ )
+      {
+        if( (threadCount > 1) && (threadResults[c] != cr8[c]) )
+        {
+          snprintf( polyStringBf, POLY_STRING_BF_SZ, "%d threads differ from 1 thread", threadCount );
+        }
+        if( fabs( threadResults[c] - serialResults[c] ) > 1e-9 )
+        {
+          snprintf( polyStringBf, POLY_STRING_BF_SZ, "%d threads differ from polyfit()", threadCount );
+        }
+        cr8[c] = threadResults[c];
+      }
+    }
+    if( 0 != rVal )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+    }
+  }
+  printf( "Test 8 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er8) )
+  {
+    printf( "Test 8 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 9---------------------------
+  printf( "Test 9 expected %s\n", er9);
+  {
+    polyfit_savgol_t smoother;
+    polyfit_savgol_t differentiator;
+    unsigned int seed = 4242u;
+
+    for( int i = 0; i < PC9; i++ )
+    {
+      seed = (seed * 1103515245u) + 12345u;
+      y9[i] = sin( 0.2 * i ) + ((double) (seed >> 16) / 65536.0 - 0.5) * 0.1;
+    }
+    rVal = polyfit_savgol_init( &smoother, WL9, CC9, 0, 0.5 );
+    if( 0 == rVal )
+    {
+      rVal = polyfit_savgol_init( &differentiator, WL9, CC9, 1, 0.5 );
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_savgol_apply( &smoother, PC9, y9, sm9 );
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_savgol_apply( &differentiator, PC9, y9, df9 );
+    }
+    polyfit_savgol_free( &smoother );
+    polyfit_savgol_free( &differentiator );
+
+    snprintf( polyStringBf, POLY_STRING_BF_SZ, "%s", er9 );
+    for( int n = 0; (0 == rVal) && (n < PC9); n++ )
+    {
+      // The window centred on n, or the first or last window near the ends.
+      int first = n - (WL9 / 2);
+      first = (first < 0) ? 0 : first;
+      first = (first > PC9 - WL9) ? (PC9 - WL9) : first;
+
+      double xWindow[WL9];
+      double coefficients[CC9];
+      for( int i = 0; i < WL9; i++ )
+      {
+        xWindow[i] = 0.5 * i;
+      }
+      rVal = polyfit( WL9, xWindow, &y9[first], CC9, coefficients );
+
+      double x = 0.5 * (n - first);
+      double value = 0.0;
+      double slope = 0.0;
+      for( int c = 0; c < CC9; c++ )
+      {
+        slope = (slope * x) + value;
+        value = (value * x) + coefficients[c];
+      }
+      if( (fabs( value - sm9[n] ) > 1e-9) || (fabs( slope - df9[n] ) > 1e-9) )
+      {
+        snprintf( polyStringBf, POLY_STRING_BF_SZ, "sample %d differs", n );
+      }
+    }
+    if( 0 != rVal )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+    }
+  }
+  printf( "Test 9 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er9) )
+  {
+    printf( "Test 9 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 10---------------------------
+  printf( "Test 10 expected %s\n", er10);
+  {
+    polyfit_workspace_t workspace;
+    size_t workspaceSize = polyfit_workspace_size( pc2, cc2 );
+    void *pMemory = malloc( workspaceSize );
+    int steadyStateCalls = 0;
+    int polyfitCalls = 0;
+
+    rVal = polyfit_workspace_init( &workspace, pMemory, workspaceSize, pc2, cc2 );
+    polyfit_set_allocator( countingCalloc, countingFree );
+    for( int i = 0; (0 == rVal) && (i < FITS10); i++ )
+    {
+      rVal = polyfit_ws( &workspace, pc2, x2, y2, cc2, cr2 );
+    }
+    steadyStateCalls = heapCalls10;
+    if( 0 == rVal )
+    {
+      double polyfitResults[3];
+      rVal = polyfit( pc2, x2, y2, cc2, polyfitResults );
+      polyfitCalls = (heapCalls10 - steadyStateCalls) / 2;     // Each calloc has its free.
+    }
+    polyfit_set_allocator( NULL, NULL );
+    free( pMemory );
+
+    if( 0 == rVal)
+    {
+      char fitBf[POLY_STRING_BF_SZ / 2];
+      polyToString( fitBf, sizeof( fitBf ), cc2, cr2 );
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "%s after %d fits with %d heap calls; polyfit() made %d",
+                fitBf, FITS10, steadyStateCalls, polyfitCalls );
+    }
+    else
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+    }
+  }
+  printf( "Test 10 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er10) )
+  {
+    printf( "Test 10 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 11---------------------------
+  printf( "Test 11 expected %s\n", er11);
+  {
+    polyfit_solver_t solvers[] = { POLYFIT_SOLVER_CHOLESKY, POLYFIT_SOLVER_QR, POLYFIT_SOLVER_GAUSS_JORDAN };
+    char fitBf[3][POLY_STRING_BF_SZ / 4];
+    int failures[3] = { 0, 0, 0 };
+    polyfit_solver_t solverUsed = POLYFIT_SOLVER_DEFAULT;
+    polyfit_solver_t farSolverUsed = POLYFIT_SOLVER_DEFAULT;
+    int farStatus = 0;
+    int quadraticStatus = 0;
+    double farResults[3];
+
+    rVal = 0;
+    for( int s = 0; (0 == rVal) && (s < 3); s++ )
+    {
+      double results[2];
+      rVal = polyfit_with_solver( pc4, x4, y4, cc4, results, solvers[s], NULL );
+      polyToString( fitBf[s], sizeof( fitBf[s] ), cc4, results );
+      failures[s] = polyfit_with_solver( pc3, x3, y3, cc3, cr3, solvers[s], NULL );
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_with_solver( pc4, x4, y4, cc4, cr4, POLYFIT_SOLVER_DEFAULT, &solverUsed );
+    }
+
+    for( int i = 0; i < PC11; i++ )
+    {
+      x11[i] = 1e6 + (0.5 * i);
+      y11[i] = (0.01 * i * i) - i + 3.0;
+    }
+    farStatus = polyfit_with_solver( PC11, x11, y11, 3, farResults, POLYFIT_SOLVER_DEFAULT, &farSolverUsed );
+    quadraticStatus = polyfit_quadratic( PC11, x11, y11, farResults );
+
+    if( (0 == rVal) && (0 == strcmp( fitBf[0], fitBf[1] )) && (0 == strcmp( fitBf[0], fitBf[2] )) )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "%s from %s, %s, %s; default ran %s; test 3 data gives %d, %d, %d; "
+                "parabola at 1e6 gives %d by %s, polyfit_quadratic() %d", fitBf[0], polyfit_solver_name( solvers[0] ),
+                polyfit_solver_name( solvers[1] ), polyfit_solver_name( solvers[2] ), polyfit_solver_name( solverUsed ),
+                failures[0], failures[1], failures[2], farStatus, polyfit_solver_name( farSolverUsed ),
+                quadraticStatus );
+    }
+    else if( 0 == rVal )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "solvers disagree: %s; %s; %s", fitBf[0], fitBf[1], fitBf[2] );
+    }
+    else
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+    }
+  }
+  printf( "Test 11 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er11) )
+  {
+    printf( "Test 11 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 12---------------------------
+  printf( "Test 12 expected %s\n", er12);
+  {
+    float xf4[5];
+    float yf4[5];
+    float floatResults[2];
+    double widenedResults[2];
+    double mixedResults[CC12W];
+    double doubleResults[CC12W];
+    bool mixedMatches = true;
+    bool wideMatches = true;
+    unsigned int seed = 1212u;
+
+    for( int i = 0; i < pc4; i++ )
+    {
+      xf4[i] = (float) x4[i];
+      yf4[i] = (float) y4[i];
+    }
+    for( int i = 0; i < PC12; i++ )
+    {
+      seed = (seed * 1103515245u) + 12345u;
+      xf12[i] = (float) ((2.0 * i / PC12) - 1.0);
+      yf12[i] = (float) ((0.5 * xf12[i] * xf12[i] * xf12[i]) - xf12[i] + 2.0 +
+                         ((double) (seed >> 16) / 65536.0 - 0.5) * 0.01);
+      x12[i] = xf12[i];
+      y12[i] = yf12[i];
+    }
+
+    rVal = polyfitf( pc4, xf4, yf4, cc4, floatResults );
+    if( 0 == rVal )
+    {
+      rVal = polyfitf_mixed( PC12, xf12, yf12, CC12, mixedResults );
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit( PC12, x12, y12, CC12, doubleResults );
+    }
+    for( int c = 0; (0 == rVal) && (c < CC12); c++ )
+    {
+      mixedMatches = mixedMatches && (fabs( mixedResults[c] - doubleResults[c] ) <= 1e-9);
+    }
+
+    // Coefficients of about 1 in t = x / 10, so each term is about 1.
+    for( int i = 0; (0 == rVal) && (i < PC12); i++ )
+    {
+      double t = (double) i / (PC12 - 1);
+      double y = 0.0;
+      for( int c = 0; c < CC12W; c++ )
+      {
+        y = (y * t) + ((0 == (c % 2)) ? 1.0 : -0.5);
+      }
+      xf12[i] = (float) (10.0 * t);
+      yf12[i] = (float) y;
+      x12[i] = xf12[i];
+      y12[i] = yf12[i];
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfitf_mixed( PC12, xf12, yf12, CC12W, mixedResults );
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_with_solver( PC12, x12, y12, CC12W, doubleResults, POLYFIT_SOLVER_QR, NULL );
+    }
+    if( 0 == rVal )
+    {
+      double largest = 0.0;
+      for( int c = 0; c < CC12W; c++ )
+      {
+        largest = fmax( largest, fabs( doubleResults[c] ));
+      }
+      for( int c = 0; c < CC12W; c++ )
+      {
+        wideMatches = wideMatches && (fabs( mixedResults[c] - doubleResults[c] ) <= 1e-10 * largest);
+      }
+    }
+
+    if( 0 == rVal )
+    {
+      char fitBf[POLY_STRING_BF_SZ / 2];
+      widenedResults[0] = floatResults[0];
+      widenedResults[1] = floatResults[1];
+      polyToString( fitBf, sizeof( fitBf ), cc4, widenedResults );
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "%s from floats; mixed precision %s polyfit() within 1e-9; "
+                "degree 7 on [0, 10] %s qr within 1e-10", fitBf, mixedMatches ? "matches" : "differs from",
+                wideMatches ? "matches" : "differs from" );
+    }
+    else
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+    }
+  }
+  printf( "Test 12 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er12) )
+  {
+    printf( "Test 12 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 13---------------------------
+  printf( "Test 13 expected %s\n", er13);
+  {
+    polyfit_plan_t plan;
+    double planResults[2];
+    int mismatches = 0;
+
+    for( int s = 0; s < SC13; s++ )
+    {
+      for( int i = 0; i < pc4; i++ )
+      {
+        y13[ (s * pc4) + i ] = (y4[i] * (s + 1)) - s;
+      }
+    }
+
+    rVal = polyfit_plan_init( &plan, pc4, x4, cc4 );
+    if( 0 == rVal )
+    {
+      rVal = polyfit_plan_execute( &plan, y4, planResults );
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_plan_execute_many( &plan, SC13, y13, cr13 );
+    }
+    for( int s = 0; (0 == rVal) && (s < SC13); s++ )
+    {
+      double singleResults[2];
+      rVal = polyfit( pc4, x4, &(y13[ s * pc4 ]), cc4, cr4 );
+      if( 0 == rVal )
+      {
+        rVal = polyfit_plan_execute( &plan, &(y13[ s * pc4 ]), singleResults );
+      }
+      for( int c = 0; (0 == rVal) && (c < cc4); c++ )
+      {
+        if( (fabs( cr13[ (s * cc4) + c ] - cr4[c] ) > 1e-12) || (fabs( singleResults[c] - cr4[c] ) > 1e-12) )
+        {
+          mismatches += 1;
+        }
+      }
+    }
+    polyfit_plan_free( &plan );
+
+    if( (0 == rVal) && (0 == mismatches) )
+    {
+      char fitBf[POLY_STRING_BF_SZ / 2];
+      polyToString( fitBf, sizeof( fitBf ), cc4, planResults );
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "%s; %d series match polyfit() within 1e-12", fitBf, SC13 );
+    }
+    else if( 0 == rVal )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "%d coefficients differ from polyfit()", mismatches );
+    }
+    else
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+    }
+  }
+  printf( "Test 13 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er13) )
+  {
+    printf( "Test 13 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 14---------------------------
+  printf( "Test 14 expected %s\n", er14);
+  {
+    int pointCounts[] = { 5, 100, 101, 1000, 1001, PC14 };
+    int mismatches = 0;
+    unsigned int seed = 1414u;
+
+    for( int i = 0; i < PC14; i++ )
+    {
+      seed = (seed * 1103515245u) + 12345u;
+      x14[i] = -3.0 + (0.25 * i);
+      y14[i] = (1e-6 * x14[i] * x14[i] * x14[i]) - (0.002 * x14[i] * x14[i]) + (3.0 * x14[i]) - 7.0 +
+               ((double) (seed >> 16) / 65536.0 - 0.5);
+    }
+
+    rVal = 0;
+    for( int p = 0; (0 == rVal) && (p < (int) (sizeof( pointCounts ) / sizeof( pointCounts[0] ))); p++ )
+    {
+      double uniformResults[CC14];
+      double qrResults[CC14];
+
+      rVal = polyfit_uniform( pointCounts[p], -3.0, 0.25, y14, CC14, uniformResults );
+      if( 0 == rVal )
+      {
+        rVal = polyfit_with_solver( pointCounts[p], x14, y14, CC14, qrResults, POLYFIT_SOLVER_QR, NULL );
+      }
+      for( int c = 0; (0 == rVal) && (c < CC14); c++ )
+      {
+        // Relative, since the x^3 coefficient is tiny and the constant is not.
+        if( fabs( uniformResults[c] - qrResults[c] ) > 1e-9 * fmax( 1.0, fabs( qrResults[c] )) )
+        {
+          printf( "  %d points: coefficient %d is %.17g, QR gives %.17g\n", pointCounts[p], c,
+                  uniformResults[c], qrResults[c] );
+          mismatches += 1;
+        }
+      }
+    }
+
+    if( (0 == rVal) && (0 == mismatches) )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "%s", er14 );
+    }
+    else if( 0 == rVal )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "%d coefficients differ from QR", mismatches );
+    }
+    else
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+    }
+  }
+  printf( "Test 14 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er14) )
+  {
+    printf( "Test 14 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 15---------------------------
+  printf( "Test 15 expected %s\n", er15);
+  {
+    int pointCounts[] = { 4, 5, 17, 127, 128, 129, PC15 };
+    int mismatches = 0;
+    unsigned int seed = 1515u;
+
+    for( int i = 0; i < PC15; i++ )
+    {
+      seed = (seed * 1103515245u) + 12345u;
+      x15[i] = (4.0 * (double) (seed >> 16) / 65536.0) - 2.0;
+      seed = (seed * 1103515245u) + 12345u;
+      y15[i] = (0.5 * x15[i] * x15[i] * x15[i]) - (1.5 * x15[i] * x15[i]) + x15[i] + 4.0 +
+               ((double) (seed >> 16) / 65536.0 - 0.5);
+    }
+
+    rVal = 0;
+    for( int p = 0; (0 == rVal) && (p < (int) (sizeof( pointCounts ) / sizeof( pointCounts[0] ))); p++ )
+    {
+      for( int coefficientCount = 2; (0 == rVal) && (coefficientCount <= 4); coefficientCount++ )
+      {
+        double fixedResults[4];
+        double generalResults[4];
+
+        switch( coefficientCount )
+        {
+          case 2:   rVal = polyfit_linear( pointCounts[p], x15, y15, fixedResults ); break;
+          case 3:   rVal = polyfit_quadratic( pointCounts[p], x15, y15, fixedResults ); break;
+          default:  rVal = polyfit_cubic( pointCounts[p], x15, y15, fixedResults ); break;
+        }
+        if( 0 == rVal )
+        {
+          rVal = polyfit_with_solver( pointCounts[p], x15, y15, coefficientCount, generalResults,
+                                      POLYFIT_SOLVER_CHOLESKY, NULL );
+        }
+        for( int c = 0; (0 == rVal) && (c < coefficientCount); c++ )
+        {
+          if( fabs( fixedResults[c] - generalResults[c] ) > 1e-9 * fmax( 1.0, fabs( generalResults[c] )) )
+          {
+            printf( "  %d points: coefficient %d of %d is %.17g, general path gives %.17g\n", pointCounts[p], c,
+                    coefficientCount, fixedResults[c], generalResults[c] );
+            mismatches += 1;
+          }
+        }
+      }
+    }
+
+    if( (0 == rVal) && (0 == mismatches) )
+    {
+      double parabolaResults[3];
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "fixed degree fits of 4 to 1000 points match the general path "
+                "within 1e-9; test 3 data gives %d", polyfit_quadratic( pc3, x3, y3, parabolaResults ));
+    }
+    else if( 0 == rVal )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "%d coefficients differ from the general path", mismatches );
+    }
+    else
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+    }
+  }
+  printf( "Test 15 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er15) )
+  {
+    printf( "Test 15 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 16---------------------------
+  printf( "Test 16 expected %s\n", er16);
+  {
+    double slopeCoefficients[CC16 - 1];
+    double curvatureCoefficients[CC16 - 2];
+    int valueMismatches = 0;
+    int derivativeMismatches = 0;
+
+    for( int c = 0; c < CC16 - 1; c++ )
+    {
+      slopeCoefficients[c] = c16[c] * (CC16 - 1 - c);
+    }
+    for( int c = 0; c < CC16 - 2; c++ )
+    {
+      curvatureCoefficients[c] = slopeCoefficients[c] * (CC16 - 2 - c);
+    }
+    for( int i = 0; i < PC16; i++ )
+    {
+      x16[i] = -2.0 + ((4.0 * i) / (PC16 - 1));
+    }
+
+    rVal = polyval( CC16, c16, PC16, x16, v16 );
+    if( 0 == rVal )
+    {
+      rVal = polyval_batch( CC16, c16, PC16, x16, y16, d16, dd16 );
+    }
+    for( int i = 0; (0 == rVal) && (i < PC16); i++ )
+    {
+      double value = 0.0;
+      double slope = 0.0;
+      double curvature = 0.0;
+      for( int c = 0; c < CC16; c++ )
+      {
+        value = (value * x16[i]) + c16[c];
+      }
+      for( int c = 0; c < CC16 - 1; c++ )
+      {
+        slope = (slope * x16[i]) + slopeCoefficients[c];
+      }
+      for( int c = 0; c < CC16 - 2; c++ )
+      {
+        curvature = (curvature * x16[i]) + curvatureCoefficients[c];
+      }
+      if( (value != v16[i]) || (value != y16[i]) )
+      {
+        valueMismatches += 1;
+      }
+      if( (fabs( slope - d16[i] ) > 1e-12 * fmax( 1.0, fabs( slope ))) ||
+          (fabs( curvature - dd16[i] ) > 1e-12 * fmax( 1.0, fabs( curvature ))) )
+      {
+        derivativeMismatches += 1;
+      }
+    }
+
+    if( (0 == rVal) && (0 == valueMismatches) && (0 == derivativeMismatches) )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "%s", er16 );
+    }
+    else if( 0 == rVal )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "%d values and %d derivatives differ", valueMismatches,
+                derivativeMismatches );
+    }
+    else
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+    }
+  }
+  printf( "Test 16 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er16) )
+  {
+    printf( "Test 16 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 17---------------------------
+  printf( "Test 17 expected %s\n", er17);
+  {
+    polyfit_stats_t stats;
+    int statuses[4];
+
+    polyfit_stats_reset();
+    polyfit_stats_set_hook( statsHook17, &hookCalls17 );
+    polyfit_stats_enable( true );
+    statuses[0] = polyfit( pc2, x2, y2, cc2, cr2 );
+    statuses[1] = polyfit( pc3, x3, y3, cc3, cr3 );
+    statuses[2] = polyfit( PC15, x15, y15, CC17, cr17 );
+    statuses[3] = polyfit_with_solver( pc2, x2, y2, cc2, cr2, POLYFIT_SOLVER_QR, NULL );
+    polyfit_stats_enable( false );
+    polyfit( pc2, x2, y2, cc2, cr2 );
+    polyfit_stats_set_hook( NULL, NULL );
+    rVal = polyfit_stats_get( &stats );
+
+    if( (0 != rVal) || (0 != statuses[0]) || (-4 != statuses[1]) || (0 != statuses[2]) || (0 != statuses[3]) )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d; statuses %d, %d, %d, %d", rVal, statuses[0],
+                statuses[1], statuses[2], statuses[3] );
+    }
+    else if( 0 != badPhases17 )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "%d fits had bad phase times", badPhases17 );
+    }
+    else
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "%llu fits, %llu failed with -4, %llu allocations, "
+                "%d hook calls; condition estimates %s, %s, %s, %s; %s",
+                stats.calls, stats.failures[4], stats.allocations, hookCalls17,
+                (isfinite( condition17[0] ) && (condition17[0] >= 1.0)) ? "finite" : "bad",
+                isinf( condition17[1] ) ? "inf" : "bad",
+                (isfinite( condition17[2] ) && (condition17[2] >= 1.0)) ? "finite" : "bad",
+                (0.0 == condition17[3]) ? "0" : "bad",
+                ((4 == stats.calls) && (4 == hookCalls17)) ? "none counted while disabled" : "disabled fits counted" );
+    }
+  }
+  printf( "Test 17 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er17) )
+  {
+    printf( "Test 17 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 18---------------------------
+  printf( "Test 18 expected %s\n", er18);
+  {
+    char json[ 128 ];
+    size_t measured = 0;
+    size_t length = 0;
+    size_t used = 0;
+    size_t binaryLength = 0;
+    size_t binaryUsed = 0;
+    int jsonCount = 0;
+    int binaryCount = 0;
+    bool jsonExact = true;
+    bool binaryExact = true;
+    int measureVal = polyfit_encode_json( NULL, 0, CC18, c18, &measured );
+    int shortVal = polyfit_encode_json( json, measured, CC18, c18, &length );
+
+    rVal = polyfit_encode_json( json, sizeof( json ), CC18, c18, &length );
+    if( 0 == rVal )
+    {
+      rVal = polyfit_decode_json( json, length, CC18, d18, &jsonCount, &used );
+    }
+    for( int c = 0; (0 == rVal) && (c < CC18); c++ )
+    {
+      jsonExact = jsonExact && (isnan( c18[c] ) ? isnan( d18[c] ) : (0 == memcmp( &(c18[c]), &(d18[c]), 8 )));
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_encode_binary( b18, sizeof( b18 ), CC18, c18, &binaryLength );
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_decode_binary( b18, sizeof( b18 ), CC18, d18, &binaryCount, &binaryUsed );
+      binaryExact = (0 == memcmp( c18, d18, sizeof( c18 )));
+    }
+    if( 0 == rVal )
+    {
+      shortVal += polyfit_decode_binary( b18, sizeof( b18 ) - 1, CC18, d18, &binaryCount, &binaryUsed );
+    }
+
+    if( (0 != rVal) || (-5 != measureVal) )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d, measuring returned %d", rVal, measureVal );
+    }
+    else
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "%s (%zu chars); JSON %s; short buffers %s", json, measured,
+                (jsonExact && binaryExact && (CC18 == jsonCount) && (length == used) && (CC18 == binaryCount) &&
+                 (sizeof( b18 ) == binaryLength) && (binaryLength == binaryUsed)) ?
+                    "and binary read back exactly" : "or binary changed",
+                (-10 == shortVal) ? "refused" : "accepted" );
+    }
+  }
+  printf( "Test 18 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er18) )
+  {
+    printf( "Test 18 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 19---------------------------
+  printf( "Test 19 expected %s\n", er19);
+  {
+    polyfit_goodness_t goodness;
+    polyfit_goodness_t parallelGoodness;
+    polyfit_accum_t accum19;
+
+    rVal = polyfit_goodness( pc2, x2, y2, cc2, cr19, se19, &goodness );
+    int len = snprintf( polyStringBf, POLY_STRING_BF_SZ, "sse %f, R2 %f, adjusted %f, variance %f, errors %f %f %f; ",
+                        goodness.sse, goodness.rSquared, goodness.adjustedRSquared, goodness.residualVariance,
+                        se19[0], se19[1], se19[2] );
+
+    if( 0 == rVal )
+    {
+      rVal = polyfit_goodness( PC15, x15, y15, CC19, cr19, NULL, &goodness );
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_accum_init( &accum19, CC19 );
+      if( 0 == rVal )
+      {
+        rVal = polyfit_accum_add_many_parallel( &accum19, PC15, x15, y15, 3 );
+      }
+      if( 0 == rVal )
+      {
+        rVal = polyfit_accum_goodness( &accum19, cr19, se19, &parallelGoodness );
+      }
+      polyfit_accum_free( &accum19 );
+    }
+
+    // The second pass: residuals and the mean, point by point.
+    double sse = 0.0;
+    double mean = 0.0;
+    double sst = 0.0;
+    for( int i = 0; i < PC15; i++ )
+    {
+      double residual = y15[i] - (((((cr19[0] * x15[i]) + cr19[1]) * x15[i]) + cr19[2]) * x15[i] + cr19[3]);
+      sse += residual * residual;
+      mean += y15[i] / PC15;
+    }
+    for( int i = 0; i < PC15; i++ )
+    {
+      sst += (y15[i] - mean) * (y15[i] - mean);
+    }
+    bool matches = (fabs( goodness.sse - sse ) <= 1e-9 * sst) && (fabs( goodness.sst - sst ) <= 1e-9 * sst) &&
+                   (fabs( parallelGoodness.sse - sse ) <= 1e-9 * sst) &&
+                   (fabs( parallelGoodness.rSquared - (1.0 - (sse / sst)) ) <= 1e-9) &&
+                   (PC15 - CC19 == parallelGoodness.degreesOfFreedom) && (se19[0] > 0.0);
+
+    if( 0 != rVal )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+    }
+    else
+    {
+      snprintf( &(polyStringBf[ len ]), POLY_STRING_BF_SZ - len, "cubic goodness %s",
+                matches ? "matches a second pass" : "differs from a second pass" );
+    }
+  }
+  printf( "Test 19 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er19) )
+  {
+    printf( "Test 19 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 20---------------------------
+  printf( "Test 20 expected %s\n", er20);
+  {
+    double fixed20[4];
+    int cubicCounts[3] = { 0, 0, 0 };
+    int lineCounts[3] = { 0, 0, 0 };
+    bool matches = true;
+    bool finite = true;
+    bool isLine = true;
+
+    rVal = polyfit( PC15, x15, y15, 4, fixed20 );
+    for( int c = 0; (0 == rVal) && (c < 3); c++ )
+    {
+      rVal = polyfit_auto( PC15, x15, y15, CC20, (polyfit_criterion_t) c, cr20, &(cubicCounts[c]), scores20 );
+      for( int k = 0; (0 == rVal) && (k < 4) && (4 == cubicCounts[c]); k++ )
+      {
+        matches = matches && (fabs( cr20[k] - fixed20[k] ) <= 1e-9);
+      }
+      for( int k = 0; k < CC20; k++ )
+      {
+        finite = finite && isfinite( scores20[k] );
+      }
+    }
+    for( int c = 0; (0 == rVal) && (c < 3); c++ )
+    {
+      rVal = polyfit_auto( (int) (sizeof( x20 ) / sizeof( x20[0] )), x20, y20, CC20, (polyfit_criterion_t) c, cr20,
+                           &(lineCounts[c]), NULL );
+      isLine = isLine && (fabs( cr20[0] - 2.0 ) <= 1e-9) && (fabs( cr20[1] - 1.0 ) <= 1e-9);
+    }
+
+    if( 0 != rVal )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+    }
+    else
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "cubic: %d %d %d coefficients, %s; line: %d %d %d coefficients, "
+                "%s; scores %s", cubicCounts[0], cubicCounts[1], cubicCounts[2],
+                matches ? "matching polyfit()" : "not matching polyfit()", lineCounts[0], lineCounts[1],
+                lineCounts[2], isLine ? "2x + 1" : "not 2x + 1", finite ? "finite" : "not finite" );
+    }
+  }
+  printf( "Test 20 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er20) )
+  {
+    printf( "Test 20 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 21---------------------------
+  printf( "Test 21 expected %s\n", er21);
+  {
+    polyfit_piecewise_t hinge;
+    polyfit_piecewise_t unjoined;
+    polyfit_piecewise_t joined;
+    polyfit_piecewise_t single;
+    polyfit_piecewise_t threaded;
+    double middles[3] = { 1.5, 4.5, 7.5 };
+    double lines[3] = { 0, 0, 0 };
+    bool continuous = true;
+    bool same = true;
+    bool fits = true;
+
+    for( int i = 0; i < PC21; i++ )
+    {
+      xs21[i] = i * 0.01;
+      ys21[i] = sin( xs21[i] );
+    }
+
+    rVal = polyfit_piecewise_fit( &hinge, 10, x21, y21, 2, 3, knots21, 0, 1 );
+    if( 0 == rVal )
+    {
+      rVal = polyfit_piecewise_eval( &hinge, 3, middles, lines );
+    }
+    polyfit_piecewise_free( &hinge );
+    if( 0 == rVal )
+    {
+      rVal = polyfit_piecewise_fit( &unjoined, 10, x21, y21, 1, 3, knots21, -1, 2 );
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_piecewise_fit( &joined, 10, x21, y21, 1, 3, knots21, 0, 2 );
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_piecewise_fit( &single, PC21, xs21, ys21, 3, 16, NULL, 1, 1 );
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_piecewise_fit( &threaded, PC21, xs21, ys21, 3, 16, NULL, 1, 3 );
+    }
+
+    if( 0 != rVal )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+    }
+    else
+    {
+      same = (single.segmentCount == threaded.segmentCount) &&
+             (0 == memcmp( single.pKnots, threaded.pKnots, (single.segmentCount + 1) * sizeof( double ))) &&
+             (0 == memcmp( single.pCoefficients, threaded.pCoefficients,
+                           single.segmentCount * 3 * sizeof( double )));
+      for( int s = 0; s < single.segmentCount - 1; s++ )
+      {
+        // Value and slope of segment s at its end, against segment s + 1 at its start.
+        double *pLeft = &(single.pCoefficients[ s * 3 ]);
+        double *pRight = &(pLeft[3]);
+        double t = single.pKnots[ s + 1 ] - single.pKnots[s];
+        double value = (((pLeft[0] * t) + pLeft[1]) * t) + pLeft[2];
+        double slope = (2.0 * pLeft[0] * t) + pLeft[1];
+        continuous = continuous && (fabs( value - pRight[2] ) <= 1e-9) && (fabs( slope - pRight[1] ) <= 1e-9);
+      }
+      polyfit_piecewise_eval( &single, PC21, xs21, ys21 );
+      for( int i = 0; i < PC21; i++ )
+      {
+        fits = fits && (fabs( ys21[i] - sin( xs21[i] )) <= 5e-3);
+      }
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "hinge %g %g %g; constants %g %g %g, joined %g %g %g; adaptive "
+                "%d segments, %s at knots, %s on 1 and 3 threads, %s", lines[0], lines[1], lines[2],
+                unjoined.pCoefficients[0], unjoined.pCoefficients[1], unjoined.pCoefficients[2],
+                joined.pCoefficients[0], joined.pCoefficients[1], joined.pCoefficients[2], single.segmentCount,
+                continuous ? "C1" : "not C1", same ? "same" : "not the same", fits ? "fits sin" : "doesn't fit sin" );
+    }
+    polyfit_piecewise_free( &unjoined );
+    polyfit_piecewise_free( &joined );
+    polyfit_piecewise_free( &single );
+    polyfit_piecewise_free( &threaded );
+  }
+  printf( "Test 21 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er21) )
+  {
+    printf( "Test 21 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 22---------------------------
+  printf( "Test 22 expected %s\n", er22);
+  {
+    polyfit_service_t *pService = NULL;
+    polyfit_service_metrics_t metrics;
+    int rightCount = 0;
+    int fullStatus = 0;
+
+    rVal = polyfit_service_create( &pService, 3, 4, 4 );
+    for( int j = 0; (0 == rVal) && (j < JC22); j++ )
+    {
+      // Line j: y = j * x + 1.
+      for( int i = 0; i < 5; i++ )
+      {
+        y22[j][i] = (j * x22[i]) + 1.0;
+      }
+      polyfit_job_t job = { 5, x22, y22[j], 2, cr22[j], (0 == (j % 2)) ? countJob22 : NULL, &callbacks22,
+                            0, 0, 0.0 };
+      jobs22[j] = job;
+      rVal = polyfit_service_submit( pService, &jobs22[j], true );
+    }
+    for( int j = 0; (0 == rVal) && (j < JC22); j++ )
+    {
+      rVal = polyfit_service_wait( pService, &jobs22[j] );
+      if( (fabs( cr22[j][0] - j ) <= 1e-9) && (fabs( cr22[j][1] - 1.0 ) <= 1e-9) )
+      {
+        rightCount += 1;
+      }
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_service_metrics( pService, &metrics );
+    }
+    polyfit_service_destroy( pService );
+
+    if( 0 == rVal )
+    {
+      int submitted = (int) metrics.submitted;
+      int completed = (int) metrics.completed;
+      bool latencies = (metrics.p99LatencyNs >= metrics.p50LatencyNs) && (metrics.p50LatencyNs > 0.0);
+      polyfit_job_t hold = { 5, x22, y22[0], 2, cr22[0], holdJob22, &release22, 0, 0, 0.0 };
+      polyfit_job_t fill = { 5, x22, y22[1], 2, cr22[1], NULL, NULL, 0, 0, 0.0 };
+      polyfit_job_t extra = { 5, x22, y22[2], 2, cr22[2], NULL, NULL, 0, 0, 0.0 };
+
+      rVal = polyfit_service_create( &pService, 1, 1, 2 );
+      if( 0 == rVal )
+      {
+        // Once the worker has taken the first job, the second fills the queue.
+        polyfit_service_submit( pService, &hold, true );
+        polyfit_service_submit( pService, &fill, true );
+        fullStatus = polyfit_service_submit( pService, &extra, false );
+        __atomic_store_n( &release22, 1, __ATOMIC_SEQ_CST );
+        polyfit_service_wait( pService, &fill );
+        polyfit_service_metrics( pService, &metrics );
+        polyfit_service_destroy( pService );
+
+        snprintf( polyStringBf, POLY_STRING_BF_SZ, "%d lines right, %d callbacks, %d completed, %s; full queue: %d, "
+                  "%lld rejected", rightCount, callbacks22, (submitted == completed) ? completed : -1,
+                  latencies ? "p99 >= p50 > 0" : "bad latencies", fullStatus, metrics.rejected );
+      }
+    }
+    if( 0 != rVal )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+    }
+  }
+  printf( "Test 22 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er22) )
+  {
+    printf( "Test 22 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 23---------------------------
+  printf( "Test 23 expected %s\n", er23);
+  {
+    polyfit_online_t online;
+    int matchCount = 0;
+    int stepCount = 0;
+    bool droppedMatch = false;
+    bool forgettingMatch = false;
+
+    for( int i = 0; i < PC23; i++ )
+    {
+      double t = i + (0.37 * sin( 1.7 * i ));
+      x23[i] = 1000.0 + t;
+      y23[i] = 3.0 - (0.5 * t) + (0.02 * t * t) + (0.1 * sin( 12.9 * i ));
+    }
+
+    rVal = polyfit_online_init( &online, 3, WL23, 1.0 );
+    for( int i = 0; (0 == rVal) && (i < PC23); i++ )
+    {
+      polyfit_online_add( &online, x23[i], y23[i] );
+      if( i >= WL23 - 1 )
+      {
+        stepCount += 1;
+        rVal = polyfit_online_solve( &online, cr23 );
+        if( 0 == rVal )
+        {
+          rVal = polyfit( WL23, &(x23[ i - WL23 + 1 ]), &(y23[ i - WL23 + 1 ]), 3, fixed23 );
+        }
+        bool same = true;
+        for( int p = i - WL23 + 1; p <= i; p++ )
+        {
+          double online23 = (((cr23[0] * x23[p]) + cr23[1]) * x23[p]) + cr23[2];
+          double fixedFit = (((fixed23[0] * x23[p]) + fixed23[1]) * x23[p]) + fixed23[2];
+          same = same && (fabs( online23 - fixedFit ) <= 1e-6 * (1.0 + fabs( fixedFit )));
+        }
+        matchCount += same ? 1 : 0;
+      }
+    }
+    for( int d = 0; (0 == rVal) && (d < 10); d++ )
+    {
+      rVal = polyfit_online_remove( &online );
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_online_solve( &online, cr23 );
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit( WL23 - 10, &(x23[ PC23 - WL23 + 10 ]), &(y23[ PC23 - WL23 + 10 ]), 3, fixed23 );
+      droppedMatch = (fabs( cr23[0] - fixed23[0] ) <= 1e-5 * fabs( fixed23[0] ));
+    }
+    polyfit_online_free( &online );
+
+    if( 0 == rVal )
+    {
+      rVal = polyfit_online_init( &online, 2, PC23, 0.9 );
+    }
+    if( 0 == rVal )
+    {
+      // Weighted sums of t = x - 1000, the newest point weighing 1.
+      double sw = 0.0, swt = 0.0, swtt = 0.0, swy = 0.0, swty = 0.0;
+      for( int i = 0; i < PC23; i++ )
+      {
+        double t = x23[i] - 1000.0;
+        double y = 2.0 + (0.25 * t) + (0.1 * sin( 12.9 * i ));
+        polyfit_online_add( &online, x23[i], y );
+        sw = (0.9 * sw) + 1.0;
+        swt = (0.9 * swt) + t;
+        swtt = (0.9 * swtt) + (t * t);
+        swy = (0.9 * swy) + y;
+        swty = (0.9 * swty) + (t * y);
+      }
+      double slope = ((sw * swty) - (swt * swy)) / ((sw * swtt) - (swt * swt));
+      double atEnd = (swy + (slope * ((sw * (x23[ PC23 - 1 ] - 1000.0)) - swt))) / sw;
+      rVal = polyfit_online_solve( &online, cr23 );
+      forgettingMatch = (fabs( cr23[0] - slope ) <= 1e-7) &&
+                        (fabs( (cr23[0] * x23[ PC23 - 1 ]) + cr23[1] - atEnd ) <= 1e-7);
+      polyfit_online_free( &online );
+    }
+
+    if( 0 != rVal )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+    }
+    else
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "window %s polyfit() at %d of %d points, and %s dropping 10; "
+                "forgetting %s the weighted line", (matchCount == stepCount) ? "matches" : "doesn't match",
+                matchCount, stepCount, droppedMatch ? "after" : "not after",
+                forgettingMatch ? "matches" : "doesn't match" );
+    }
+  }
+  printf( "Test 23 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er23) )
+  {
+    printf( "Test 23 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 24---------------------------
+  printf( "Test 24 expected %s\n", er24);
+  {
+    polyfit_accum_t shard;
+    polyfit_accum_t merged[SC24];
+    size_t length = 0;
+    int mergedCount = 0;
+    bool ordersMatch = true;
+    bool roundTrips = false;
+    int newerStatus = 0;
+    int otherSizeStatus = 0;
+
+    for( int i = 0; i < PC24; i++ )
+    {
+      x24[i] = -3.0 + ((6.0 * i) / PC24);
+      y24[i] = 0.5 - x24[i] + (0.25 * x24[i] * x24[i] * x24[i]) + (0.01 * sin( 7.3 * i ));
+    }
+
+    // Each shard accumulates its own points and sends only its state.
+    rVal = 0;
+    for( int s = 0; (0 == rVal) && (s < SC24); s++ )
+    {
+      int first = (0 == s) ? 0 : shardEnds24[ s - 1 ];
+      rVal = polyfit_accum_init( &shard, CC24 );
+      if( 0 == rVal )
+      {
+        rVal = polyfit_accum_add_many( &shard, shardEnds24[s] - first, &(x24[ first ]), &(y24[ first ]) );
+      }
+      if( 0 == rVal )
+      {
+        rVal = polyfit_accum_encode( state24[s], SB24, &shard, &length );
+      }
+      polyfit_accum_free( &shard );
+    }
+
+    // The coordinator decodes the states and merges them three ways.
+    for( int order = 0; (0 == rVal) && (order < 3); order++ )
+    {
+      for( mergedCount = 0; (0 == rVal) && (mergedCount < SC24); mergedCount++ )
+      {
+        int s = (1 == order) ? (SC24 - 1 - mergedCount) : mergedCount;
+        rVal = polyfit_accum_decode( state24[s], SB24, &merged[ mergedCount ], &length );
+      }
+      for( int s = 1; (0 == rVal) && (order < 2) && (s < SC24); s++ )
+      {
+        rVal = polyfit_accum_merge( &merged[0], &merged[s] );
+      }
+      // Order 2 merges pairs, then pairs of pairs, and so on.
+      for( int step = 1; (0 == rVal) && (2 == order) && (step < SC24); step *= 2 )
+      {
+        for( int s = 0; (0 == rVal) && (s + step < SC24); s += 2 * step )
+        {
+          rVal = polyfit_accum_merge( &merged[s], &merged[ s + step ] );
+        }
+      }
+      if( 0 == rVal )
+      {
+        rVal = polyfit_accum_solve( &merged[0], cr24[ order ] );
+      }
+      for( int s = 0; s < mergedCount; s++ )
+      {
+        polyfit_accum_free( &merged[s] );
+      }
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit( PC24, x24, y24, CC24, fixed24 );
+    }
+    for( int order = 0; (0 == rVal) && (order < 3); order++ )
+    {
+      for( int c = 0; c < CC24; c++ )
+      {
+        ordersMatch = ordersMatch && (fabs( cr24[ order ][c] - fixed24[c] ) <= 1e-12 * (1.0 + fabs( fixed24[c] )));
+      }
+    }
+
+    if( 0 == rVal )
+    {
+      unsigned char again[SB24];
+      rVal = polyfit_accum_decode( state24[3], SB24, &shard, &length );
+      if( 0 == rVal )
+      {
+        rVal = polyfit_accum_encode( again, SB24, &shard, &length );
+        roundTrips = (SB24 == length) && (0 == memcmp( again, state24[3], SB24 )) &&
+                     (0 == memcmp( again, "PFAS\x01\x00\x00\x00\x04\x00\x00\x00", 12 ));
+      }
+      polyfit_accum_free( &shard );
+
+      polyfit_accum_t smaller;
+      state24[3][4] = 2;
+      newerStatus = polyfit_accum_decode( state24[3], SB24, &shard, &length );
+      if( (0 == rVal) && (0 == polyfit_accum_init( &shard, CC24 )) && (0 == polyfit_accum_init( &smaller, 2 )) )
+      {
+        otherSizeStatus = polyfit_accum_merge( &shard, &smaller );
+        polyfit_accum_free( &smaller );
+      }
+      polyfit_accum_free( &shard );
+    }
+
+    if( 0 != rVal )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+    }
+    else
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "%d shards merged in 3 orders %s polyfit(); state %s; "
+                "newer version %d, other size %d", mergedCount, ordersMatch ? "match" : "don't match",
+                roundTrips ? "round trips exactly" : "doesn't round trip", newerStatus, otherSizeStatus );
+    }
+  }
+  printf( "Test 24 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er24) )
+  {
+    printf( "Test 24 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 25---------------------------
+  printf( "Test 25 expected %s\n", er25);
+  {
+    const int64_t startNs = 1700000000000000000LL;
+    polyfit_view_t timeView = { &(records25[0].timeNs), sizeof( record25_t ), POLYFIT_TYPE_TIME_NS, startNs };
+    polyfit_view_t valueView = { &(records25[0].value), sizeof( record25_t ), POLYFIT_TYPE_DOUBLE, 0 };
+    polyfit_view_t levelView = { &(records25[0].level), sizeof( record25_t ), POLYFIT_TYPE_FLOAT, 0 };
+    polyfit_view_t countView = { &(records25[0].count), sizeof( record25_t ), POLYFIT_TYPE_INT32, 0 };
+    polyfit_view_t xArrayView = { x25, sizeof( double ), POLYFIT_TYPE_DOUBLE, 0 };
+    polyfit_view_t yArrayView = { y25, sizeof( double ), POLYFIT_TYPE_DOUBLE, 0 };
+    polyfit_accum_t viewed;
+    polyfit_accum_t direct;
+    bool timeMatches = false;
+    bool levelMatches = false;
+    bool arraysExact = false;
+    int badTypeStatus = 0;
+
+    for( int i = 0; i < PC25; i++ )
+    {
+      double seconds = i * 1.000003e-3;
+      records25[i].timeNs = startNs + (i * 1000003LL);
+      records25[i].level = (float) (i * 0.01);
+      records25[i].count = (3 * i) - 1000;
+      records25[i].value = 2.0 + (3.0 * seconds) + (0.5 * seconds * seconds) + (1e-3 * sin( 4.1 * i ));
+    }
+
+    // Timestamps, against seconds worked out by hand.
+    rVal = polyfit_view_fit( PC25, &timeView, &valueView, 3, cr25 );
+    for( int i = 0; i < PC25; i++ )
+    {
+      x25[i] = (double) (records25[i].timeNs - startNs) * 1e-9;
+      y25[i] = records25[i].value;
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit( PC25, x25, y25, 3, fixed25 );
+    }
+    if( 0 == rVal )
+    {
+      timeMatches = (fabs( cr25[0] - 0.5 ) < 1e-2) && (fabs( cr25[1] - 3.0 ) < 1e-2) &&
+                    (fabs( cr25[2] - 2.0 ) < 1e-3);
+      for( int c = 0; c < 3; c++ )
+      {
+        timeMatches = timeMatches && (fabs( cr25[c] - fixed25[c] ) <= 1e-9 * (1.0 + fabs( fixed25[c] )));
+      }
+    }
+
+    // An int32 field against a float one.
+    if( 0 == rVal )
+    {
+      rVal = polyfit_view_fit( PC25, &levelView, &countView, 2, cr25 );
+    }
+    for( int i = 0; i < PC25; i++ )
+    {
+      x25[i] = records25[i].level;
+      y25[i] = records25[i].count;
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit( PC25, x25, y25, 2, fixed25 );
+      levelMatches = (fabs( cr25[0] - fixed25[0] ) <= 1e-9 * fabs( fixed25[0] )) &&
+                     (fabs( cr25[1] - fixed25[1] ) <= 1e-9 * fabs( fixed25[1] ));
+    }
+
+    // Plain arrays take the same path as the accumulator, so the sums are equal.
+    if( 0 == rVal )
+    {
+      rVal = polyfit_accum_init( &viewed, 3 );
+      if( 0 == rVal )
+      {
+        rVal = polyfit_accum_init( &direct, 3 );
+        if( 0 == rVal )
+        {
+          rVal = polyfit_accum_add_view( &viewed, PC25, &xArrayView, &yArrayView );
+          if( 0 == rVal )
+          {
+            rVal = polyfit_accum_add_many( &direct, PC25, x25, y25 );
+          }
+          arraysExact = (0 == rVal) && (0 == memcmp( viewed.pPowerSums, direct.pPowerSums, 8 * sizeof( double )));
+          countView.type = (polyfit_type_t) 7;
+          badTypeStatus = polyfit_accum_add_view( &viewed, PC25, &levelView, &countView );
+          polyfit_accum_free( &direct );
+        }
+        polyfit_accum_free( &viewed );
+      }
+    }
+
+    if( 0 != rVal )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+    }
+    else
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "timestamps %s; float and int32 %s; double arrays %s; "
+                "bad type %d", timeMatches ? "0.5 3 2 and match copies" : "don't match",
+                levelMatches ? "match copies" : "don't match", arraysExact ? "exact" : "differ", badTypeStatus );
+    }
+  }
+  printf( "Test 25 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er25) )
+  {
+    printf( "Test 25 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 26---------------------------
+  printf( "Test 26 expected %s\n", er26);
+  {
+    double low = 0.0;
+    double high = 0.0;
+    bool orthogonalMatches = true;
+    bool chebyshevMatches = true;
+    double worstError = 0.0;
+    int normalStatus = 0;
+    int distinctStatus = 0;
+
+    for( int i = 0; i < 100; i++ )
+    {
+      x26[i] = -3.0 + (0.06 * i) + (0.01 * sin( (double) i ));
+      y26[i] = 1.0 - (2.0 * x26[i]) + (0.5 * x26[i] * x26[i] * x26[i]) + (0.01 * sin( 7.7 * i ));
+    }
+    rVal = polyfit_orthogonal( 100, x26, y26, 5, cr26 );
+    if( 0 == rVal )
+    {
+      rVal = polyfit( 100, x26, y26, 5, fixed26 );
+    }
+    for( int c = 0; (0 == rVal) && (c < 5); c++ )
+    {
+      orthogonalMatches = orthogonalMatches && (fabs( cr26[c] - fixed26[c] ) <= 1e-9 * (1.0 + fabs( fixed26[c] )));
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyval( 5, cr26, 100, x26, y26 );
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_chebyshev( 100, x26, y26, 5, &low, &high, fixed26 );
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyval_chebyshev( 5, fixed26, low, high, 100, x26, v26 );
+    }
+    for( int i = 0; (0 == rVal) && (i < 100); i++ )
+    {
+      chebyshevMatches = chebyshevMatches && (fabs( v26[i] - y26[i] ) <= 1e-12 * (1.0 + fabs( y26[i] )));
+    }
+
+    for( int i = 0; i < PC26; i++ )
+    {
+      x26[i] = 1000.0 + ((6.0 * i) / (PC26 - 1)) + (0.003 * sin( (double) i ));
+      y26[i] = cos( 3.0 * x26[i] );
+    }
+    if( 0 == rVal )
+    {
+      normalStatus = polyfit( PC26, x26, y26, CC26, fixed26 );
+      rVal = polyfit_chebyshev( PC26, x26, y26, CC26, &low, &high, cr26 );
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyval_chebyshev( CC26, cr26, low, high, PC26, x26, v26 );
+    }
+    for( int i = 0; (0 == rVal) && (i < PC26); i++ )
+    {
+      worstError = fmax( worstError, fabs( v26[i] - y26[i] ));
+    }
+    if( 0 == rVal )
+    {
+      distinctStatus = polyfit_orthogonal( 6, xs26, xs26, 4, cr26 );
+    }
+
+    if( 0 != rVal )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+    }
+    else
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "orthogonal %s polyfit(), Chebyshev %s monomial; cos(3x) with %d: "
+                "polyfit() %d, Chebyshev %s 1e-11; 3 distinct x for 4: %d",
+                orthogonalMatches ? "matches" : "doesn't match", chebyshevMatches ? "matches" : "doesn't match",
+                CC26, normalStatus, (worstError < 1e-11) ? "within" : "not within", distinctStatus );
+    }
+  }
+  printf( "Test 26 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er26) )
+  {
+    printf( "Test 26 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 27---------------------------
+  printf( "Test 27 expected %s\n", er27);
+  {
+    polyfit_surface_t surface;
+    int termCount = 0;
+    int cubeAt = -1;
+    int countStatus = 0;
+    int threeCount = 0;
+    int fewStatus = 0;
+    bool recovered = true;
+    bool sparseMatches = true;
+    bool workspaceSame = false;
+    bool farMatches = true;
+    int smallStatus = 0;
+    polyfit_workspace_t workspace;
+    size_t workspaceSize = polyfit_surface_workspace_size( TC27 );
+    void *pMemory = malloc( workspaceSize );
+
+    rVal = polyfit_surface_terms( 2, 3, TC27, terms27, &termCount );
+    for( int t = 0; (0 == rVal) && (t < termCount); t++ )
+    {
+      cubeAt = ((cubeAt < 0) && (3 == terms27[2 * t])) ? t : cubeAt;
+    }
+    if( 0 == rVal )
+    {
+      countStatus = polyfit_surface_terms( 3, 2, 0, NULL, &threeCount );
+    }
+
+    for( int i = 0; i < PC27; i++ )
+    {
+      double x = 100.0 * (i % 20) / 19.0;
+      double y = 0.01 * (((i / 20) / 4.5) - 1.0);
+      in27[2 * i] = x;
+      in27[(2 * i) + 1] = y;
+      z27[i] = 0.0;
+      for( int t = 0; t < TC27; t++ )
+      {
+        z27[i] += cr27[t] * pow( x, terms27[2 * t] ) * pow( y, terms27[(2 * t) + 1] );
+      }
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_surface_fit( &surface, PC27, 2, in27, z27, TC27, terms27 );
+    }
+    for( int t = 0; (0 == rVal) && (t < TC27); t++ )
+    {
+      recovered = recovered && (fabs( surface.pCoefficients[t] - cr27[t] ) <= 1e-8 * fabs( cr27[t] ));
+    }
+
+    if( (0 == rVal) && (NULL == pMemory) )
+    {
+      rVal = -3;
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_workspace_init( &workspace, pMemory, workspaceSize, INT_MAX, TC27 );
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_surface_fit_ws( &workspace, PC27, 2, in27, z27, TC27, terms27, ws27 );
+      workspaceSame = (0 == rVal) && (0 == memcmp( ws27, surface.pCoefficients, sizeof( ws27 )));
+    }
+    if( 0 == rVal )
+    {
+      workspace.size = polyfit_surface_workspace_size( TC27 - 1 );
+      smallStatus = polyfit_surface_fit_ws( &workspace, PC27, 2, in27, z27, TC27, terms27, ws27 );
+    }
+    free( pMemory );
+    polyfit_surface_free( &surface );
+
+    double farLargest = 0.0;
+    for( int i = 0; i < PC27; i++ )
+    {
+      double u = (i % 20) / 19.0;
+      double v = (i / 20) / 9.0;
+      in27[2 * i] = 1000.0 + (10.0 * u);
+      in27[(2 * i) + 1] = 1000.0 + (10.0 * v);
+      z27[i] = 0.0;
+      for( int t = 0; t < TC27; t++ )
+      {
+        z27[i] += ((t % 3) - 0.5) * pow( u, terms27[2 * t] ) * pow( v, terms27[(2 * t) + 1] );
+      }
+      farLargest = fmax( farLargest, fabs( z27[i] ));
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_surface_fit( &surface, PC27, 2, in27, z27, TC27, terms27 );
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_surface_eval( &surface, PC27, in27, v27 );
+    }
+    for( int i = 0; (0 == rVal) && (i < PC27); i++ )
+    {
+      farMatches = farMatches && (fabs( v27[i] - z27[i] ) <= 1e-10 * farLargest);
+    }
+    polyfit_surface_free( &surface );
+
+    for( int i = 0; i < PC27; i++ )
+    {
+      double x = -1.0 + (0.01 * i);
+      double y = 3.0 * sin( 0.7 * i );
+      double w = 10.0 * cos( 1.3 * i );
+      in27[3 * i] = x;
+      in27[(3 * i) + 1] = y;
+      in27[(3 * i) + 2] = w;
+      z27[i] = crs27[0] + (crs27[1] * x) + (crs27[2] * w * w) + (crs27[3] * x * y * w) + (crs27[4] * y * y * y) +
+               (0.01 * sin( 5.1 * i ));
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_surface_fit( &surface, PC27, 3, in27, z27, 5, sparse27 );
+    }
+    if( 0 == rVal )
+    {
+      rVal = polyfit_surface_eval( &surface, PC27, in27, v27 );
+    }
+    for( int i = 0; (0 == rVal) && (i < PC27); i++ )
+    {
+      sparseMatches = sparseMatches && (fabs( v27[i] - z27[i] ) <= 0.05);
+    }
+    polyfit_surface_free( &surface );
+    if( 0 == rVal )
+    {
+      fewStatus = polyfit_surface_fit( &surface, 4, 3, in27, z27, 5, sparse27 );
+    }
+
+    if( 0 != rVal )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+    }
+    else
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "%d terms, first x^3 at %d; 3 dimensions of degree 2: %d with %d; "
+                "cubic %s; sparse %s; 4 points for 5 terms: %d; workspace fit %s, too small: %d; cubic at 1000 %s",
+                termCount, cubeAt, countStatus, threeCount, recovered ? "recovered" : "not recovered",
+                sparseMatches ? "matches" : "doesn't match", fewStatus, workspaceSame ? "identical" : "differs",
+                smallStatus, farMatches ? "within 1e-10" : "off by more than 1e-10" );
+    }
+  }
+  printf( "Test 27 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er27) )
+  {
+    printf( "Test 27 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
+//---------------------TEST 28---------------------------
+  printf( "Test 28 expected %s\n", er28);
+  {
+    char text[ 48 ];
+    const char *pLocale = NULL;
+    size_t length = 0;
+    size_t used = 0;
+    int count = 0;
+    int written = 0;
+    bool readExactly = false;
+    uint64_t seed = 2020u;
+
+    for( size_t l = 0; (NULL == pLocale) && (l < sizeof( locales28 ) / sizeof( locales28[0] )); l++ )
+    {
+      if( (NULL != setlocale( LC_NUMERIC, locales28[l] )) && (0 == strcmp( localeconv()->decimal_point, "," )) )
+      {
+        pLocale = locales28[l];
+      }
+    }
+    if( NULL == pLocale )
+    {
+      setlocale( LC_NUMERIC, "C" );
+    }
+    printf( "Test 28 running in the %s locale\n", (NULL != pLocale) ? pLocale : "C (no comma locale is installed)" );
+
+    rVal = polyfit_decode_json( json28, strlen( json28 ), 3, d28, &count, &used );
+    readExactly = (0 == rVal) && (3 == count) && (1.5 == d28[0]) && (-2.25e-3 == d28[1]) && (0.1 == d28[2]);
+
+    for( int v = 0; (0 == rVal) && (v < VC28); v++ )
+    {
+      double value;
+      seed = (seed * 6364136223846793005u) + 1442695040888963407u;
+      memcpy( &value, &seed, sizeof( value ));
+      if( !isfinite( value ) )
+      {
+        value = 1.0 / 3.0;
+      }
+      text[0] = '[';
+      rVal = polyfit_format_double( &(text[1]), sizeof( text ) - 2, value, &length );
+      if( 0 == rVal )
+      {
+        text[ length + 1 ] = ']';
+        rVal = polyfit_decode_json( text, length + 2, 1, d28, &count, &used );
+      }
+      if( (0 == rVal) && (NULL == strchr( text, ',' )) && (0 == memcmp( &value, d28, sizeof( value ))) )
+      {
+        written += 1;
+      }
+    }
+    setlocale( LC_NUMERIC, "C" );
+
+    if( 0 != rVal )
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "error = %d", rVal );
+    }
+    else
+    {
+      snprintf( polyStringBf, POLY_STRING_BF_SZ, "%s %s; %d random doubles written with '.' and read back exactly",
+                json28, readExactly ? "read exactly" : "changed", written );
+    }
+  }
+  printf( "Test 28 produced %s\n", polyStringBf);
+  if( 0 == strcmp( polyStringBf, er28) )
+  {
+    printf( "Test 28 passed OK.\n\n");
+    passedCount += 1;
+  }
+  else
+  {
+    printf( "Test failed.\n\n");
+    failedCount += 1;
+  }
+
 //---------------------SUMMARY--------------------------- 
   printf( "Tests complete: %d passed, %d failed.\n", passedCount, failedCount); 
   return( -failedCount );